@@ -0,0 +1,806 @@
+/* Writes a synthetic file-per-table tablespace for benchmarks: the
+sbtest1 table of sysbench (id INT PRIMARY KEY, k INT, c CHAR(120),
+pad CHAR(60), latin1) with its clustered index bulk loaded in key order,
+and the ibd2sdi json that describes it.
+
+The file is laid out the way InnoDB lays out a table it created: an
+FSP_HDR page and an XDES page every page_size pages describing every
+extent, an INODE page holding the two segments of the index, the first
+32 pages of each segment taken as fragment pages and the rest in whole
+extents, compact records with a page directory, and CRC32 checksums. */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/fil0fil.h"
+#include "include/fil0types.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page0types.h"
+#include "include/page_crc32.h"
+#include "include/rem0types.h"
+#include "include/rec.h"
+#include "include/ut0crc32.h"
+
+/** Pages of an extent, pages of the file described by one XDES page */
+static const page_no_t IBDGEN_EXTENT_PAGES = FSP_EXTENT_SIZE;
+static const page_no_t IBDGEN_XDES_PAGES = UNIV_PAGE_SIZE;
+
+/** Bytes of a user record of sbtest1: id, DB_TRX_ID, DB_ROLL_PTR, k, c,
+pad, after its 5-byte header */
+static const ulint IBDGEN_LEAF_REC_SIZE = 4 + 6 + 7 + 4 + 120 + 60;
+/** Bytes of a node pointer: id and the child page number */
+static const ulint IBDGEN_NODE_REC_SIZE = 4 + 4;
+
+/** Page directory, growing down from the FIL trailer; InnoDB's names,
+which the tool does not need elsewhere */
+static const ulint PAGE_DIR = FIL_PAGE_DATA_END;
+static const ulint PAGE_DIR_SLOT_SIZE = 2;
+
+/** LSN of the first page; page n is written at IBDGEN_LSN + n, so that
+--since-lsn can pick any part of the file */
+static const uint64_t IBDGEN_LSN = 100000;
+
+enum ibdgen_page_kind_t {
+  IBDGEN_FREE,
+  IBDGEN_FSP_HDR,
+  IBDGEN_IBUF_BITMAP,
+  IBDGEN_INODE,
+  IBDGEN_XDES,
+  IBDGEN_SDI,
+  IBDGEN_INDEX
+};
+
+/** Segments in the order of their inodes: the two of the SDI index, as
+every MySQL 8.0 tablespace has them, then the two of the clustered
+index */
+enum ibdgen_seg_no_t {
+  IBDGEN_SEG_SDI_TOP,
+  IBDGEN_SEG_SDI_LEAF,
+  IBDGEN_SEG_TOP,
+  IBDGEN_SEG_LEAF,
+  IBDGEN_N_SEGS
+};
+
+/** Index id of the SDI index, as dict_sdi_get_index_id() gives it */
+static const uint64_t IBDGEN_SDI_INDEX_ID = UINT64_MAX - 1;
+
+struct ibdgen_page_t {
+  ibdgen_page_kind_t kind;
+  /** B-tree level and position in the level of an index page */
+  uint32_t level;
+  uint32_t pos;
+};
+
+struct ibdgen_extent_t {
+  ibdgen_extent_t() : state(XDES_FREE), seg_id(0), used(0) {}
+
+  uint32_t state;
+  uint64_t seg_id;
+  /** one bit per page, set if the page is used */
+  uint64_t used;
+
+  uint32_t n_used() const { return __builtin_popcountll(used); }
+  bool is_full() const { return n_used() == IBDGEN_EXTENT_PAGES; }
+};
+
+/** A segment, with its inode in slot seg_no of the INODE page and id
+seg_no + 1 */
+struct ibdgen_seg_t {
+  std::vector<page_no_t> frag;
+  std::vector<uint32_t> extents;
+};
+
+/** The file being laid out */
+struct ibdgen_t {
+  space_id_t space_id;
+  uint64_t index_id;
+  uint32_t space_flags;
+
+  uint64_t n_rows;
+  /** records on a leaf page and on a non-leaf page */
+  uint64_t n_per_leaf;
+  uint64_t n_per_node;
+
+  std::vector<ibdgen_page_t> pages;
+  std::vector<ibdgen_extent_t> extents;
+  /** extents giving out fragment pages, in order */
+  std::vector<uint32_t> frag_extents;
+  size_t frag_cur;
+
+  ibdgen_seg_t segs[IBDGEN_N_SEGS];
+  /** page numbers of each level, leaves first */
+  std::vector<std::vector<page_no_t>> levels;
+};
+
+static void ibdgen_use_page(ibdgen_t *gen, page_no_t page_no,
+                            ibdgen_page_kind_t kind) {
+  gen->extents[page_no / IBDGEN_EXTENT_PAGES].used |=
+      1ULL << (page_no % IBDGEN_EXTENT_PAGES);
+  gen->pages[page_no].kind = kind;
+}
+
+/** Adds an extent at the end of the file. An extent starting with an XDES
+page is made a fragment extent, as InnoDB makes it. */
+static uint32_t ibdgen_add_extent(ibdgen_t *gen) {
+  uint32_t e = gen->extents.size();
+  page_no_t first = e * IBDGEN_EXTENT_PAGES;
+  gen->extents.emplace_back();
+  gen->pages.resize(first + IBDGEN_EXTENT_PAGES);
+  if (first % IBDGEN_XDES_PAGES != 0) {
+    return e;
+  }
+  gen->extents[e].state = XDES_FREE_FRAG;
+  gen->frag_extents.push_back(e);
+  if (e == 0) {
+    ibdgen_use_page(gen, 0, IBDGEN_FSP_HDR);
+    ibdgen_use_page(gen, 1, IBDGEN_IBUF_BITMAP);
+    ibdgen_use_page(gen, 2, IBDGEN_INODE);
+  } else {
+    ibdgen_use_page(gen, first, IBDGEN_XDES);
+    ibdgen_use_page(gen, first + 1, IBDGEN_IBUF_BITMAP);
+  }
+  return e;
+}
+
+static page_no_t ibdgen_alloc_frag_page(ibdgen_t *gen) {
+  for (;;) {
+    while (gen->frag_cur < gen->frag_extents.size() &&
+           gen->extents[gen->frag_extents[gen->frag_cur]].is_full()) {
+      gen->frag_cur++;
+    }
+    if (gen->frag_cur < gen->frag_extents.size()) {
+      break;
+    }
+    uint32_t e = ibdgen_add_extent(gen);
+    if (gen->extents[e].state == XDES_FREE) {
+      gen->extents[e].state = XDES_FREE_FRAG;
+      gen->frag_extents.push_back(e);
+    }
+  }
+  uint32_t e = gen->frag_extents[gen->frag_cur];
+  page_no_t page_no =
+      e * IBDGEN_EXTENT_PAGES + __builtin_ctzll(~gen->extents[e].used);
+  ibdgen_use_page(gen, page_no, IBDGEN_INDEX);
+  return page_no;
+}
+
+/** Allocates the next page of a segment as fseg_alloc_free_page() does:
+fragment pages until the fragment array is full, then whole extents. */
+static page_no_t ibdgen_alloc_page(ibdgen_t *gen, ibdgen_seg_no_t seg_no) {
+  ibdgen_seg_t *seg = &gen->segs[seg_no];
+  if (seg->frag.size() < FSEG_FRAG_ARR_N_SLOTS) {
+    seg->frag.push_back(ibdgen_alloc_frag_page(gen));
+    return seg->frag.back();
+  }
+  if (seg->extents.empty() || gen->extents[seg->extents.back()].is_full()) {
+    uint32_t e;
+    do {
+      e = ibdgen_add_extent(gen);
+    } while (gen->extents[e].state != XDES_FREE);
+    gen->extents[e].state = XDES_FSEG;
+    gen->extents[e].seg_id = seg_no + 1;
+    seg->extents.push_back(e);
+  }
+  uint32_t e = seg->extents.back();
+  page_no_t page_no = e * IBDGEN_EXTENT_PAGES + gen->extents[e].n_used();
+  ibdgen_use_page(gen, page_no, IBDGEN_INDEX);
+  return page_no;
+}
+
+/** Number of records of a size that fit on a page filled to fill percent,
+leaving room for the page directory. */
+static uint64_t ibdgen_recs_per_page(ulint rec_size, uint32_t fill) {
+  ulint space = (UNIV_PAGE_SIZE - PAGE_NEW_SUPREMUM_END - FIL_PAGE_DATA_END) *
+                fill / 100;
+  uint64_t n = 0;
+  while (PAGE_NEW_SUPREMUM_END + (n + 1) * (REC_N_NEW_EXTRA_BYTES + rec_size) +
+             PAGE_DIR_SLOT_SIZE * ((n + 1) / 4 + 2) <=
+         PAGE_NEW_SUPREMUM_END + space) {
+    n++;
+  }
+  return std::max<uint64_t>(n, 2);
+}
+
+/** Lays out the B-tree: the root first, as btr_create() allocates it, then
+the leaves left to right, then the levels above them. */
+static void ibdgen_layout(ibdgen_t *gen) {
+  std::vector<uint64_t> counts(1, (gen->n_rows + gen->n_per_leaf - 1) /
+                                      gen->n_per_leaf);
+  counts[0] = std::max<uint64_t>(counts[0], 1);
+  while (counts.back() > 1) {
+    counts.push_back((counts.back() + gen->n_per_node - 1) / gen->n_per_node);
+  }
+
+  gen->frag_cur = 0;
+  /* the SDI root is page 3, the root of the clustered index page 4; the
+  SDI itself is in the json written next to the file */
+  gen->pages[ibdgen_alloc_page(gen, IBDGEN_SEG_SDI_TOP)].kind = IBDGEN_SDI;
+  page_no_t root = ibdgen_alloc_page(gen, IBDGEN_SEG_TOP);
+  gen->levels.resize(counts.size());
+  for (size_t level = 0; level + 1 < counts.size(); level++) {
+    ibdgen_seg_no_t seg = level == 0 ? IBDGEN_SEG_LEAF : IBDGEN_SEG_TOP;
+    for (uint64_t i = 0; i < counts[level]; i++) {
+      gen->levels[level].push_back(ibdgen_alloc_page(gen, seg));
+    }
+  }
+  gen->levels.back().push_back(root);
+
+  for (size_t level = 0; level < gen->levels.size(); level++) {
+    for (size_t i = 0; i < gen->levels[level].size(); i++) {
+      ibdgen_page_t &page = gen->pages[gen->levels[level][i]];
+      page.level = level;
+      page.pos = i;
+    }
+  }
+}
+
+/** Smallest id of the subtree of a page */
+static uint64_t ibdgen_min_key(const ibdgen_t *gen, uint32_t level,
+                               uint64_t pos) {
+  while (level > 0) {
+    pos *= gen->n_per_node;
+    level--;
+  }
+  return pos * gen->n_per_leaf + 1;
+}
+
+static void ibdgen_write_addr(byte *ptr, page_no_t page_no, ulint boffset) {
+  mach_write_to_4(ptr, page_no);
+  mach_write_to_2(ptr + 4, boffset);
+}
+
+/** Address of the list node in the descriptor of an extent */
+static void ibdgen_xdes_addr(uint32_t e, page_no_t *page_no, ulint *boffset) {
+  page_no_t first = e * IBDGEN_EXTENT_PAGES;
+  *page_no = first - first % IBDGEN_XDES_PAGES;
+  *boffset = XDES_ARR_OFFSET +
+             XDES_SIZE * (first % IBDGEN_XDES_PAGES / IBDGEN_EXTENT_PAGES) +
+             XDES_FLST_NODE;
+}
+
+/** Writes a list of extents: its base node, and the node of every extent
+when its XDES page is the one being written. */
+static void ibdgen_write_list(const std::vector<uint32_t> &list, byte *base,
+                              byte *xdes_page, page_no_t xdes_page_no) {
+  page_no_t page_no;
+  ulint boffset;
+  if (base != nullptr) {
+    mach_write_to_4(base + FLST_LEN, list.size());
+    ibdgen_write_addr(base + FLST_FIRST, FIL_NULL, 0);
+    ibdgen_write_addr(base + FLST_LAST, FIL_NULL, 0);
+    if (!list.empty()) {
+      ibdgen_xdes_addr(list.front(), &page_no, &boffset);
+      ibdgen_write_addr(base + FLST_FIRST, page_no, boffset);
+      ibdgen_xdes_addr(list.back(), &page_no, &boffset);
+      ibdgen_write_addr(base + FLST_LAST, page_no, boffset);
+    }
+  }
+  for (size_t i = 0; i < list.size(); i++) {
+    ibdgen_xdes_addr(list[i], &page_no, &boffset);
+    if (page_no != xdes_page_no) {
+      continue;
+    }
+    byte *node = xdes_page + boffset;
+    ibdgen_write_addr(node + FLST_PREV, FIL_NULL, 0);
+    ibdgen_write_addr(node + FLST_NEXT, FIL_NULL, 0);
+    if (i > 0) {
+      ibdgen_xdes_addr(list[i - 1], &page_no, &boffset);
+      ibdgen_write_addr(node + FLST_PREV, page_no, boffset);
+    }
+    if (i + 1 < list.size()) {
+      ibdgen_xdes_addr(list[i + 1], &page_no, &boffset);
+      ibdgen_write_addr(node + FLST_NEXT, page_no, boffset);
+    }
+  }
+}
+
+/** Lists of extents kept in the space header and the segment inodes */
+struct ibdgen_lists_t {
+  std::vector<uint32_t> free_frag;
+  std::vector<uint32_t> full_frag;
+  std::vector<uint32_t> seg_full[IBDGEN_N_SEGS];
+  std::vector<uint32_t> seg_not_full[IBDGEN_N_SEGS];
+  /** pages used in the extents of FSP_FREE_FRAG */
+  uint32_t frag_n_used;
+  uint32_t seg_not_full_n_used[IBDGEN_N_SEGS];
+};
+
+static void ibdgen_build_lists(ibdgen_t *gen, ibdgen_lists_t *lists) {
+  lists->frag_n_used = 0;
+  for (uint32_t e : gen->frag_extents) {
+    ibdgen_extent_t &extent = gen->extents[e];
+    if (extent.is_full()) {
+      extent.state = XDES_FULL_FRAG;
+      lists->full_frag.push_back(e);
+    } else {
+      lists->free_frag.push_back(e);
+      lists->frag_n_used += extent.n_used();
+    }
+  }
+  for (int i = 0; i < IBDGEN_N_SEGS; i++) {
+    lists->seg_not_full_n_used[i] = 0;
+    for (uint32_t e : gen->segs[i].extents) {
+      if (gen->extents[e].is_full()) {
+        lists->seg_full[i].push_back(e);
+      } else {
+        lists->seg_not_full[i].push_back(e);
+        lists->seg_not_full_n_used[i] += gen->extents[e].n_used();
+      }
+    }
+  }
+}
+
+/** Writes the descriptors of the extents an FSP_HDR or XDES page covers */
+static void ibdgen_write_xdes(const ibdgen_t *gen, const ibdgen_lists_t &lists,
+                              page_no_t page_no, byte *page) {
+  for (uint32_t i = 0; i < IBDGEN_XDES_PAGES / IBDGEN_EXTENT_PAGES; i++) {
+    uint32_t e = page_no / IBDGEN_EXTENT_PAGES + i;
+    if (e >= gen->extents.size()) {
+      break;
+    }
+    const ibdgen_extent_t &extent = gen->extents[e];
+    byte *xdes = page + XDES_ARR_OFFSET + XDES_SIZE * i;
+    mach_write_to_8(xdes + XDES_ID, extent.seg_id);
+    mach_write_to_4(xdes + XDES_STATE, extent.state);
+    for (page_no_t p = 0; p < IBDGEN_EXTENT_PAGES; p++) {
+      /* a free bit and a clean bit per page */
+      ulint bit = p * XDES_BITS_PER_PAGE;
+      if (!(extent.used & (1ULL << p))) {
+        xdes[XDES_BITMAP + (bit + XDES_FREE_BIT) / 8] |=
+            1 << ((bit + XDES_FREE_BIT) % 8);
+      }
+      xdes[XDES_BITMAP + (bit + XDES_CLEAN_BIT) / 8] |=
+          1 << ((bit + XDES_CLEAN_BIT) % 8);
+    }
+  }
+  ibdgen_write_list(lists.free_frag, nullptr, page, page_no);
+  ibdgen_write_list(lists.full_frag, nullptr, page, page_no);
+  for (int i = 0; i < IBDGEN_N_SEGS; i++) {
+    ibdgen_write_list(lists.seg_full[i], nullptr, page, page_no);
+    ibdgen_write_list(lists.seg_not_full[i], nullptr, page, page_no);
+  }
+}
+
+static void ibdgen_write_fsp_hdr(const ibdgen_t *gen,
+                                 const ibdgen_lists_t &lists, byte *page) {
+  byte *header = page + FSP_HEADER_OFFSET;
+  mach_write_to_4(header + FSP_SPACE_ID, gen->space_id);
+  mach_write_to_4(header + FSP_SIZE, gen->pages.size());
+  mach_write_to_4(header + FSP_FREE_LIMIT, gen->pages.size());
+  mach_write_to_4(header + FSP_SPACE_FLAGS, gen->space_flags);
+  mach_write_to_4(header + FSP_FRAG_N_USED, lists.frag_n_used);
+  ibdgen_write_list(std::vector<uint32_t>(), header + FSP_FREE, page, 0);
+  ibdgen_write_list(lists.free_frag, header + FSP_FREE_FRAG, page, 0);
+  ibdgen_write_list(lists.full_frag, header + FSP_FULL_FRAG, page, 0);
+  mach_write_to_8(header + FSP_SEG_ID, IBDGEN_N_SEGS + 1);
+  /* the INODE page has free slots */
+  mach_write_to_4(header + FSP_SEG_INODES_FULL + FLST_LEN, 0);
+  ibdgen_write_addr(header + FSP_SEG_INODES_FULL + FLST_FIRST, FIL_NULL, 0);
+  ibdgen_write_addr(header + FSP_SEG_INODES_FULL + FLST_LAST, FIL_NULL, 0);
+  mach_write_to_4(header + FSP_SEG_INODES_FREE + FLST_LEN, 1);
+  ibdgen_write_addr(header + FSP_SEG_INODES_FREE + FLST_FIRST, 2,
+                    FSEG_INODE_PAGE_NODE);
+  ibdgen_write_addr(header + FSP_SEG_INODES_FREE + FLST_LAST, 2,
+                    FSEG_INODE_PAGE_NODE);
+  ibdgen_write_xdes(gen, lists, 0, page);
+}
+
+static void ibdgen_write_inode(const ibdgen_t *gen, const ibdgen_lists_t &lists,
+                               byte *page) {
+  ibdgen_write_addr(page + FSEG_INODE_PAGE_NODE + FLST_PREV, FIL_NULL, 0);
+  ibdgen_write_addr(page + FSEG_INODE_PAGE_NODE + FLST_NEXT, FIL_NULL, 0);
+  for (int i = 0; i < IBDGEN_N_SEGS; i++) {
+    const ibdgen_seg_t &seg = gen->segs[i];
+    byte *inode = page + FSEG_ARR_OFFSET + FSEG_INODE_SIZE * i;
+    mach_write_to_8(inode + FSEG_ID, i + 1);
+    mach_write_to_4(inode + FSEG_NOT_FULL_N_USED,
+                    lists.seg_not_full_n_used[i]);
+    ibdgen_write_list(std::vector<uint32_t>(), inode + FSEG_FREE, nullptr,
+                      FIL_NULL);
+    ibdgen_write_list(lists.seg_not_full[i], inode + FSEG_NOT_FULL, nullptr,
+                      FIL_NULL);
+    ibdgen_write_list(lists.seg_full[i], inode + FSEG_FULL, nullptr,
+                      FIL_NULL);
+    mach_write_to_4(inode + FSEG_MAGIC_N, FSEG_MAGIC_N_VALUE);
+    for (ulint slot = 0; slot < FSEG_FRAG_ARR_N_SLOTS; slot++) {
+      mach_write_to_4(inode + FSEG_FRAG_ARR + slot * FSEG_FRAG_SLOT_SIZE,
+                      slot < seg.frag.size() ? seg.frag[slot] : FIL_NULL);
+    }
+  }
+}
+
+/** Writes the 5-byte header of a compact record but its next offset,
+which is written once the next record is placed */
+static void ibdgen_rec_header(byte *rec, ulint info_bits, ulint heap_no,
+                              ulint status) {
+  rec[-5] = (byte)info_bits;
+  mach_write_to_2(rec - 4, (heap_no << REC_HEAP_NO_SHIFT) | status);
+}
+
+/** Random-looking digits, as sysbench fills c and pad with */
+static void ibdgen_fill_digits(byte *ptr, ulint len, ulint n_groups,
+                               uint64_t seed) {
+  memset(ptr, ' ', len);
+  ulint pos = 0;
+  for (ulint g = 0; g < n_groups; g++) {
+    if (g > 0) {
+      ptr[pos++] = '-';
+    }
+    for (int d = 0; d < 11; d++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ptr[pos++] = '0' + (seed >> 59) % 10;
+    }
+  }
+}
+
+/** Writes the records of an index page with its directory and header.
+The root of the SDI index is left empty. */
+static void ibdgen_write_index(const ibdgen_t *gen, page_no_t page_no,
+                               byte *page) {
+  const ibdgen_page_t &desc = gen->pages[page_no];
+  const bool is_sdi = desc.kind == IBDGEN_SDI;
+  const std::vector<page_no_t> &level = gen->levels[desc.level];
+  const bool is_leaf = desc.level == 0;
+  const uint64_t per_page = is_leaf ? gen->n_per_leaf : gen->n_per_node;
+  const uint64_t n_below = is_leaf ? gen->n_rows
+                                   : gen->levels[desc.level - 1].size();
+  const uint64_t first = desc.pos * per_page;
+  const uint64_t n_recs =
+      is_sdi ? 0 : std::min<uint64_t>(per_page, n_below - first);
+  const ulint rec_size =
+      REC_N_NEW_EXTRA_BYTES + (is_leaf ? IBDGEN_LEAF_REC_SIZE
+                                       : IBDGEN_NODE_REC_SIZE);
+
+  mach_write_to_4(page + FIL_PAGE_PREV,
+                  !is_sdi && desc.pos > 0 ? level[desc.pos - 1] : FIL_NULL);
+  mach_write_to_4(page + FIL_PAGE_NEXT,
+                  !is_sdi && desc.pos + 1 < level.size() ? level[desc.pos + 1]
+                                                         : FIL_NULL);
+
+  /* offsets below are from the page start */
+  byte *base = page;
+  std::vector<ulint> slots(1, PAGE_NEW_INFIMUM);
+  ulint heap_top = PAGE_NEW_SUPREMUM_END;
+  ulint n_owned = 0;
+  ulint prev = PAGE_NEW_INFIMUM;
+  for (uint64_t i = 0; i < n_recs; i++) {
+    ulint off = heap_top + REC_N_NEW_EXTRA_BYTES;
+    byte *rec = base + off;
+    uint64_t n = first + i;
+    if (is_leaf) {
+      uint64_t id = n + 1;
+      mach_write_to_4(rec, (id & 0xFFFFFFFF) ^ 0x80000000);
+      mach_write_to_6(rec + 4, 1000 + id);
+      /* an insert undo record, purged */
+      mach_write_to_8(rec + 10, 1ULL << 63);
+      uint64_t k = (id * 2654435761ULL) % gen->n_rows + 1;
+      mach_write_to_4(rec + 17, (k & 0xFFFFFFFF) ^ 0x80000000);
+      ibdgen_fill_digits(rec + 21, 120, 10, id);
+      ibdgen_fill_digits(rec + 141, 60, 5, id * 31);
+    } else {
+      mach_write_to_4(rec,
+                      (ibdgen_min_key(gen, desc.level - 1, n) & 0xFFFFFFFF) ^
+                          0x80000000);
+      mach_write_to_4(rec + 4, gen->levels[desc.level - 1][n]);
+    }
+    ulint info_bits =
+        !is_leaf && desc.pos == 0 && i == 0 ? REC_INFO_MIN_REC_FLAG : 0;
+    ibdgen_rec_header(rec, info_bits, PAGE_HEAP_NO_USER_LOW + i,
+                      is_leaf ? REC_STATUS_ORDINARY : REC_STATUS_NODE_PTR);
+    /* link the previous record to this one */
+    mach_write_to_2(base + prev - 2, (off - prev) & 0xFFFF);
+    prev = off;
+    heap_top += rec_size;
+
+    /* a slot owns 4 records, the supremum owns the last 1 to 8 */
+    if (++n_owned == 4 && n_recs - i - 1 >= 4) {
+      base[off - 5] |= n_owned;
+      slots.push_back(off);
+      n_owned = 0;
+    }
+  }
+  mach_write_to_2(base + prev - 2, (PAGE_NEW_SUPREMUM - prev) & 0xFFFF);
+
+  /* infimum and supremum */
+  memcpy(base + PAGE_NEW_INFIMUM, "infimum\0", 8);
+  base[PAGE_NEW_INFIMUM - 5] = 1;
+  mach_write_to_2(base + PAGE_NEW_INFIMUM - 4,
+                  (PAGE_HEAP_NO_INFIMUM << REC_HEAP_NO_SHIFT) |
+                      REC_STATUS_INFIMUM);
+  if (n_recs == 0) {
+    mach_write_to_2(base + PAGE_NEW_INFIMUM - 2,
+                    PAGE_NEW_SUPREMUM - PAGE_NEW_INFIMUM);
+  }
+  memcpy(base + PAGE_NEW_SUPREMUM, "supremum", 8);
+  base[PAGE_NEW_SUPREMUM - 5] = n_owned + 1;
+  mach_write_to_2(base + PAGE_NEW_SUPREMUM - 4,
+                  (PAGE_HEAP_NO_SUPREMUM << REC_HEAP_NO_SHIFT) |
+                      REC_STATUS_SUPREMUM);
+  mach_write_to_2(base + PAGE_NEW_SUPREMUM - 2, 0);
+  slots.push_back(PAGE_NEW_SUPREMUM);
+
+  for (size_t s = 0; s < slots.size(); s++) {
+    mach_write_to_2(page + UNIV_PAGE_SIZE - PAGE_DIR - PAGE_DIR_SLOT_SIZE * (s + 1),
+                    slots[s]);
+  }
+
+  byte *header = page + PAGE_HEADER;
+  mach_write_to_2(header + PAGE_N_DIR_SLOTS, slots.size());
+  mach_write_to_2(header + PAGE_HEAP_TOP, heap_top);
+  mach_write_to_2(header + PAGE_N_HEAP,
+                  PAGE_IS_COMPACT | (PAGE_HEAP_NO_USER_LOW + n_recs));
+  mach_write_to_2(header + PAGE_LAST_INSERT,
+                  n_recs > 0 ? prev : 0);
+  mach_write_to_2(header + PAGE_DIRECTION, PAGE_RIGHT);
+  mach_write_to_2(header + PAGE_N_DIRECTION, n_recs);
+  mach_write_to_2(header + PAGE_N_RECS, n_recs);
+  mach_write_to_2(header + PAGE_LEVEL, desc.level);
+  mach_write_to_8(header + PAGE_INDEX_ID,
+                  is_sdi ? IBDGEN_SDI_INDEX_ID : gen->index_id);
+
+  if (is_sdi || desc.level + 1 == gen->levels.size()) {
+    /* the root points to the inodes of both segments */
+    const int segs[2] = {is_sdi ? IBDGEN_SEG_SDI_LEAF : IBDGEN_SEG_LEAF,
+                         is_sdi ? IBDGEN_SEG_SDI_TOP : IBDGEN_SEG_TOP};
+    const ulint fields[2] = {PAGE_BTR_SEG_LEAF, PAGE_BTR_SEG_TOP};
+    for (int i = 0; i < 2; i++) {
+      byte *seg_header = header + fields[i];
+      mach_write_to_4(seg_header + FSEG_HDR_SPACE, gen->space_id);
+      mach_write_to_4(seg_header + FSEG_HDR_PAGE_NO, 2);
+      mach_write_to_2(seg_header + FSEG_HDR_OFFSET,
+                      FSEG_ARR_OFFSET + FSEG_INODE_SIZE * segs[i]);
+    }
+  }
+}
+
+/** Fills the FIL header and trailer and the checksums of a written page */
+static void ibdgen_seal(const ibdgen_t *gen, page_no_t page_no,
+                        page_type_t type, byte *page) {
+  mach_write_to_4(page + FIL_PAGE_OFFSET, page_no);
+  if (type != FIL_PAGE_INDEX && type != FIL_PAGE_SDI) {
+    mach_write_to_4(page + FIL_PAGE_PREV, 0);
+    mach_write_to_4(page + FIL_PAGE_NEXT, 0);
+  }
+  mach_write_to_8(page + FIL_PAGE_LSN, IBDGEN_LSN + page_no);
+  mach_write_to_2(page + FIL_PAGE_TYPE, type);
+  mach_write_to_4(page + FIL_PAGE_SPACE_ID, gen->space_id);
+  mach_write_to_4(page + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM + 4,
+                  IBDGEN_LSN + page_no);
+  uint32_t checksum = buf_calc_page_crc32(page, false, UNIV_PAGE_SIZE);
+  mach_write_to_4(page + FIL_PAGE_SPACE_OR_CHKSUM, checksum);
+  mach_write_to_4(page + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
+                  checksum);
+}
+
+static bool ibdgen_write_file(ibdgen_t *gen, const char *path) {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+    return false;
+  }
+  ibdgen_lists_t lists;
+  ibdgen_build_lists(gen, &lists);
+
+  /* one extent per write */
+  std::vector<byte> buf(IBDGEN_EXTENT_PAGES * UNIV_PAGE_SIZE);
+  for (page_no_t first = 0; first < gen->pages.size();
+       first += IBDGEN_EXTENT_PAGES) {
+    memset(buf.data(), 0, buf.size());
+    for (page_no_t i = 0; i < IBDGEN_EXTENT_PAGES; i++) {
+      page_no_t page_no = first + i;
+      byte *page = buf.data() + i * UNIV_PAGE_SIZE;
+      switch (gen->pages[page_no].kind) {
+        case IBDGEN_FREE:
+          /* never written, all zero */
+          continue;
+        case IBDGEN_FSP_HDR:
+          ibdgen_write_fsp_hdr(gen, lists, page);
+          ibdgen_seal(gen, page_no, FIL_PAGE_TYPE_FSP_HDR, page);
+          break;
+        case IBDGEN_XDES:
+          ibdgen_write_xdes(gen, lists, page_no, page);
+          ibdgen_seal(gen, page_no, FIL_PAGE_TYPE_XDES, page);
+          break;
+        case IBDGEN_IBUF_BITMAP:
+          ibdgen_seal(gen, page_no, FIL_PAGE_IBUF_BITMAP, page);
+          break;
+        case IBDGEN_INODE:
+          ibdgen_write_inode(gen, lists, page);
+          ibdgen_seal(gen, page_no, FIL_PAGE_INODE, page);
+          break;
+        case IBDGEN_SDI:
+          ibdgen_write_index(gen, page_no, page);
+          ibdgen_seal(gen, page_no, FIL_PAGE_SDI, page);
+          break;
+        case IBDGEN_INDEX:
+          ibdgen_write_index(gen, page_no, page);
+          ibdgen_seal(gen, page_no, FIL_PAGE_INDEX, page);
+          break;
+      }
+    }
+    if (pwrite(fd, buf.data(), buf.size(), (off_t)first * UNIV_PAGE_SIZE) !=
+        (ssize_t)buf.size()) {
+      fprintf(stderr, "Cannot write %s: %s\n", path, strerror(errno));
+      close(fd);
+      return false;
+    }
+  }
+  close(fd);
+  return true;
+}
+
+/** Writes the ibd2sdi json of the table, with the columns and the
+clustered index dict_load_from_sdi() reads */
+static bool ibdgen_write_sdi(const ibdgen_t *gen, const char *path,
+                             const char *row_format) {
+  FILE *f = fopen(path, "w");
+  if (f == nullptr) {
+    fprintf(stderr, "Cannot create %s: %s\n", path, strerror(errno));
+    return false;
+  }
+  struct {
+    const char *name;
+    const char *type_utf8;
+    int type;
+    int char_length;
+    int collation_id;
+    int precision;
+    int hidden;
+  } cols[] = {{"id", "int", 4, 11, 8, 10, 1},
+              {"k", "int", 4, 11, 8, 10, 1},
+              {"c", "char(120)", 29, 120, 8, 0, 1},
+              {"pad", "char(60)", 29, 60, 8, 0, 1},
+              {"DB_TRX_ID", "", 10, 6, 63, 0, 2},
+              {"DB_ROLL_PTR", "", 9, 7, 63, 0, 2}};
+  fprintf(f,
+          "[\n\"ibd2sdi\"\n,\n{\n  \"type\": 1,\n  \"id\": %u,\n"
+          "  \"object\": {\n    \"mysqld_version_id\": 80032,\n"
+          "    \"dd_object_type\": \"Table\",\n    \"dd_object\": {\n"
+          "      \"name\": \"sbtest1\",\n      \"se_private_id\": %u,\n"
+          "      \"row_format_name\": \"%s\",\n      \"columns\": [\n",
+          gen->space_id, gen->space_id, row_format);
+  for (size_t i = 0; i < sizeof(cols) / sizeof(cols[0]); i++) {
+    fprintf(f,
+            "        {\"name\": \"%s\", \"type\": %d, \"is_nullable\": false, "
+            "\"is_unsigned\": false, \"hidden\": %d, \"ordinal_position\": "
+            "%lu, \"char_length\": %d, \"numeric_precision\": %d, "
+            "\"numeric_scale\": 0, \"datetime_precision\": 0, "
+            "\"collation_id\": %d, \"column_type_utf8\": \"%s\"}%s\n",
+            cols[i].name, cols[i].type, cols[i].hidden, i + 1,
+            cols[i].char_length, cols[i].precision, cols[i].collation_id,
+            cols[i].type_utf8, i + 1 < sizeof(cols) / sizeof(cols[0]) ? ","
+                                                                     : "");
+  }
+  page_no_t root = gen->levels.back()[0];
+  fprintf(f,
+          "      ],\n      \"indexes\": [\n        {\"name\": \"PRIMARY\", "
+          "\"type\": 1, \"se_private_data\": "
+          "\"id=%lu;root=%u;space_id=%u;table_id=%u;trx_id=1000;\",\n"
+          "         \"elements\": [\n",
+          gen->index_id, root, gen->space_id, gen->space_id);
+  /* id, DB_TRX_ID, DB_ROLL_PTR, then the other columns */
+  const struct {
+    int opx;
+    bool hidden;
+  } elements[] = {{0, false}, {4, true}, {5, true},
+                  {1, true},  {2, true}, {3, true}};
+  for (size_t i = 0; i < 6; i++) {
+    fprintf(f,
+            "           {\"ordinal_position\": %lu, \"length\": %u, "
+            "\"order\": 2, \"hidden\": %s, \"column_opx\": %d}%s\n",
+            i + 1, elements[i].hidden ? 4294967295U : 4,
+            elements[i].hidden ? "true" : "false", elements[i].opx,
+            i + 1 < 6 ? "," : "");
+  }
+  fprintf(f, "         ]\n        }\n      ]\n    }\n  }\n}\n]\n");
+  bool ok = ferror(f) == 0;
+  ok = fclose(f) == 0 && ok;
+  return ok;
+}
+
+static void usage() {
+  fprintf(stderr,
+      "usage: ibdgen -o sbtest1.ibd [-r rows | -m size_mb] [--fill pct]\n"
+      "\t-o file           -- tablespace to write, its ibd2sdi json goes next to it\n"
+      "\t-r rows           -- rows of the table\n"
+      "\t-m size_mb        -- rows enough for a file of about this size, default 256\n"
+      "\t--fill pct        -- fill factor of the pages, default 100\n"
+      "\t--row-format fmt  -- compact or dynamic, default dynamic\n"
+      "\t--space-id id     -- space id, default 100\n");
+}
+
+int main(int argc, char *argv[]) {
+  enum { OPT_FILL = 256, OPT_ROW_FORMAT, OPT_SPACE_ID };
+  static const struct option long_options[] = {
+      {"fill", required_argument, nullptr, OPT_FILL},
+      {"row-format", required_argument, nullptr, OPT_ROW_FORMAT},
+      {"space-id", required_argument, nullptr, OPT_SPACE_ID},
+      {nullptr, 0, nullptr, 0}};
+  std::string path;
+  uint64_t n_rows = 0;
+  uint64_t size_mb = 256;
+  uint32_t fill = 100;
+  std::string row_format = "dynamic";
+  ibdgen_t gen;
+  gen.space_id = 100;
+  gen.index_id = 1000;
+
+  int c;
+  while ((c = getopt_long(argc, argv, "ho:r:m:", long_options, nullptr)) !=
+         -1) {
+    switch (c) {
+      case 'o':
+        path = optarg;
+        break;
+      case 'r':
+        n_rows = strtoull(optarg, nullptr, 10);
+        break;
+      case 'm':
+        size_mb = strtoull(optarg, nullptr, 10);
+        break;
+      case OPT_FILL:
+        fill = strtoul(optarg, nullptr, 10);
+        break;
+      case OPT_ROW_FORMAT:
+        row_format = optarg;
+        break;
+      case OPT_SPACE_ID:
+        gen.space_id = strtoul(optarg, nullptr, 10);
+        break;
+      default:
+        usage();
+        return 1;
+    }
+  }
+  if (path.empty() || fill < 10 || fill > 100 ||
+      (row_format != "compact" && row_format != "dynamic")) {
+    usage();
+    return 1;
+  }
+
+  ut_crc32_init();
+  /* COMPACT and DYNAMIC store short rows alike; DYNAMIC is told apart by
+  the atomic blobs flag of the space */
+  gen.space_flags = 1 << FSP_FLAGS_POS_POST_ANTELOPE | 1 << FSP_FLAGS_POS_SDI;
+  if (row_format == "dynamic") {
+    gen.space_flags |= 1 << FSP_FLAGS_POS_ATOMIC_BLOBS;
+  }
+  gen.n_per_leaf = ibdgen_recs_per_page(IBDGEN_LEAF_REC_SIZE, fill);
+  gen.n_per_node = ibdgen_recs_per_page(IBDGEN_NODE_REC_SIZE, fill);
+  if (n_rows == 0) {
+    n_rows = (size_mb << 20) / UNIV_PAGE_SIZE * gen.n_per_leaf;
+  }
+  /* ids are 32-bit */
+  gen.n_rows = std::min<uint64_t>(std::max<uint64_t>(n_rows, 1), INT32_MAX);
+
+  ibdgen_layout(&gen);
+
+  std::string sdi_path = path;
+  if (sdi_path.size() > 4 &&
+      sdi_path.compare(sdi_path.size() - 4, 4, ".ibd") == 0) {
+    sdi_path.resize(sdi_path.size() - 4);
+  }
+  sdi_path += ".json";
+  if (!ibdgen_write_file(&gen, path.c_str()) ||
+      !ibdgen_write_sdi(&gen, sdi_path.c_str(), row_format.c_str())) {
+    return 1;
+  }
+  printf("%s: %lu rows, %lu pages, %lu leaf pages, height %lu, "
+         "%lu rows per leaf, fill %u%%, %s\n",
+         path.c_str(), gen.n_rows, gen.pages.size(), gen.levels[0].size(),
+         gen.levels.size(), gen.n_per_leaf, fill, row_format.c_str());
+  printf("%s: ibd2sdi json\n", sdi_path.c_str());
+  return 0;
+}
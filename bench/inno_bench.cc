@@ -0,0 +1,370 @@
+/* Benchmarks of libinnospace and of the inno command line on a
+tablespace, usually one written by ibdgen.
+
+Micro benchmarks time the inner loops every command shares: mach_read_*,
+CRC32 of a page, decoding the records of a leaf page, reading the pages
+of the file and hits of the page cache. Each one runs with a doubling
+number of iterations until a run lasts --min-time seconds, and reports
+the time of one iteration and the throughput.
+
+Macro benchmarks run ./inno -c <command> on the file, output thrown away,
+and report the best wall time of --runs runs in pages and rows per
+second of the whole file. */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0space.h"
+#include "include/buf0cache.h"
+#include "include/fil0fil.h"
+#include "include/mach_data.h"
+#include "include/page0page.h"
+#include "include/page_crc32.h"
+#include "include/rem0rec.h"
+#include "include/ut0crc32.h"
+
+/** Keeps the results of the timed loops alive */
+static volatile uint64_t bench_sink;
+
+static double bench_min_time = 0.5;
+
+static double bench_now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** Runs body(n) with n = 1, 2, 4, ... until it takes bench_min_time, and
+prints the time of one iteration and items per second.
+@param[in]  name   benchmark
+@param[in]  items  items an iteration processes, such as bytes or records
+@param[in]  unit   name of an item
+@param[in]  body   runs n iterations */
+static void bench_run(const char *name, double items, const char *unit,
+                      const std::function<void(uint64_t)> &body) {
+  uint64_t n = 1;
+  double elapsed = 0;
+  for (;;) {
+    double start = bench_now();
+    body(n);
+    elapsed = bench_now() - start;
+    if (elapsed >= bench_min_time || n >= (1ULL << 40)) {
+      break;
+    }
+    n *= 2;
+  }
+  double ns = elapsed * 1e9 / n;
+  printf("%-34s %12.1f ns %14lu iterations %14.0f %s/s\n", name, ns, n,
+         items * n / elapsed, unit);
+  fflush(stdout);
+}
+
+/** Runs inno with args on the file, output to /dev/null.
+@return seconds of the fastest of runs runs, -1 if inno failed */
+static double bench_exec(const std::string &inno,
+                         const std::vector<std::string> &args, int runs) {
+  double best = -1;
+  for (int r = 0; r < runs; r++) {
+    double start = bench_now();
+    pid_t pid = fork();
+    if (pid == 0) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDOUT_FILENO);
+      dup2(null_fd, STDERR_FILENO);
+      std::vector<char *> argv;
+      argv.push_back(const_cast<char *>(inno.c_str()));
+      for (const std::string &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+      }
+      argv.push_back(nullptr);
+      execv(inno.c_str(), argv.data());
+      _exit(127);
+    }
+    int status;
+    if (pid == -1 || waitpid(pid, &status, 0) == -1 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      return -1;
+    }
+    double elapsed = bench_now() - start;
+    if (best < 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+static void usage() {
+  fprintf(stderr,
+      "usage: inno_bench -f sbtest1.ibd -s sbtest1.json [--inno ./inno]\n"
+      "\t-f file           -- tablespace, such as one written by ibdgen\n"
+      "\t-s sdi.json       -- its ibd2sdi json\n"
+      "\t--inno path       -- inno binary of the macro benchmarks, default ./inno\n"
+      "\t--min-time sec    -- shortest run of a micro benchmark, default 0.5\n"
+      "\t--runs n          -- runs of a macro benchmark, the best is shown, default 3\n"
+      "\t--micro-only      -- skip the macro benchmarks\n");
+}
+
+int main(int argc, char *argv[]) {
+  enum { OPT_INNO = 256, OPT_MIN_TIME, OPT_RUNS, OPT_MICRO_ONLY };
+  static const struct option long_options[] = {
+      {"inno", required_argument, nullptr, OPT_INNO},
+      {"min-time", required_argument, nullptr, OPT_MIN_TIME},
+      {"runs", required_argument, nullptr, OPT_RUNS},
+      {"micro-only", no_argument, nullptr, OPT_MICRO_ONLY},
+      {nullptr, 0, nullptr, 0}};
+  std::string path;
+  std::string sdi_path;
+  std::string inno = "./inno";
+  int runs = 3;
+  bool micro_only = false;
+
+  int c;
+  while ((c = getopt_long(argc, argv, "hf:s:", long_options, nullptr)) !=
+         -1) {
+    switch (c) {
+      case 'f':
+        path = optarg;
+        break;
+      case 's':
+        sdi_path = optarg;
+        break;
+      case OPT_INNO:
+        inno = optarg;
+        break;
+      case OPT_MIN_TIME:
+        bench_min_time = atof(optarg);
+        break;
+      case OPT_RUNS:
+        runs = std::max(atoi(optarg), 1);
+        break;
+      case OPT_MICRO_ONLY:
+        micro_only = true;
+        break;
+      default:
+        usage();
+        return 1;
+    }
+  }
+  if (path.empty() || sdi_path.empty()) {
+    usage();
+    return 1;
+  }
+
+  std::unique_ptr<Tablespace> space = Tablespace::open(path.c_str());
+  if (space == nullptr) {
+    fprintf(stderr, "Cannot open %s\n", path.c_str());
+    return 1;
+  }
+  std::unique_ptr<Schema> schema = Schema::load(sdi_path.c_str());
+  if (schema == nullptr || schema->clustered_index() == nullptr) {
+    fprintf(stderr, "Cannot load the clustered index from %s\n",
+            sdi_path.c_str());
+    return 1;
+  }
+  const dict_index_t &index = *schema->clustered_index();
+  const ulint page_size = space->page_size().logical();
+  const ulint physical = space->page_size().physical();
+
+  /* rows of the file, and its first full leaf page for the record
+  benchmarks */
+  uint64_t n_rows = 0;
+  uint64_t n_leaves = 0;
+  page_no_t leaf_no = FIL_NULL;
+  ulint leaf_recs = 0;
+  {
+    Page_iterator it(*space);
+    while (it.next()) {
+      const byte *page = it.page();
+      if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+          mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID) != index.id ||
+          mach_read_from_2(page + PAGE_HEADER + PAGE_LEVEL) != 0) {
+        continue;
+      }
+      ulint n_recs = mach_read_from_2(page + PAGE_HEADER + PAGE_N_RECS);
+      n_rows += n_recs;
+      n_leaves++;
+      if (n_recs > leaf_recs) {
+        leaf_no = it.page_no();
+        leaf_recs = n_recs;
+      }
+    }
+  }
+  if (leaf_no == FIL_NULL) {
+    fprintf(stderr, "No leaf page of index %lu in %s\n", index.id,
+            path.c_str());
+    return 1;
+  }
+  printf("%s: %u pages of %u bytes, %lu leaf pages, %lu rows\n\n",
+         path.c_str(), space->n_pages(), page_size, n_leaves, n_rows);
+
+  byte *leaf = nullptr;
+  if (posix_memalign((void **)&leaf, page_size, page_size) != 0 ||
+      !space->read_page(leaf_no, leaf)) {
+    fprintf(stderr, "Cannot read page %u\n", leaf_no);
+    return 1;
+  }
+
+  printf("%-34s %15s %25s %16s\n", "benchmark", "time", "", "throughput");
+
+  bench_run("mach_read_from_2", 1, "reads", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += mach_read_from_2(leaf + (i & (page_size / 2 - 1)) * 2);
+    }
+    bench_sink = sum;
+  });
+  bench_run("mach_read_from_4", 1, "reads", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += mach_read_from_4(leaf + (i & (page_size / 4 - 1)) * 4);
+    }
+    bench_sink = sum;
+  });
+  bench_run("mach_read_from_8", 1, "reads", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += mach_read_from_8(leaf + (i & (page_size / 8 - 1)) * 8);
+    }
+    bench_sink = sum;
+  });
+  bench_run("ut_crc32 page", page_size, "bytes", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += ut_crc32(leaf, page_size);
+    }
+    bench_sink = sum;
+  });
+  bench_run("buf_calc_page_crc32", 1, "pages", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += buf_calc_page_crc32(leaf, false, page_size);
+    }
+    bench_sink = sum;
+  });
+  bench_run("buf_page_is_corrupted", 1, "pages", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += buf_page_is_corrupted(leaf, page_size);
+    }
+    bench_sink = sum;
+  });
+
+  /* the records of the leaf, in key order */
+  std::vector<const rec_t *> recs;
+  {
+    Record_cursor cursor(leaf, index, page_size);
+    while (cursor.next()) {
+      recs.push_back(cursor.rec());
+    }
+  }
+  std::vector<ulint> offsets;
+  bench_run("rec_get_offsets", 1, "records", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      rec_get_offsets(recs[i % recs.size()], index, offsets, page_size);
+      sum += offsets.back();
+    }
+    bench_sink = sum;
+  });
+  bench_run("Record_cursor leaf page", recs.size(), "records",
+            [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      Record_cursor cursor(leaf, index, page_size);
+      while (cursor.next()) {
+        ulint len;
+        sum += *cursor.field(0, &len);
+      }
+    }
+    bench_sink = sum;
+  });
+  bench_run("Page_iterator file", space->n_pages(), "pages",
+            [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      Page_iterator it(*space);
+      while (it.next()) {
+        sum += it.page_no();
+      }
+    }
+    bench_sink = sum;
+  });
+
+  /* hits on a working set the cache holds */
+  const page_no_t n_hot = std::min<page_no_t>(space->n_pages(), 1024);
+  Buf_page_cache cache((size_t)n_hot * 2 * physical, physical);
+  for (page_no_t page_no = 0; page_no < n_hot; page_no++) {
+    Buf_page_guard guard(&cache, space->fd(), physical, page_no);
+  }
+  bench_run("Buf_page_cache pin hit", 1, "pages", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      Buf_page_guard guard(&cache, space->fd(), physical, i % n_hot);
+      sum += guard.page() != nullptr;
+    }
+    bench_sink = sum;
+  });
+  bench_run("Buf_page_cache read hit", 1, "pages", [&](uint64_t n) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+      sum += cache.read(space->fd(), physical, i % n_hot, leaf);
+    }
+    bench_sink = sum;
+  });
+  free(leaf);
+
+  if (micro_only) {
+    return 0;
+  }
+
+  /* every -c command that needs nothing but the file and its json; the
+  redo, undo and doublewrite commands need files ibdgen does not write */
+  size_t slash = path.find_last_of('/');
+  const std::string dir = slash == std::string::npos ? "." : path.substr(0, slash);
+  struct {
+    const char *name;
+    std::vector<std::string> args;
+    bool per_row;
+  } commands[] = {
+      {"list-page-type", {"-f", path, "-c", "list-page-type"}, false},
+      {"index-summary", {"-f", path, "-c", "index-summary"}, false},
+      {"dump-all-records",
+       {"-f", path, "-s", sdi_path, "-c", "dump-all-records"}, true},
+      {"column-stats", {"-f", path, "-s", sdi_path, "-c", "column-stats"},
+       true},
+      {"disk-usage", {"-f", path, "-c", "disk-usage"}, false},
+      {"changed-pages",
+       {"-f", path, "-c", "changed-pages", "--since-lsn", "0"}, false},
+      {"diff", {"-f", path, "-c", "diff", path}, false},
+      {"datadir scan", {"-D", dir}, false},
+  };
+  printf("\n%-34s %15s %18s %18s\n", "command", "time", "pages/s", "rows/s");
+  for (const auto &command : commands) {
+    double elapsed = bench_exec(inno, command.args, runs);
+    if (elapsed < 0) {
+      printf("%-34s %15s\n", command.name, "failed");
+      continue;
+    }
+    char rows_per_sec[32] = "-";
+    if (command.per_row) {
+      snprintf(rows_per_sec, sizeof(rows_per_sec), "%.0f", n_rows / elapsed);
+    }
+    printf("%-34s %13.3f s %18.0f %18s\n", command.name, elapsed,
+           space->n_pages() / elapsed, rows_per_sec);
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,225 @@
+#ifndef inno_space_api_space_h
+#define inno_space_api_space_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/dict0dict.h"
+#include "include/fil0fil.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/page0size.h"
+#include "include/rem0types.h"
+
+/** The API of libinnospace for programs that embed it. Any number of
+tablespaces may be open and scanned at once, from as many threads. A
+Tablespace may be shared between threads; a Page_iterator or a
+Record_cursor belongs to the thread using it.
+
+A Tablespace holds what its pages are read with: its files, its key and
+the page cache it was given. read_page(), scan() and Page_iterator are
+handed them and look up nothing by fd, so tablespaces of different
+keyrings and caches can be read side by side. What is left to the
+process is the keyring of inno_load_keyring(), for the tablespaces opened
+without one, the spaces attached for the functions given an fd
+(fil0space.h), the output format (ut0json.h) and the counters of
+srv0mon.h. */
+
+class Buf_page_cache;
+struct fil_keyring_t;
+struct fil_space_key_t;
+
+/** Sets up the process-wide tables the library reads, such as those of
+CRC32. It may be called from any thread any number of times, and is
+called by Tablespace::open(). */
+void inno_init();
+
+/** Loads the master keys of a keyring file into the keyring of the
+process; tablespaces opened after it without a keyring of their own can
+be decrypted with them.
+@param[in]  path  keyring_file or component_keyring_file file
+@return false if the file can not be read or parsed */
+bool inno_load_keyring(const char *path);
+
+/** An open tablespace: a single .ibd or undo file, or the system
+tablespace with all the files it spans. */
+class Tablespace {
+ public:
+  /** Opens a tablespace. Given the first file of the system tablespace,
+  the files following it are opened too.
+  @param[in]  path      data file
+  @param[in]  writable  whether pages may be written
+  @param[in]  keyring   master keys, loaded by fil_keyring_load(), the key
+                        of the tablespace is unwrapped with; nullptr for
+                        those of inno_load_keyring()
+  @return the tablespace, nullptr if it can not be opened */
+  static std::unique_ptr<Tablespace> open(
+      const char *path, bool writable = false,
+      const fil_keyring_t *keyring = nullptr);
+  ~Tablespace();
+
+  const std::string &path() const { return m_path; }
+  /** fd of the first file, which the fil_*() and Show*() functions given
+  an fd read as this tablespace once attach() was called */
+  int fd() const { return m_space.fd; }
+  /** files, key and cache the pages are read with */
+  const fil_space_t &space() const { return m_space; }
+  space_id_t space_id() const { return m_space_id; }
+  const page_size_t &page_size() const { return m_page_size; }
+  /** number of pages of the space */
+  page_no_t n_pages() const { return m_n_pages; }
+
+  /** Sets the cache read_page() goes through, before the tablespace is
+  shared between threads.
+  @param[in]  cache  cache of the pages as they are in the file, kept by
+                     the caller while the tablespace is open; nullptr to
+                     read the file */
+  void set_cache(Buf_page_cache *cache) { m_space.cache = cache; }
+
+  /** Attaches the tablespace under its fd, for the functions given an fd
+  rather than a Tablespace. It is detached when closed.
+  @return false if the fd can not be attached */
+  bool attach() const { return fil_space_attach(&m_space); }
+
+  /** Reads a page as the server sees it in the buffer pool: decrypted,
+  with transparent page compression undone and, on a
+  ROW_FORMAT=COMPRESSED tablespace, index pages inflated.
+  @param[in]   page_no  page number
+  @param[out]  frame    page_size().logical() bytes, aligned to them
+  @param[in]   cache    cache of the pages as they are in the file,
+                        nullptr for the one of set_cache()
+  @return false if the page can not be read or restored */
+  bool read_page(page_no_t page_no, byte *frame,
+                 Buf_page_cache *cache = nullptr) const;
+
+  /** Visits pages [first, last) on n_threads threads, as
+  fil_scan_parallel() does.
+  @return number of pages visited */
+  uint64_t scan(page_no_t first, page_no_t last, uint32_t n_threads,
+                const fil_scan_func_t &func) const;
+
+ private:
+  Tablespace();
+  Tablespace(const Tablespace &) = delete;
+  Tablespace &operator=(const Tablespace &) = delete;
+
+  std::string m_path;
+  fil_space_t m_space;
+  /** key of an encrypted tablespace, m_space.key */
+  std::unique_ptr<fil_space_key_t> m_key;
+  space_id_t m_space_id;
+  page_size_t m_page_size;
+  page_no_t m_n_pages;
+};
+
+/** Reads the pages of a tablespace in order, FIL_SCAN_BATCH_PAGES at a
+time, restored as Tablespace::read_page() does. Pages that can not be
+restored are skipped.
+@code
+  Page_iterator it(*space);
+  while (it.next()) {
+    use(it.page_no(), it.page());
+  }
+@endcode */
+class Page_iterator {
+ public:
+  /** @param[in]  space  tablespace, open while the iterator is used
+  @param[in]  first  first page
+  @param[in]  last   page after the last one, FIL_NULL for the end */
+  Page_iterator(const Tablespace &space, page_no_t first = 0,
+                page_no_t last = FIL_NULL);
+  ~Page_iterator();
+
+  /** Moves to the next page.
+  @return false past the last page */
+  bool next();
+
+  page_no_t page_no() const { return m_page_nos[m_pos]; }
+  /** @return the page frame, valid until the next call to next() */
+  const byte *page() const { return m_frames + m_pos * m_frame_size; }
+
+ private:
+  Page_iterator(const Page_iterator &) = delete;
+  Page_iterator &operator=(const Page_iterator &) = delete;
+
+  fil_scan_space_t m_space;
+  Fil_scan_reader m_reader;
+  uint64_t m_next;
+  uint64_t m_last;
+  /** logical size of a page frame */
+  ulint m_frame_size;
+  /** pages of the current batch */
+  byte *m_frames;
+  std::vector<page_no_t> m_page_nos;
+  size_t m_pos;
+};
+
+/** Walks the user records of a compact index page in key order,
+skipping records marked deleted.
+@code
+  Record_cursor cursor(page, *schema->clustered_index(), page_size);
+  while (cursor.next()) {
+    const byte *data = cursor.field(0, &len);
+  }
+@endcode */
+class Record_cursor {
+ public:
+  /** @param[in]  page       index page, in a frame aligned to page_size
+  @param[in]  index      index the page belongs to
+  @param[in]  page_size  logical page size */
+  Record_cursor(const byte *page, const dict_index_t &index,
+                ulint page_size);
+
+  /** Moves to the next record whose header is consistent with the page.
+  @return false past the last record */
+  bool next();
+
+  const rec_t *rec() const { return m_page + m_rec_off; }
+  /** @return the end offsets of the fields, see rec_get_offsets() */
+  const std::vector<ulint> &offsets() const { return m_offsets; }
+  /** Gets the nth field of the record.
+  @param[in]   n    field number in the index
+  @param[out]  len  field length, UNIV_SQL_NULL for NULL
+  @return field data */
+  const byte *field(ulint n, ulint *len) const;
+  /** @return true if the nth field is stored off-page */
+  bool is_extern(ulint n) const;
+
+ private:
+  const byte *m_page;
+  const dict_index_t &m_index;
+  ulint m_page_size;
+  /** offset of the current record, PAGE_NEW_INFIMUM before the first */
+  ulint m_rec_off;
+  ulint m_n_heap;
+  ulint m_n_visited;
+  std::vector<ulint> m_offsets;
+};
+
+/** The definition of a table, from the json ibd2sdi prints. */
+class Schema {
+ public:
+  /** Loads a table definition.
+  @param[in]  sdi_path  ibd2sdi json file
+  @return the schema, nullptr if the file can not be parsed */
+  static std::unique_ptr<Schema> load(const char *sdi_path);
+
+  const dict_table_t &table() const { return m_table; }
+  /** @return the clustered index, nullptr if the SDI has none */
+  const dict_index_t *clustered_index() const {
+    return m_table.clustered_index();
+  }
+  /** @return the index with an id, as in PAGE_INDEX_ID of its pages,
+  nullptr if the table has none */
+  const dict_index_t *index_by_id(uint64_t id) const;
+
+ private:
+  Schema() {}
+
+  dict_table_t m_table;
+};
+
+#endif
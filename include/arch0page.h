@@ -0,0 +1,71 @@
+#ifndef inno_space_arch_page_h
+#define inno_space_arch_page_h
+
+#include <stdio.h>
+
+#include <functional>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/log0log.h"
+
+/** A page changed by the redo log. */
+struct arch_page_t {
+  space_id_t space_id;
+  page_no_t page_no;
+  /** lsn of the latest record changing the page */
+  lsn_t lsn;
+};
+
+/** Called for every page by Arch_page_set::for_each(). */
+typedef std::function<void(const arch_page_t &page)> arch_page_func_t;
+
+/** The set of pages named by redo records, keeping the latest lsn of each
+page. Entries are collected in memory; when they outgrow the memory
+budget they are sorted and deduplicated, and if that does not free half
+of the budget they are spilled to a temporary file as a sorted run. The
+runs and what is left in memory are merged when the set is read. */
+class Arch_page_set {
+ public:
+  /** @param[in]  mem_budget  bytes of entries kept in memory */
+  explicit Arch_page_set(size_t mem_budget);
+  ~Arch_page_set();
+
+  /** Adds a page change. */
+  void add(space_id_t space_id, page_no_t page_no, lsn_t lsn);
+
+  /** Visits every page once, ordered by space id and page number.
+  @return false if a spilled run could not be read back */
+  bool for_each(const arch_page_func_t &func);
+
+  /** @return number of runs spilled to disk */
+  size_t n_runs() const { return m_runs.size(); }
+
+ private:
+  /** Sorts and deduplicates the entries in memory. */
+  void compact();
+
+  /** Writes the entries in memory to a new run. */
+  bool spill();
+
+  size_t m_max_pages;
+  std::vector<arch_page_t> m_pages;
+  /** sorted, deduplicated runs, each in a temporary file */
+  std::vector<FILE *> m_runs;
+};
+
+/** Builds the set of pages changed by the redo log in an lsn window and
+checks the pages of a tablespace against it: a page whose FIL_PAGE_LSN is
+older than a change that the last checkpoint says was flushed has lost a
+write.
+@param[in]  fd          tablespace to check
+@param[in]  redo_path   redo log file, glob or directory
+@param[in]  since_lsn   first lsn of the window
+@param[in]  until_lsn   end of the window, 0 for the end of the log
+@param[in]  mem_budget  bytes of page entries kept in memory
+@param[in]  n_threads   threads reading the tablespace, 0 for one per CPU */
+void ShowRedoPages(int fd, const char *redo_path, lsn_t since_lsn,
+                   lsn_t until_lsn, size_t mem_budget, uint32_t n_threads);
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef inno_space_buf_cache_h
+#define inno_space_buf_cache_h
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+struct fil_space_t;
+
+/** Alignment of the frame arena, so that the kernel can back it with
+transparent huge pages */
+#define BUF_CACHE_ARENA_ALIGN (2 * 1024 * 1024)
+
+/** Frame size of a cache that is not told the page size of its files */
+#define BUF_CACHE_FRAME_SIZE (16 * 1024)
+
+/** A page cache shared by the threads of one command. Pages are kept, as
+they are in the file, in fixed-size frames carved out of one arena
+mapped at construction, and are keyed by file descriptor and page
+number. Keys are spread over shards by hash; each shard owns a slice of
+the frames, its own mutex and its own CLOCK hand, so threads reading
+different pages rarely contend and no lock covers the whole cache.
+
+A pinned frame is neither evicted nor reused until it is unpinned, so a
+caller may parse a page in place rather than copying it. Pages larger
+than a frame are not cached; they are read from the file by read() and
+pin() gives up on them. */
+class Buf_page_cache {
+ public:
+  /** @param[in]  capacity    bytes of page frames kept in total
+  @param[in]  frame_size  bytes of a frame, a power of two no smaller than
+                          the pages to be cached
+  @param[in]  n_shards    number of independently locked shards */
+  explicit Buf_page_cache(size_t capacity,
+                          ulint frame_size = BUF_CACHE_FRAME_SIZE,
+                          uint32_t n_shards = 16);
+  ~Buf_page_cache();
+
+  /** Copies a page into buf, reading it from the file on a miss.
+  @param[in]   space      tablespace, its pages are keyed by its fd
+  @param[in]   page_size  page size of the file
+  @param[in]   page_no    page number
+  @param[out]  buf        page frame of page_size bytes
+  @return false if the page could not be read */
+  bool read(const fil_space_t &space, ulint page_size, page_no_t page_no,
+            byte *buf);
+  /** read() of the space attached under an fd */
+  bool read(int fd, ulint page_size, page_no_t page_no, byte *buf);
+
+  /** Pins the frame of a page, reading the page from the file on a miss.
+  The frame is aligned to frame_size(), not to UNIV_PAGE_SIZE_MAX, so
+  page_align() does not work on it.
+  @param[in]  space      tablespace, its pages are keyed by its fd
+  @param[in]  page_size  page size of the file
+  @param[in]  page_no    page number
+  @return the page, to be given back to unpin(); nullptr if it can not
+  be read, is larger than a frame or every frame of its shard is pinned */
+  const byte *pin(const fil_space_t &space, ulint page_size,
+                  page_no_t page_no);
+  /** pin() of the space attached under an fd */
+  const byte *pin(int fd, ulint page_size, page_no_t page_no);
+
+  /** Releases a frame returned by pin().
+  @param[in]  frame  page frame */
+  void unpin(const byte *frame);
+
+  /** Drops a page, after it was written to the file.
+  @param[in]  fd       file
+  @param[in]  page_no  page number */
+  void invalidate(int fd, page_no_t page_no);
+
+  /** Drops the pages of a file, before its descriptor is closed and may
+  be reused for another file.
+  @param[in]  fd  file */
+  void evict(int fd);
+
+  /** @return bytes of pages held */
+  size_t size() const;
+
+  ulint frame_size() const { return m_frame_size; }
+
+  uint64_t n_hits() const;
+  uint64_t n_misses() const;
+
+ private:
+  Buf_page_cache(const Buf_page_cache &) = delete;
+  Buf_page_cache &operator=(const Buf_page_cache &) = delete;
+
+  typedef uint64_t key_t;
+
+  /** Control block of a frame. Everything but n_pins and ref is protected
+  by the mutex of the shard owning the frame. */
+  struct frame_t {
+    frame_t() : key(0), len(0), in_map(false), io_fix(false), n_pins(0),
+                ref(false) {}
+
+    key_t key;
+    /** bytes of the page held */
+    ulint len;
+    /** the frame is in the map of its shard under key */
+    bool in_map;
+    /** the page is being read from the file */
+    bool io_fix;
+    /** a pinned frame is never chosen by the CLOCK hand; it is raised
+    under the shard mutex only, and dropped without it */
+    std::atomic<uint32_t> n_pins;
+    /** CLOCK reference bit, set on every hit */
+    std::atomic<bool> ref;
+  };
+
+  struct shard_t {
+    shard_t() : first(0), n_frames(0), hand(0), size(0), n_hits(0),
+                n_misses(0) {}
+
+    std::mutex mutex;
+    /** signalled when a read of a page of the shard completes */
+    std::condition_variable io_done;
+    /** frames [first, first + n_frames) belong to the shard */
+    size_t first;
+    size_t n_frames;
+    /** CLOCK hand, relative to first */
+    size_t hand;
+    /** bytes of the pages in map */
+    size_t size;
+    std::unordered_map<key_t, size_t> map;
+    std::atomic<uint64_t> n_hits;
+    std::atomic<uint64_t> n_misses;
+  };
+
+  static key_t make_key(int fd, page_no_t page_no) {
+    return (static_cast<key_t>(fd) << 32) | page_no;
+  }
+
+  shard_t &shard(key_t key) {
+    return *m_shards[((key * 0x9E3779B97F4A7C15ULL) >> 32) % m_shards.size()];
+  }
+
+  byte *frame_buf(size_t i) const { return m_arena + i * m_frame_size; }
+
+  /** Takes a frame out of the map of its shard; s.mutex is held */
+  void remove(shard_t &s, frame_t &frame);
+
+  /** Picks the frame a page is read into, with the CLOCK hand; s.mutex
+  is held.
+  @return frame number, or m_n_frames if every frame is pinned */
+  size_t victim(shard_t &s);
+
+  ulint m_frame_size;
+  /** base of the mapping, and its length */
+  byte *m_map;
+  size_t m_map_size;
+  /** first frame, aligned to BUF_CACHE_ARENA_ALIGN */
+  byte *m_arena;
+  std::unique_ptr<frame_t[]> m_frames;
+  size_t m_n_frames;
+  std::vector<std::unique_ptr<shard_t>> m_shards;
+};
+
+/** Keeps a page pinned while the guard lives.
+@code
+  Buf_page_guard guard(cache, fd, page_size, page_no);
+  if (guard.page() != nullptr) {
+    use(guard.page());
+  }
+@endcode */
+class Buf_page_guard {
+ public:
+  Buf_page_guard(Buf_page_cache *cache, int fd, ulint page_size,
+                 page_no_t page_no)
+      : m_cache(cache), m_page(cache->pin(fd, page_size, page_no)) {}
+  ~Buf_page_guard() {
+    if (m_page != nullptr) {
+      m_cache->unpin(m_page);
+    }
+  }
+
+  /** @return the page, nullptr if pin() failed */
+  const byte *page() const { return m_page; }
+
+ private:
+  Buf_page_guard(const Buf_page_guard &) = delete;
+  Buf_page_guard &operator=(const Buf_page_guard &) = delete;
+
+  Buf_page_cache *m_cache;
+  const byte *m_page;
+};
+
+/** Reads a page as it is in the file, through the cache of the space
+attached under fd, if it has one.
+@param[in]   fd         file
+@param[in]   page_size  physical page size of the file
+@param[in]   page_no    page number
+@param[out]  buf        page frame of page_size bytes
+@return false if the page could not be read */
+bool buf_read_page(int fd, ulint page_size, page_no_t page_no, byte *buf);
+
+/** Writes a page to the file and drops the copy of the cache of its
+space.
+@return false if the page could not be written */
+bool buf_write_page(int fd, ulint page_size, page_no_t page_no,
+                    const byte *buf);
+
+#endif
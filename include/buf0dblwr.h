@@ -0,0 +1,72 @@
+#ifndef inno_space_buf_dblwr_h
+#define inno_space_buf_dblwr_h
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/log0log.h"
+
+/** What the checksum of a page image in a doublewrite file says */
+enum dblwr_state_t {
+  DBLWR_VALID,
+  DBLWR_CORRUPT,
+  /** encrypted or page compressed: the checksum is over the page before
+  it was encrypted or compressed, so only a reader with the key of its
+  tablespace can check it */
+  DBLWR_UNVERIFIED
+};
+
+/** A page image in a doublewrite file. */
+struct dblwr_page_t {
+  lsn_t lsn;
+  /** index in dblwr_index_t::files */
+  uint32_t file_no;
+  /** offset of the image in the file */
+  uint64_t offset;
+  dblwr_state_t state;
+};
+
+/** The page images of the doublewrite files of an instance, by the
+space id and page number in their FIL header. */
+struct dblwr_index_t {
+  dblwr_index_t()
+      : page_size(0), n_images(0), n_empty(0), n_valid(0), n_corrupt(0) {}
+
+  std::vector<std::string> files;
+  /** the innodb_page_size the files were written with */
+  ulint page_size;
+  uint64_t n_images;
+  /** slots never written */
+  uint64_t n_empty;
+  uint64_t n_valid;
+  uint64_t n_corrupt;
+  /** copies of each page, newest LSN first */
+  std::map<std::pair<space_id_t, page_no_t>, std::vector<dblwr_page_t>> pages;
+};
+
+/** Indexes every page image of the doublewrite files of MySQL 8.0.20 and
+later, #ib_<page size>_<n>.dblwr and .bdblwr, in one sequential read of
+each file. Files written with another page size are skipped.
+@param[in]   path       file, glob or directory
+@param[in]   page_size  logical page size of the pages wanted
+@param[out]  index      page images
+@return false if no doublewrite file was found */
+bool dblwr_index_build(const char *path, ulint page_size,
+                       dblwr_index_t *index);
+
+/** Lists the corrupt pages of a tablespace and, for each, the newest copy
+in the doublewrite files whose checksum is valid; with apply set, writes
+that copy over the page.
+@param[in]  fd          tablespace, opened for writing if apply is set
+@param[in]  dblwr_path  doublewrite files, glob or directory
+@param[in]  apply       whether to restore the pages
+@param[in]  n_threads   threads checking the tablespace, 0 for one per
+                        CPU */
+void ShowDblwr(int fd, const char *dblwr_path, bool apply,
+               uint32_t n_threads);
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef inno_space_dict_dict_h
+#define inno_space_dict_dict_h
+
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** Column types as stored in the "type" attribute of an SDI column
+(dd::enum_column_types). Only the values we need to tell apart. */
+enum dict_col_type_t {
+  DD_TYPE_DECIMAL = 1,
+  DD_TYPE_TINY = 2,
+  DD_TYPE_SHORT = 3,
+  DD_TYPE_LONG = 4,
+  DD_TYPE_FLOAT = 5,
+  DD_TYPE_DOUBLE = 6,
+  DD_TYPE_TIMESTAMP = 8,
+  DD_TYPE_LONGLONG = 9,
+  DD_TYPE_INT24 = 10,
+  DD_TYPE_DATE = 11,
+  DD_TYPE_TIME = 12,
+  DD_TYPE_DATETIME = 13,
+  DD_TYPE_YEAR = 14,
+  DD_TYPE_NEWDATE = 15,
+  DD_TYPE_VARCHAR = 16,
+  DD_TYPE_BIT = 17,
+  DD_TYPE_TIMESTAMP2 = 18,
+  DD_TYPE_DATETIME2 = 19,
+  DD_TYPE_TIME2 = 20,
+  DD_TYPE_NEWDECIMAL = 21,
+  DD_TYPE_ENUM = 22,
+  DD_TYPE_SET = 23,
+  DD_TYPE_TINY_BLOB = 24,
+  DD_TYPE_MEDIUM_BLOB = 25,
+  DD_TYPE_LONG_BLOB = 26,
+  DD_TYPE_BLOB = 27,
+  DD_TYPE_VAR_STRING = 28,
+  DD_TYPE_STRING = 29,
+  DD_TYPE_GEOMETRY = 30,
+  DD_TYPE_JSON = 31
+};
+
+/** Value of the "hidden" attribute of columns added by InnoDB itself
+(DB_ROW_ID, DB_TRX_ID, DB_ROLL_PTR). */
+#define DD_HIDDEN_SE 2
+
+/** A table column, as described by the SDI json. */
+struct dict_col_t {
+  std::string name;
+  std::string column_type_utf8;
+  uint32_t type;
+  /** maximum length of the column in bytes */
+  uint32_t char_length;
+  uint32_t collation_id;
+  uint32_t mbmaxlen;
+  uint32_t numeric_precision;
+  uint32_t numeric_scale;
+  uint32_t datetime_precision;
+  uint32_t hidden;
+  bool is_nullable;
+  bool is_unsigned;
+};
+
+/** A field of an index record. */
+struct dict_field_t {
+  /** position of the column in dict_table_t::cols */
+  uint32_t col_no;
+  /** fixed length of the field in bytes, 0 if variable-length */
+  uint32_t fixed_len;
+  /** maximum length of the field in bytes */
+  uint32_t max_len;
+  /** true if the length may need two bytes in the record header */
+  bool is_big;
+  bool is_nullable;
+};
+
+struct dict_index_t {
+  std::string name;
+  uint64_t id;
+  page_no_t root;
+  space_id_t space;
+  bool is_clustered;
+  /** number of nullable fields, sizes the null bitmap */
+  uint32_t n_nullable;
+  /** number of fields that identify a record (node pointer key prefix) */
+  uint32_t n_uniq;
+  std::vector<dict_field_t> fields;
+};
+
+struct dict_table_t {
+  std::string name;
+  uint64_t id;
+  std::vector<dict_col_t> cols;
+  std::vector<dict_index_t> indexes;
+
+  /** @return the clustered index, nullptr if the SDI has none */
+  const dict_index_t *clustered_index() const;
+};
+
+/** Loads the table definition from an ibd2sdi json file.
+@param[in]   sdi_path  path of the json file
+@param[out]  table     table definition
+@return 0 on success, -1 on error */
+int dict_load_from_sdi(const char *sdi_path, dict_table_t *table);
+
+/** @return true if the column is stored as an integer */
+bool dict_col_is_integer(const dict_col_t &col);
+
+/** @return true if the column is a float or double */
+bool dict_col_is_float(const dict_col_t &col);
+
+/** @return true if the column holds character or binary strings */
+bool dict_col_is_string(const dict_col_t &col);
+
+/** @return true if the column may be stored off-page */
+bool dict_col_is_lob(const dict_col_t &col);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef inno_space_fil_comp_h
+#define inno_space_fil_comp_h
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+struct fil_space_t;
+#include "include/fil0fil.h"
+
+/** Algorithm of a page compressed with COMPRESSION=, stored in
+FIL_PAGE_ALGORITHM_V1, as Compression::Type in the server */
+enum fil_comp_algorithm_t {
+  FIL_COMP_NONE = 0,
+  FIL_COMP_ZLIB = 1,
+  FIL_COMP_LZ4 = 2
+};
+
+/** @name Versions of the control information of a FIL_PAGE_COMPRESSED
+page, stored in FIL_PAGE_VERSION */
+/* @{ */
+#define FIL_COMP_VERSION_1 1
+/** version 2 also checksums the compressed page */
+#define FIL_COMP_VERSION_2 2
+/* @} */
+
+/** Control information of a FIL_PAGE_COMPRESSED page, which the server
+keeps in the 8 bytes of FIL_PAGE_FILE_FLUSH_LSN */
+struct fil_comp_meta_t {
+  ulint version;
+  fil_comp_algorithm_t algorithm;
+  /** FIL_PAGE_TYPE of the page before it was compressed */
+  page_type_t original_type;
+  /** bytes after FIL_PAGE_DATA before compression */
+  ulint original_size;
+  /** bytes of the compressed payload after FIL_PAGE_DATA */
+  ulint compressed_size;
+};
+
+/** Reads the control information of a FIL_PAGE_COMPRESSED page.
+@param[in]   page  page as read from the file
+@param[out]  meta  control information */
+void fil_comp_read_meta(const byte *page, fil_comp_meta_t *meta);
+
+/** @return true if a page was written compressed by transparent page
+compression, COMPRESSION='zlib' or 'lz4' */
+bool fil_page_is_page_compressed(const byte *page);
+
+/** Restores a FIL_PAGE_COMPRESSED page to the page the server compressed:
+the FIL header is copied with its original type and the payload after
+FIL_PAGE_DATA is inflated with zlib or decoded as an LZ4 block. src and
+dst may be the same frame.
+@param[in]   src        page as read from the file
+@param[in]   page_size  page size of the tablespace
+@param[out]  dst        page frame of page_size bytes
+@return false if the control information or the payload is corrupt */
+bool fil_page_decompress(const byte *src, ulint page_size, byte *dst);
+
+/** Gets the offset of the first byte of data at or after an offset, as
+lseek(SEEK_DATA) does. The holes of a sparse file are read as zeroes and
+need not be read at all.
+@param[in]  space   tablespace
+@param[in]  offset  offset to look from
+@return offset of the next data, offset itself if the file system does
+not report holes, UINT64_MAX if only a hole follows */
+uint64_t fil_seek_data(const fil_space_t &space, uint64_t offset);
+uint64_t fil_seek_data(int fd, uint64_t offset);
+
+/** Gets the bytes of a page that are allocated on disk, that is its size
+less the holes punched in it.
+@param[in]  fd         file
+@param[in]  page_no    page number
+@param[in]  page_size  physical page size
+@return bytes of the page not in a hole */
+ulint fil_page_get_disk_size(int fd, page_no_t page_no, ulint page_size);
+
+/** Reports, index by index, the bytes the pages of a tablespace occupy on
+disk next to their logical size, with the holes punched by transparent
+page compression taken off. The file is read by n_threads threads.
+@param[in]  fd         tablespace
+@param[in]  n_threads  scanning threads, 0 for one per CPU */
+void ShowDiskUsage(int fd, uint32_t n_threads);
+
+#endif
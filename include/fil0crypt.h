@@ -0,0 +1,129 @@
+#ifndef inno_space_fil_crypt_h
+#define inno_space_fil_crypt_h
+
+#include <openssl/evp.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/page0size.h"
+
+/** Length of the tablespace key, of its IV and of a master key */
+#define ENCRYPTION_KEY_LEN 32
+
+/** @name Encryption information in page 0, written right after the
+extent descriptors as Encryption::fill_encryption_info() does */
+/* @{ */
+#define ENCRYPTION_MAGIC_SIZE 3
+/** magic of version 1, without the server uuid */
+#define ENCRYPTION_KEY_MAGIC_V1 "lCA"
+/** magic of version 2, with the server uuid */
+#define ENCRYPTION_KEY_MAGIC_V2 "lCB"
+/** magic of version 3, laid out as version 2 */
+#define ENCRYPTION_KEY_MAGIC_V3 "lCC"
+#define ENCRYPTION_SERVER_UUID_LEN 36
+/** prefix of the names of InnoDB master keys in the keyring */
+#define ENCRYPTION_MASTER_KEY_PREFIX "INNODBKey"
+/* @} */
+
+/** Tablespace key and IV, unwrapped from page 0 with the master key. */
+struct fil_space_key_t {
+  byte key[ENCRYPTION_KEY_LEN];
+  /** only the first AES block is used by the page cipher */
+  byte iv[ENCRYPTION_KEY_LEN];
+};
+
+/** Master keys of a keyring file */
+struct fil_keyring_t {
+  /** key data by key id */
+  std::map<std::string, std::string> keys;
+};
+
+struct fil_space_t;
+
+/** Loads the master keys of a keyring file, in the format of either the
+keyring_file plugin or the component_keyring_file component.
+@param[in]   path     keyring file
+@param[out]  keyring  keys, added to those it holds
+@return false if the file can not be read or parsed */
+bool fil_keyring_load(const char *path, fil_keyring_t *keyring);
+
+/** Loads the master keys of a keyring file into the keyring of the
+process, which fil_space_get_key() unwraps keys with.
+@param[in]  path  keyring file
+@return false if the file can not be read or parsed */
+bool fil_crypt_load_keyring(const char *path);
+
+/** Unwraps the tablespace key of an encrypted tablespace from the
+encryption information in page 0 with its master key.
+@param[in]  fd       tablespace
+@param[in]  keyring  master keys, nullptr for those of the process
+@return the key, nullptr if the tablespace is not encrypted or the key
+can not be unwrapped */
+std::unique_ptr<fil_space_key_t> fil_space_read_key(
+    int fd, const fil_keyring_t *keyring);
+
+/** Gets the tablespace key of an encrypted tablespace, unwrapped with the
+keyring of the process. Keys are cached per file.
+@param[in]  fd  tablespace
+@return the key, nullptr if the tablespace is not encrypted or the key
+can not be unwrapped */
+const fil_space_key_t *fil_space_get_key(int fd);
+
+/** @return true if a page was written encrypted, FIL_PAGE_ENCRYPTED,
+FIL_PAGE_COMPRESSED_AND_ENCRYPTED or FIL_PAGE_ENCRYPTED_RTREE */
+bool fil_page_is_encrypted(const byte *page);
+
+/** Decrypts pages with AES-256 in place, as Encryption::decrypt() does.
+The key schedule is set up once: an object is meant to be owned by one
+thread and reused for every page of a space, each page only resets the
+IV of the CBC context. */
+class Fil_page_decryptor {
+ public:
+  explicit Fil_page_decryptor(const fil_space_key_t &key);
+  ~Fil_page_decryptor();
+
+  /** Decrypts a page and restores its type. A page that was compressed
+  before it was encrypted is left FIL_PAGE_COMPRESSED for
+  fil_page_decompress().
+  @param[in,out]  page        page as read from the file
+  @param[in]      page_size   physical page size
+  @param[in]      block_size  file system block size compressed pages
+                              were aligned to when written
+  @return false if the page is not an encrypted page or OpenSSL fails */
+  bool decrypt(byte *page, ulint page_size, ulint block_size);
+
+ private:
+  Fil_page_decryptor(const Fil_page_decryptor &) = delete;
+  Fil_page_decryptor &operator=(const Fil_page_decryptor &) = delete;
+
+  /** AES-256-CBC over the whole AES blocks of the page body */
+  EVP_CIPHER_CTX *m_cbc;
+  /** AES-256-ECB over the last two blocks, which cover the tail that is
+  not a whole block */
+  EVP_CIPHER_CTX *m_ecb;
+  byte m_iv[ENCRYPTION_KEY_LEN];
+};
+
+/** Reads a page as InnoDB wrote it into the frame it parses: decrypts it
+with the key of the tablespace, then undoes transparent page
+compression. Pages that are neither are left alone.
+@param[in]      space      tablespace the page was read from
+@param[in,out]  page       page as read from the file
+@param[in]      page_size  physical page size
+@return false if the page could not be decrypted or decompressed */
+bool fil_page_restore(const fil_space_t &space, byte *page,
+                      ulint page_size);
+
+/** fil_page_restore() on the space attached under an fd; without a key
+of its own, it is decrypted with fil_space_get_key(). */
+bool fil_page_restore(int fd, byte *page, ulint page_size);
+
+/** @return the block size of the file system holding a file, the unit
+transparent page compression aligns pages to */
+ulint fil_get_block_size(int fd);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef inno_space_fil_datadir_h
+#define inno_space_fil_datadir_h
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** Bytes of a tablespace scanned as one task of a datadir scan, so that
+large files are shared out among the threads; a multiple of every page
+size */
+#define FIL_DATADIR_TASK_BYTES (16ULL << 20)
+
+/** Scans every tablespace of a data directory in one process and prints
+one report for all of them: pages by type, pages failing their checksum
+and the free pages each file could give back. Files are cut into tasks
+of FIL_DATADIR_TASK_BYTES, largest files first, which n_threads threads
+claim one after the other, each reusing its page buffers from file to
+file. A file is opened by the first thread that reaches it and closed
+by the one finishing its last task, so few files are open at a time.
+@param[in]  datadir    data directory
+@param[in]  n_threads  scanning threads, 0 for one per CPU */
+void ShowDatadir(const char *datadir, uint32_t n_threads);
+
+#endif
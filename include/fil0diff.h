@@ -0,0 +1,25 @@
+#ifndef inno_space_fil_diff_h
+#define inno_space_fil_diff_h
+
+#include "include/udef.h"
+#include "include/log0log.h"
+
+/** Lists the pages whose FIL_PAGE_LSN is newer than an lsn, as ranges of
+pages and bytes that an incremental copy has to ship. The file is read
+by n_threads threads.
+@param[in]  fd         tablespace
+@param[in]  since_lsn  pages with FIL_PAGE_LSN > since_lsn are listed
+@param[in]  n_threads  scanning threads, 0 for one per CPU */
+void ShowChangedPages(int fd, lsn_t since_lsn, uint32_t n_threads);
+
+/** Compares two copies of a tablespace page by page and lists the pages
+that differ, as ShowChangedPages() does. Pages whose FIL_PAGE_LSN or
+checksum differ are changed without comparing their bytes; pages equal
+in both are compared byte by byte, and a difference there is reported
+as corruption since InnoDB never changes a page without its LSN.
+@param[in]  fd          tablespace
+@param[in]  other_path  the other copy
+@param[in]  n_threads   comparing threads, 0 for one per CPU */
+void ShowFileDiff(int fd, const char *other_path, uint32_t n_threads);
+
+#endif
@@ -10,6 +10,7 @@
 
 #include <limits>
 #include <iostream>
+#include <string>
 
 /** The byte offsets on a file page for various variables. */
 
@@ -190,6 +191,18 @@ extern page_no_t fil_page_get_prev(const byte *page);
    * @return FIL_PAGE_NEXT */
 extern page_no_t fil_page_get_next(const byte *page);
 
+/** Get the description of a page type.
+ * @param[in]  type    File page type
+ * @return description, "ERROR" for an unknown type */
+extern const char *fil_get_page_type_str(page_type_t type);
+
+/** Formats the FIL header of a page as the -p report prints it.
+ * @param[out]  out      report
+ * @param[in]   page_no  page number, for the banner
+ * @param[in]   page     File page */
+extern void fil_format_header(std::string *out, page_no_t page_no,
+                              const byte *page);
+
 /** Sets the file page type.
  * @param[in,out]  page    File page
  * @param[in]  type    File page type to set */
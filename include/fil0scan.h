@@ -0,0 +1,195 @@
+#ifndef inno_space_fil_scan_h
+#define inno_space_fil_scan_h
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/fil0space.h"
+#include "include/page0size.h"
+
+/** Number of pages read by one pread() of a scan thread, one extent */
+#define FIL_SCAN_BATCH_PAGES 64
+
+/** Called for every page visited by fil_scan_parallel().
+@param[in]  thread_no  scanning thread, in [0, n_threads)
+@param[in]  page_no    page number
+@param[in]  page       page frame, valid only during the call */
+typedef std::function<void(uint32_t thread_no, page_no_t page_no,
+                           const byte *page)>
+    fil_scan_func_t;
+
+/** Gets the number of threads to use for a scan.
+@param[in]  requested  value given on the command line, 0 for default
+@return number of threads, at least 1 */
+uint32_t fil_scan_n_threads(uint32_t requested);
+
+/** Gets the page size of a tablespace from the FSP_SPACE_FLAGS of page
+0: the innodb_page_size it was created with and, on a
+ROW_FORMAT=COMPRESSED tablespace, its compressed page size.
+@return page size, UNIV_PAGE_SIZE if page 0 can not be read */
+page_size_t fil_get_page_size(int fd);
+
+/** Gets the number of whole pages in a file.
+@return number of pages, 0 on error */
+page_no_t fil_get_n_pages(int fd);
+
+/** Gets the number of whole pages of a given size in a file.
+@param[in]  fd         tablespace
+@param[in]  page_size  page size the file is read in
+@return number of pages, 0 on error */
+page_no_t fil_get_n_pages(int fd, const page_size_t &page_size);
+
+/** Works out the page size of a tablespace from its pages, for a file
+whose page 0 may be destroyed. Pages are sampled across the file in the
+size of page 0 and in every innodb_page_size from 4K to 64K, and the size
+is taken under which most of them carry their own page number in
+FIL_PAGE_OFFSET and pass the checksum check, the page number alone
+deciding when no checksum holds, such as on encrypted pages. Page 0
+wins ties, and is kept if no size places any page.
+@param[in]  fd  tablespace
+@return page size */
+page_size_t fil_detect_page_size(int fd);
+
+/** Expands a path given on the command line into a list of files. A
+directory is searched with dir_patterns, a path holding glob characters
+is expanded, anything else is taken as it is. Files are ordered by name,
+comparing embedded numbers by value so that undo_10 follows undo_9.
+@param[in]   path          file, glob or directory
+@param[in]   dir_patterns  glob patterns of the files of a directory
+@param[out]  files         matching files */
+void fil_expand_paths(const char *path,
+                      const std::vector<std::string> &dir_patterns,
+                      std::vector<std::string> *files);
+
+struct fil_space_key_t;
+class Fil_page_decryptor;
+class Page_zip_decompressor;
+
+/** How the pages of a tablespace are handed to a scan callback, worked
+out once per tablespace from page 0. */
+struct fil_scan_space_t {
+  /** Reads page 0 of a tablespace.
+  @param[in]  fd          tablespace
+  @param[in]  uncompress  whether pages are decrypted and decompressed,
+                          see fil_scan_parallel() */
+  fil_scan_space_t(int fd, bool uncompress);
+
+  /** Sets up a tablespace read in a page size not taken from page 0.
+  @param[in]  fd          tablespace
+  @param[in]  page_size   page size
+  @param[in]  uncompress  see fil_scan_parallel() */
+  fil_scan_space_t(int fd, const page_size_t &page_size, bool uncompress);
+
+  /** Sets up a tablespace whose files and key are known, as those of a
+  Tablespace, and need not be looked up by fd.
+  @param[in]  space       tablespace
+  @param[in]  page_size   page size
+  @param[in]  uncompress  see fil_scan_parallel() */
+  fil_scan_space_t(const fil_space_t &space, const page_size_t &page_size,
+                   bool uncompress);
+
+  /** files of the tablespace, the key its pages are decrypted with,
+  nullptr if there is none or they are not decrypted, and its block size */
+  fil_space_t files;
+  page_size_t page_size;
+  /** whether encrypted pages are decrypted */
+  bool decrypt;
+  /** whether FIL_PAGE_COMPRESSED pages are restored */
+  bool page_compressed;
+  /** whether ROW_FORMAT=COMPRESSED pages are inflated */
+  bool inflate;
+  /** number of pages in the file */
+  page_no_t n_pages;
+};
+
+/** Buffers of a scanning thread: a batch buffer of FIL_SCAN_BATCH_PAGES
+pages of the largest page size and the frames pages are restored in.
+They are allocated once and reused for every batch, whatever tablespace
+it comes from. */
+class Fil_scan_reader {
+ public:
+  Fil_scan_reader();
+  ~Fil_scan_reader();
+
+  /** @return false if the buffers could not be allocated */
+  bool is_ready() const { return m_buf != nullptr && m_frame != nullptr; }
+
+  /** Reads up to FIL_SCAN_BATCH_PAGES pages with one pread() and calls
+  func on each of them. Holes are not read: their pages are passed as
+  zeroes.
+  @param[in]  space      tablespace
+  @param[in]  start      first page
+  @param[in]  n_pages    number of pages, at most FIL_SCAN_BATCH_PAGES
+  @param[in]  thread_no  passed to func
+  @param[in]  func       called on every page
+  @return number of pages read, those that could not be restored and were
+  not passed to func, counted in n_corrupt and n_undecrypted, included */
+  uint64_t read_batch(const fil_scan_space_t &space, uint64_t start,
+                      uint64_t n_pages, uint32_t thread_no,
+                      const fil_scan_func_t &func);
+
+  /** compressed pages that could not be inflated or restored */
+  uint64_t n_corrupt;
+  /** encrypted pages that could not be decrypted */
+  uint64_t n_undecrypted;
+
+ private:
+  Fil_scan_reader(const Fil_scan_reader &) = delete;
+  Fil_scan_reader &operator=(const Fil_scan_reader &) = delete;
+
+  byte *m_buf;
+  /** frame the pages of transparent page compression are restored in */
+  byte *m_frame;
+  std::unique_ptr<Fil_page_decryptor> m_decryptor;
+  /** key m_decryptor was set up with */
+  const fil_space_key_t *m_decryptor_key;
+  std::unique_ptr<Page_zip_decompressor> m_zip;
+};
+
+/** Prints to stderr how many pages of a scan could not be restored.
+@param[in]  n_corrupt      compressed pages that could not be inflated
+@param[in]  n_undecrypted  encrypted pages that could not be decrypted
+@param[in]  has_key        whether the key of a tablespace was found */
+void fil_scan_report_errors(uint64_t n_corrupt, uint64_t n_undecrypted,
+                            bool has_key);
+
+/** Reads pages [first, last) of a file on n_threads threads. Threads
+claim batches of FIL_SCAN_BATCH_PAGES pages and read each batch with a
+single pread() into a private buffer, then call func on every page of it.
+func must only touch state owned by its thread_no. Ranges of the file
+that are holes are not read: their pages are passed as zeroes.
+
+Pages of a ROW_FORMAT=COMPRESSED tablespace are read in their physical
+size. With uncompress set, each thread inflates them into a frame of
+the logical page size of its own before calling func, and index pages
+that fail to inflate are skipped. Likewise FIL_PAGE_COMPRESSED pages
+of transparent page compression are restored to their original type and
+content. Callers that only look at the FIL header can pass false and get
+the pages as they are in the file.
+@return number of pages passed to func: pages that fail to inflate or
+decrypt are reported to stderr and not counted */
+uint64_t fil_scan_parallel(int fd, page_no_t first, page_no_t last,
+                           uint32_t n_threads, const fil_scan_func_t &func,
+                           bool uncompress = true);
+
+/** fil_scan_parallel() in a page size given by the caller, such as the
+one fil_detect_page_size() found, instead of the one of page 0.
+@param[in]  page_size  page size the file is read in
+@return number of pages visited */
+uint64_t fil_scan_parallel(int fd, const page_size_t &page_size,
+                           page_no_t first, page_no_t last,
+                           uint32_t n_threads, const fil_scan_func_t &func,
+                           bool uncompress = true);
+
+/** fil_scan_parallel() of a tablespace set up by the caller.
+@param[in]  space  tablespace, how its pages are restored included
+@return number of pages visited */
+uint64_t fil_scan_parallel(const fil_scan_space_t &space, page_no_t first,
+                           page_no_t last, uint32_t n_threads,
+                           const fil_scan_func_t &func);
+
+#endif
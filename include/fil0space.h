@@ -0,0 +1,139 @@
+#ifndef inno_space_fil_space_h
+#define inno_space_fil_space_h
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** A tablespace made of several files, as the system tablespace is when
+innodb_data_file_path names ibdata1, ibdata2... Page numbers run on from
+one file to the next.
+
+A space is read through a fil_space_t, which holds its files and what
+its pages are restored with. Its owner, such as a Tablespace, gives it to
+the readers, which look nothing up. The readers that are given an fd
+instead, the fd of the first file, find the space attached under it:
+fil_space_open() attaches the spaces of several files, and an owner may
+attach its own with fil_space_attach(). An fd that has none is read as a
+single-file tablespace. Lookups take no latch. The functions here may be
+called from any thread, as long as a space is not closed while it is
+being read. */
+
+struct fil_space_key_t;
+class Buf_page_cache;
+
+/** A file of a multi-file tablespace, as fil_node_t in the server */
+struct fil_node_t {
+  std::string name;
+  int fd;
+  /** offset of the first byte of the file in the space */
+  uint64_t start;
+  /** bytes of the file that belong to the space */
+  uint64_t size;
+};
+
+/** What a tablespace is read with, as fil_space_t in the server. It does
+not own its files or its key. */
+struct fil_space_t {
+  explicit fil_space_t(int fd = -1)
+      : fd(fd), key(nullptr), block_size(0), cache(nullptr) {}
+
+  /** fd of the first file, the one holding page 0 */
+  int fd;
+  /** files of a multi-file tablespace, empty for a single file */
+  std::vector<fil_node_t> nodes;
+  /** key of an encrypted tablespace, nullptr if there is none */
+  const fil_space_key_t *key;
+  /** file system block size compressed pages were aligned to, 0 if not
+  known */
+  ulint block_size;
+  /** cache the pages read one at a time go through, nullptr for none */
+  Buf_page_cache *cache;
+};
+
+/** Opens the files of a tablespace in order. Files are taken whole, but
+no further than the FSP_SIZE recorded in page 0: the last one may have
+autoextended beyond it, and files past it hold no page of the space.
+@param[in]   files  data files, first one holding page 0
+@param[in]   flags  open() flags
+@param[out]  space  the files, not attached
+@return false if a file can not be opened */
+bool fil_space_open(const std::vector<std::string> &files, int flags,
+                    fil_space_t *space);
+
+/** Closes the files of a tablespace opened by fil_space_open() into a
+fil_space_t, which must not be attached any more. */
+void fil_space_close(fil_space_t *space);
+
+/** Opens the files of a tablespace. When there is more than one file, a
+space holding them is attached under the fd of the first one and closed
+with it.
+@param[in]  files  data files, first one holding page 0
+@param[in]  flags  open() flags
+@return fd of the first file, -1 if a file can not be opened */
+int fil_space_open(const std::vector<std::string> &files, int flags);
+
+/** Closes the files of a tablespace opened by fil_space_open().
+@param[in]  fd  fd of the first file */
+void fil_space_close(int fd);
+
+/** Attaches a space under the fd of its first file, for the readers that
+are given that fd.
+@param[in]  space  space, kept by the caller until it is detached
+@return false if the fd is beyond what can be attached */
+bool fil_space_attach(const fil_space_t *space);
+
+/** Detaches a space attached by fil_space_attach(), if it is. */
+void fil_space_detach(const fil_space_t *space);
+
+/** Gets the space an fd is read as.
+@param[in]  fd      fd of the first file
+@param[in]  single  space returned for an fd that has none attached, of
+                    the file alone
+@return the attached space, or single */
+const fil_space_t &fil_space_get(int fd, fil_space_t *single);
+
+/** Finds the files of the system tablespace next to a file given on the
+command line: when it is the first file of space 0 and FSP_SIZE goes
+beyond it, the ibdata files of its directory follow it.
+@param[in]   path   file given on the command line
+@param[out]  files  files of the space, path first */
+void fil_space_find_files(const char *path, std::vector<std::string> *files);
+
+/** Maps an offset of a tablespace to the file holding it.
+@param[in]   space        tablespace
+@param[in]   offset       offset in the space
+@param[out]  file_fd      fd of the file holding offset
+@param[out]  file_offset  offset in that file
+@return bytes of the space left in that file from file_offset, 0 if
+offset is beyond the last file; UINT64_MAX for a single-file space */
+uint64_t fil_space_map(const fil_space_t &space, uint64_t offset,
+                       int *file_fd, uint64_t *file_offset);
+uint64_t fil_space_map(int fd, uint64_t offset, int *file_fd,
+                       uint64_t *file_offset);
+
+/** pread() on a tablespace, reading across the files it spans */
+ssize_t fil_pread(const fil_space_t &space, void *buf, size_t n,
+                  uint64_t offset);
+ssize_t fil_pread(int fd, void *buf, size_t n, uint64_t offset);
+
+/** pwrite() on a tablespace, writing across the files it spans */
+ssize_t fil_pwrite(const fil_space_t &space, const void *buf, size_t n,
+                   uint64_t offset);
+ssize_t fil_pwrite(int fd, const void *buf, size_t n, uint64_t offset);
+
+/** fstat() on a tablespace: st_size is the size of the space, that is
+the valid size of all its files, and st_blocks adds up their blocks. */
+int fil_space_stat(const fil_space_t &space, struct stat *stat_buf);
+int fil_space_stat(int fd, struct stat *stat_buf);
+
+/** Prints the files of a multi-file tablespace and the pages each holds;
+nothing for a single-file tablespace. */
+void fil_space_print_files(int fd);
+
+#endif
@@ -215,9 +215,13 @@ enum xdes_state_t {
   XDES_FSEG_FRAG = 5
 };
 
+/** File extent data structure size in bytes for a logical page size. */
+#define XDES_SIZE_OF(page_size)                                  \
+  (XDES_BITMAP + UT_BITS_IN_BYTES(FSP_EXTENT_SIZE_OF(page_size) * \
+                                  XDES_BITS_PER_PAGE))
+
 /** File extent data structure size in bytes. */
-#define XDES_SIZE \
-  (XDES_BITMAP + UT_BITS_IN_BYTES(FSP_EXTENT_SIZE * XDES_BITS_PER_PAGE))
+#define XDES_SIZE XDES_SIZE_OF(UNIV_PAGE_SIZE)
 
 /** File extent data structure size in bytes for MAX page size. */
 #define XDES_SIZE_MAX \
@@ -24,12 +24,15 @@ page size | file space extent size
   32 KiB  |  64 pages = 2 MiB
   64 KiB  |  64 pages = 4 MiB
 */
-#define FSP_EXTENT_SIZE                                                 \
-  static_cast<page_no_t>(                                               \
-      ((UNIV_PAGE_SIZE <= (16384)                                       \
-            ? (1048576 / UNIV_PAGE_SIZE)                                \
-            : ((UNIV_PAGE_SIZE <= (32768)) ? (2097152 / UNIV_PAGE_SIZE) \
-                                           : (4194304 / UNIV_PAGE_SIZE)))))
+#define FSP_EXTENT_SIZE_OF(page_size)                                \
+  static_cast<page_no_t>(                                            \
+      (((page_size) <= (16384)                                       \
+            ? (1048576 / (page_size))                                \
+            : (((page_size) <= (32768)) ? (2097152 / (page_size))    \
+                                        : (4194304 / (page_size))))))
+
+/** File space extent size in pages for the default page size */
+#define FSP_EXTENT_SIZE FSP_EXTENT_SIZE_OF(UNIV_PAGE_SIZE)
 
 /** File space extent size (four megabyte) in pages for MAX page size */
 #define FSP_EXTENT_SIZE_MAX (4194304 / UNIV_PAGE_SIZE_MAX)
@@ -61,5 +64,62 @@ typedef byte fseg_header_t;
   3 /*!< rollback segment directory \
     page number in each undo tablespace */
 
+/** @name Bits of FSP_SPACE_FLAGS
+The flags describe the format of the tablespace as fil_space_t::flags
+does; only the fields the tool reads are listed. */
+/* @{ */
+/** Zero relative shift position of the POST_ANTELOPE field */
+#define FSP_FLAGS_POS_POST_ANTELOPE 0
+/** Zero relative shift position of the ZIP_SSIZE field */
+#define FSP_FLAGS_POS_ZIP_SSIZE 1
+/** Width of the ZIP_SSIZE field */
+#define FSP_FLAGS_WIDTH_ZIP_SSIZE 4
+/** Bit mask of the ZIP_SSIZE field */
+#define FSP_FLAGS_MASK_ZIP_SSIZE \
+  ((~(~0U << FSP_FLAGS_WIDTH_ZIP_SSIZE)) << FSP_FLAGS_POS_ZIP_SSIZE)
+
+/** Return the value of the ZIP_SSIZE field: 0 for an uncompressed
+tablespace, else the compressed page size is (UNIV_ZIP_SIZE_MIN >> 1)
+<< ssize */
+#define FSP_FLAGS_GET_ZIP_SSIZE(flags) \
+  (((flags)&FSP_FLAGS_MASK_ZIP_SSIZE) >> FSP_FLAGS_POS_ZIP_SSIZE)
+
+/** Zero relative shift position of the ATOMIC_BLOBS field, set for the
+DYNAMIC and COMPRESSED row formats */
+#define FSP_FLAGS_POS_ATOMIC_BLOBS 5
+
+/** Zero relative shift position of the PAGE_SSIZE field, after
+ATOMIC_BLOBS */
+#define FSP_FLAGS_POS_PAGE_SSIZE 6
+/** Width of the PAGE_SSIZE field */
+#define FSP_FLAGS_WIDTH_PAGE_SSIZE 4
+/** Bit mask of the PAGE_SSIZE field */
+#define FSP_FLAGS_MASK_PAGE_SSIZE \
+  ((~(~0U << FSP_FLAGS_WIDTH_PAGE_SSIZE)) << FSP_FLAGS_POS_PAGE_SSIZE)
+
+/** Return the value of the PAGE_SSIZE field: 0 for the original 16K
+page size, else the logical page size is (UNIV_ZIP_SIZE_MIN >> 1)
+<< ssize */
+#define FSP_FLAGS_GET_PAGE_SSIZE(flags) \
+  (((flags)&FSP_FLAGS_MASK_PAGE_SSIZE) >> FSP_FLAGS_POS_PAGE_SSIZE)
+
+/** Zero relative shift position of the ENCRYPTION field, after
+DATA_DIR, SHARED and TEMPORARY */
+#define FSP_FLAGS_POS_ENCRYPTION 13
+/** Bit mask of the ENCRYPTION field */
+#define FSP_FLAGS_MASK_ENCRYPTION (1U << FSP_FLAGS_POS_ENCRYPTION)
+
+/** Return the value of the ENCRYPTION field: set if the pages but
+page 0 are encrypted with the tablespace key */
+#define FSP_FLAGS_GET_ENCRYPTION(flags) \
+  (((flags)&FSP_FLAGS_MASK_ENCRYPTION) >> FSP_FLAGS_POS_ENCRYPTION)
+
+/** Zero relative shift position of the SDI field, set if the tablespace
+has an SDI index at page 3 */
+#define FSP_FLAGS_POS_SDI 14
+/* @} */
+
+/** Smallest compressed page size */
+#define UNIV_ZIP_SIZE_MIN 1024
 
 #endif
@@ -152,7 +152,9 @@ inline std::ostream &operator<<(std::ostream &out, const flst_bnode_t &obj) {
 }
 
 
-/** Reads a file address.
+/** Reads a file address as the page holds it. Unlike InnoDB, which
+asserts on a corrupt address, the caller checks the page number and
+byte offset before following it.
  @return file address */
 static inline fil_addr_t flst_read_addr(
     const fil_faddr_t *faddr) /*!< in: pointer to file faddress */
@@ -162,8 +164,6 @@ static inline fil_addr_t flst_read_addr(
 
   addr.page = mach_read_from_4(faddr + FIL_ADDR_PAGE);
   addr.boffset = mach_read_from_2(faddr + FIL_ADDR_BYTE);
-  ut_a(addr.page == FIL_NULL || addr.boffset >= FIL_PAGE_DATA);
-  ut_a(ut_align_offset(faddr, UNIV_PAGE_SIZE) >= FIL_PAGE_DATA);
   return (addr);
 }
 
@@ -0,0 +1,102 @@
+#ifndef inno_space_lob_lob_h
+#define inno_space_lob_lob_h
+
+#include <functional>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/page0size.h"
+
+/** The structure of the 20-byte external field reference stored at the
+end of the local prefix of an off-page column */
+/* @{ */
+#define BTR_EXTERN_SPACE_ID 0 /* space id where stored */
+#define BTR_EXTERN_PAGE_NO 4  /* page no where stored */
+#define BTR_EXTERN_OFFSET 8   /* offset of BLOB header on that page */
+#define BTR_EXTERN_VERSION BTR_EXTERN_OFFSET /* LOB version, 8.0 LOBs */
+#define BTR_EXTERN_LEN 12     /* 8 bytes containing the length of the \
+                              externally stored part of the LOB; the \
+                              2 highest bits are reserved for flags */
+/* @} */
+
+/** The most significant bit of BTR_EXTERN_LEN (i.e., the most
+significant bit of the byte at smallest address) is set to 1 if this
+field does not 'own' the externally stored field; only the owner field
+is allowed to free the field in purge! */
+#define BTR_EXTERN_OWNER_FLAG 128U
+/** If the second most significant bit of BTR_EXTERN_LEN (i.e., the
+second most significant bit of the byte at smallest address) is 1 then
+it means that the externally stored field was inherited from an earlier
+version of the row. */
+#define BTR_EXTERN_INHERITED_FLAG 64U
+/** If the 3rd most significant bit of BTR_EXTERN_LEN is 1, then it
+means that the externally stored field is currently being modified. */
+#define BTR_EXTERN_BEING_MODIFIED_FLAG 32U
+
+/** A decoded external field reference. */
+struct lob_ref_t {
+  space_id_t space_id;
+  page_no_t page_no;
+  /** BTR_EXTERN_OFFSET of old BLOBs, the LOB version of 8.0 LOBs */
+  uint32_t offset;
+  /** length of the externally stored part */
+  uint64_t length;
+  bool owner;
+  bool inherited;
+  bool being_modified;
+};
+
+/** Outcome of lob_read() */
+enum lob_status_t {
+  LOB_OK,
+  /** the reference is zero: the LOB was never completely written */
+  LOB_EMPTY_REF,
+  /** a page of the LOB is beyond the end of the file */
+  LOB_READ_ERROR,
+  /** a page or index entry of the LOB is not what the chain says */
+  LOB_CORRUPT,
+  /** the LOB belongs to a ROW_FORMAT=COMPRESSED table */
+  LOB_COMPRESSED,
+  /** the sink asked to stop */
+  LOB_STOPPED
+};
+
+/** Receives the externally stored part of a value piece by piece, in
+order, straight from the page frame being read.
+@param[in]  data  piece of the value, valid only during the call
+@param[in]  len   length of the piece
+@return false to stop reading */
+typedef std::function<bool(const byte *data, ulint len)> lob_sink_t;
+
+/** Decodes an external field reference.
+@param[in]  field_ref  the BTR_EXTERN_FIELD_REF_SIZE bytes at the end of
+                       the local part of a field */
+lob_ref_t lob_ref_parse(const byte *field_ref);
+
+/** @return a name for a lob_read() outcome */
+const char *lob_status_name(lob_status_t status);
+
+/** Streams the externally stored part of a value into a sink, following
+an old-style FIL_PAGE_TYPE_BLOB chain or the index of an 8.0 LOB, whose
+entries are read in the version the reference names. Only one page is
+in memory at a time, whatever the length of the value.
+@param[in]   fd         tablespace holding the LOB
+@param[in]   page_size  page size of the tablespace
+@param[in]   ref        decoded reference
+@param[in]   buf        page frame of the logical page size owned by the
+                        caller
+@param[in]   sink       receives the value
+@param[out]  n_read     bytes passed to the sink
+@return LOB_OK if the whole value was delivered */
+lob_status_t lob_read(int fd, const page_size_t &page_size,
+                      const lob_ref_t &ref, byte *buf,
+                      const lob_sink_t &sink, uint64_t *n_read);
+
+/** Streams every off-page value of the clustered index, local prefix
+included, to stdout or to one file per value.
+@param[in]  fd        tablespace file
+@param[in]  sdi_path  ibd2sdi json describing the table
+@param[in]  lob_dir   directory for the value files, nullptr for stdout */
+void DumpLobs(int fd, const char *sdi_path, const char *lob_dir);
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef inno_space_log_log_h
+#define inno_space_log_log_h
+
+#include "include/udef.h"
+
+/** Type used for all log sequence number storage and arithmetics */
+typedef uint64_t lsn_t;
+
+/** Redo log block size */
+#define OS_FILE_LOG_BLOCK_SIZE 512
+
+/** Offsets of a log block header */
+/* @{ */
+#define LOG_BLOCK_HDR_NO                    \
+  0 /* block number which must be > 0 and \
+    is allowed to wrap around at 1G; the  \
+    highest bit is set to 1 if this is the \
+    first log block in a log flush write  \
+    segment */
+#define LOG_BLOCK_FLUSH_BIT_MASK 0x80000000UL
+/* mask used to get the highest bit in
+the preceding field */
+#define LOG_BLOCK_MAX_NO 0x3FFFFFFFUL
+/* maximum value of the block number */
+#define LOG_BLOCK_HDR_DATA_LEN             \
+  4 /* number of bytes of log written to \
+    this block */
+#define LOG_BLOCK_FIRST_REC_GROUP            \
+  6 /* offset of the first start of an mtr \
+    log record group in this log block,    \
+    0 if none; if the value is the same as \
+    LOG_BLOCK_HDR_DATA_LEN, it means that  \
+    the first rec group has not yet been   \
+    catenated to this log block, but if it \
+    will, it will start at this offset     \
+    within the block */
+#define LOG_BLOCK_EPOCH_NO                 \
+  8 /* 4 lower bytes of the value of     \
+    log_sys.next_checkpoint_no when the  \
+    log block was last written to */
+#define LOG_BLOCK_HDR_SIZE 12 /* size of the log block header */
+/* @} */
+
+/** Offsets of a log block trailer from the end of the block */
+/* @{ */
+#define LOG_BLOCK_CHECKSUM 4 /* 4 byte checksum of the log block \
+                             contents */
+#define LOG_BLOCK_TRL_SIZE 4 /* trailer size in bytes */
+/* @} */
+
+/** Bytes of log record data in a full block */
+#define LOG_BLOCK_DATA_SIZE \
+  (OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE - LOG_BLOCK_TRL_SIZE)
+
+/** Checksum written when innodb_log_checksums=OFF */
+#define LOG_NO_CHECKSUM_MAGIC 0xDEADBEEFUL
+
+/** Offsets inside the log file header, which is the first block of
+every log file */
+/* @{ */
+#define LOG_HEADER_FORMAT 0 /* log file format, LOG_HEADER_FORMAT_* */
+#define LOG_HEADER_PAD1 4   /* 8.0.30+: LOG_HEADER_LOG_UUID */
+#define LOG_HEADER_START_LSN \
+  8 /* LSN of the start of data in this log file */
+#define LOG_HEADER_CREATOR \
+  16 /* a 32-byte field which contains the name of the \
+     log file creator */
+#define LOG_HEADER_CREATOR_END (LOG_HEADER_CREATOR + 32)
+#define LOG_HEADER_FLAGS 48 /* 8.0.30+: 32 bits of flags */
+/* @} */
+
+/** Log file header formats */
+/* @{ */
+#define LOG_HEADER_FORMAT_5_7_9 1
+#define LOG_HEADER_FORMAT_8_0_1 2
+#define LOG_HEADER_FORMAT_8_0_3 3
+#define LOG_HEADER_FORMAT_8_0_19 4
+#define LOG_HEADER_FORMAT_8_0_28 5
+#define LOG_HEADER_FORMAT_8_0_30 6
+/* @} */
+
+/** Offsets of the blocks of the log file header */
+/* @{ */
+#define LOG_CHECKPOINT_1 OS_FILE_LOG_BLOCK_SIZE
+/* first checkpoint field in the log header; we write alternately to
+the checkpoint fields when we make new checkpoints */
+#define LOG_ENCRYPTION (2 * OS_FILE_LOG_BLOCK_SIZE)
+/* encryption information */
+#define LOG_CHECKPOINT_2 (3 * OS_FILE_LOG_BLOCK_SIZE)
+/* second checkpoint field in the log header */
+#define LOG_FILE_HDR_SIZE (4 * OS_FILE_LOG_BLOCK_SIZE)
+/* @} */
+
+/** Offsets inside a checkpoint block */
+/* @{ */
+#define LOG_CHECKPOINT_NO 0 /* checkpoint number, before 8.0.30 */
+#define LOG_CHECKPOINT_LSN 8
+#define LOG_CHECKPOINT_OFFSET \
+  16 /* offset of the checkpoint lsn in the log files, before 8.0.30 */
+#define LOG_CHECKPOINT_LOG_BUF_SIZE 24
+/* @} */
+
+/** Gets the block number of a log block.
+@param[in]  block  log block
+@return log block number, it is > 0 and <= 1G */
+inline uint32_t log_block_get_hdr_no(const byte *block) {
+  return ((uint32_t)block[LOG_BLOCK_HDR_NO] << 24 |
+          (uint32_t)block[LOG_BLOCK_HDR_NO + 1] << 16 |
+          (uint32_t)block[LOG_BLOCK_HDR_NO + 2] << 8 |
+          (uint32_t)block[LOG_BLOCK_HDR_NO + 3]) &
+         ~LOG_BLOCK_FLUSH_BIT_MASK;
+}
+
+/** Converts a lsn to a log block number.
+@param[in]  lsn  lsn of a byte within the block
+@return log block number, it is > 0 and <= 1G */
+inline uint32_t log_block_convert_lsn_to_no(lsn_t lsn) {
+  return ((uint32_t)(lsn / OS_FILE_LOG_BLOCK_SIZE) & LOG_BLOCK_MAX_NO) + 1;
+}
+
+/** Finds the start lsn of a block from its wrapped block number.
+@param[in]  hdr_no   block number of the block
+@param[in]  ref_lsn  an lsn known to be within 256 GiB of the block
+@return start lsn of the block */
+lsn_t log_block_get_start_lsn(uint32_t hdr_no, lsn_t ref_lsn);
+
+/** Validates the checksum of a log block or checkpoint block.
+@return true if the block is intact or written without checksums */
+bool log_block_checksum_is_ok(const byte *block);
+
+/** Shows the headers, checkpoints, block validation results and LSN
+range of every redo log file, and the redo records by type and by
+tablespace.
+@param[in]  path  a redo log file, a glob, or a directory holding
+                  #ib_redoN or ib_logfileN files */
+void ShowRedoFile(const char *path);
+
+/** Prints every redo record with its lsn, type, space id and page number.
+@param[in]  path  as for ShowRedoFile() */
+void DumpRedoRecords(const char *path);
+
+#endif
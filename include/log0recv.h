@@ -0,0 +1,121 @@
+#ifndef inno_space_log_recv_h
+#define inno_space_log_recv_h
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/log0log.h"
+#include "include/mtr0types.h"
+
+/** A redo log record found by log_scan_files(). */
+struct log_rec_t {
+  /** lsn of the first byte of the record */
+  lsn_t lsn;
+  /** record type, without MLOG_SINGLE_REC_FLAG */
+  mlog_id_t type;
+  /** whether the record is the only one of its mtr */
+  bool single_rec;
+  /** whether the record names a page; MLOG_MULTI_REC_END and
+  MLOG_DUMMY_RECORD do not */
+  bool has_page;
+  space_id_t space_id;
+  page_no_t page_no;
+  /** length of the record in bytes, header included */
+  ulint len;
+};
+
+/** Called for every redo record by log_scan_files().
+@param[in]  rec   the record
+@param[in]  body  the record bytes; valid only during the call */
+typedef std::function<void(const log_rec_t &rec, const byte *body)>
+    log_rec_func_t;
+
+/** A checkpoint block of the log file header. */
+struct log_checkpoint_t {
+  bool checksum_ok;
+  uint64_t no;
+  lsn_t lsn;
+  uint64_t offset;
+};
+
+/** What log_scan_files() learnt about one redo log file. */
+struct log_file_info_t {
+  std::string path;
+  uint64_t size;
+
+  /** whether the header block could be read and is intact */
+  bool header_ok;
+  ulint format;
+  lsn_t start_lsn;
+  uint32_t uuid;
+  uint32_t flags;
+  char creator[LOG_HEADER_CREATOR_END - LOG_HEADER_CREATOR + 1];
+  log_checkpoint_t checkpoints[2];
+
+  /** log blocks after the file header, intact ones, ones failing the
+  checksum and intact ones holding no log data */
+  uint64_t n_blocks;
+  uint64_t n_valid;
+  uint64_t n_bad_checksum;
+  uint64_t n_empty;
+
+  /** lsn range [first_lsn, end_lsn) of the log data of the intact
+  blocks, both 0 if there is none */
+  lsn_t first_lsn;
+  lsn_t end_lsn;
+};
+
+/** Totals of a scan. */
+struct log_scan_stats_t {
+  log_scan_stats_t()
+      : n_recs(0), n_rec_bytes(0), n_resyncs(0), n_skipped_bytes(0),
+        n_tail_bytes(0), n_type_recs(), n_type_bytes() {}
+
+  uint64_t n_recs;
+  uint64_t n_rec_bytes;
+  /** times the parser gave up on a record it could not decode and
+  skipped to the next mtr that starts in a later block */
+  uint64_t n_resyncs;
+  /** log data skipped that way, or before the first mtr start */
+  uint64_t n_skipped_bytes;
+  /** bytes of mtrs cut off by a gap in the log, normally at its end */
+  uint64_t n_tail_bytes;
+
+  uint64_t n_type_recs[MLOG_BIGGEST_TYPE + 1];
+  uint64_t n_type_bytes[MLOG_BIGGEST_TYPE + 1];
+};
+
+/** Gets the name of a redo record type.
+@param[in]  type  record type, without MLOG_SINGLE_REC_FLAG
+@return name, or "UNKNOWN" */
+const char *mlog_type_name(ulint type);
+
+/** Finds the redo log files of a path given on the command line: a file,
+a glob, or a directory holding #ib_redoN or ib_logfileN files. Spare
+#ib_redoN_tmp files are left out.
+@param[in]   path   path given on the command line
+@param[out]  paths  redo log files, oldest first
+@return false, after telling so, if there is none */
+bool log_expand_paths(const char *path, std::vector<std::string> *paths);
+
+/** Reads the header and checkpoint blocks of a redo log file.
+@param[in]   fd    redo log file
+@param[out]  info  header fields; path and size are left alone
+@return false if the header block cannot be read */
+bool log_read_file_header(int fd, log_file_info_t *info);
+
+/** Scans redo log files in sequence, validating every block and decoding
+the records of the intact stretches of log. Files are read sequentially
+in large chunks; records spanning blocks and files are reassembled.
+@param[in]   paths  redo log files, oldest first
+@param[out]  files  what was learnt about every file
+@param[in]   func   called for every record, may be empty
+@param[out]  stats  totals of the scan */
+void log_scan_files(const std::vector<std::string> &paths,
+                    std::vector<log_file_info_t> *files,
+                    const log_rec_func_t &func, log_scan_stats_t *stats);
+
+#endif
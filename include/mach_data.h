@@ -13,6 +13,12 @@ uint8_t mach_read_from_1(const byte *b);
 
 uint16_t mach_read_from_2(const byte *b);
 
+/** The following function is used to fetch data from 3 consecutive
+bytes. The most significant byte is at the lowest address.
+@param[in]	b	pointer to 3 bytes to read
+@return 32 bit integer */
+uint32_t mach_read_from_3(const byte *b);
+
 uint32_t mach_read_from_4(const byte *b);
 
 uint64_t mach_read_from_6(const byte *b);
@@ -23,6 +29,26 @@ uint64_t mach_read_from_6(const byte *b);
  * @return 64-bit integer */
 uint64_t mach_read_from_8(const byte *b);
 
+/** Read a 32-bit integer in a compressed form and advance the pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned value */
+uint32_t mach_read_next_compressed(const byte **b);
+
+/** Read a 64-bit integer in a compressed form (a compressed high word
+followed by 4 bytes) and advance the pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned value */
+uint64_t mach_u64_read_next_compressed(const byte **b);
+
+/** Read a 64-bit integer in a much compressed form and advance the
+pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned 64-bit integer */
+uint64_t mach_read_next_much_compressed(const byte **b);
+
 
 /** The following function is used to store data in one byte.
 @param[in]	b	pointer to byte where to store
@@ -48,4 +74,16 @@ bytes. We store the most significant byte to the lowest address.
 @param[in]  n 4 byte integer to be stored */
 void mach_write_to_4(byte *b, ulint n);
 
+/** The following function is used to store data in 6 consecutive
+bytes. We store the most significant byte to the lowest address.
+@param[in]  b pointer to 6 bytes where to store
+@param[in]  n 48-bit integer to be stored */
+void mach_write_to_6(byte *b, uint64_t n);
+
+/** The following function is used to store data in 8 consecutive
+bytes. We store the most significant byte to the lowest address.
+@param[in]  b pointer to 8 bytes where to store
+@param[in]  n 64-bit integer to be stored */
+void mach_write_to_8(byte *b, uint64_t n);
+
 #endif
@@ -2,6 +2,8 @@
 #ifndef inno_space_page_page_h
 #define inno_space_page_page_h
 
+#include <vector>
+
 #include "include/fil0fil.h"
 #include "include/page0types.h"
 #include "include/fil0types.h"
@@ -261,9 +263,46 @@ log page header, in bytes */
   2 /*!< Offset of the last undo log header \
     on the segment header page, 0 if        \
     none */
+#define TRX_UNDO_FSEG_HEADER               \
+  4 /*!< Header for the file segment which \
+    the undo log segment occupies */
+#define TRX_UNDO_PAGE_LIST                \
+  (4 + FSEG_HEADER_SIZE) /*!< Base node for \
+  the list of pages in the undo log segment; \
+  defined only on the undo log segment's     \
+  first page */
+/*-------------------------------------------------------------*/
+/* @} */
+
+/** States of an undo log segment */
+/* @{ */
+#define TRX_UNDO_ACTIVE 1   /*!< contains an undo log of an active \
+                            transaction */
+#define TRX_UNDO_CACHED 2   /*!< cached for quick reuse */
+#define TRX_UNDO_TO_FREE 3  /*!< insert undo segment can be freed */
+#define TRX_UNDO_TO_PURGE 4 /*!< update undo segment will not be \
+                            reused: it can be freed in purge when \
+                            all undo data in it is removed */
+#define TRX_UNDO_PREPARED 5 /*!< contains an undo log of an \
+                            prepared transaction */
+/* @} */
+
+/** Number of undo log slots in a rollback segment header page */
+#define TRX_RSEG_N_SLOTS_OF(page_size) ((page_size) / 16)
+#define TRX_RSEG_N_SLOTS TRX_RSEG_N_SLOTS_OF(UNIV_PAGE_SIZE)
 
+/** Default innodb_page_size, used by tablespaces whose FSP_SPACE_FLAGS
+leave PAGE_SSIZE at 0 */
 #define UNIV_PAGE_SIZE (16 * 1024)
 
+/** Smallest and largest innodb_page_size. Page frames are allocated
+UNIV_PAGE_SIZE_MAX bytes long and aligned to it, so that masking a record
+pointer with the logical page size gives its offset whatever the size. */
+/* @{ */
+#define UNIV_PAGE_SIZE_MIN (4 * 1024)
+#define UNIV_PAGE_SIZE_MAX (64 * 1024)
+/* @} */
+
 /** Gets the page number.
  @return page number */
 page_no_t page_get_page_no(const page_t *page); /*!< in: page */
@@ -272,7 +311,10 @@ page_no_t page_get_page_no(const page_t *page); /*!< in: page */
  @return space id */
 space_id_t page_get_space_id(const page_t *page); /*!< in: page */
 
-page_t *align_page(const void* ptr);
+/** Gets the start of the frame a pointer points into.
+@param[in]  ptr        pointer into a frame aligned to page_size
+@param[in]  page_size  logical page size */
+page_t *align_page(const void* ptr, ulint page_size);
 
 /** Reads the given header field. */
 ulint page_header_get_field(const page_t *page, ulint field);        /*!< in: PAGE_LEVEL, ... */
@@ -288,4 +330,66 @@ bool
 page_is_leaf(
 /*=========*/
   const page_t*   page);   /*!< in: page */
+
+/** Checks that a field of len bytes at offset, both read from the page
+itself, lies inside the page before it is read.
+@param[in]  offset     offset within the page
+@param[in]  len        number of bytes
+@param[in]  page_size  page size
+@return true if [offset, offset + len) is inside the page */
+inline bool page_range_is_valid(ulint offset, ulint len, ulint page_size) {
+  return offset <= page_size && len <= page_size - offset;
+}
+
+/** Outcome of Page_rec_check::check() */
+enum page_check_t {
+  PAGE_CHECK_OK,
+  /** PAGE_N_HEAP, PAGE_HEAP_TOP or the infimum and supremum are wrong */
+  PAGE_CHECK_HEADER,
+  /** a next record link leaves the record heap */
+  PAGE_CHECK_LINK,
+  /** a record is met twice: the links loop */
+  PAGE_CHECK_LOOP,
+  /** a record status does not fit the level of the page */
+  PAGE_CHECK_STATUS,
+  /** the list does not hold PAGE_N_RECS records */
+  PAGE_CHECK_N_RECS
+};
+
+/** @return a short description of a check outcome */
+const char *page_check_name(page_check_t check);
+
+/** Checks the record list of a compact index page whatever the page holds:
+each link must stay inside the record heap and lead, through records of
+the status of the page level and distinct heap numbers, to the supremum
+after PAGE_N_RECS records. A bitmap of the heap numbers met stops links
+that loop, so a page is walked at most once. An object is reused from
+page to page by one thread; nothing is allocated after the first page.
+@code
+  Page_rec_check check;
+  if (check.check(page, page_size) != PAGE_CHECK_OK) {
+    skip(page_no, check.bad_offset());
+  }
+@endcode */
+class Page_rec_check {
+ public:
+  Page_rec_check() : m_n_recs(0), m_bad_offset(0) {}
+
+  /** @param[in]  page       compact index page
+  @param[in]  page_size  logical page size
+  @return PAGE_CHECK_OK if the record list is intact */
+  page_check_t check(const page_t *page, ulint page_size);
+
+  /** @return user records walked by the last check */
+  ulint n_recs() const { return m_n_recs; }
+  /** @return offset of the record the last check stopped at, or the
+  offset of the link out of the heap */
+  ulint bad_offset() const { return m_bad_offset; }
+
+ private:
+  /** a bit per heap number */
+  std::vector<uint64_t> m_seen;
+  ulint m_n_recs;
+  ulint m_bad_offset;
+};
 #endif
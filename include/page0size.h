@@ -0,0 +1,41 @@
+#ifndef inno_space_page_size_h
+#define inno_space_page_size_h
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** Page size of a tablespace, as page_size_t in the server. The physical
+size is what a page occupies in the file; the logical size is the size of
+the frame the page is parsed in. Both are the innodb_page_size of the
+instance, except on ROW_FORMAT=COMPRESSED tablespaces whose physical
+size is the KEY_BLOCK_SIZE. */
+class page_size_t {
+ public:
+  /** @param[in]  physical       page size in the file
+  @param[in]  logical        page size of the frame
+  @param[in]  is_compressed  whether pages are compressed */
+  page_size_t(ulint physical, ulint logical, bool is_compressed)
+      : m_physical(physical),
+        m_logical(logical),
+        m_is_compressed(is_compressed) {}
+
+  /** Decodes the page size from the FSP_SPACE_FLAGS of page 0. Flags
+  naming an unknown size give the default UNIV_PAGE_SIZE.
+  @param[in]  fsp_flags  FSP_SPACE_FLAGS */
+  explicit page_size_t(uint32_t fsp_flags);
+
+  ulint physical() const { return m_physical; }
+  ulint logical() const { return m_logical; }
+  bool is_compressed() const { return m_is_compressed; }
+
+  bool equals_to(const page_size_t &other) const {
+    return m_physical == other.m_physical && m_logical == other.m_logical;
+  }
+
+ private:
+  ulint m_physical;
+  ulint m_logical;
+  bool m_is_compressed;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef inno_space_page_zip_h
+#define inno_space_page_zip_h
+
+#include <zlib.h>
+
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+#include "include/dict0dict.h"
+#include "include/page0size.h"
+#include "include/page0types.h"
+
+/** @name Layout of the dense page directory at the end of a compressed
+page, two bytes per heap record, user records first */
+/* @{ */
+#define PAGE_ZIP_DIR_SLOT_SIZE 2
+/** Mask of record offsets */
+#define PAGE_ZIP_DIR_SLOT_MASK 0x3fffU
+/** 'owned' flag */
+#define PAGE_ZIP_DIR_SLOT_OWNED 0x4000U
+/** 'deleted' flag */
+#define PAGE_ZIP_DIR_SLOT_DEL 0x8000U
+/* @} */
+
+/** Start offset of the area that is compressed on a compressed page */
+#define PAGE_ZIP_START PAGE_NEW_SUPREMUM_END
+
+/** Turns the pages of a ROW_FORMAT=COMPRESSED tablespace into the
+logical page size frames the rest of the tool parses, as
+page_zip_decompress() does in the server. An object is meant to be owned
+by one thread: the inflate stream, the output frame and the work arrays
+are allocated once and reused for every page, so a scan allocates
+nothing per page. */
+class Page_zip_decompressor {
+ public:
+  Page_zip_decompressor();
+  ~Page_zip_decompressor();
+
+  /** Gets the uncompressed frame of a page. Index pages are inflated and
+  their modification log applied; other pages are stored uncompressed in
+  the physical size and are copied with the rest of the frame zeroed.
+  @param[in]  zip        page as read from the file
+  @param[in]  page_size  page size of the tablespace
+  @return the frame, valid until the next call, or nullptr if the page
+  could not be inflated */
+  const byte *decompress(const byte *zip, const page_size_t &page_size);
+
+ private:
+  Page_zip_decompressor(const Page_zip_decompressor &) = delete;
+  Page_zip_decompressor &operator=(const Page_zip_decompressor &) = delete;
+
+  bool decompress_index(const byte *zip, ulint zip_size);
+  bool dir_decode(const byte *zip, ulint zip_size, ulint n_dense);
+  bool fields_decode(const byte *buf, const byte *end, bool is_leaf);
+  bool inflate_recs(const byte *zip, ulint n_dense, ulint *heap_status);
+  const byte *apply_log(const byte *data, ulint size, ulint n_dense,
+                        ulint *heap_status);
+  bool set_extra_bytes(const byte *zip, ulint zip_size, ulint info_bits);
+
+  z_stream m_stream;
+  bool m_stream_ok;
+  /** UNIV_PAGE_SIZE_MAX frame preceded by a guard frame, so that a corrupt
+  record header can not make the offsets walk out of the allocation */
+  byte *m_buf;
+  /** the uncompressed frame */
+  byte *m_page;
+  /** logical page size of the page being inflated */
+  ulint m_size;
+  /** records of the dense directory, sorted by address */
+  std::vector<byte *> m_recs;
+  std::vector<ulint> m_offsets;
+  /** index of the page, decoded from the field information that leads
+  the compressed stream */
+  dict_index_t m_index;
+  /** position of DB_TRX_ID in m_index on clustered leaf pages, else
+  ULINT_UNDEFINED */
+  ulint m_trx_id_col;
+  /** true on node pointer pages */
+  bool m_node_ptr;
+  /** end of the modification log, offset within the compressed page */
+  ulint m_end;
+};
+
+#endif
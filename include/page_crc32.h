@@ -1,19 +1,29 @@
 
+#ifndef inno_space_page_crc32_h
+#define inno_space_page_crc32_h
+
 #include "include/ut0crc32.h"
 #include "include/fil0fil.h"
 #include "include/fil0types.h"
+#include "include/srv0mon.h"
+#include "include/ut0mem.h"
+
+/** Magic value to use instead of checksums when they are disabled */
+#define BUF_NO_CHECKSUM_MAGIC 0xDEADBEEFUL
 
 /** Calculates the CRC32 checksum of a page. The value is stored to the page
 when it is written to a file and also checked for a match when reading from
 the file. When reading we allow both normal CRC32 and CRC-legacy-big-endian
 variants. Note that we must be careful to calculate the same value on 32-bit
 and 64-bit architectures.
-@param[in]  page      buffer page (UNIV_PAGE_SIZE bytes)
+@param[in]  page      buffer page (page_size bytes)
 @param[in]  use_legacy_big_endian if true then use big endian
 byteorder when converting byte strings to integers
+@param[in]  page_size logical page size
 @return checksum */
-uint32_t buf_calc_page_crc32(const byte *page,
-                             bool use_legacy_big_endian /* = false */) {
+inline uint32_t buf_calc_page_crc32(const byte *page,
+                                    bool use_legacy_big_endian /* = false */,
+                                    ulint page_size) {
   /* Since the field FIL_PAGE_FILE_FLUSH_LSN, and in versions <= 4.1.x
   FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID, are written outside the buffer pool
   to the first pages of data files, we have to skip them in the page
@@ -22,6 +32,9 @@ uint32_t buf_calc_page_crc32(const byte *page,
   checksum is stored, and also the last 8 bytes of page because
   there we store the old formula checksum. */
 
+  Monitor_timer timer(MONITOR_PAGE_CRC);
+  timer.add_bytes(page_size);
+
   ut_crc32_func_t crc32_func =
       use_legacy_big_endian ? ut_crc32_legacy_big_endian : ut_crc32;
 
@@ -30,7 +43,41 @@ uint32_t buf_calc_page_crc32(const byte *page,
 
   const uint32_t c2 =
       crc32_func(page + FIL_PAGE_DATA,
-                 UNIV_PAGE_SIZE - FIL_PAGE_DATA - FIL_PAGE_END_LSN_OLD_CHKSUM);
+                 page_size - FIL_PAGE_DATA - FIL_PAGE_END_LSN_OLD_CHKSUM);
 
   return (c1 ^ c2);
 }
+
+/** Checks an uncompressed page read from a file as buf_page_is_corrupted()
+does with innodb_checksum_algorithm=crc32: both checksum fields must
+hold the CRC32 of the page, in either byte order, or the "none" magic,
+and the low 32 bits of FIL_PAGE_LSN must be repeated in the trailer. An
+all-zero page, never written, is not corrupt.
+@param[in]  page       page as read from the file
+@param[in]  page_size  logical page size
+@return true if the page is corrupt */
+inline bool buf_page_is_corrupted(const byte *page, ulint page_size) {
+  if (mach_read_from_4(page + FIL_PAGE_LSN + 4) !=
+      mach_read_from_4(page + page_size - FIL_PAGE_END_LSN_OLD_CHKSUM + 4)) {
+    return true;
+  }
+
+  uint32_t field1 = mach_read_from_4(page + FIL_PAGE_SPACE_OR_CHKSUM);
+  uint32_t field2 =
+      mach_read_from_4(page + page_size - FIL_PAGE_END_LSN_OLD_CHKSUM);
+  if (field1 == 0 && field2 == 0 &&
+      mach_read_from_8(page + FIL_PAGE_LSN) == 0 &&
+      ut_is_zeroes(page, page_size)) {
+    return false;
+  }
+  if (field1 == BUF_NO_CHECKSUM_MAGIC && field2 == BUF_NO_CHECKSUM_MAGIC) {
+    return false;
+  }
+  if (field1 != field2) {
+    return true;
+  }
+  return field1 != buf_calc_page_crc32(page, false, page_size) &&
+         field1 != buf_calc_page_crc32(page, true, page_size);
+}
+
+#endif
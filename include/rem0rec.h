@@ -0,0 +1,71 @@
+#ifndef inno_space_rem_rec_h
+#define inno_space_rem_rec_h
+
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/rem0types.h"
+#include "include/rec.h"
+#include "include/dict0dict.h"
+
+/** Length of an SQL NULL field returned by rec_get_nth_field() */
+#define UNIV_SQL_NULL 0xFFFFFFFFUL
+
+/** Length of the external field reference stored at the end of a
+locally stored prefix of an off-page column */
+#define BTR_EXTERN_FIELD_REF_SIZE 20
+
+/** Gets the offset of the next record on a compact page.
+@param[in]  page       index page
+@param[in]  rec_off    offset of the current record within the page
+@param[in]  page_size  logical page size
+@return offset of the next record, 0 if the link is out of bounds */
+ulint rec_get_next_offs(const byte *page, ulint rec_off, ulint page_size);
+
+/** Computes the end offsets of the fields of a compact leaf record,
+following rec_init_offsets_comp_ordinary(). Each entry may carry
+REC_OFFS_SQL_NULL or REC_OFFS_EXTERNAL.
+@param[in]   rec        physical record, in a frame aligned to page_size
+@param[in]   index      index the record belongs to
+@param[out]  offsets    one end offset per index field
+@param[in]   page_size  logical page size
+@return false if the record header is inconsistent with the page, or an
+off-page field is too short to hold its reference */
+bool rec_get_offsets(const rec_t *rec, const dict_index_t &index,
+                     std::vector<ulint> &offsets, ulint page_size);
+
+/** Gets the nth field of a record.
+@param[in]   rec      physical record
+@param[in]   offsets  offsets computed by rec_get_offsets()
+@param[in]   n        field number
+@param[out]  len      field length, UNIV_SQL_NULL for NULL
+@return pointer to the field data */
+const byte *rec_get_nth_field(const rec_t *rec,
+                              const std::vector<ulint> &offsets, ulint n,
+                              ulint *len);
+
+/** @return true if the nth field is stored off-page */
+inline bool rec_offs_nth_extern(const std::vector<ulint> &offsets, ulint n) {
+  return (offsets[n] & REC_OFFS_EXTERNAL) != 0;
+}
+
+/** Decodes a signed or unsigned integer column.
+@param[in]  col   column definition
+@param[in]  data  field data
+@param[in]  len   field length
+@return the value */
+int64_t rec_field_to_int(const dict_col_t &col, const byte *data, ulint len);
+
+/** Decodes a FLOAT or DOUBLE column. */
+double rec_field_to_double(const dict_col_t &col, const byte *data);
+
+/** Formats a field into printable text.
+@param[in]   col   column definition
+@param[in]   data  field data
+@param[in]   len   field length
+@param[out]  out   text representation */
+void rec_field_to_string(const dict_col_t &col, const byte *data, ulint len,
+                         std::string *out);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef inno_space_row_recover_h
+#define inno_space_row_recover_h
+
+#include "include/udef.h"
+
+/** Recovers deleted rows of the clustered index that are still on disk,
+with one parallel scan of every page whose PAGE_INDEX_ID is that of the
+index, whether it is still in the B-tree or not:
+- records delete-marked and waiting for purge;
+- records on the PAGE_FREE list of a page, purged but not yet
+  overwritten by an insert;
+- every record of a leaf page the extent descriptors mark free, such as
+  the pages a large DELETE emptied and gave back to the tablespace.
+Each candidate must pass rec_get_offsets() and lie inside the record
+heap of its page before it is decoded with the table definition, so
+that space reused by later records is not reported as a row. Rows come
+out in no particular order, as the threads find them.
+@param[in]  fd         tablespace file
+@param[in]  sdi_path   ibd2sdi json describing the table
+@param[in]  n_threads  scan threads, 0 for one per CPU */
+void ShowDeletedRecords(int fd, const char *sdi_path, uint32_t n_threads);
+
+/** Salvages the rows of a tablespace whose B-tree can no longer be
+walked, with page 0, the inodes or the upper levels destroyed. A
+parallel scan keeps every leaf page of type FIL_PAGE_INDEX whose record
+list holds together on its own and groups them by PAGE_INDEX_ID; the
+pages of each index are then put in the order of their sibling links,
+a chain for each run of links that still agree. The pages of the
+clustered index are read again, a batch at a time, and their records
+printed in that order.
+@param[in]  fd         tablespace file
+@param[in]  sdi_path   ibd2sdi json describing the table, nullptr or ""
+                       to list the indexes found without records
+@param[in]  n_threads  scan threads, 0 for one per CPU */
+void ShowCarvedRecords(int fd, const char *sdi_path, uint32_t n_threads);
+
+#endif
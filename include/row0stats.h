@@ -0,0 +1,14 @@
+#ifndef inno_space_row_stats_h
+#define inno_space_row_stats_h
+
+#include "include/udef.h"
+
+/** Profiles every column of the clustered index with one parallel scan of
+its leaf pages: null fraction, min/max, average length, equi-height
+histogram, distinct count and most frequent values.
+@param[in]  fd         tablespace file
+@param[in]  sdi_path   ibd2sdi json describing the table
+@param[in]  n_threads  scan threads, 0 for one per CPU */
+void ShowColumnStats(int fd, const char *sdi_path, uint32_t n_threads);
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef inno_space_srv_mon_h
+#define inno_space_srv_mon_h
+
+#include <stdio.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "include/udef.h"
+
+/** Timers of the hot paths of a command, reported by --stats, and the
+progress line of --progress. Each thread counts into a slot of its own,
+so timing a call costs two reads of the time stamp counter and a few
+adds to memory no other thread writes; the slots are summed when the
+report is printed. Nothing is counted until monitor_enable() is called,
+and a disabled timer costs one test of a global flag. */
+
+/** The phases timed */
+enum monitor_id_t {
+  /** fil_pread(): reads of pages and page runs */
+  MONITOR_PAGE_READ,
+  /** buf_calc_page_crc32() */
+  MONITOR_PAGE_CRC,
+  /** rec_get_offsets() */
+  MONITOR_REC_DECODE,
+  /** lob_read(): one off-page value, with the reads of its pages and
+  the output of its pieces, which are counted in their phases too */
+  MONITOR_LOB_FETCH,
+  /** writes of dumped values and replies, and the flush of stdout */
+  MONITOR_OUTPUT,
+  NUM_MONITOR
+};
+
+/** Set by monitor_enable(), before any thread is started */
+extern bool monitor_is_on;
+
+/** @return the time stamp counter, or nanoseconds of a steady clock where
+there is none; never 0 */
+inline uint64_t monitor_clock() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/** Counts one call of a phase in the slot of the calling thread.
+@param[in]  id     phase
+@param[in]  ticks  duration, in monitor_clock() ticks
+@param[in]  bytes  bytes processed */
+void monitor_add(monitor_id_t id, uint64_t ticks, uint64_t bytes);
+
+/** Times a scope as one call of a phase.
+@code
+  Monitor_timer timer(MONITOR_PAGE_READ);
+  ssize_t ret = pread(fd, buf, n, offset);
+  timer.add_bytes(ret);
+@endcode */
+class Monitor_timer {
+ public:
+  explicit Monitor_timer(monitor_id_t id)
+      : m_id(id), m_start(monitor_is_on ? monitor_clock() : 0), m_bytes(0) {}
+  ~Monitor_timer() {
+    if (m_start != 0) {
+      monitor_add(m_id, monitor_clock() - m_start, m_bytes);
+    }
+  }
+
+  void add_bytes(uint64_t n) { m_bytes += n; }
+
+ private:
+  Monitor_timer(const Monitor_timer &) = delete;
+  Monitor_timer &operator=(const Monitor_timer &) = delete;
+
+  monitor_id_t m_id;
+  uint64_t m_start;
+  uint64_t m_bytes;
+};
+
+/** Starts counting; the wall clock of the report starts here too. */
+void monitor_enable();
+
+/** Prints the time of each phase, its throughput and a histogram of its
+latencies, and flushes stdout first, as part of MONITOR_OUTPUT.
+@param[in]  out  stream, stderr so that the output of the command is
+                 left alone */
+void monitor_print(FILE *out);
+
+/** Prints a progress line to stderr every interval seconds: bytes and
+pages read, the read rate and, once a total is set, the time left.
+@param[in]  interval  seconds between two lines */
+void monitor_progress_start(uint32_t interval);
+
+/** Sets the bytes the command is expected to read, for the ETA of the
+progress line; a later call replaces the total.
+@param[in]  total      bytes
+@param[in]  page_size  physical page size, to count pages; 0 if the files
+                       read have different page sizes */
+void monitor_progress_set_total(uint64_t total, ulint page_size);
+
+/** Counts bytes a scan passes over without reading them, such as the
+holes of a sparse file, as done in the progress line.
+@param[in]  bytes  bytes skipped */
+void monitor_progress_skip(uint64_t bytes);
+
+/** Stops the progress thread; called at exit. */
+void monitor_progress_stop();
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef inno_space_srv_srv_h
+#define inno_space_srv_srv_h
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** Longest request line the server reads */
+#define SRV_MAX_REQUEST 4096
+
+/** Serves inspection requests on a Unix socket until a client sends
+"shutdown". Tablespaces stay open between requests, and a page cache
+bounded by cache_bytes keeps the pages read, so that repeated requests
+are answered from memory; a file whose mtime or size changed is opened
+again and its pages dropped. Frames are BUF_CACHE_FRAME_SIZE bytes, so
+pages of 32KB and 64KB are read from the file every time.
+
+A request is one line of words separated by spaces, answered with lines
+of text ending with "OK <microseconds>" or "ERROR <message>":
+
+  page <file> <page_no>              FIL header, and page header of an
+                                     index page
+  records <file> <page_no> <sdi>     user records of a leaf page, with
+                                     the columns of an ibd2sdi json
+  summary <file>                     space header, pages by type and the
+                                     root of each index
+  stats                              open files and cache hits
+  close <file>                       forget a file
+  shutdown                           stop the server
+
+Each connection is served by a thread of its own, so clients do not
+wait for each other.
+@param[in]  socket_path  path of the socket, replaced if it exists
+@param[in]  cache_bytes  memory for cached pages
+@param[in]  n_threads    threads of a summary scan, 0 for one per CPU
+@return 0 after shutdown, -1 if the socket can not be set up */
+int srv_serve(const char *socket_path, uint64_t cache_bytes,
+              uint32_t n_threads);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef inno_space_trx_purge_h
+#define inno_space_trx_purge_h
+
+#include "include/udef.h"
+
+/** Reports what holds purge back in an undo tablespace: history length
+and oldest trx_no per rollback segment, undo segment pages by state, undo
+bytes per table_id and the space purge would give back. The rollback
+segments are walked concurrently.
+@param[in]  fd         undo tablespace
+@param[in]  n_threads  walking threads, 0 for one per CPU */
+void ShowPurgeLag(int fd, uint32_t n_threads);
+
+#endif
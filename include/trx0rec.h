@@ -0,0 +1,101 @@
+#ifndef inno_space_trx_rec_h
+#define inno_space_trx_rec_h
+
+#include <vector>
+
+#include "include/udef.h"
+
+/** Types of an undo log record */
+/* @{ */
+#define TRX_UNDO_INSERT_REC 11 /* fresh insert into clustered index */
+#define TRX_UNDO_UPD_EXIST_REC    \
+  12 /* update of a non-delete-marked \
+     record */
+#define TRX_UNDO_UPD_DEL_REC                  \
+  13 /* update of a delete marked record to \
+     a not delete marked record; also the   \
+     fields of the record can change */
+#define TRX_UNDO_DEL_MARK_REC              \
+  14 /* delete marking of a record; fields \
+     do not change */
+#define TRX_UNDO_CMPL_INFO_MULT           \
+  16 /* compilation info is multiplied by \
+     this and ORed to the type above */
+#define TRX_UNDO_MODIFY_BLOB              \
+  64 /* If this bit is set in type_cmpl,  \
+     then the undo log record has support \
+     for partial update of BLOBs */
+#define TRX_UNDO_UPD_EXTERN                \
+  128 /* This bit can be ORed to type_cmpl \
+      to denote that we updated external   \
+      storage fields: used by purge to     \
+      free the external storage */
+/* @} */
+
+/** The compilation info flag telling that no ordering field of the
+clustered index changed in an update */
+#define UPD_NODE_NO_ORD_CHANGE 1
+
+/** Length marker of a field whose prefix is stored in the undo record
+and whose full value is stored off-page */
+#define UNIV_EXTERN_STORAGE_FIELD (0xFFFFFFFFUL - 16384)
+
+/** A field stored in an undo log record. */
+struct trx_undo_field_t {
+  /** position of the field in the clustered index */
+  ulint field_no;
+  /** field data, nullptr for SQL NULL */
+  const byte *data;
+  /** length of the data, UNIV_SQL_NULL for SQL NULL */
+  ulint len;
+  /** true if only a prefix is stored and the rest lives off-page */
+  bool is_extern;
+};
+
+/** An undo log record decoded by trx_undo_rec_parse(). */
+struct trx_undo_rec_info_t {
+  ulint type;
+  ulint cmpl_info;
+  bool updated_extern;
+  uint64_t undo_no;
+  uint64_t table_id;
+
+  /** info bits, DB_TRX_ID and DB_ROLL_PTR of the old version; defined
+  only for update and delete-mark records */
+  ulint info_bits;
+  uint64_t trx_id;
+  uint64_t roll_ptr;
+
+  /** unique fields of the clustered index */
+  std::vector<trx_undo_field_t> pk;
+  /** old values of the updated fields */
+  std::vector<trx_undo_field_t> update;
+
+  /** true if decoding stopped early at a part of the record this tool
+  does not understand (virtual columns, partial LOB updates) */
+  bool truncated;
+};
+
+/** Reads the type, undo number and table id of an undo log record.
+@param[in]   rec   undo log record, starting at its next record pointer
+@param[in]   size  total size of the record, including both 2-byte links
+@param[out]  info  header fields of the record
+@return pointer to the rest of the record, nullptr if it is corrupted */
+const byte *trx_undo_rec_get_pars(const byte *rec, ulint size,
+                                  trx_undo_rec_info_t *info);
+
+/** Decodes an undo log record following trx_undo_rec_get_pars(),
+trx_undo_update_rec_get_sys_cols(), trx_undo_rec_get_row_ref() and
+trx_undo_update_rec_get_update().
+@param[in]   rec   undo log record, starting at its next record pointer
+@param[in]   size  total size of the record, including both 2-byte links
+@param[in]   n_pk  number of unique fields of the clustered index
+@param[out]  info  decoded record; field data points into rec
+@return false if the record is corrupted */
+bool trx_undo_rec_parse(const byte *rec, ulint size, ulint n_pk,
+                        trx_undo_rec_info_t *info);
+
+/** @return printable name of an undo record type */
+const char *trx_undo_rec_type_name(ulint type);
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef inno_space_trx_rseg_h
+#define inno_space_trx_rseg_h
+
+#include "include/udef.h"
+
+/** Shows the rollback segment array and every rollback segment of one or
+more undo tablespaces: their headers and the last undo log in each
+history list. path may name one file, a glob such as
+"log/undo_00[1-8]", or a directory, in which case its undo_NNN and *.ibu
+files are taken. The rollback segments of all files are read
+concurrently through one shared page cache, and the report is printed in
+file and slot order once everything has been read.
+@param[in]  path       undo tablespace, glob or directory
+@param[in]  n_threads  worker threads, 0 for one per CPU */
+void ShowUndoFile(const char *path, uint32_t n_threads);
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef inno_space_trx_undo_h
+#define inno_space_trx_undo_h
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/api0api.h"
+
+/** An undo log found in the history list of a rollback segment. */
+struct trx_undo_log_t {
+  /** rollback segment slot */
+  uint32_t rseg_id;
+  /** page and offset of the undo log header */
+  page_no_t hdr_page_no;
+  ulint hdr_offset;
+
+  uint64_t trx_id;
+  uint64_t trx_no;
+  bool del_marks;
+
+  /** TRX_UNDO_STATE and page list length of the undo segment whose
+  first page holds the log header */
+  ulint seg_state;
+  ulint seg_n_pages;
+
+  /** pages, records and record bytes of the log; complete only when
+  the log callback of trx_undo_walk_history() is called */
+  ulint n_pages;
+  uint64_t n_recs;
+  uint64_t n_bytes;
+};
+
+/** Called for every undo log record by trx_undo_walk_history().
+@param[in]  log   the undo log the record belongs to
+@param[in]  rec   record, starting at its next record pointer; valid
+                  only during the call
+@param[in]  size  size of the record, including both 2-byte links */
+typedef std::function<void(const trx_undo_log_t &log, const byte *rec,
+                           ulint size)>
+    trx_undo_rec_func_t;
+
+/** Called for every undo log by trx_undo_walk_history() once all of its
+records were visited. */
+typedef std::function<void(const trx_undo_log_t &log)> trx_undo_log_func_t;
+
+/** Asks the kernel to start reading a page that is needed soon.
+@param[in]  fd         tablespace file
+@param[in]  page_size  page size of the tablespace
+@param[in]  page_no    page number, FIL_NULL is ignored */
+void trx_undo_prefetch(int fd, ulint page_size, page_no_t page_no);
+
+/** Reads one page of an undo tablespace.
+@param[in]   fd         tablespace file
+@param[in]   page_size  page size of the tablespace
+@param[in]   page_no    page number
+@param[out]  buf        page frame of page_size bytes
+@return false if the page is beyond the end of the file */
+bool trx_undo_read_page(int fd, ulint page_size, page_no_t page_no,
+                        byte *buf);
+
+/** Reads the rollback segment header page numbers of an undo tablespace.
+@param[in]   fd         undo tablespace
+@param[in]   page_size  page size of the tablespace
+@param[out]  rsegs      one page number per slot, FIL_NULL for unused
+                        slots
+@return false if the RSEG_ARRAY page is missing or corrupted */
+bool trx_undo_read_rseg_array(int fd, ulint page_size,
+                              std::vector<page_no_t> *rsegs);
+
+/** Walks the TRX_RSEG_HISTORY list of a rollback segment from the newest
+to the oldest undo log, and the pages and records of every log. The page
+of the next log header and the next page of the current log are handed to
+the kernel with POSIX_FADV_WILLNEED before the current page is parsed, so
+that reading a long history overlaps with decoding it.
+@param[in]  fd           undo tablespace
+@param[in]  page_size    page size of the tablespace
+@param[in]  rseg_id      rollback segment slot, only reported back
+@param[in]  rseg_page    page of the rollback segment header
+@param[in]  log_func     called once per undo log, may be empty
+@param[in]  rec_func     called once per record, may be empty
+@return number of undo logs visited */
+uint64_t trx_undo_walk_history(int fd, ulint page_size, uint32_t rseg_id,
+                               page_no_t rseg_page,
+                               const trx_undo_log_func_t &log_func,
+                               const trx_undo_rec_func_t &rec_func);
+
+/** Walks the history list of every rollback segment of an undo
+tablespace and prints every undo log and its decoded records, followed by
+per-table and per-transaction aggregates.
+@param[in]  fd        undo tablespace
+@param[in]  sdi_path  optional ibd2sdi json; records of that table get
+                      their primary key and updated columns decoded */
+void ShowUndoHistory(int fd, const char *sdi_path);
+
+/** Formats the undo page header and undo segment header of an undo page
+as the -p report prints them.
+@param[out]  out   report
+@param[in]   page  undo page */
+void trx_undo_format_page_header(std::string *out, const byte *page);
+
+#endif
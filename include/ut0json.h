@@ -0,0 +1,123 @@
+#ifndef inno_space_ut_json_h
+#define inno_space_ut_json_h
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "include/udef.h"
+#include "include/rem0types.h"
+
+struct dict_table_t;
+struct dict_index_t;
+
+/** Output of the reports as JSON, chosen by --format json. Each object a
+report prints is one line of NDJSON with a "kind" member naming it, so
+that a stream of millions of pages or records is parsed a line at a
+time. Objects are written by a rapidjson Writer into a buffer of the
+calling thread, reused from line to line, and nothing is kept once a line
+is out: memory stays the size of the largest line. */
+
+/** Output formats */
+enum ut_format_t {
+  /** the text the reports have always printed */
+  UT_FORMAT_TEXT,
+  /** a JSON object per line */
+  UT_FORMAT_JSON
+};
+
+/** Set by --format, before any report runs */
+extern ut_format_t ut_format;
+
+/** @return true if the reports print JSON */
+inline bool ut_format_is_json() { return ut_format == UT_FORMAT_JSON; }
+
+/** Parses the argument of --format.
+@param[in]   name    "text" or "json"
+@param[out]  format  the format
+@return false if the name is unknown */
+bool ut_format_parse(const char *name, ut_format_t *format);
+
+typedef rapidjson::Writer<rapidjson::StringBuffer> Json_writer;
+
+/** One line of NDJSON: an object begun by the constructor and written to
+stdout, with its newline, by one fwrite() in the destructor, so lines of
+several threads do not interleave. Only one line may be open in a thread.
+@code
+  Json_line line("fil_header");
+  line.add("page_no", page_no);
+  line.writer().Key("segments");
+  line.writer().StartArray();
+@endcode */
+class Json_line {
+ public:
+  /** @param[in]  kind  value of the "kind" member */
+  explicit Json_line(const char *kind);
+  ~Json_line();
+
+  /** @return the writer, for nested objects and arrays */
+  Json_writer &writer() { return m_writer; }
+
+  void add(const char *key, int value);
+  void add(const char *key, uint32_t value);
+  void add(const char *key, int64_t value);
+  void add(const char *key, uint64_t value);
+  void add(const char *key, double value);
+  void add(const char *key, bool value);
+  void add(const char *key, const char *value);
+  void add(const char *key, const std::string &value);
+  void add_null(const char *key);
+
+  /** Ends the object and appends it, with its newline, to a report rather
+  than stdout; for reports formatted by threads and printed in order.
+  @param[out]  out  report */
+  void append_to(std::string *out);
+
+  /** Writes a string value too long to be buffered, such as an off-page
+  column: the line so far is written out, then the bytes as they are
+  given to string_append(). Each byte is one code point, so the value is
+  the bytes once encoded as Latin-1. The line is no longer written by one
+  fwrite(), so this is for reports of one thread.
+  @param[in]  key  member name */
+  void string_begin(const char *key);
+  /** @param[in]  data  bytes of the value
+  @param[in]  len   number of bytes */
+  void string_append(const byte *data, ulint len);
+  void string_end();
+
+ private:
+  Json_line(const Json_line &) = delete;
+  Json_line &operator=(const Json_line &) = delete;
+
+  rapidjson::StringBuffer &m_buf;
+  Json_writer &m_writer;
+  /** set by append_to() */
+  bool m_done;
+};
+
+/** Writes a string value: text that is valid UTF-8 as it is, anything
+else a code point per byte, so that the line stays valid JSON whatever
+the character set of the column.
+@param[in]  writer  writer
+@param[in]  data    bytes
+@param[in]  len     number of bytes */
+void ut_json_string(Json_writer &writer, const char *data, size_t len);
+
+/** Writes the columns of a compact leaf record as the "fields" object of
+a line: integers as numbers, NULL as null, off-page columns as
+"<off-page>" and the others as rec_field_to_string() formats them. The
+columns InnoDB adds, such as DB_TRX_ID, are left out.
+@param[in]  line     line
+@param[in]  table    table definition
+@param[in]  index    index of the record
+@param[in]  rec      record
+@param[in]  offsets  offsets computed by rec_get_offsets() */
+void ut_json_rec_fields(Json_line &line, const dict_table_t &table,
+                        const dict_index_t &index, const rec_t *rec,
+                        const std::vector<ulint> &offsets);
+
+#endif
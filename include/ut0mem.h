@@ -0,0 +1,31 @@
+#ifndef inno_space_ut_mem_h
+#define inno_space_ut_mem_h
+
+#include <stddef.h>
+
+#include "include/udef.h"
+
+/** Compiles a byte scanning kernel once for each instruction set listed
+and picks one when the program is loaded, from what the CPU has, so that
+a binary built for any x86-64 uses AVX2 (x86-64-v3) or AVX-512
+(x86-64-v4) where they exist. The clones differ only in how the compiler
+vectorizes their loops, which it does from -O2; the CRC32 functions
+choose their SSE4.2 code with cpuid in ut_crc32_init() instead. */
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+#define UT_TARGET_CLONES \
+  __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define UT_TARGET_CLONES
+#endif
+
+/** Bytes the kernels test at a time: a cache line, which one test of a
+vector register OR-ed over it can accept or reject */
+#define UT_SCAN_BLOCK 64
+
+/** @return true if every byte of a buffer is zero, such as a page that
+was allocated but never written
+@param[in]  ptr  buffer
+@param[in]  len  number of bytes */
+bool ut_is_zeroes(const byte *ptr, ulint len);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef inno_space_ut_pool_h
+#define inno_space_ut_pool_h
+
+#include <stddef.h>
+
+#include <functional>
+
+#include "include/udef.h"
+
+/** Called for every task run by ut_parallel_for().
+@param[in]  thread_no  worker running the task, in [0, n_threads)
+@param[in]  task_no    task number, in [0, n_tasks) */
+typedef std::function<void(uint32_t thread_no, size_t task_no)>
+    ut_task_func_t;
+
+/** Runs tasks 0..n_tasks-1 on a fixed pool of worker threads. Workers
+claim the next task from a shared counter, so long tasks do not hold up
+the others. Returns when all tasks are done; a single thread runs the
+tasks in order on the calling thread.
+@param[in]  n_tasks    number of tasks
+@param[in]  n_threads  number of worker threads, at least 1
+@param[in]  func       task body; must only touch state owned by its
+                       task_no or its thread_no */
+void ut_parallel_for(size_t n_tasks, uint32_t n_threads,
+                     const ut_task_func_t &func);
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef inno_space_ut_sketch_h
+#define inno_space_ut_sketch_h
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "include/udef.h"
+
+/** Mergeable summaries used by the column statistics scan. Every scan
+thread fills its own copy and the copies are merged at the end, so none
+of these classes is thread-safe. */
+
+/** 64-bit hash of a byte string (murmur2 style).
+@param[in]  data  bytes to hash
+@param[in]  len   number of bytes
+@param[in]  seed  hash seed
+@return hash value */
+uint64_t ut_hash_bytes(const void *data, size_t len, uint64_t seed = 0);
+
+/** HyperLogLog distinct count estimator with 2^HLL_PRECISION registers. */
+class Hll_sketch {
+ public:
+  static const uint32_t HLL_PRECISION = 14;
+  static const uint32_t HLL_REGISTERS = 1U << HLL_PRECISION;
+
+  Hll_sketch() : m_registers(HLL_REGISTERS, 0) {}
+
+  /** Adds a hashed value. */
+  void update(uint64_t hash) {
+    uint32_t idx = hash >> (64 - HLL_PRECISION);
+    uint64_t rest = hash << HLL_PRECISION;
+    uint8_t rank = rest == 0 ? (64 - HLL_PRECISION + 1)
+                             : (__builtin_clzll(rest) + 1);
+    if (rank > m_registers[idx]) {
+      m_registers[idx] = rank;
+    }
+  }
+
+  void merge(const Hll_sketch &other);
+
+  /** @return estimated number of distinct values */
+  uint64_t estimate() const;
+
+ private:
+  std::vector<uint8_t> m_registers;
+};
+
+/** Count-min sketch with a bounded set of heavy hitter candidates, used
+to report the most frequent values of a column. */
+class Top_k_sketch {
+ public:
+  static const uint32_t CM_DEPTH = 4;
+  static const uint32_t CM_WIDTH = 2048;
+
+  /** @param[in]  k  number of values to report */
+  explicit Top_k_sketch(uint32_t k = 10)
+      : m_k(k), m_counts(CM_DEPTH * CM_WIDTH, 0), m_min_candidate(0) {}
+
+  /** Adds one occurrence of a value. */
+  void update(const std::string &value, uint64_t hash);
+
+  void merge(const Top_k_sketch &other);
+
+  /** @return up to k (value, estimated count) pairs, most frequent first */
+  std::vector<std::pair<std::string, uint64_t>> top() const;
+
+ private:
+  uint64_t estimate(uint64_t hash) const;
+
+  /** Drops candidates beyond the capacity, keeping the most frequent,
+  and sets the count a new value needs to become a candidate. */
+  void prune();
+
+  /** candidates kept, a multiple of k to make merges accurate */
+  size_t capacity() const { return 4 * m_k; }
+
+  uint32_t m_k;
+  std::vector<uint32_t> m_counts;
+  /** value -> (hash, estimated count), up to twice capacity() between
+  two prunes */
+  std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> m_candidates;
+  /** smallest count the last prune kept: once the set is full, a new
+  value needs more to be added */
+  uint64_t m_min_candidate;
+};
+
+/** KLL quantile sketch (Karnin, Lang, Liberty). Level h holds items of
+weight 2^h; a full level is sorted and every other item is promoted. */
+template <typename T>
+class Kll_sketch {
+ public:
+  explicit Kll_sketch(uint32_t k = 200) : m_k(k), m_n(0), m_rng(0x9E3779B9) {
+    m_levels.resize(1);
+  }
+
+  void update(const T &value) {
+    m_levels[0].push_back(value);
+    m_n++;
+    if (m_levels[0].size() >= capacity(0)) {
+      compress();
+    }
+  }
+
+  void merge(const Kll_sketch &other) {
+    if (other.m_levels.size() > m_levels.size()) {
+      m_levels.resize(other.m_levels.size());
+    }
+    for (size_t h = 0; h < other.m_levels.size(); h++) {
+      m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(),
+                         other.m_levels[h].end());
+    }
+    m_n += other.m_n;
+    compress();
+  }
+
+  uint64_t count() const { return m_n; }
+
+  /** Gets the values at the given ranks.
+  @param[in]  ranks  normalized ranks in [0, 1], ascending
+  @return one value per rank */
+  std::vector<T> quantiles(const std::vector<double> &ranks) const {
+    std::vector<std::pair<T, uint64_t>> items;
+    for (size_t h = 0; h < m_levels.size(); h++) {
+      for (const T &v : m_levels[h]) {
+        items.push_back(std::make_pair(v, (uint64_t)1 << h));
+      }
+    }
+    std::vector<T> result;
+    if (items.empty()) {
+      return result;
+    }
+    std::sort(items.begin(), items.end(),
+              [](const std::pair<T, uint64_t> &a,
+                 const std::pair<T, uint64_t> &b) { return a.first < b.first; });
+    uint64_t total = 0;
+    for (const auto &item : items) {
+      total += item.second;
+    }
+    uint64_t cum = 0;
+    size_t i = 0;
+    for (double r : ranks) {
+      uint64_t target = (uint64_t)(r * total);
+      while (i + 1 < items.size() && cum + items[i].second <= target) {
+        cum += items[i].second;
+        i++;
+      }
+      result.push_back(items[i].first);
+    }
+    return result;
+  }
+
+ private:
+  /** Capacity of level h, shrinking by 2/3 per level below the top. */
+  size_t capacity(size_t h) const {
+    size_t depth = m_levels.size() - h - 1;
+    double cap = m_k;
+    for (size_t i = 0; i < depth; i++) {
+      cap *= 2.0 / 3.0;
+    }
+    return cap < 8 ? 8 : (size_t)cap;
+  }
+
+  void compress() {
+    for (size_t h = 0; h < m_levels.size(); h++) {
+      if (m_levels[h].size() < capacity(h)) {
+        continue;
+      }
+      if (h + 1 == m_levels.size()) {
+        m_levels.resize(m_levels.size() + 1);
+      }
+      std::vector<T> &level = m_levels[h];
+      std::sort(level.begin(), level.end());
+      m_rng = m_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+      size_t offset = (m_rng >> 63) & 1;
+      /* an odd item stays behind so the weight is preserved */
+      size_t keep = level.size() % 2;
+      std::vector<T> &next = m_levels[h + 1];
+      for (size_t i = keep + offset; i < level.size(); i += 2) {
+        next.push_back(level[i]);
+      }
+      level.resize(keep);
+    }
+  }
+
+  uint32_t m_k;
+  uint64_t m_n;
+  uint64_t m_rng;
+  std::vector<std::vector<T>> m_levels;
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef inno_space_ut_ut_h
+#define inno_space_ut_ut_h
+
+#include <string>
+
+/** Appends printf-formatted text to a string, for reports that are
+formatted by one thread or function and printed by another.
+@param[out]  out  report
+@param[in]   fmt  printf format */
+void ut_str_printf(std::string *out, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif
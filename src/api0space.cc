@@ -0,0 +1,200 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <mutex>
+
+#include "include/api0space.h"
+#include "include/buf0cache.h"
+#include "include/fil0crypt.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page0zip.h"
+#include "include/rem0rec.h"
+#include "include/ut0crc32.h"
+
+void inno_init() {
+  static std::once_flag once;
+  std::call_once(once, ut_crc32_init);
+}
+
+bool inno_load_keyring(const char *path) {
+  return fil_crypt_load_keyring(path);
+}
+
+Tablespace::Tablespace()
+    : m_space_id(0), m_page_size(0, 0, false), m_n_pages(0) {}
+
+std::unique_ptr<Tablespace> Tablespace::open(const char *path,
+                                             bool writable,
+                                             const fil_keyring_t *keyring) {
+  inno_init();
+  std::vector<std::string> files;
+  fil_space_find_files(path, &files);
+  if (files.empty()) {
+    return nullptr;
+  }
+  std::unique_ptr<Tablespace> space(new Tablespace());
+  if (!fil_space_open(files, writable ? O_RDWR : O_RDONLY, &space->m_space)) {
+    return nullptr;
+  }
+
+  const int fd = space->m_space.fd;
+  space->m_path = path;
+  space->m_page_size = fil_get_page_size(fd);
+  struct stat stat_buf;
+  if (fil_space_stat(space->m_space, &stat_buf) == 0) {
+    space->m_n_pages = stat_buf.st_size / space->m_page_size.physical();
+  }
+  byte space_id[4];
+  if (fil_pread(space->m_space, space_id, sizeof(space_id),
+                FSP_HEADER_OFFSET + FSP_SPACE_ID) == sizeof(space_id)) {
+    space->m_space_id = mach_read_from_4(space_id);
+  }
+  space->m_key = fil_space_read_key(fd, keyring);
+  space->m_space.key = space->m_key.get();
+  return space;
+}
+
+Tablespace::~Tablespace() {
+  fil_space_detach(&m_space);
+  fil_space_close(&m_space);
+}
+
+bool Tablespace::read_page(page_no_t page_no, byte *frame,
+                           Buf_page_cache *cache) const {
+  const ulint physical = m_page_size.physical();
+  if (page_no >= m_n_pages) {
+    return false;
+  }
+  if (cache == nullptr) {
+    cache = m_space.cache;
+  }
+  bool ok = cache != nullptr
+                ? cache->read(m_space, physical, page_no, frame)
+                : fil_pread(m_space, frame, physical,
+                            (uint64_t)page_no * physical) == (ssize_t)physical;
+  if (!ok || !fil_page_restore(m_space, frame, physical)) {
+    return false;
+  }
+  if (!m_page_size.is_compressed()) {
+    return true;
+  }
+  /* each thread inflates into a frame of its own */
+  thread_local std::unique_ptr<Page_zip_decompressor> zip;
+  if (!zip) {
+    zip.reset(new Page_zip_decompressor());
+  }
+  const byte *page = zip->decompress(frame, m_page_size);
+  if (page == nullptr) {
+    return false;
+  }
+  memcpy(frame, page, m_page_size.logical());
+  return true;
+}
+
+uint64_t Tablespace::scan(page_no_t first, page_no_t last,
+                          uint32_t n_threads,
+                          const fil_scan_func_t &func) const {
+  return fil_scan_parallel(fil_scan_space_t(m_space, m_page_size, true),
+                           first, last, n_threads, func);
+}
+
+Page_iterator::Page_iterator(const Tablespace &space, page_no_t first,
+                             page_no_t last)
+    : m_space(space.space(), space.page_size(), true),
+      m_next(first),
+      m_last(std::min(last, m_space.n_pages)),
+      m_frame_size(m_space.page_size.logical()),
+      m_frames(nullptr),
+      m_pos(0) {
+  if (posix_memalign((void **)&m_frames, UNIV_PAGE_SIZE_MAX,
+                     m_frame_size * FIL_SCAN_BATCH_PAGES) != 0) {
+    m_frames = nullptr;
+  }
+}
+
+Page_iterator::~Page_iterator() { free(m_frames); }
+
+bool Page_iterator::next() {
+  if (m_pos + 1 < m_page_nos.size()) {
+    m_pos++;
+    return true;
+  }
+  if (m_frames == nullptr || !m_reader.is_ready()) {
+    return false;
+  }
+  m_page_nos.clear();
+  m_pos = 0;
+  /* a batch whose pages all fail to be restored yields nothing */
+  while (m_page_nos.empty() && m_next < m_last) {
+    uint64_t n_pages =
+        std::min<uint64_t>(m_last - m_next, FIL_SCAN_BATCH_PAGES);
+    uint64_t n_read = m_reader.read_batch(
+        m_space, m_next, n_pages, 0,
+        [this](uint32_t, page_no_t page_no, const byte *page) {
+          memcpy(m_frames + m_page_nos.size() * m_frame_size, page,
+                 m_frame_size);
+          m_page_nos.push_back(page_no);
+        });
+    /* a short read is the end of the file */
+    m_next = n_read < n_pages ? m_last : m_next + n_pages;
+  }
+  return !m_page_nos.empty();
+}
+
+Record_cursor::Record_cursor(const byte *page, const dict_index_t &index,
+                             ulint page_size)
+    : m_page(page),
+      m_index(index),
+      m_page_size(page_size),
+      m_rec_off(PAGE_NEW_INFIMUM),
+      m_n_heap(page_dir_get_n_heap(page)),
+      m_n_visited(0) {}
+
+bool Record_cursor::next() {
+  /* the heap bounds the walk on a page whose links loop */
+  while (m_n_visited < m_n_heap) {
+    m_rec_off = rec_get_next_offs(m_page, m_rec_off, m_page_size);
+    if (m_rec_off == 0 || m_rec_off == PAGE_NEW_SUPREMUM) {
+      break;
+    }
+    m_n_visited++;
+    const rec_t *rec = m_page + m_rec_off;
+    if (rec_get_status(rec) == REC_STATUS_ORDINARY &&
+        !(rec_get_info_bits(rec, true) & REC_INFO_DELETED_FLAG) &&
+        rec_get_offsets(rec, m_index, m_offsets, m_page_size)) {
+      return true;
+    }
+  }
+  m_n_visited = m_n_heap;
+  return false;
+}
+
+const byte *Record_cursor::field(ulint n, ulint *len) const {
+  return rec_get_nth_field(rec(), m_offsets, n, len);
+}
+
+bool Record_cursor::is_extern(ulint n) const {
+  return rec_offs_nth_extern(m_offsets, n);
+}
+
+std::unique_ptr<Schema> Schema::load(const char *sdi_path) {
+  std::unique_ptr<Schema> schema(new Schema());
+  if (dict_load_from_sdi(sdi_path, &schema->m_table) != 0) {
+    return nullptr;
+  }
+  return schema;
+}
+
+const dict_index_t *Schema::index_by_id(uint64_t id) const {
+  for (const dict_index_t &index : m_table.indexes) {
+    if (index.id == id) {
+      return &index;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,417 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "include/arch0page.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/log0recv.h"
+#include "include/page0page.h"
+#include "include/ut0pool.h"
+
+/** Entries read back from a spilled run by one fread() */
+static const size_t ARCH_RUN_READ_PAGES = 8192;
+
+/** Pages of the checked tablespace looked up at once */
+static const size_t ARCH_CHECK_BATCH = 65536;
+
+/** Pages looked up by one task of a batch */
+static const size_t ARCH_CHECK_TASK = 256;
+
+/** @return whether a sorts before b */
+static bool arch_page_less(const arch_page_t &a, const arch_page_t &b) {
+  return a.space_id != b.space_id ? a.space_id < b.space_id
+                                  : a.page_no < b.page_no;
+}
+
+/** @return whether a and b name the same page */
+static bool arch_page_equal(const arch_page_t &a, const arch_page_t &b) {
+  return a.space_id == b.space_id && a.page_no == b.page_no;
+}
+
+Arch_page_set::Arch_page_set(size_t mem_budget) {
+  m_max_pages = std::max<size_t>(mem_budget / sizeof(arch_page_t), 1024);
+}
+
+Arch_page_set::~Arch_page_set() {
+  for (FILE *run : m_runs) {
+    fclose(run);
+  }
+}
+
+void Arch_page_set::add(space_id_t space_id, page_no_t page_no, lsn_t lsn) {
+  arch_page_t page = {space_id, page_no, lsn};
+  m_pages.push_back(page);
+  if (m_pages.size() < m_max_pages) {
+    return;
+  }
+  compact();
+  /* redo usually hits the same pages again and again; only spill when
+  deduplication did not pay off */
+  if (m_pages.size() > m_max_pages / 2 && !spill()) {
+    fprintf(stderr, "Arch_page_set cannot spill to a temporary file: %s\n",
+            strerror(errno));
+    m_max_pages *= 2;
+  }
+}
+
+void Arch_page_set::compact() {
+  std::sort(m_pages.begin(), m_pages.end(), arch_page_less);
+  size_t n = 0;
+  for (size_t i = 0; i < m_pages.size(); i++) {
+    if (n > 0 && arch_page_equal(m_pages[n - 1], m_pages[i])) {
+      m_pages[n - 1].lsn = std::max(m_pages[n - 1].lsn, m_pages[i].lsn);
+    } else {
+      m_pages[n++] = m_pages[i];
+    }
+  }
+  m_pages.resize(n);
+}
+
+bool Arch_page_set::spill() {
+  FILE *run = tmpfile();
+  if (run == nullptr) {
+    return false;
+  }
+  if (fwrite(m_pages.data(), sizeof(arch_page_t), m_pages.size(), run) !=
+          m_pages.size() ||
+      fflush(run) != 0) {
+    fclose(run);
+    return false;
+  }
+  rewind(run);
+  m_runs.push_back(run);
+  m_pages.clear();
+  return true;
+}
+
+/** A sorted source of pages merged by Arch_page_set::for_each(): either a
+spilled run or the entries left in memory. */
+struct arch_cursor_t {
+  FILE *run;
+  std::vector<arch_page_t> buf;
+  size_t pos;
+  size_t end;
+
+  /** @return the current page */
+  const arch_page_t &page() const { return buf[pos]; }
+
+  /** Moves to the next page.
+  @return false at the end */
+  bool next() {
+    if (++pos < end) {
+      return true;
+    }
+    if (run == nullptr) {
+      return false;
+    }
+    buf.resize(ARCH_RUN_READ_PAGES);
+    end = fread(buf.data(), sizeof(arch_page_t), buf.size(), run);
+    pos = 0;
+    return end > 0;
+  }
+};
+
+bool Arch_page_set::for_each(const arch_page_func_t &func) {
+  compact();
+
+  std::vector<arch_cursor_t> cursors(m_runs.size() + 1);
+  for (size_t i = 0; i < m_runs.size(); i++) {
+    rewind(m_runs[i]);
+    cursors[i].run = m_runs[i];
+    cursors[i].pos = cursors[i].end = 0;
+  }
+  cursors.back().run = nullptr;
+  cursors.back().buf.swap(m_pages);
+  cursors.back().pos = 0;
+  cursors.back().end = cursors.back().buf.size();
+
+  /* the cursor holding the smallest page on top */
+  auto greater = [&](size_t a, size_t b) {
+    return arch_page_less(cursors[b].page(), cursors[a].page());
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(
+      greater);
+  for (size_t i = 0; i < cursors.size(); i++) {
+    arch_cursor_t &c = cursors[i];
+    if (c.run != nullptr) {
+      if (!c.next()) {
+        continue;
+      }
+    } else if (c.end == 0) {
+      continue;
+    }
+    heap.push(i);
+  }
+
+  bool have_pending = false;
+  arch_page_t pending = {0, 0, 0};
+  while (!heap.empty()) {
+    size_t i = heap.top();
+    heap.pop();
+    const arch_page_t &page = cursors[i].page();
+    if (have_pending && arch_page_equal(pending, page)) {
+      pending.lsn = std::max(pending.lsn, page.lsn);
+    } else {
+      if (have_pending) {
+        func(pending);
+      }
+      pending = page;
+      have_pending = true;
+    }
+    if (cursors[i].next()) {
+      heap.push(i);
+    }
+  }
+  if (have_pending) {
+    func(pending);
+  }
+
+  m_pages.swap(cursors.back().buf);
+  for (size_t i = 0; i < m_runs.size(); i++) {
+    if (ferror(m_runs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** What the tablespace says about a page changed by redo */
+enum arch_check_t {
+  /** FIL_PAGE_LSN is at or past the latest change */
+  ARCH_PAGE_CURRENT,
+  /** changed after the last checkpoint, may not be flushed yet */
+  ARCH_PAGE_UNFLUSHED,
+  /** older than a change that the checkpoint says was flushed */
+  ARCH_PAGE_LOST_WRITE,
+  /** beyond the end of the file */
+  ARCH_PAGE_MISSING
+};
+
+/** Checks a batch of changed pages against their FIL_PAGE_LSN.
+@param[in]   fd              tablespace
+@param[in]   page_size       physical page size
+@param[in]   n_pages         pages in the file
+@param[in]   checkpoint_lsn  latest checkpoint of the redo log
+@param[in]   pages           changed pages of the tablespace
+@param[in]   n_threads       reading threads
+@param[out]  page_lsns       FIL_PAGE_LSN of every page
+@param[out]  checks          outcome for every page */
+static void arch_check_batch(int fd, ulint page_size, page_no_t n_pages,
+                             lsn_t checkpoint_lsn,
+                             const std::vector<arch_page_t> &pages,
+                             uint32_t n_threads, std::vector<lsn_t> *page_lsns,
+                             std::vector<arch_check_t> *checks) {
+  page_lsns->assign(pages.size(), 0);
+  checks->assign(pages.size(), ARCH_PAGE_CURRENT);
+  size_t n_tasks = (pages.size() + ARCH_CHECK_TASK - 1) / ARCH_CHECK_TASK;
+  ut_parallel_for(n_tasks, n_threads, [&](uint32_t thread_no, size_t task_no) {
+    (void)thread_no;
+    size_t last = std::min(pages.size(), (task_no + 1) * ARCH_CHECK_TASK);
+    for (size_t i = task_no * ARCH_CHECK_TASK; i < last; i++) {
+      const arch_page_t &page = pages[i];
+      byte lsn_buf[8];
+      /* only the header field is needed, not the whole page */
+      if (page.page_no >= n_pages ||
+          fil_pread(fd, lsn_buf, sizeof(lsn_buf),
+                    (off_t)page.page_no * page_size + FIL_PAGE_LSN) !=
+              sizeof(lsn_buf)) {
+        (*checks)[i] = ARCH_PAGE_MISSING;
+        continue;
+      }
+      lsn_t page_lsn = mach_read_from_8(lsn_buf);
+      (*page_lsns)[i] = page_lsn;
+      if (page_lsn >= page.lsn) {
+        (*checks)[i] = ARCH_PAGE_CURRENT;
+      } else if (page.lsn >= checkpoint_lsn) {
+        (*checks)[i] = ARCH_PAGE_UNFLUSHED;
+      } else {
+        (*checks)[i] = ARCH_PAGE_LOST_WRITE;
+      }
+    }
+  });
+}
+
+/** Prints page numbers as ranges, a few per line. */
+class Arch_range_printer {
+ public:
+  Arch_range_printer() : m_first(FIL_NULL), m_last(FIL_NULL), m_on_line(0) {}
+
+  void add(page_no_t page_no) {
+    if (m_first != FIL_NULL && page_no == m_last + 1) {
+      m_last = page_no;
+      return;
+    }
+    flush();
+    m_first = m_last = page_no;
+  }
+
+  void flush() {
+    if (m_first == FIL_NULL) {
+      return;
+    }
+    if (m_on_line == 0) {
+      printf(" ");
+    }
+    if (m_first == m_last) {
+      printf(" %u", m_first);
+    } else {
+      printf(" %u-%u", m_first, m_last);
+    }
+    if (++m_on_line == 10) {
+      printf("\n");
+      m_on_line = 0;
+    }
+    m_first = m_last = FIL_NULL;
+  }
+
+  void finish() {
+    flush();
+    if (m_on_line > 0) {
+      printf("\n");
+    }
+  }
+
+ private:
+  page_no_t m_first;
+  page_no_t m_last;
+  uint32_t m_on_line;
+};
+
+/** @return whether a record changes the page it names */
+static bool arch_rec_changes_page(const log_rec_t &rec) {
+  switch (rec.type) {
+    case MLOG_FILE_CREATE:
+    case MLOG_FILE_RENAME:
+    case MLOG_FILE_DELETE:
+    case MLOG_FILE_EXTEND:
+    case MLOG_INDEX_LOAD:
+      return false;
+    default:
+      return rec.has_page;
+  }
+}
+
+void ShowRedoPages(int fd, const char *redo_path, lsn_t since_lsn,
+                   lsn_t until_lsn, size_t mem_budget, uint32_t n_threads) {
+  printf("==========================Redo Page Index==========================\n");
+  std::vector<std::string> paths;
+  if (!log_expand_paths(redo_path, &paths)) {
+    return;
+  }
+
+  byte space_buf[4];
+  if (fil_pread(fd, space_buf, sizeof(space_buf),
+                FSP_HEADER_OFFSET + FSP_SPACE_ID) != sizeof(space_buf)) {
+    fprintf(stderr, "ShowRedoPages cannot read page 0\n");
+    return;
+  }
+  space_id_t space_id = mach_read_from_4(space_buf);
+
+  Arch_page_set page_set(mem_budget);
+  uint64_t n_changes = 0;
+  std::vector<log_file_info_t> files;
+  log_scan_stats_t stats;
+  log_scan_files(paths, &files,
+                 [&](const log_rec_t &rec, const byte *body) {
+                   (void)body;
+                   if (!arch_rec_changes_page(rec) || rec.lsn < since_lsn ||
+                       (until_lsn != 0 && rec.lsn >= until_lsn)) {
+                     return;
+                   }
+                   n_changes++;
+                   page_set.add(rec.space_id, rec.page_no, rec.lsn);
+                 },
+                 &stats);
+
+  lsn_t checkpoint_lsn = 0;
+  for (const log_file_info_t &info : files) {
+    for (const log_checkpoint_t &cp : info.checkpoints) {
+      if (cp.checksum_ok && cp.lsn > checkpoint_lsn) {
+        checkpoint_lsn = cp.lsn;
+      }
+    }
+  }
+  printf("Redo log files: %lu, LSN window [%lu, ", files.size(), since_lsn);
+  if (until_lsn == 0) {
+    printf("end of log)\n");
+  } else {
+    printf("%lu)\n", until_lsn);
+  }
+  printf("Latest checkpoint LSN: %lu\n", checkpoint_lsn);
+  printf("Records: %lu, page changes in window: %lu, resyncs %lu\n",
+         stats.n_recs, n_changes, stats.n_resyncs);
+
+  n_threads = fil_scan_n_threads(n_threads);
+  ulint page_size = fil_get_page_size(fd).physical();
+  page_no_t n_pages = fil_get_n_pages(fd);
+  std::map<space_id_t, uint64_t> space_pages;
+  std::vector<arch_page_t> batch;
+  std::vector<lsn_t> page_lsns;
+  std::vector<arch_check_t> checks;
+  uint64_t n_checked[ARCH_PAGE_MISSING + 1] = {0, 0, 0, 0};
+  Arch_range_printer ranges;
+  /* lost writes are rare, keep them to list after the ranges */
+  std::vector<std::pair<arch_page_t, lsn_t>> lost;
+
+  printf("\n==========================Space %u==========================\n",
+         space_id);
+  printf("Changed pages:\n");
+  auto check = [&]() {
+    arch_check_batch(fd, page_size, n_pages, checkpoint_lsn, batch, n_threads,
+                     &page_lsns, &checks);
+    for (size_t i = 0; i < batch.size(); i++) {
+      ranges.add(batch[i].page_no);
+      n_checked[checks[i]]++;
+    }
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (checks[i] == ARCH_PAGE_LOST_WRITE) {
+        lost.push_back(std::make_pair(batch[i], page_lsns[i]));
+      }
+    }
+    batch.clear();
+  };
+  bool ok = page_set.for_each([&](const arch_page_t &page) {
+    space_pages[page.space_id]++;
+    if (page.space_id != space_id) {
+      return;
+    }
+    batch.push_back(page);
+    if (batch.size() == ARCH_CHECK_BATCH) {
+      check();
+    }
+  });
+  check();
+  ranges.finish();
+  if (!ok) {
+    fprintf(stderr, "ShowRedoPages failed to read a spilled run back\n");
+  }
+
+  for (const auto &l : lost) {
+    printf("Lost write: page %u, FIL_PAGE_LSN %lu is behind redo lsn %lu\n",
+           l.first.page_no, l.second, l.first.lsn);
+  }
+  printf("Pages changed: %lu, current %lu, not flushed since checkpoint "
+         "%lu, lost writes %lu, beyond end of file %lu\n",
+         space_pages[space_id], n_checked[ARCH_PAGE_CURRENT],
+         n_checked[ARCH_PAGE_UNFLUSHED], n_checked[ARCH_PAGE_LOST_WRITE],
+         n_checked[ARCH_PAGE_MISSING]);
+
+  printf("\n==========================Pages by space==========================\n");
+  printf("Spilled runs: %lu\n", page_set.n_runs());
+  for (const auto &s : space_pages) {
+    if (s.second > 0) {
+      printf("  space %u: %lu pages\n", s.first, s.second);
+    }
+  }
+}
@@ -0,0 +1,243 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "include/buf0cache.h"
+#include "include/fil0space.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+
+Buf_page_cache::Buf_page_cache(size_t capacity, ulint frame_size,
+                               uint32_t n_shards)
+    : m_frame_size(frame_size), m_map(nullptr), m_map_size(0),
+      m_arena(nullptr), m_n_frames(0) {
+  if (n_shards == 0) {
+    n_shards = 1;
+  }
+  size_t n_frames = std::max<size_t>(capacity / frame_size, n_shards);
+  m_map_size = n_frames * frame_size + BUF_CACHE_ARENA_ALIGN;
+  void *map = mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED) {
+    fprintf(stderr, "Page cache of %lu bytes can not be mapped: %s\n",
+            n_frames * frame_size, strerror(errno));
+    n_frames = 0;
+    m_map_size = 0;
+  } else {
+    m_map = static_cast<byte *>(map);
+    m_arena = m_map + (BUF_CACHE_ARENA_ALIGN -
+                       (uintptr_t)m_map % BUF_CACHE_ARENA_ALIGN) %
+                          BUF_CACHE_ARENA_ALIGN;
+#ifdef MADV_HUGEPAGE
+    /* only a hint, the cache works the same on 4K pages */
+    madvise(m_arena, n_frames * frame_size, MADV_HUGEPAGE);
+#endif
+  }
+  m_n_frames = n_frames;
+  m_frames.reset(new frame_t[n_frames]);
+  for (uint32_t i = 0; i < n_shards; i++) {
+    m_shards.emplace_back(new shard_t());
+    m_shards[i]->first = n_frames * i / n_shards;
+    m_shards[i]->n_frames =
+        n_frames * (i + 1) / n_shards - m_shards[i]->first;
+  }
+}
+
+Buf_page_cache::~Buf_page_cache() {
+  if (m_map != nullptr) {
+    munmap(m_map, m_map_size);
+  }
+}
+
+void Buf_page_cache::remove(shard_t &s, frame_t &frame) {
+  s.map.erase(frame.key);
+  s.size -= frame.len;
+  frame.in_map = false;
+  frame.ref = false;
+}
+
+size_t Buf_page_cache::victim(shard_t &s) {
+  /* two turns of the hand clear every reference bit */
+  for (size_t n = 0; n < 2 * s.n_frames; n++) {
+    size_t i = s.first + s.hand;
+    s.hand = (s.hand + 1) % s.n_frames;
+    frame_t &frame = m_frames[i];
+    if (frame.io_fix || frame.n_pins.load() != 0) {
+      continue;
+    }
+    if (frame.ref.exchange(false)) {
+      continue;
+    }
+    if (frame.in_map) {
+      remove(s, frame);
+    }
+    return i;
+  }
+  return m_n_frames;
+}
+
+const byte *Buf_page_cache::pin(const fil_space_t &space, ulint page_size,
+                                page_no_t page_no) {
+  if (page_size > m_frame_size) {
+    return nullptr;
+  }
+  key_t key = make_key(space.fd, page_no);
+  shard_t &s = shard(key);
+  std::unique_lock<std::mutex> lock(s.mutex);
+  for (;;) {
+    auto it = s.map.find(key);
+    if (it == s.map.end()) {
+      break;
+    }
+    frame_t &frame = m_frames[it->second];
+    if (frame.io_fix) {
+      /* another thread is reading the page, wait for it */
+      s.io_done.wait(lock);
+      continue;
+    }
+    if (frame.len != page_size) {
+      /* the descriptor was reused for a file of another page size */
+      remove(s, frame);
+      break;
+    }
+    frame.n_pins++;
+    frame.ref = true;
+    s.n_hits.fetch_add(1, std::memory_order_relaxed);
+    return frame_buf(it->second);
+  }
+  s.n_misses.fetch_add(1, std::memory_order_relaxed);
+
+  size_t i = victim(s);
+  if (i == m_n_frames) {
+    return nullptr;
+  }
+  frame_t &frame = m_frames[i];
+  frame.key = key;
+  frame.len = page_size;
+  frame.in_map = true;
+  frame.io_fix = true;
+  frame.n_pins = 1;
+  frame.ref = true;
+  s.map[key] = i;
+  s.size += page_size;
+
+  /* read outside the latch; threads missing on the same page wait on
+  io_done rather than reading it again */
+  lock.unlock();
+  bool ok = fil_pread(space, frame_buf(i), page_size,
+                      (uint64_t)page_no * page_size) == (ssize_t)page_size;
+  lock.lock();
+  frame.io_fix = false;
+  if (!ok) {
+    if (frame.in_map) {
+      remove(s, frame);
+    }
+    frame.n_pins--;
+  }
+  s.io_done.notify_all();
+  return ok ? frame_buf(i) : nullptr;
+}
+
+void Buf_page_cache::unpin(const byte *frame) {
+  m_frames[(frame - m_arena) / m_frame_size].n_pins--;
+}
+
+const byte *Buf_page_cache::pin(int fd, ulint page_size, page_no_t page_no) {
+  fil_space_t single(fd);
+  return pin(fil_space_get(fd, &single), page_size, page_no);
+}
+
+bool Buf_page_cache::read(const fil_space_t &space, ulint page_size,
+                          page_no_t page_no, byte *buf) {
+  const byte *frame = pin(space, page_size, page_no);
+  if (frame != nullptr) {
+    memcpy(buf, frame, page_size);
+    unpin(frame);
+    return true;
+  }
+  /* too large for a frame, or no frame to spare */
+  return fil_pread(space, buf, page_size, (uint64_t)page_no * page_size) ==
+         (ssize_t)page_size;
+}
+
+bool Buf_page_cache::read(int fd, ulint page_size, page_no_t page_no,
+                          byte *buf) {
+  fil_space_t single(fd);
+  return read(fil_space_get(fd, &single), page_size, page_no, buf);
+}
+
+void Buf_page_cache::invalidate(int fd, page_no_t page_no) {
+  key_t key = make_key(fd, page_no);
+  shard_t &s = shard(key);
+  std::lock_guard<std::mutex> guard(s.mutex);
+  auto it = s.map.find(key);
+  if (it != s.map.end()) {
+    /* a read in flight still completes into the frame, which is reused
+    once its readers unpin it */
+    remove(s, m_frames[it->second]);
+  }
+}
+
+void Buf_page_cache::evict(int fd) {
+  for (const std::unique_ptr<shard_t> &s : m_shards) {
+    std::lock_guard<std::mutex> guard(s->mutex);
+    for (size_t i = s->first; i < s->first + s->n_frames; i++) {
+      frame_t &frame = m_frames[i];
+      if (frame.in_map && static_cast<int>(frame.key >> 32) == fd) {
+        remove(*s, frame);
+      }
+    }
+  }
+}
+
+size_t Buf_page_cache::size() const {
+  size_t size = 0;
+  for (const std::unique_ptr<shard_t> &s : m_shards) {
+    std::lock_guard<std::mutex> guard(s->mutex);
+    size += s->size;
+  }
+  return size;
+}
+
+uint64_t Buf_page_cache::n_hits() const {
+  uint64_t n = 0;
+  for (const std::unique_ptr<shard_t> &s : m_shards) {
+    n += s->n_hits.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+uint64_t Buf_page_cache::n_misses() const {
+  uint64_t n = 0;
+  for (const std::unique_ptr<shard_t> &s : m_shards) {
+    n += s->n_misses.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+bool buf_read_page(int fd, ulint page_size, page_no_t page_no, byte *buf) {
+  fil_space_t single(fd);
+  const fil_space_t &space = fil_space_get(fd, &single);
+  if (space.cache != nullptr) {
+    return space.cache->read(space, page_size, page_no, buf);
+  }
+  return fil_pread(space, buf, page_size, (uint64_t)page_no * page_size) ==
+         (ssize_t)page_size;
+}
+
+bool buf_write_page(int fd, ulint page_size, page_no_t page_no,
+                    const byte *buf) {
+  fil_space_t single(fd);
+  const fil_space_t &space = fil_space_get(fd, &single);
+  bool ok =
+      fil_pwrite(space, buf, page_size, (uint64_t)page_no * page_size) ==
+      (ssize_t)page_size;
+  if (space.cache != nullptr) {
+    space.cache->invalidate(fd, page_no);
+  }
+  return ok;
+}
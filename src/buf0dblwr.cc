@@ -0,0 +1,250 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "include/buf0dblwr.h"
+#include "include/buf0cache.h"
+#include "include/fil0comp.h"
+#include "include/fil0crypt.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page_crc32.h"
+
+/** Pages read by one pread() of a doublewrite file */
+#define DBLWR_READ_PAGES 64
+
+/** Gets the page size a doublewrite file was written with from its name,
+#ib_<page size>_<n>.dblwr.
+@return page size, 0 if the name does not tell */
+static ulint dblwr_file_page_size(const std::string &path) {
+  std::string name(path);
+  unsigned long page_size = 0;
+  if (sscanf(basename(&name[0]), "#ib_%lu_", &page_size) != 1) {
+    return 0;
+  }
+  return page_size;
+}
+
+/** Checks the checksum of a page as the server does on read: encrypted
+and page compressed pages are restored first, with the key of the
+tablespace fd when it is needed.
+@param[in]  fd         tablespace the page belongs to
+@param[in]  page       page as written to the file
+@param[in]  page_size  page size
+@return true if the page is corrupt */
+static bool dblwr_page_is_corrupted(int fd, const byte *page,
+                                    ulint page_size) {
+  if (!fil_page_is_encrypted(page) && !fil_page_is_page_compressed(page)) {
+    return buf_page_is_corrupted(page, page_size);
+  }
+  std::unique_ptr<byte[]> copy(new byte[page_size]);
+  memcpy(copy.get(), page, page_size);
+  return !fil_page_restore(fd, copy.get(), page_size) ||
+         buf_page_is_corrupted(copy.get(), page_size);
+}
+
+/** @return true if no byte of a page is set */
+static bool dblwr_page_is_empty(const byte *page, ulint page_size) {
+  for (ulint i = 0; i < page_size; i++) {
+    if (page[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool dblwr_index_build(const char *path, ulint page_size,
+                       dblwr_index_t *index) {
+  std::vector<std::string> files;
+  fil_expand_paths(path, {"#ib_*.dblwr", "#ib_*.bdblwr"}, &files);
+  index->page_size = page_size;
+
+  std::unique_ptr<byte[]> buf(new byte[page_size * DBLWR_READ_PAGES]);
+  for (const std::string &file : files) {
+    ulint file_page_size = dblwr_file_page_size(file);
+    if (file_page_size != 0 && file_page_size != page_size) {
+      fprintf(stderr, "Skip %s, written with page size %u\n", file.c_str(),
+              file_page_size);
+      continue;
+    }
+    int fd = open(file.c_str(), O_RDONLY);
+    if (fd == -1) {
+      fprintf(stderr, "Open %s failed: %s\n", file.c_str(), strerror(errno));
+      continue;
+    }
+    uint32_t file_no = index->files.size();
+    index->files.push_back(file);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    uint64_t offset = 0;
+    while (true) {
+      ssize_t ret = pread(fd, buf.get(), page_size * DBLWR_READ_PAGES, offset);
+      if (ret <= 0) {
+        break;
+      }
+      ulint n_pages = ret / page_size;
+      for (ulint i = 0; i < n_pages; i++, offset += page_size) {
+        const byte *page = buf.get() + i * page_size;
+        if (dblwr_page_is_empty(page, page_size)) {
+          index->n_empty++;
+          continue;
+        }
+        dblwr_page_t image;
+        image.lsn = mach_read_from_8(page + FIL_PAGE_LSN);
+        image.file_no = file_no;
+        image.offset = offset;
+        if (fil_page_is_encrypted(page) ||
+            fil_page_is_page_compressed(page)) {
+          image.state = DBLWR_UNVERIFIED;
+        } else if (buf_page_is_corrupted(page, page_size)) {
+          image.state = DBLWR_CORRUPT;
+          index->n_corrupt++;
+        } else {
+          image.state = DBLWR_VALID;
+          index->n_valid++;
+        }
+        index->n_images++;
+        index->pages[std::make_pair(
+                         mach_read_from_4(page + FIL_PAGE_SPACE_ID),
+                         mach_read_from_4(page + FIL_PAGE_OFFSET))]
+            .push_back(image);
+      }
+      if ((ulint)ret < page_size * DBLWR_READ_PAGES) {
+        break;
+      }
+    }
+    close(fd);
+  }
+
+  for (auto &it : index->pages) {
+    std::sort(it.second.begin(), it.second.end(),
+              [](const dblwr_page_t &a, const dblwr_page_t &b) {
+                return a.lsn > b.lsn;
+              });
+  }
+  return !index->files.empty();
+}
+
+/** Finds the newest copy of a page that passes its checksum.
+@param[in]   fd     tablespace the page belongs to
+@param[in]   index  doublewrite page images
+@param[in]   key    space id and page number
+@param[out]  image  page image of index->page_size bytes
+@return the copy, nullptr if there is none */
+static const dblwr_page_t *dblwr_find_copy(
+    int fd, const dblwr_index_t &index,
+    const std::pair<space_id_t, page_no_t> &key, byte *image) {
+  auto it = index.pages.find(key);
+  if (it == index.pages.end()) {
+    return nullptr;
+  }
+  for (const dblwr_page_t &copy : it->second) {
+    if (copy.state == DBLWR_CORRUPT) {
+      continue;
+    }
+    int dblwr_fd = open(index.files[copy.file_no].c_str(), O_RDONLY);
+    if (dblwr_fd == -1) {
+      continue;
+    }
+    bool ok = pread(dblwr_fd, image, index.page_size, copy.offset) ==
+              (ssize_t)index.page_size;
+    close(dblwr_fd);
+    if (ok && (copy.state == DBLWR_VALID ||
+               !dblwr_page_is_corrupted(fd, image, index.page_size))) {
+      return &copy;
+    }
+  }
+  return nullptr;
+}
+
+void ShowDblwr(int fd, const char *dblwr_path, bool apply,
+               uint32_t n_threads) {
+  printf("==========================Doublewrite==========================\n");
+  page_size_t page_size = fil_get_page_size(fd);
+  if (page_size.is_compressed()) {
+    fprintf(stderr, "Compressed tablespaces are not supported\n");
+    return;
+  }
+  ulint size = page_size.physical();
+
+  dblwr_index_t index;
+  if (!dblwr_index_build(dblwr_path, size, &index)) {
+    fprintf(stderr, "No doublewrite file in %s\n", dblwr_path);
+    return;
+  }
+  printf("Doublewrite files %lu, page images %lu, valid %lu, corrupt %lu, "
+         "empty slots %lu, distinct pages %lu\n",
+         index.files.size(), index.n_images, index.n_valid, index.n_corrupt,
+         index.n_empty, index.pages.size());
+
+  byte space_buf[4];
+  if (fil_pread(fd, space_buf, sizeof(space_buf),
+                FSP_HEADER_OFFSET + FSP_SPACE_ID) != sizeof(space_buf)) {
+    fprintf(stderr, "ShowDblwr cannot read page 0\n");
+    return;
+  }
+  space_id_t space_id = mach_read_from_4(space_buf);
+
+  /* the checksum is over the pages as they are in the file */
+  n_threads = fil_scan_n_threads(n_threads);
+  std::vector<std::vector<page_no_t>> per_thread(n_threads);
+  fil_scan_parallel(fd, 0, fil_get_n_pages(fd), n_threads,
+                    [&](uint32_t thread_no, page_no_t page_no,
+                        const byte *page) {
+                      if (dblwr_page_is_corrupted(fd, page, size)) {
+                        per_thread[thread_no].push_back(page_no);
+                      }
+                    },
+                    false);
+  std::vector<page_no_t> corrupt;
+  for (const std::vector<page_no_t> &pages : per_thread) {
+    corrupt.insert(corrupt.end(), pages.begin(), pages.end());
+  }
+  std::sort(corrupt.begin(), corrupt.end());
+
+  std::unique_ptr<byte[]> image(new byte[size]);
+  std::unique_ptr<byte[]> page(new byte[size]);
+  uint64_t n_found = 0;
+  uint64_t n_restored = 0;
+  for (page_no_t page_no : corrupt) {
+    uint64_t offset = (uint64_t)page_no * size;
+    lsn_t page_lsn = 0;
+    if (fil_pread(fd, page.get(), size, offset) == (ssize_t)size) {
+      page_lsn = mach_read_from_8(page.get() + FIL_PAGE_LSN);
+    }
+    const dblwr_page_t *copy = dblwr_find_copy(
+        fd, index, std::make_pair(space_id, page_no), image.get());
+    if (copy == nullptr) {
+      printf("page %u lsn %lu: corrupt, no valid copy\n", page_no, page_lsn);
+      continue;
+    }
+    n_found++;
+    printf("page %u lsn %lu: corrupt, copy lsn %lu in %s offset %lu", page_no,
+           page_lsn, copy->lsn, index.files[copy->file_no].c_str(),
+           copy->offset);
+    if (apply) {
+      if (buf_write_page(fd, size, page_no, image.get())) {
+        n_restored++;
+        printf(", restored");
+      } else {
+        printf(", write failed: %s", strerror(errno));
+      }
+    }
+    printf("\n");
+  }
+  printf("Space %u: corrupt pages %lu, with a valid copy %lu, restored %lu\n",
+         space_id, corrupt.size(), n_found, n_restored);
+  if (!apply && n_found > 0) {
+    printf("Run again with --apply to write the copies\n");
+  }
+}
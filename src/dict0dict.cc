@@ -0,0 +1,393 @@
+#include <string.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <rapidjson/document.h>
+
+#include "include/dict0dict.h"
+
+/** Gets the maximum bytes per character of a collation. Only the
+single-byte and utf8mb3 collations are listed, everything else is
+treated as utf8mb4. */
+static uint32_t dict_collation_mbmaxlen(uint32_t collation_id) {
+  switch (collation_id) {
+    case 5: case 8: case 11: case 15: case 31: case 47: case 48: case 49:
+    case 63: case 65: case 94:
+      return 1;
+    case 33: case 83:
+      return 3;
+    default:
+      if (collation_id >= 192 && collation_id <= 223) {
+        return 3;
+      }
+      return 4;
+  }
+}
+
+/** Reads "key=value;" out of an se_private_data string.
+@return the value, 0 if the key is absent */
+static uint64_t dict_se_private_get(const char *data, const char *key) {
+  size_t key_len = strlen(key);
+  const char *p = data;
+  while (p != nullptr && *p != '\0') {
+    if (strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+      return strtoull(p + key_len + 1, nullptr, 10);
+    }
+    p = strchr(p, ';');
+    if (p != nullptr) {
+      p++;
+    }
+  }
+  return 0;
+}
+
+/** Bytes used by the fractional part of TIME2/DATETIME2/TIMESTAMP2. */
+static uint32_t dict_frac_bytes(uint32_t fsp) {
+  return (fsp + 1) / 2;
+}
+
+/** Storage size of a NEWDECIMAL(precision, scale). */
+static uint32_t dict_decimal_bin_size(uint32_t precision, uint32_t scale) {
+  static const uint32_t dig2bytes[10] = {0, 1, 1, 2, 2, 3, 3, 4, 4, 4};
+  uint32_t intg = precision - scale;
+  return (intg / 9) * 4 + dig2bytes[intg % 9] + (scale / 9) * 4 +
+         dig2bytes[scale % 9];
+}
+
+/** Gets the fixed storage length of a column in a compact record.
+@return length in bytes, 0 if the column is variable-length */
+static uint32_t dict_col_fixed_len(const dict_col_t &col) {
+  if (col.hidden == DD_HIDDEN_SE) {
+    /* DB_ROW_ID, DB_TRX_ID and DB_ROLL_PTR keep their length here */
+    return col.char_length;
+  }
+  switch (col.type) {
+    case DD_TYPE_TINY:
+    case DD_TYPE_YEAR:
+      return 1;
+    case DD_TYPE_SHORT:
+      return 2;
+    case DD_TYPE_INT24:
+    case DD_TYPE_DATE:
+    case DD_TYPE_NEWDATE:
+      return 3;
+    case DD_TYPE_LONG:
+    case DD_TYPE_FLOAT:
+      return 4;
+    case DD_TYPE_LONGLONG:
+    case DD_TYPE_DOUBLE:
+      return 8;
+    case DD_TYPE_TIMESTAMP2:
+      return 4 + dict_frac_bytes(col.datetime_precision);
+    case DD_TYPE_DATETIME2:
+      return 5 + dict_frac_bytes(col.datetime_precision);
+    case DD_TYPE_TIME2:
+      return 3 + dict_frac_bytes(col.datetime_precision);
+    case DD_TYPE_NEWDECIMAL:
+      return dict_decimal_bin_size(col.numeric_precision, col.numeric_scale);
+    case DD_TYPE_BIT:
+      return (col.char_length + 7) / 8;
+    case DD_TYPE_ENUM:
+      return col.char_length > 255 ? 2 : 1;
+    case DD_TYPE_SET:
+      return (col.char_length + 7) / 8 > 4 ? 8 : (col.char_length + 7) / 8;
+    case DD_TYPE_STRING:
+      /* CHAR(n) is variable-length in compact records when the
+      character set is multi-byte */
+      return col.mbmaxlen == 1 ? col.char_length : 0;
+    default:
+      return 0;
+  }
+}
+
+bool dict_col_is_integer(const dict_col_t &col) {
+  switch (col.type) {
+    case DD_TYPE_TINY:
+    case DD_TYPE_SHORT:
+    case DD_TYPE_INT24:
+    case DD_TYPE_LONG:
+    case DD_TYPE_LONGLONG:
+    case DD_TYPE_YEAR:
+      return col.hidden != DD_HIDDEN_SE;
+    default:
+      return false;
+  }
+}
+
+bool dict_col_is_float(const dict_col_t &col) {
+  return col.type == DD_TYPE_FLOAT || col.type == DD_TYPE_DOUBLE;
+}
+
+bool dict_col_is_string(const dict_col_t &col) {
+  switch (col.type) {
+    case DD_TYPE_VARCHAR:
+    case DD_TYPE_VAR_STRING:
+    case DD_TYPE_STRING:
+      return true;
+    default:
+      return dict_col_is_lob(col);
+  }
+}
+
+bool dict_col_is_lob(const dict_col_t &col) {
+  switch (col.type) {
+    case DD_TYPE_TINY_BLOB:
+    case DD_TYPE_MEDIUM_BLOB:
+    case DD_TYPE_LONG_BLOB:
+    case DD_TYPE_BLOB:
+    case DD_TYPE_GEOMETRY:
+    case DD_TYPE_JSON:
+      return true;
+    default:
+      return false;
+  }
+}
+
+const dict_index_t *dict_table_t::clustered_index() const {
+  for (const dict_index_t &index : indexes) {
+    if (index.is_clustered) {
+      return &index;
+    }
+  }
+  return nullptr;
+}
+
+/** @return a member of a json object, nullptr if v is not an object or
+has no such member */
+static const rapidjson::Value *dict_json_member(const rapidjson::Value &v,
+                                                const char *key) {
+  if (!v.IsObject()) {
+    return nullptr;
+  }
+  rapidjson::Value::ConstMemberIterator it = v.FindMember(key);
+  return it == v.MemberEnd() ? nullptr : &it->value;
+}
+
+/** The typed readers of a member: each returns false, and leaves the
+output alone, if the member is missing or of another type. Without them a
+malformed SDI would dereference null, as rapidjson only asserts. */
+static bool dict_json_get(const rapidjson::Value &v, const char *key,
+                          const char **out) {
+  const rapidjson::Value *m = dict_json_member(v, key);
+  if (m == nullptr || !m->IsString()) {
+    return false;
+  }
+  *out = m->GetString();
+  return true;
+}
+
+static bool dict_json_get(const rapidjson::Value &v, const char *key,
+                          std::string *out) {
+  const char *str;
+  if (!dict_json_get(v, key, &str)) {
+    return false;
+  }
+  out->assign(str);
+  return true;
+}
+
+static bool dict_json_get(const rapidjson::Value &v, const char *key,
+                          uint32_t *out) {
+  const rapidjson::Value *m = dict_json_member(v, key);
+  if (m == nullptr || !m->IsUint()) {
+    return false;
+  }
+  *out = m->GetUint();
+  return true;
+}
+
+static bool dict_json_get(const rapidjson::Value &v, const char *key,
+                          uint64_t *out) {
+  const rapidjson::Value *m = dict_json_member(v, key);
+  if (m == nullptr || !m->IsUint64()) {
+    return false;
+  }
+  *out = m->GetUint64();
+  return true;
+}
+
+static bool dict_json_get(const rapidjson::Value &v, const char *key,
+                          bool *out) {
+  const rapidjson::Value *m = dict_json_member(v, key);
+  if (m == nullptr || !m->IsBool()) {
+    return false;
+  }
+  *out = m->GetBool();
+  return true;
+}
+
+/** @return an array member, nullptr if it is missing or not an array */
+static const rapidjson::Value *dict_json_array(const rapidjson::Value &v,
+                                               const char *key) {
+  const rapidjson::Value *m = dict_json_member(v, key);
+  return m != nullptr && m->IsArray() ? m : nullptr;
+}
+
+int dict_load_from_sdi(const char *sdi_path, dict_table_t *table) {
+  std::ifstream file(sdi_path);
+  if (!file.is_open()) {
+    fprintf(stderr, "Failed to open json file %s\n", sdi_path);
+    return -1;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+
+  rapidjson::Document d;
+  d.Parse(contents.str().c_str());
+  if (d.HasParseError() || !d.IsArray()) {
+    fprintf(stderr, "Failed to parse json file %s\n", sdi_path);
+    return -1;
+  }
+
+  const rapidjson::Value *obj = nullptr;
+  for (rapidjson::SizeType i = 0; i < d.Size(); i++) {
+    const rapidjson::Value *object = dict_json_member(d[i], "object");
+    const char *type;
+    if (object != nullptr && dict_json_get(*object, "dd_object_type", &type) &&
+        strcmp(type, "Table") == 0) {
+      obj = dict_json_member(*object, "dd_object");
+      break;
+    }
+  }
+  if (obj == nullptr || !obj->IsObject()) {
+    fprintf(stderr, "No table object in json file %s\n", sdi_path);
+    return -1;
+  }
+
+  auto bad_member = [sdi_path](const char *what, const char *key) {
+    fprintf(stderr, "Missing or invalid %s member \"%s\" in json file %s\n",
+            what, key, sdi_path);
+    return -1;
+  };
+
+  if (!dict_json_get(*obj, "name", &table->name)) {
+    return bad_member("table", "name");
+  }
+  if (!dict_json_get(*obj, "se_private_id", &table->id)) {
+    return bad_member("table", "se_private_id");
+  }
+  table->cols.clear();
+  table->indexes.clear();
+
+  const rapidjson::Value *columns = dict_json_array(*obj, "columns");
+  if (columns == nullptr) {
+    return bad_member("table", "columns");
+  }
+  for (rapidjson::SizeType i = 0; i < columns->Size(); i++) {
+    const rapidjson::Value &c = (*columns)[i];
+    dict_col_t col;
+    struct {
+      const char *key;
+      uint32_t *value;
+    } uints[] = {{"type", &col.type},
+                 {"char_length", &col.char_length},
+                 {"collation_id", &col.collation_id},
+                 {"numeric_precision", &col.numeric_precision},
+                 {"numeric_scale", &col.numeric_scale},
+                 {"datetime_precision", &col.datetime_precision},
+                 {"hidden", &col.hidden}};
+    if (!dict_json_get(c, "name", &col.name)) {
+      return bad_member("column", "name");
+    }
+    if (!dict_json_get(c, "column_type_utf8", &col.column_type_utf8)) {
+      return bad_member("column", "column_type_utf8");
+    }
+    for (const auto &u : uints) {
+      if (!dict_json_get(c, u.key, u.value)) {
+        return bad_member("column", u.key);
+      }
+    }
+    if (!dict_json_get(c, "is_nullable", &col.is_nullable)) {
+      return bad_member("column", "is_nullable");
+    }
+    if (!dict_json_get(c, "is_unsigned", &col.is_unsigned)) {
+      return bad_member("column", "is_unsigned");
+    }
+    col.mbmaxlen = dict_collation_mbmaxlen(col.collation_id);
+    if (col.type == DD_TYPE_ENUM || col.type == DD_TYPE_SET) {
+      /* remember the number of elements, it decides the pack length */
+      const rapidjson::Value *elements = dict_json_array(c, "elements");
+      if (elements == nullptr) {
+        return bad_member("column", "elements");
+      }
+      col.char_length = elements->Size();
+    }
+    table->cols.push_back(col);
+  }
+
+  const rapidjson::Value *indexes = dict_json_array(*obj, "indexes");
+  if (indexes == nullptr) {
+    return bad_member("table", "indexes");
+  }
+  for (rapidjson::SizeType i = 0; i < indexes->Size(); i++) {
+    const rapidjson::Value &idx = (*indexes)[i];
+    const char *se_data;
+    uint32_t type;
+    dict_index_t index;
+    if (!dict_json_get(idx, "se_private_data", &se_data)) {
+      return bad_member("index", "se_private_data");
+    }
+    if (!dict_json_get(idx, "name", &index.name)) {
+      return bad_member("index", "name");
+    }
+    if (!dict_json_get(idx, "type", &type)) {
+      return bad_member("index", "type");
+    }
+    index.id = dict_se_private_get(se_data, "id");
+    index.root = dict_se_private_get(se_data, "root");
+    index.space = dict_se_private_get(se_data, "space_id");
+    /* dd::Index::IT_PRIMARY */
+    index.is_clustered = (type == 1);
+    index.n_nullable = 0;
+    index.n_uniq = 0;
+
+    const rapidjson::Value *elements = dict_json_array(idx, "elements");
+    if (elements == nullptr) {
+      return bad_member("index", "elements");
+    }
+    for (rapidjson::SizeType j = 0; j < elements->Size(); j++) {
+      const rapidjson::Value &e = (*elements)[j];
+      uint32_t col_no;
+      uint32_t prefix_len;
+      bool hidden;
+      if (!dict_json_get(e, "column_opx", &col_no)) {
+        return bad_member("index element", "column_opx");
+      }
+      if (!dict_json_get(e, "length", &prefix_len)) {
+        return bad_member("index element", "length");
+      }
+      if (!dict_json_get(e, "hidden", &hidden)) {
+        return bad_member("index element", "hidden");
+      }
+      if (col_no >= table->cols.size()) {
+        return bad_member("index element", "column_opx");
+      }
+      const dict_col_t &col = table->cols[col_no];
+      dict_field_t field;
+      field.col_no = col_no;
+      field.fixed_len = dict_col_fixed_len(col);
+      field.max_len = field.fixed_len != 0 ? field.fixed_len : col.char_length;
+      if (field.fixed_len == 0 && prefix_len < field.max_len && !hidden) {
+        field.max_len = prefix_len;
+      }
+      field.is_big = (field.max_len > 255 || dict_col_is_lob(col));
+      field.is_nullable = col.is_nullable;
+      if (field.is_nullable) {
+        index.n_nullable++;
+      }
+      if (!hidden) {
+        index.n_uniq++;
+      }
+      index.fields.push_back(field);
+    }
+    if (index.is_clustered == false) {
+      /* the primary key columns appended to a secondary index are part
+      of its unique prefix as well */
+      index.n_uniq = index.fields.size();
+    }
+    table->indexes.push_back(index);
+  }
+  return 0;
+}
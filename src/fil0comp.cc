@@ -0,0 +1,288 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "include/fil0comp.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/page0page.h"
+
+void fil_comp_read_meta(const byte *page, fil_comp_meta_t *meta) {
+  meta->version = mach_read_from_1(page + FIL_PAGE_VERSION);
+  meta->algorithm =
+      (fil_comp_algorithm_t)mach_read_from_1(page + FIL_PAGE_ALGORITHM_V1);
+  meta->original_type = mach_read_from_2(page + FIL_PAGE_ORIGINAL_TYPE_V1);
+  meta->original_size = mach_read_from_2(page + FIL_PAGE_ORIGINAL_SIZE_V1);
+  meta->compressed_size = mach_read_from_2(page + FIL_PAGE_COMPRESS_SIZE_V1);
+}
+
+bool fil_page_is_page_compressed(const byte *page) {
+  return fil_page_get_type(page) == FIL_PAGE_COMPRESSED;
+}
+
+/** Decodes an LZ4 block, the format LZ4_compress_default() writes. Each
+sequence is a token, literals and a match copied from the output already
+produced; the last sequence has literals only.
+@return true if the block decodes to exactly dst_len bytes */
+static bool fil_lz4_decode(const byte *src, ulint src_len, byte *dst,
+                           ulint dst_len) {
+  const byte *ip = src;
+  const byte *const iend = src + src_len;
+  byte *op = dst;
+  byte *const oend = dst + dst_len;
+
+  while (ip < iend) {
+    ulint token = *ip++;
+
+    ulint len = token >> 4;
+    if (len == 15) {
+      byte b;
+      do {
+        if (ip >= iend) {
+          return false;
+        }
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    if (len > (ulint)(iend - ip) || len > (ulint)(oend - op)) {
+      return false;
+    }
+    memcpy(op, ip, len);
+    ip += len;
+    op += len;
+    if (ip == iend) {
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return false;
+    }
+    ulint offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (ulint)(op - dst)) {
+      return false;
+    }
+
+    len = token & 15;
+    if (len == 15) {
+      byte b;
+      do {
+        if (ip >= iend) {
+          return false;
+        }
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    len += 4;
+    if (len > (ulint)(oend - op)) {
+      return false;
+    }
+    /* the match may overlap the bytes it produces */
+    const byte *match = op - offset;
+    for (ulint i = 0; i < len; i++) {
+      op[i] = match[i];
+    }
+    op += len;
+  }
+  return op == oend;
+}
+
+bool fil_page_decompress(const byte *src, ulint page_size, byte *dst) {
+  fil_comp_meta_t meta;
+  fil_comp_read_meta(src, &meta);
+  if ((meta.version != FIL_COMP_VERSION_1 &&
+       meta.version != FIL_COMP_VERSION_2) ||
+      meta.original_size != page_size - FIL_PAGE_DATA ||
+      meta.compressed_size > page_size - FIL_PAGE_DATA) {
+    return false;
+  }
+
+  byte payload[UNIV_PAGE_SIZE_MAX];
+  memcpy(payload, src + FIL_PAGE_DATA, meta.compressed_size);
+  if (dst != src) {
+    memcpy(dst, src, FIL_PAGE_DATA);
+  }
+
+  byte *out = dst + FIL_PAGE_DATA;
+  switch (meta.algorithm) {
+    case FIL_COMP_NONE:
+      if (meta.compressed_size != meta.original_size) {
+        return false;
+      }
+      memcpy(out, payload, meta.original_size);
+      break;
+    case FIL_COMP_ZLIB: {
+      uLongf len = meta.original_size;
+      if (uncompress(out, &len, payload, meta.compressed_size) != Z_OK ||
+          len != meta.original_size) {
+        return false;
+      }
+      break;
+    }
+    case FIL_COMP_LZ4:
+      if (!fil_lz4_decode(payload, meta.compressed_size, out,
+                          meta.original_size)) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+
+  /* the control information overlaid FIL_PAGE_FILE_FLUSH_LSN, which is
+  zero on every page but page 0 of the system tablespace */
+  mach_write_to_2(dst + FIL_PAGE_TYPE, meta.original_type);
+  memset(dst + FIL_PAGE_FILE_FLUSH_LSN, 0, 8);
+  return true;
+}
+
+uint64_t fil_seek_data(const fil_space_t &space, uint64_t offset) {
+  while (true) {
+    int file_fd;
+    uint64_t file_offset;
+    uint64_t left = fil_space_map(space, offset, &file_fd, &file_offset);
+    if (left == 0) {
+      return UINT64_MAX;
+    }
+    off_t ret = lseek(file_fd, (off_t)file_offset, SEEK_DATA);
+    if (ret == (off_t)-1 && errno != ENXIO) {
+      return offset;
+    }
+    /* ENXIO: nothing but a hole up to the end of the file, the space may
+    go on in the next one */
+    if (ret != (off_t)-1 && (uint64_t)ret - file_offset < left) {
+      return offset + (ret - file_offset);
+    }
+    if (left == UINT64_MAX) {
+      return UINT64_MAX;
+    }
+    offset += left;
+  }
+}
+
+uint64_t fil_seek_data(int fd, uint64_t offset) {
+  fil_space_t single(fd);
+  return fil_seek_data(fil_space_get(fd, &single), offset);
+}
+
+ulint fil_page_get_disk_size(int fd, page_no_t page_no, ulint page_size) {
+  uint64_t start = (uint64_t)page_no * page_size;
+  uint64_t end = start + page_size;
+  uint64_t cur = start;
+  ulint size = 0;
+  while (cur < end) {
+    uint64_t data = fil_seek_data(fd, cur);
+    if (data >= end) {
+      break;
+    }
+    int file_fd;
+    uint64_t file_offset;
+    fil_space_map(fd, data, &file_fd, &file_offset);
+    off_t hole = lseek(file_fd, (off_t)file_offset, SEEK_HOLE);
+    uint64_t data_end = hole == (off_t)-1 ? end : data + (hole - file_offset);
+    data_end = std::min(data_end, end);
+    if (data_end <= data) {
+      break;
+    }
+    size += data_end - data;
+    cur = data_end;
+  }
+  return size;
+}
+
+/** Pages of one index or of one page type, and the room they take. */
+struct fil_usage_t {
+  fil_usage_t() : n_pages(0), n_punched(0), logical(0), disk(0) {}
+
+  void add(const fil_usage_t &other) {
+    n_pages += other.n_pages;
+    n_punched += other.n_punched;
+    logical += other.logical;
+    disk += other.disk;
+  }
+
+  uint64_t n_pages;
+  /** pages with a hole punched in them */
+  uint64_t n_punched;
+  uint64_t logical;
+  uint64_t disk;
+};
+
+/** What one scanning thread counted. */
+struct fil_usage_thread_t {
+  std::map<uint64_t, fil_usage_t> indexes;
+  std::map<page_type_t, fil_usage_t> others;
+};
+
+static void fil_usage_print(const char *name, uint64_t id,
+                            const fil_usage_t &u) {
+  printf("%s %lu\t%lu\t\t%lu\t\t%lu\t\t%lu\t\t%.2lf%%\n", name, id,
+         u.n_pages, u.n_punched, u.logical, u.disk,
+         u.logical == 0 ? 0.0 : u.disk * 100.0 / u.logical);
+}
+
+void ShowDiskUsage(int fd, uint32_t n_threads) {
+  printf("==========================Disk Usage==========================\n");
+  n_threads = fil_scan_n_threads(n_threads);
+  const page_size_t page_size = fil_get_page_size(fd);
+  std::vector<fil_usage_thread_t> threads(n_threads);
+
+  fil_scan_parallel(
+      fd, 0, fil_get_n_pages(fd), n_threads,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        fil_usage_t u;
+        u.n_pages = 1;
+        u.logical = page_size.logical();
+        u.disk = fil_page_get_disk_size(fd, page_no, page_size.physical());
+        u.n_punched = u.disk < page_size.physical();
+        page_type_t type = fil_page_get_type(page);
+        if (fil_page_type_is_index(type)) {
+          threads[thread_no]
+              .indexes[mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID)]
+              .add(u);
+        } else {
+          threads[thread_no].others[type].add(u);
+        }
+      });
+
+  fil_usage_thread_t &merged = threads[0];
+  for (uint32_t i = 1; i < n_threads; i++) {
+    for (const auto &it : threads[i].indexes) {
+      merged.indexes[it.first].add(it.second);
+    }
+    for (const auto &it : threads[i].others) {
+      merged.others[it.first].add(it.second);
+    }
+  }
+
+  fil_usage_t total;
+  printf("owner\t\tpages\t\tpunched\t\tlogical\t\tdisk\t\tratio\n");
+  for (const auto &it : merged.indexes) {
+    fil_usage_print("index", it.first, it.second);
+    total.add(it.second);
+  }
+  for (const auto &it : merged.others) {
+    fil_usage_print("page type", it.first, it.second);
+    total.add(it.second);
+  }
+  printf("Total pages %lu, punched %lu, logical %lu, on disk %lu (%.2lf%%)\n",
+         total.n_pages, total.n_punched, total.logical, total.disk,
+         total.logical == 0 ? 0.0 : total.disk * 100.0 / total.logical);
+
+  /* blocks preallocated by fallocate() but never written read as holes
+  above, and are counted here */
+  struct stat stat_buf;
+  if (fil_space_stat(fd, &stat_buf) == 0) {
+    printf("File size %lu, allocated blocks %lu\n", (uint64_t)stat_buf.st_size,
+           (uint64_t)stat_buf.st_blocks * 512);
+  }
+}
@@ -0,0 +1,441 @@
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include <rapidjson/document.h>
+
+#include "include/fil0crypt.h"
+#include "include/fil0comp.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/ut0crc32.h"
+
+/** AES block size */
+#define ENCRYPTION_BLOCK_SIZE 16
+
+/** Size of the encryption information in page 0: magic, master key id,
+server uuid, encrypted key and IV, checksum */
+#define ENCRYPTION_INFO_SIZE                              \
+  (ENCRYPTION_MAGIC_SIZE + 4 + ENCRYPTION_SERVER_UUID_LEN + \
+   ENCRYPTION_KEY_LEN * 2 + 4)
+
+/** Master keys of inno_load_keyring(), for the files that are read
+without a fil_space_t holding their key */
+static fil_keyring_t process_keyring;
+
+/** Tablespace keys by device and inode of the file, nullptr for files
+that are not encrypted or whose key could not be unwrapped */
+static std::map<std::pair<dev_t, ino_t>, std::unique_ptr<fil_space_key_t>>
+    space_keys;
+/** protects process_keyring and space_keys */
+static std::mutex space_keys_mutex;
+
+/** Header of a keyring_file plugin file, followed by a 3 byte version */
+static const char keyring_file_header[] = "Keyring file version:";
+/** Tag between the keys and the SHA-256 digest of a keyring_file */
+static const char keyring_file_eof[] = "EOF";
+/** Size of the digest */
+#define KEYRING_FILE_DIGEST_SIZE 32
+/** The keyring_file plugin stores key data XORed with this string */
+static const char keyring_obfuscate_str[] = "*305=Ljt0*!@$Hnm(*-9-w;:";
+
+/** Parses the keys of a keyring_file plugin file. Each key is five
+size_t lengths, of the whole key padded to a size_t, of its id, type,
+user and data, then the four fields.
+@return false if a key runs out of the file */
+static bool fil_keyring_parse_plugin(const std::string &contents,
+                                     fil_keyring_t *keyring) {
+  size_t pos = strlen(keyring_file_header) + 3;
+  size_t end = contents.size();
+  size_t eof_len = strlen(keyring_file_eof);
+  if (end >= pos + eof_len + KEYRING_FILE_DIGEST_SIZE &&
+      contents.compare(end - KEYRING_FILE_DIGEST_SIZE - eof_len, eof_len,
+                       keyring_file_eof) == 0) {
+    end -= KEYRING_FILE_DIGEST_SIZE + eof_len;
+  } else if (end >= pos + eof_len &&
+             contents.compare(end - eof_len, eof_len, keyring_file_eof) ==
+                 0) {
+    end -= eof_len;
+  } else {
+    return false;
+  }
+
+  const size_t n_lengths = 5;
+  while (pos < end) {
+    uint64_t len[n_lengths];
+    if (end - pos < sizeof(len)) {
+      return false;
+    }
+    memcpy(len, contents.data() + pos, sizeof(len));
+    uint64_t pod_size = len[0];
+    uint64_t fields = len[1] + len[2] + len[3] + len[4];
+    if (pod_size < sizeof(len) + fields || pod_size > end - pos) {
+      return false;
+    }
+    size_t field = pos + sizeof(len);
+    std::string id = contents.substr(field, len[1]);
+    field += len[1] + len[2] + len[3];
+    std::string data = contents.substr(field, len[4]);
+    size_t n = strlen(keyring_obfuscate_str);
+    for (size_t i = 0; i < data.size(); i++) {
+      data[i] ^= keyring_obfuscate_str[i % n];
+    }
+    keyring->keys[id] = data;
+    pos += pod_size;
+  }
+  return true;
+}
+
+/** Parses the json of a component_keyring_file file, whose elements hold
+the key data in hex. */
+static bool fil_keyring_parse_component(const std::string &contents,
+                                        fil_keyring_t *keyring) {
+  rapidjson::Document d;
+  d.Parse(contents.c_str());
+  if (d.HasParseError() || !d.IsObject() || !d.HasMember("elements") ||
+      !d["elements"].IsArray()) {
+    return false;
+  }
+  const rapidjson::Value &elements = d["elements"];
+  for (rapidjson::SizeType i = 0; i < elements.Size(); i++) {
+    const rapidjson::Value &e = elements[i];
+    if (!e.IsObject() || !e.HasMember("data_id") || !e.HasMember("data") ||
+        !e["data_id"].IsString() || !e["data"].IsString()) {
+      continue;
+    }
+    const char *hex = e["data"].GetString();
+    size_t hex_len = e["data"].GetStringLength();
+    std::string data;
+    for (size_t j = 0; j + 1 < hex_len; j += 2) {
+      char byte_hex[3] = {hex[j], hex[j + 1], '\0'};
+      data.push_back((char)strtoul(byte_hex, nullptr, 16));
+    }
+    keyring->keys[e["data_id"].GetString()] = data;
+  }
+  return true;
+}
+
+bool fil_keyring_load(const char *path, fil_keyring_t *keyring) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    fprintf(stderr, "Failed to open keyring file %s\n", path);
+    return false;
+  }
+  std::stringstream contents;
+  contents << file.rdbuf();
+  const std::string &s = contents.str();
+
+  bool ok;
+  if (s.compare(0, strlen(keyring_file_header), keyring_file_header) == 0) {
+    ok = fil_keyring_parse_plugin(s, keyring);
+  } else {
+    ok = fil_keyring_parse_component(s, keyring);
+  }
+  if (!ok) {
+    fprintf(stderr, "Failed to parse keyring file %s\n", path);
+  }
+  return ok;
+}
+
+bool fil_crypt_load_keyring(const char *path) {
+  fil_keyring_t loaded;
+  bool ok = fil_keyring_load(path, &loaded);
+  std::lock_guard<std::mutex> guard(space_keys_mutex);
+  for (const auto &it : loaded.keys) {
+    process_keyring.keys[it.first] = it.second;
+  }
+  /* tablespaces whose master key was missing may be readable now */
+  for (auto it = space_keys.begin(); it != space_keys.end();) {
+    it = it->second ? std::next(it) : space_keys.erase(it);
+  }
+  return ok;
+}
+
+/** Finds the master key a tablespace key was encrypted with. Version 1
+of the encryption information does not record the server uuid: any
+InnoDB key of the same id is taken.
+@return the key, nullptr if the keyring does not have it */
+static const std::string *fil_crypt_find_master_key(
+    const fil_keyring_t &keyring, uint32_t master_key_id, const char *uuid) {
+  std::string suffix = "-" + std::to_string(master_key_id);
+  if (uuid != nullptr) {
+    auto it = keyring.keys.find(ENCRYPTION_MASTER_KEY_PREFIX "-" +
+                                std::string(uuid, ENCRYPTION_SERVER_UUID_LEN) +
+                                suffix);
+    return it == keyring.keys.end() ? nullptr : &it->second;
+  }
+  for (const auto &it : keyring.keys) {
+    const std::string &name = it.first;
+    if (name.compare(0, strlen(ENCRYPTION_MASTER_KEY_PREFIX "-"),
+                     ENCRYPTION_MASTER_KEY_PREFIX "-") == 0 &&
+        name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) ==
+            0) {
+      return &it.second;
+    }
+  }
+  return nullptr;
+}
+
+/** Unwraps the tablespace key from the encryption information of page 0:
+the key and IV are encrypted with AES-256-ECB under the master key and
+followed by the CRC-32C of their plain text.
+@return false if the information is not valid or the master key is
+missing */
+static bool fil_crypt_decode_info(const fil_keyring_t &keyring,
+                                  const byte *page, ulint offset,
+                                  fil_space_key_t *key) {
+  const byte *ptr = page + offset;
+  const char *uuid = nullptr;
+  if (memcmp(ptr, ENCRYPTION_KEY_MAGIC_V1, ENCRYPTION_MAGIC_SIZE) == 0) {
+    ptr += ENCRYPTION_MAGIC_SIZE;
+  } else if (memcmp(ptr, ENCRYPTION_KEY_MAGIC_V2, ENCRYPTION_MAGIC_SIZE) ==
+                 0 ||
+             memcmp(ptr, ENCRYPTION_KEY_MAGIC_V3, ENCRYPTION_MAGIC_SIZE) ==
+                 0) {
+    ptr += ENCRYPTION_MAGIC_SIZE;
+    uuid = (const char *)ptr + 4;
+  } else {
+    fprintf(stderr, "No encryption information in page 0\n");
+    return false;
+  }
+
+  uint32_t master_key_id = mach_read_from_4(ptr);
+  ptr += 4;
+  if (uuid != nullptr) {
+    ptr += ENCRYPTION_SERVER_UUID_LEN;
+  }
+  const std::string *master_key =
+      fil_crypt_find_master_key(keyring, master_key_id, uuid);
+  if (master_key == nullptr || master_key->size() != ENCRYPTION_KEY_LEN) {
+    fprintf(stderr, "Master key %u%s%.*s is not in the keyring\n",
+            master_key_id, uuid == nullptr ? "" : " of server ",
+            uuid == nullptr ? 0 : ENCRYPTION_SERVER_UUID_LEN,
+            uuid == nullptr ? "" : uuid);
+    return false;
+  }
+
+  byte key_info[ENCRYPTION_KEY_LEN * 2];
+  int len = 0;
+  int final_len = 0;
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  bool ok = ctx != nullptr &&
+            EVP_DecryptInit_ex(ctx, EVP_aes_256_ecb(), nullptr,
+                               (const byte *)master_key->data(),
+                               nullptr) == 1 &&
+            EVP_CIPHER_CTX_set_padding(ctx, 0) == 1 &&
+            EVP_DecryptUpdate(ctx, key_info, &len, ptr, sizeof(key_info)) ==
+                1 &&
+            EVP_DecryptFinal_ex(ctx, key_info + len, &final_len) == 1;
+  EVP_CIPHER_CTX_free(ctx);
+  ptr += sizeof(key_info);
+  if (!ok || mach_read_from_4(ptr) != ut_crc32(key_info, sizeof(key_info))) {
+    fprintf(stderr, "Tablespace key does not match master key %u\n",
+            master_key_id);
+    return false;
+  }
+  memcpy(key->key, key_info, ENCRYPTION_KEY_LEN);
+  memcpy(key->iv, key_info + ENCRYPTION_KEY_LEN, ENCRYPTION_KEY_LEN);
+  return true;
+}
+
+std::unique_ptr<fil_space_key_t> fil_space_read_key(
+    int fd, const fil_keyring_t *keyring) {
+  std::unique_ptr<fil_space_key_t> key;
+  page_size_t page_size = fil_get_page_size(fd);
+  ulint physical = page_size.physical();
+  ulint logical = page_size.logical();
+  std::unique_ptr<byte[]> page(new byte[physical]);
+  if (pread(fd, page.get(), physical, 0) != (ssize_t)physical ||
+      !FSP_FLAGS_GET_ENCRYPTION(mach_read_from_4(
+          page.get() + FSP_HEADER_OFFSET + FSP_SPACE_FLAGS))) {
+    return key;
+  }
+  /* as fsp_header_get_encryption_offset(): after the descriptors of the
+  extents of page 0 */
+  ulint offset = XDES_ARR_OFFSET + XDES_SIZE_OF(logical) *
+                                       (physical / FSP_EXTENT_SIZE_OF(logical));
+  if (offset + ENCRYPTION_INFO_SIZE > physical - FIL_PAGE_DATA_END) {
+    return key;
+  }
+  key.reset(new fil_space_key_t());
+  /* without any master key there is nothing to report: reading an
+  encrypted page asks for the keyring */
+  bool ok;
+  if (keyring != nullptr) {
+    ok = !keyring->keys.empty() &&
+         fil_crypt_decode_info(*keyring, page.get(), offset, key.get());
+  } else {
+    std::lock_guard<std::mutex> guard(space_keys_mutex);
+    ok = !process_keyring.keys.empty() &&
+         fil_crypt_decode_info(process_keyring, page.get(), offset,
+                               key.get());
+  }
+  if (!ok) {
+    key.reset();
+  }
+  return key;
+}
+
+const fil_space_key_t *fil_space_get_key(int fd) {
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    return nullptr;
+  }
+  std::pair<dev_t, ino_t> file(stat_buf.st_dev, stat_buf.st_ino);
+  std::lock_guard<std::mutex> guard(space_keys_mutex);
+  auto it = space_keys.find(file);
+  if (it == space_keys.end()) {
+    it = space_keys.emplace(file, fil_space_read_key(fd, &process_keyring)).first;
+  }
+  return it->second.get();
+}
+
+bool fil_page_is_encrypted(const byte *page) {
+  page_type_t type = fil_page_get_type(page);
+  return type == FIL_PAGE_ENCRYPTED ||
+         type == FIL_PAGE_COMPRESSED_AND_ENCRYPTED ||
+         type == FIL_PAGE_ENCRYPTED_RTREE;
+}
+
+Fil_page_decryptor::Fil_page_decryptor(const fil_space_key_t &key)
+    : m_cbc(EVP_CIPHER_CTX_new()), m_ecb(EVP_CIPHER_CTX_new()) {
+  memcpy(m_iv, key.iv, sizeof(m_iv));
+  if (m_cbc != nullptr) {
+    EVP_DecryptInit_ex(m_cbc, EVP_aes_256_cbc(), nullptr, key.key, m_iv);
+    EVP_CIPHER_CTX_set_padding(m_cbc, 0);
+  }
+  if (m_ecb != nullptr) {
+    EVP_DecryptInit_ex(m_ecb, EVP_aes_256_ecb(), nullptr, key.key, nullptr);
+    EVP_CIPHER_CTX_set_padding(m_ecb, 0);
+  }
+}
+
+Fil_page_decryptor::~Fil_page_decryptor() {
+  EVP_CIPHER_CTX_free(m_cbc);
+  EVP_CIPHER_CTX_free(m_ecb);
+}
+
+bool Fil_page_decryptor::decrypt(byte *page, ulint page_size,
+                                 ulint block_size) {
+  if (m_cbc == nullptr || m_ecb == nullptr) {
+    return false;
+  }
+  page_type_t type = fil_page_get_type(page);
+  ulint len = page_size;
+  if (type == FIL_PAGE_COMPRESSED_AND_ENCRYPTED) {
+    /* compressed pages are encrypted in the length they are written
+    in, aligned to the block size */
+    len = mach_read_from_2(page + FIL_PAGE_COMPRESS_SIZE_V1) + FIL_PAGE_DATA;
+    len = (len + block_size - 1) / block_size * block_size;
+    if (len > page_size) {
+      return false;
+    }
+  } else if (type != FIL_PAGE_ENCRYPTED && type != FIL_PAGE_ENCRYPTED_RTREE) {
+    return false;
+  }
+
+  byte *data = page + FIL_PAGE_DATA;
+  int data_len = len - FIL_PAGE_DATA;
+  int main_len = data_len / ENCRYPTION_BLOCK_SIZE * ENCRYPTION_BLOCK_SIZE;
+  int out_len = 0;
+  if (main_len < 2 * ENCRYPTION_BLOCK_SIZE) {
+    return false;
+  }
+  /* the tail that is not a whole block was encrypted last, with the
+  block before it, in ECB */
+  if (data_len != main_len) {
+    byte *tail = data + data_len - 2 * ENCRYPTION_BLOCK_SIZE;
+    if (EVP_DecryptInit_ex(m_ecb, nullptr, nullptr, nullptr, nullptr) != 1 ||
+        EVP_DecryptUpdate(m_ecb, tail, &out_len, tail,
+                          2 * ENCRYPTION_BLOCK_SIZE) != 1) {
+      return false;
+    }
+  }
+  if (EVP_DecryptInit_ex(m_cbc, nullptr, nullptr, nullptr, m_iv) != 1 ||
+      EVP_DecryptUpdate(m_cbc, data, &out_len, data, main_len) != 1) {
+    return false;
+  }
+
+  if (type == FIL_PAGE_COMPRESSED_AND_ENCRYPTED) {
+    mach_write_to_2(page + FIL_PAGE_TYPE, FIL_PAGE_COMPRESSED);
+  } else if (type == FIL_PAGE_ENCRYPTED_RTREE) {
+    /* the original type would overwrite the split sequence number */
+    mach_write_to_2(page + FIL_PAGE_TYPE, FIL_PAGE_RTREE);
+  } else {
+    mach_write_to_2(page + FIL_PAGE_TYPE,
+                    mach_read_from_2(page + FIL_PAGE_ORIGINAL_TYPE_V1));
+    mach_write_to_2(page + FIL_PAGE_ORIGINAL_TYPE_V1, 0);
+  }
+  return true;
+}
+
+ulint fil_get_block_size(int fd) {
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1 || stat_buf.st_blksize <= 0) {
+    return 512;
+  }
+  return stat_buf.st_blksize;
+}
+
+/** fil_page_restore() with a key and block size.
+@param[in]  fd          first file of the space, for its block size
+@param[in]  block_size  block size, 0 if not known */
+static bool fil_page_restore_low(const fil_space_key_t *key,
+                                 ulint block_size, int fd, byte *page,
+                                 ulint page_size) {
+  if (fil_page_is_encrypted(page)) {
+    /* single pages are read by one thread at a time, whose context is
+    kept for the next page of a space with the same key */
+    thread_local std::unique_ptr<Fil_page_decryptor> decryptor;
+    thread_local fil_space_key_t decryptor_key;
+    if (key == nullptr) {
+      return false;
+    }
+    if (!decryptor || memcmp(&decryptor_key, key, sizeof(*key)) != 0) {
+      decryptor.reset(new Fil_page_decryptor(*key));
+      decryptor_key = *key;
+    }
+    if (block_size == 0) {
+      block_size = fil_get_block_size(fd);
+    }
+    if (!decryptor->decrypt(page, page_size, block_size)) {
+      return false;
+    }
+  }
+  if (fil_page_is_page_compressed(page)) {
+    return fil_page_decompress(page, page_size, page);
+  }
+  return true;
+}
+
+bool fil_page_restore(const fil_space_t &space, byte *page,
+                      ulint page_size) {
+  return fil_page_restore_low(space.key, space.block_size, space.fd, page,
+                              page_size);
+}
+
+bool fil_page_restore(int fd, byte *page, ulint page_size) {
+  fil_space_t single(fd);
+  const fil_space_t &space = fil_space_get(fd, &single);
+  const fil_space_key_t *key = space.key;
+  /* a space that was not given its key is decrypted with the keys of
+  inno_load_keyring() */
+  if (key == nullptr && fil_page_is_encrypted(page)) {
+    key = fil_space_get_key(fd);
+  }
+  return fil_page_restore_low(key, space.block_size, fd, page, page_size);
+}
@@ -0,0 +1,403 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/fil0datadir.h"
+#include "include/fil0crypt.h"
+#include "include/fil0fil.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page_crc32.h"
+#include "include/srv0mon.h"
+
+/** Page types are counted in slots: FIL_PAGE_TYPE values up to
+FIL_PAGE_TYPE_LAST in their own slot, then the index types, then one
+slot for any other value. */
+#define FIL_DATADIR_SLOT_INDEX (FIL_PAGE_TYPE_LAST + 1)
+#define FIL_DATADIR_SLOT_RTREE (FIL_PAGE_TYPE_LAST + 2)
+#define FIL_DATADIR_SLOT_SDI (FIL_PAGE_TYPE_LAST + 3)
+#define FIL_DATADIR_SLOT_OTHER (FIL_PAGE_TYPE_LAST + 4)
+#define FIL_DATADIR_N_SLOTS (FIL_PAGE_TYPE_LAST + 5)
+
+/** A tablespace of the data directory */
+struct fil_datadir_file_t {
+  fil_datadir_file_t()
+      : size(0), n_tasks(0), fd(-1), opened(false), page_size(0), n_tasks_done(0), n_pages(0), n_corrupt(0),
+        n_free(0) {}
+
+  /** path relative to the data directory */
+  std::string name;
+  /** files of the space, more than one for the system tablespace */
+  std::vector<std::string> files;
+  /** bytes of the space, of its files until it is opened */
+  uint64_t size;
+  uint32_t n_tasks;
+
+  /** protects the opening of the file */
+  std::mutex mutex;
+  int fd;
+  bool opened;
+  std::unique_ptr<fil_scan_space_t> space;
+  /** physical page size, kept once the file is closed */
+  ulint page_size;
+
+  std::atomic<uint32_t> n_tasks_done;
+  std::atomic<uint64_t> n_pages;
+  /** pages failing their checksum */
+  std::atomic<uint64_t> n_corrupt;
+  /** free pages below the free limit and pages above it */
+  page_no_t n_free;
+};
+
+/** Bytes [start, end) of a tablespace */
+struct fil_datadir_task_t {
+  uint32_t file_no;
+  uint64_t start;
+  uint64_t end;
+};
+
+/** @return the slot a page type is counted in */
+static uint32_t fil_datadir_type_slot(page_type_t type) {
+  if (type <= FIL_PAGE_TYPE_LAST) {
+    return type;
+  } else if (type == FIL_PAGE_INDEX) {
+    return FIL_DATADIR_SLOT_INDEX;
+  } else if (type == FIL_PAGE_RTREE) {
+    return FIL_DATADIR_SLOT_RTREE;
+  } else if (type == FIL_PAGE_SDI) {
+    return FIL_DATADIR_SLOT_SDI;
+  }
+  return FIL_DATADIR_SLOT_OTHER;
+}
+
+/** @return the description of the page types counted in a slot */
+static const char *fil_datadir_slot_str(uint32_t slot) {
+  if (slot <= FIL_PAGE_TYPE_LAST) {
+    return fil_get_page_type_str(slot);
+  } else if (slot == FIL_DATADIR_SLOT_INDEX) {
+    return fil_get_page_type_str(FIL_PAGE_INDEX);
+  } else if (slot == FIL_DATADIR_SLOT_RTREE) {
+    return fil_get_page_type_str(FIL_PAGE_RTREE);
+  } else if (slot == FIL_DATADIR_SLOT_SDI) {
+    return fil_get_page_type_str(FIL_PAGE_SDI);
+  }
+  return "ERROR";
+}
+
+/** Counts the pages of a tablespace that OPTIMIZE TABLE would give back:
+the pages marked free in the extent descriptors below the free limit,
+which include the pages a segment reserved and never used, and all the
+pages above it.
+@param[in]  space  tablespace
+@param[in]  page   frame of UNIV_PAGE_SIZE_MAX bytes to read pages into
+@return number of free pages */
+static page_no_t fil_datadir_free_pages(const fil_scan_space_t &space,
+                                        byte *page) {
+  const ulint physical = space.page_size.physical();
+  const ulint logical = space.page_size.logical();
+  const page_no_t extent_size = FSP_EXTENT_SIZE_OF(logical);
+
+  if (fil_pread(space.files, page, physical, 0) != (ssize_t)physical) {
+    return 0;
+  }
+  page_no_t free_limit =
+      mach_read_from_4(page + FSP_HEADER_OFFSET + FSP_FREE_LIMIT);
+  free_limit = std::min(free_limit, space.n_pages);
+  page_no_t n_free = space.n_pages - free_limit;
+
+  /* an extent descriptor page describes the physical pages after it */
+  for (uint64_t xdes_page_no = 0; xdes_page_no < free_limit;
+       xdes_page_no += physical) {
+    if (xdes_page_no != 0 &&
+        (fil_pread(space.files, page, physical, xdes_page_no * physical) !=
+             (ssize_t)physical ||
+         !fil_page_restore(space.files, page, physical))) {
+      break;
+    }
+    for (ulint i = 0; i < physical / extent_size; i++) {
+      uint64_t first = xdes_page_no + i * extent_size;
+      if (first >= free_limit) {
+        break;
+      }
+      const xdes_t *descr = page + XDES_ARR_OFFSET + i * XDES_SIZE_OF(logical);
+      if (mach_read_from_4(descr + XDES_STATE) == XDES_NOT_INITED) {
+        continue;
+      }
+      for (page_no_t j = 0; j < extent_size && first + j < free_limit; j++) {
+        ulint bit = j * XDES_BITS_PER_PAGE + XDES_FREE_BIT;
+        if ((descr[XDES_BITMAP + bit / 8] >> (bit % 8)) & 1) {
+          n_free++;
+        }
+      }
+    }
+  }
+  return n_free;
+}
+
+/** Opens a tablespace when the first task of it is claimed, and counts
+its free pages.
+@param[in,out]  file  tablespace
+@param[in]      page  frame of UNIV_PAGE_SIZE_MAX bytes
+@return false if it can not be opened */
+static bool fil_datadir_open(fil_datadir_file_t *file, byte *page) {
+  std::lock_guard<std::mutex> guard(file->mutex);
+  if (!file->opened) {
+    file->opened = true;
+    file->fd = fil_space_open(file->files, O_RDONLY);
+    if (file->fd != -1) {
+      file->space.reset(new fil_scan_space_t(file->fd, true));
+      /* the header of a ROW_FORMAT=COMPRESSED page is enough here */
+      file->space->inflate = false;
+      file->page_size = file->space->page_size.physical();
+      file->n_free = fil_datadir_free_pages(*file->space, page);
+      /* the last file of a multi-file space may be longer than it */
+      struct stat stat_buf;
+      if (fil_space_stat(file->fd, &stat_buf) == 0) {
+        file->size = stat_buf.st_size;
+      }
+    }
+  }
+  return file->fd != -1;
+}
+
+/** Finds the tablespaces of a data directory: the system tablespace
+with all its files, undo tablespaces and the .ibd files of the data
+directory and of its schema directories. */
+static void fil_datadir_find(
+    const char *datadir,
+    std::vector<std::unique_ptr<fil_datadir_file_t>> *files) {
+  /* names of the files of the system tablespace are compared, the
+  directory must be spelt as fil_space_find_files() does */
+  std::string dir(datadir);
+  while (dir.size() > 1 && dir.back() == '/') {
+    dir.pop_back();
+  }
+  std::vector<std::string> paths;
+  fil_expand_paths(dir.c_str(), {"ibdata*", "undo_[0-9]*", "*.ibu", "*.ibd",
+                             "*/*.ibd", "*/*.ibu"},
+                   &paths);
+
+  std::set<std::string> in_system;
+  for (const std::string &path : paths) {
+    if (in_system.count(path) > 0) {
+      continue;
+    }
+    std::unique_ptr<fil_datadir_file_t> file(new fil_datadir_file_t());
+    file->name = path.compare(0, dir.size(), dir) == 0
+                     ? path.substr(path.find_first_not_of('/', dir.size()))
+                     : path;
+    fil_space_find_files(path.c_str(), &file->files);
+    if (file->files.size() > 1) {
+      in_system.insert(file->files.begin(), file->files.end());
+    }
+    for (const std::string &name : file->files) {
+      struct stat stat_buf;
+      if (stat(name.c_str(), &stat_buf) == 0) {
+        file->size += stat_buf.st_size;
+      }
+    }
+    files->push_back(std::move(file));
+  }
+}
+
+void ShowDatadir(const char *datadir, uint32_t n_threads) {
+  printf("==========================Datadir==========================\n");
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<std::unique_ptr<fil_datadir_file_t>> files;
+  fil_datadir_find(datadir, &files);
+  if (files.empty()) {
+    fprintf(stderr, "No tablespace in %s\n", datadir);
+    return;
+  }
+
+  /* largest files first, so that the threads end together */
+  std::sort(files.begin(), files.end(),
+            [](const std::unique_ptr<fil_datadir_file_t> &a,
+               const std::unique_ptr<fil_datadir_file_t> &b) {
+              return a->size > b->size;
+            });
+  /* page sizes differ between files, the progress line counts bytes */
+  uint64_t scan_bytes = 0;
+  for (const std::unique_ptr<fil_datadir_file_t> &file : files) {
+    scan_bytes += file->size;
+  }
+  monitor_progress_set_total(scan_bytes, 0);
+
+  std::vector<fil_datadir_task_t> tasks;
+  for (uint32_t i = 0; i < files.size(); i++) {
+    uint64_t start = 0;
+    do {
+      uint64_t end = std::min<uint64_t>(start + FIL_DATADIR_TASK_BYTES, files[i]->size);
+      tasks.push_back({i, start, end});
+      files[i]->n_tasks++;
+      start = end;
+    } while (start < files[i]->size);
+  }
+
+  n_threads = fil_scan_n_threads(n_threads);
+  std::atomic<uint64_t> next_task(0);
+  std::atomic<uint64_t> n_zip_pages(0);
+  std::atomic<uint64_t> n_corrupt(0);
+  std::atomic<uint64_t> n_undecrypted(0);
+  std::vector<std::vector<uint64_t>> type_counts(
+      n_threads, std::vector<uint64_t>(FIL_DATADIR_N_SLOTS, 0));
+
+  auto worker = [&](uint32_t thread_no) {
+    Fil_scan_reader reader;
+    byte *page = nullptr;
+    if (!reader.is_ready() ||
+        posix_memalign((void **)&page, UNIV_PAGE_SIZE_MAX,
+                       UNIV_PAGE_SIZE_MAX) != 0) {
+      return;
+    }
+    std::vector<uint64_t> &counts = type_counts[thread_no];
+    uint64_t zip_pages = 0;
+    while (true) {
+      uint64_t task_no = next_task.fetch_add(1);
+      if (task_no >= tasks.size()) {
+        break;
+      }
+      const fil_datadir_task_t &task = tasks[task_no];
+      fil_datadir_file_t *file = files[task.file_no].get();
+      if (fil_datadir_open(file, page)) {
+        const fil_scan_space_t &space = *file->space;
+        const ulint physical = space.page_size.physical();
+        const ulint logical = space.page_size.logical();
+        /* the checksum of a ROW_FORMAT=COMPRESSED page is over its
+        compressed image, with an algorithm not checked here */
+        const bool check = !space.page_size.is_compressed();
+        uint64_t first = task.start / physical;
+        uint64_t last = std::min<uint64_t>(task.end / physical, space.n_pages);
+        uint64_t corrupt = 0;
+        uint64_t visited = 0;
+        auto func = [&](uint32_t, page_no_t, const byte *frame) {
+          counts[fil_datadir_type_slot(fil_page_get_type(frame))]++;
+          if (check && buf_page_is_corrupted(frame, logical)) {
+            corrupt++;
+          }
+        };
+        for (uint64_t batch = first; batch < last;
+             batch += FIL_SCAN_BATCH_PAGES) {
+          visited += reader.read_batch(
+              space, batch,
+              std::min<uint64_t>(last - batch, FIL_SCAN_BATCH_PAGES),
+              thread_no, func);
+        }
+        file->n_pages += visited;
+        file->n_corrupt += corrupt;
+        if (!check) {
+          zip_pages += visited;
+        }
+      }
+      /* the last thread out of a file closes it */
+      if (file->n_tasks_done.fetch_add(1) + 1 == file->n_tasks &&
+          file->fd != -1) {
+        file->space.reset();
+        fil_space_close(file->fd);
+      }
+    }
+    free(page);
+    n_zip_pages += zip_pages;
+    n_corrupt += reader.n_corrupt;
+    n_undecrypted += reader.n_undecrypted;
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time)
+                       .count();
+
+  uint64_t total_pages = 0;
+  uint64_t total_size = 0;
+  uint64_t total_corrupt = 0;
+  uint64_t total_free = 0;
+  uint64_t n_corrupt_files = 0;
+  uint64_t n_failed = 0;
+  for (const std::unique_ptr<fil_datadir_file_t> &file : files) {
+    if (file->fd == -1) {
+      n_failed++;
+      continue;
+    }
+    total_pages += file->n_pages;
+    total_size += file->size;
+    total_corrupt += file->n_corrupt;
+    total_free += (uint64_t)file->n_free * file->page_size;
+    n_corrupt_files += file->n_corrupt > 0;
+  }
+  printf("Tablespaces %lu, not readable %lu, pages %lu, size %lu, "
+         "%u threads, %.2lf s\n",
+         files.size(), n_failed, total_pages, total_size, n_threads, seconds);
+
+  printf("\ncount\t\ttype\n");
+  for (uint32_t slot = 0; slot < FIL_DATADIR_N_SLOTS; slot++) {
+    uint64_t count = 0;
+    for (const std::vector<uint64_t> &counts : type_counts) {
+      count += counts[slot];
+    }
+    if (count > 0) {
+      printf("%lu\t\t%s\n", count, fil_datadir_slot_str(slot));
+    }
+  }
+
+  printf("\nChecksum failures %lu in %lu files\n", total_corrupt,
+         n_corrupt_files);
+  if (n_zip_pages > 0) {
+    printf("%lu pages of ROW_FORMAT=COMPRESSED tablespaces not checked\n",
+           n_zip_pages.load());
+  }
+  if (n_corrupt_files > 0) {
+    printf("pages\t\tcorrupt\t\tfile\n");
+    for (const std::unique_ptr<fil_datadir_file_t> &file : files) {
+      if (file->n_corrupt > 0) {
+        printf("%lu\t\t%lu\t\t%s\n", file->n_pages.load(),
+               file->n_corrupt.load(), file->name.c_str());
+      }
+    }
+  }
+
+  std::vector<const fil_datadir_file_t *> reclaimable;
+  for (const std::unique_ptr<fil_datadir_file_t> &file : files) {
+    if (file->fd != -1 && file->n_free > 0) {
+      reclaimable.push_back(file.get());
+    }
+  }
+  std::sort(reclaimable.begin(), reclaimable.end(),
+            [](const fil_datadir_file_t *a, const fil_datadir_file_t *b) {
+              return (uint64_t)a->n_free * a->page_size >
+                     (uint64_t)b->n_free * b->page_size;
+            });
+  printf("\nReclaimable space %lu, percentage %.2lf%%\n", total_free,
+         total_size == 0 ? 0.0 : (double)total_free * 100.0 / total_size);
+  if (!reclaimable.empty()) {
+    printf("size\t\tfree pages\treclaimable\tpercentage\tfile\n");
+    for (const fil_datadir_file_t *file : reclaimable) {
+      uint64_t bytes = (uint64_t)file->n_free * file->page_size;
+      printf("%lu\t%u\t\t%lu\t%.2lf%%\t\t%s\n", file->size, file->n_free,
+             bytes, (double)bytes * 100.0 / file->size, file->name.c_str());
+    }
+  }
+
+  fil_scan_report_errors(n_corrupt, n_undecrypted, false);
+}
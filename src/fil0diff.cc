@@ -0,0 +1,214 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "include/fil0diff.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/ut0pool.h"
+
+/** Pages of an extent, the unit incremental copies usually ship */
+#define FIL_DIFF_EXTENT_PAGES 64
+
+/** An inclusive range of page numbers */
+typedef std::pair<page_no_t, page_no_t> fil_range_t;
+
+/** Appends a page to the ranges of one thread, which sees its pages in
+ascending order. */
+static void fil_range_add(std::vector<fil_range_t> *ranges,
+                          page_no_t page_no) {
+  if (!ranges->empty() && ranges->back().second + 1 == page_no) {
+    ranges->back().second = page_no;
+  } else {
+    ranges->push_back(fil_range_t(page_no, page_no));
+  }
+}
+
+/** Merges the ranges gathered by all threads into sorted ranges with
+adjacent ones joined. */
+static std::vector<fil_range_t> fil_range_merge(
+    const std::vector<std::vector<fil_range_t>> &per_thread) {
+  std::vector<fil_range_t> all;
+  for (const auto &ranges : per_thread) {
+    all.insert(all.end(), ranges.begin(), ranges.end());
+  }
+  std::sort(all.begin(), all.end());
+  std::vector<fil_range_t> merged;
+  for (const fil_range_t &r : all) {
+    if (!merged.empty() && merged.back().second + 1 >= r.first) {
+      merged.back().second = std::max(merged.back().second, r.second);
+    } else {
+      merged.push_back(r);
+    }
+  }
+  return merged;
+}
+
+/** Prints changed ranges, one per line for copy tools, and their totals.
+@param[in]  ranges     sorted, joined ranges
+@param[in]  n_pages    pages in the file
+@param[in]  page_size  physical page size */
+static void fil_range_show(const std::vector<fil_range_t> &ranges,
+                           page_no_t n_pages, ulint page_size) {
+  uint64_t n_changed = 0;
+  uint64_t n_extents = 0;
+  uint64_t last_extent = ~0ULL;
+  for (const fil_range_t &r : ranges) {
+    uint64_t n = (uint64_t)r.second - r.first + 1;
+    printf("range pages %u-%u offset %lu length %lu\n", r.first, r.second,
+           (uint64_t)r.first * page_size, n * page_size);
+    n_changed += n;
+    uint64_t first_extent = r.first / FIL_DIFF_EXTENT_PAGES;
+    uint64_t end_extent = r.second / FIL_DIFF_EXTENT_PAGES;
+    n_extents += end_extent - first_extent + 1;
+    if (first_extent == last_extent) {
+      n_extents--;
+    }
+    last_extent = end_extent;
+  }
+  printf("Changed pages: %lu of %u (%.2lf%%), ranges %lu, extents %lu, "
+         "bytes to copy %lu (%.2lf MiB)\n",
+         n_changed, n_pages, n_pages == 0 ? 0.0 : n_changed * 100.0 / n_pages,
+         ranges.size(), n_extents, n_changed * page_size,
+         (double)n_changed * page_size / (1024 * 1024));
+}
+
+void ShowChangedPages(int fd, lsn_t since_lsn, uint32_t n_threads) {
+  printf("==========================Changed Pages==========================\n");
+  n_threads = fil_scan_n_threads(n_threads);
+  ulint page_size = fil_get_page_size(fd).physical();
+  page_no_t n_pages = fil_get_n_pages(fd);
+  std::vector<std::vector<fil_range_t>> per_thread(n_threads);
+  /* only FIL_PAGE_LSN is read, compressed pages need not be inflated */
+  fil_scan_parallel(fd, 0, n_pages, n_threads,
+                    [&](uint32_t thread_no, page_no_t page_no,
+                        const byte *page) {
+                      if (mach_read_from_8(page + FIL_PAGE_LSN) > since_lsn) {
+                        fil_range_add(&per_thread[thread_no], page_no);
+                      }
+                    },
+                    false);
+  printf("Pages with FIL_PAGE_LSN > %lu, threads %u:\n", since_lsn, n_threads);
+  fil_range_show(fil_range_merge(per_thread), n_pages, page_size);
+}
+
+/** @return whether the LSN or checksum fields of two pages differ */
+static bool fil_diff_header_differs(const byte *a, const byte *b,
+                                    ulint page_size) {
+  return memcmp(a + FIL_PAGE_SPACE_OR_CHKSUM, b + FIL_PAGE_SPACE_OR_CHKSUM,
+                4) != 0 ||
+         memcmp(a + FIL_PAGE_LSN, b + FIL_PAGE_LSN, 8) != 0 ||
+         memcmp(a + page_size - FIL_PAGE_END_LSN_OLD_CHKSUM,
+                b + page_size - FIL_PAGE_END_LSN_OLD_CHKSUM, 8) != 0;
+}
+
+/** What one comparing thread found. */
+struct fil_diff_thread_t {
+  fil_diff_thread_t() : buf(nullptr), n_header_diff(0) {}
+
+  /** FIL_DIFF_EXTENT_PAGES pages of each file */
+  byte *buf;
+  std::vector<fil_range_t> ranges;
+  uint64_t n_header_diff;
+  /** pages with equal LSN and checksum but different bytes */
+  std::vector<page_no_t> silent;
+};
+
+void ShowFileDiff(int fd, const char *other_path, uint32_t n_threads) {
+  printf("==========================Diff==========================\n");
+  int other_fd = open(other_path, O_RDONLY);
+  if (other_fd == -1) {
+    fprintf(stderr, "Open %s failed: %s\n", other_path, strerror(errno));
+    return;
+  }
+  n_threads = fil_scan_n_threads(n_threads);
+  ulint page_size = fil_get_page_size(fd).physical();
+  if (!fil_get_page_size(other_fd).equals_to(fil_get_page_size(fd))) {
+    fprintf(stderr, "%s has a different page size\n", other_path);
+    close(other_fd);
+    return;
+  }
+  page_no_t n_pages = fil_get_n_pages(fd);
+  page_no_t n_other_pages = fil_get_n_pages(other_fd);
+  page_no_t n_common = std::min(n_pages, n_other_pages);
+
+  const size_t batch_size = (size_t)page_size * FIL_DIFF_EXTENT_PAGES;
+  std::vector<fil_diff_thread_t> threads(n_threads);
+  for (fil_diff_thread_t &t : threads) {
+    if (posix_memalign((void **)&t.buf, UNIV_PAGE_SIZE_MAX, 2 * batch_size) != 0) {
+      fprintf(stderr, "ShowFileDiff out of memory\n");
+      for (fil_diff_thread_t &u : threads) {
+        free(u.buf);
+      }
+      close(other_fd);
+      return;
+    }
+  }
+
+  size_t n_batches =
+      (n_common + FIL_DIFF_EXTENT_PAGES - 1) / FIL_DIFF_EXTENT_PAGES;
+  ut_parallel_for(n_batches, n_threads, [&](uint32_t thread_no,
+                                            size_t batch_no) {
+    fil_diff_thread_t &t = threads[thread_no];
+    page_no_t first = batch_no * FIL_DIFF_EXTENT_PAGES;
+    page_no_t n = std::min<page_no_t>(FIL_DIFF_EXTENT_PAGES, n_common - first);
+    off_t offset = (off_t)first * page_size;
+    size_t len = (size_t)n * page_size;
+    if (fil_pread(fd, t.buf, len, offset) != (ssize_t)len ||
+        fil_pread(other_fd, t.buf + batch_size, len, offset) !=
+            (ssize_t)len) {
+      /* unreadable pages have to be shipped */
+      for (page_no_t i = 0; i < n; i++) {
+        fil_range_add(&t.ranges, first + i);
+      }
+      return;
+    }
+    for (page_no_t i = 0; i < n; i++) {
+      const byte *a = t.buf + (size_t)i * page_size;
+      const byte *b = t.buf + batch_size + (size_t)i * page_size;
+      if (fil_diff_header_differs(a, b, page_size)) {
+        t.n_header_diff++;
+        fil_range_add(&t.ranges, first + i);
+      } else if (memcmp(a, b, page_size) != 0) {
+        t.silent.push_back(first + i);
+        fil_range_add(&t.ranges, first + i);
+      }
+    }
+  });
+  close(other_fd);
+
+  std::vector<std::vector<fil_range_t>> per_thread;
+  uint64_t n_header_diff = 0;
+  std::vector<page_no_t> silent;
+  for (fil_diff_thread_t &t : threads) {
+    per_thread.push_back(t.ranges);
+    n_header_diff += t.n_header_diff;
+    silent.insert(silent.end(), t.silent.begin(), t.silent.end());
+    free(t.buf);
+  }
+  /* pages only this file has are all shipped */
+  if (n_pages > n_common) {
+    per_thread.push_back({fil_range_t(n_common, n_pages - 1)});
+  }
+  std::sort(silent.begin(), silent.end());
+
+  printf("Compared %u pages with %s, threads %u\n", n_common, other_path,
+         n_threads);
+  fil_range_show(fil_range_merge(per_thread), n_pages, page_size);
+  printf("Pages with a different LSN or checksum: %lu\n", n_header_diff);
+  printf("Pages only in this file: %u, only in the other file: %u\n",
+         n_pages - n_common, n_other_pages - n_common);
+  printf("Pages with the same LSN and checksum but different bytes: %lu\n",
+         silent.size());
+  for (page_no_t page_no : silent) {
+    printf("  page %u, possibly corrupted\n", page_no);
+  }
+}
@@ -1,5 +1,6 @@
 
 #include "include/fil0fil.h"
+#include "include/ut0ut.h"
 
 /** Get the predecessor of a file page.
  * @param[in]  page    File page
@@ -21,3 +22,88 @@ extern page_no_t fil_page_get_next(const byte *page) {
 extern void fil_page_set_type(byte *page, ulint type) {
     mach_write_to_2(page + FIL_PAGE_TYPE, type);
 }
+
+/** Get the description of a page type.
+ * @param[in]  type    File page type
+ * @return description, "ERROR" for an unknown type */
+extern const char *fil_get_page_type_str(page_type_t type) {
+  switch (type) {
+    case FIL_PAGE_INDEX:
+      return "INDEX PAGE";
+    case FIL_PAGE_RTREE:
+      return "RTREE PAGE";
+    case FIL_PAGE_SDI:
+      return "SDI INDEX PAGE";
+    case FIL_PAGE_UNDO_LOG:
+      return "UNDO LOG PAGE";
+    case FIL_PAGE_INODE:
+      return "INDEX NODE PAGE";
+    case FIL_PAGE_IBUF_FREE_LIST:
+      return "INSERT BUFFER FREE LIST";
+    case FIL_PAGE_TYPE_ALLOCATED:
+      return "FRESHLY ALLOCATED PAGE";
+    case FIL_PAGE_IBUF_BITMAP:
+      return "INSERT BUFFER BITMAP";
+    case FIL_PAGE_TYPE_SYS:
+      return "SYSTEM PAGE";
+    case FIL_PAGE_TYPE_TRX_SYS:
+      return "TRX SYSTEM PAGE";
+    case FIL_PAGE_TYPE_FSP_HDR:
+      return "FSP HDR";
+    case FIL_PAGE_TYPE_XDES:
+      return "XDES";
+    case FIL_PAGE_TYPE_BLOB:
+      return "UNCOMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZBLOB:
+      return "FIRST COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZBLOB2:
+      return "SUBSEQUENT FRESHLY ALLOCATED PAGE";
+    case FIL_PAGE_TYPE_UNKNOWN:
+      return "UNDO TYPE PAGE";
+    case FIL_PAGE_COMPRESSED:
+      return "PAGE COMPRESSED PAGE";
+    case FIL_PAGE_TYPE_LOB_FIRST:
+      return "FIRST PAGE OF UNCOMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_LOB_INDEX:
+      return "INDEX PAGE OF UNCOMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_LOB_DATA:
+      return "DATA PAGE OF UNCOMPRESSED BLOB PAGE";
+    case FIL_PAGE_ENCRYPTED:
+      return "ENCRYPTED PAGE";
+    case FIL_PAGE_COMPRESSED_AND_ENCRYPTED:
+      return "COMPRESSED AND ENCRYPTED PAGE";
+    case FIL_PAGE_ENCRYPTED_RTREE:
+      return "ENCRYPTED RTREE PAGE";
+    case FIL_PAGE_SDI_BLOB:
+      return "SDI BLOB PAGE";
+    case FIL_PAGE_SDI_ZBLOB:
+      return "SDI COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_RSEG_ARRAY:
+      return "RSEG ARRAY PAGE";
+    case FIL_PAGE_TYPE_ZLOB_FIRST:
+      return "FIRST PAGE OF COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZLOB_DATA:
+      return "DATA PAGE OF COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZLOB_INDEX:
+      return "INDEX PAGE OF COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZLOB_FRAG:
+      return "FRAGMENT PAGE OF COMPRESSED BLOB PAGE";
+    case FIL_PAGE_TYPE_ZLOB_FRAG_ENTRY:
+      return "FRAGMENT INDEX PAGE OF COMPRESSED BLOB PAGE";
+    default:
+      return "ERROR";
+  }
+}
+
+extern void fil_format_header(std::string *out, page_no_t page_no,
+                              const byte *page) {
+  ut_str_printf(out, "=========================%u's block==========================\n", page_no);
+  ut_str_printf(out, "FIL Header:\n");
+  ut_str_printf(out, "CheckSum: %u\n", mach_read_from_4(page));
+  ut_str_printf(out, "Page number: %u\n", mach_read_from_4(page + FIL_PAGE_OFFSET));
+  ut_str_printf(out, "Previous Page: %u\n", mach_read_from_4(page + FIL_PAGE_PREV));
+  ut_str_printf(out, "Next Page: %u\n", mach_read_from_4(page + FIL_PAGE_NEXT));
+  ut_str_printf(out, "Page LSN: %lu\n", mach_read_from_8(page + FIL_PAGE_LSN));
+  ut_str_printf(out, "Page Type: %hu\n", mach_read_from_2(page + FIL_PAGE_TYPE));
+  ut_str_printf(out, "Flush LSN: %lu\n", mach_read_from_8(page + FIL_PAGE_FILE_FLUSH_LSN));
+}
@@ -0,0 +1,392 @@
+#include <ctype.h>
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "include/fil0scan.h"
+#include "include/fil0comp.h"
+#include "include/fil0crypt.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/srv0mon.h"
+#include "include/page0zip.h"
+#include "include/page_crc32.h"
+#include "include/ut0mem.h"
+
+uint32_t fil_scan_n_threads(uint32_t requested) {
+  if (requested != 0) {
+    return requested;
+  }
+  uint32_t n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+page_size_t fil_get_page_size(int fd) {
+  byte flags[4];
+  if (pread(fd, flags, sizeof(flags), FSP_HEADER_OFFSET + FSP_SPACE_FLAGS) !=
+      sizeof(flags)) {
+    return page_size_t(UNIV_PAGE_SIZE, UNIV_PAGE_SIZE, false);
+  }
+  return page_size_t(mach_read_from_4(flags));
+}
+
+page_no_t fil_get_n_pages(int fd) {
+  return fil_get_n_pages(fd, fil_get_page_size(fd));
+}
+
+page_no_t fil_get_n_pages(int fd, const page_size_t &page_size) {
+  struct stat stat_buf;
+  if (fil_space_stat(fd, &stat_buf) == -1) {
+    return 0;
+  }
+  return stat_buf.st_size / page_size.physical();
+}
+
+/** Pages fil_detect_page_size() reads in each page size */
+#define FIL_DETECT_SAMPLES 64
+
+/** Sampled pages of a file that agree with a page size */
+struct fil_detect_score_t {
+  /** pages whose FIL_PAGE_OFFSET is their page number */
+  uint64_t n_placed;
+  /** of those, pages whose checksums hold */
+  uint64_t n_valid;
+
+  bool better_than(const fil_detect_score_t &other) const {
+    return n_valid != other.n_valid ? n_valid > other.n_valid
+                                    : n_placed > other.n_placed;
+  }
+};
+
+/** Reads pages spread evenly over a file in a page size and counts those
+that are where that size puts them. Page 0, which every size places,
+and pages never written are left out.
+@param[in]  buf  frame of UNIV_PAGE_SIZE_MAX bytes */
+static fil_detect_score_t fil_detect_sample(int fd, const page_size_t &page_size,
+                                            byte *buf) {
+  fil_detect_score_t score = {0, 0};
+  const ulint physical = page_size.physical();
+  const page_no_t n_pages = fil_get_n_pages(fd, page_size);
+  if (n_pages < 2) {
+    return score;
+  }
+  const uint64_t n_samples =
+      std::min<uint64_t>(n_pages - 1, FIL_DETECT_SAMPLES);
+  for (uint64_t i = 0; i < n_samples; i++) {
+    page_no_t page_no = 1 + i * (n_pages - 1) / n_samples;
+    if (fil_pread(fd, buf, physical, (uint64_t)page_no * physical) !=
+            (ssize_t)physical ||
+        ut_is_zeroes(buf, physical) ||
+        mach_read_from_4(buf + FIL_PAGE_OFFSET) != page_no) {
+      continue;
+    }
+    score.n_placed++;
+    /* a ROW_FORMAT=COMPRESSED page has a checksum of its own */
+    if (!page_size.is_compressed() && !buf_page_is_corrupted(buf, physical)) {
+      score.n_valid++;
+    }
+  }
+  return score;
+}
+
+page_size_t fil_detect_page_size(int fd) {
+  const page_size_t flags_size = fil_get_page_size(fd);
+  byte *buf;
+  if (posix_memalign((void **)&buf, UNIV_PAGE_SIZE_MAX, UNIV_PAGE_SIZE_MAX) !=
+      0) {
+    return flags_size;
+  }
+  page_size_t best = flags_size;
+  fil_detect_score_t best_score = fil_detect_sample(fd, flags_size, buf);
+  for (ulint size = UNIV_PAGE_SIZE_MIN; size <= UNIV_PAGE_SIZE_MAX;
+       size <<= 1) {
+    const page_size_t candidate(size, size, false);
+    if (candidate.equals_to(flags_size)) {
+      continue;
+    }
+    fil_detect_score_t score = fil_detect_sample(fd, candidate, buf);
+    if (score.better_than(best_score)) {
+      best = candidate;
+      best_score = score;
+    }
+  }
+  free(buf);
+  return best;
+}
+
+/** @return true if a sorts before b, comparing digit runs by value */
+static bool fil_name_less(const std::string &a, const std::string &b) {
+  size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (isdigit(a[i]) && isdigit(b[j])) {
+      size_t i_end = i, j_end = j;
+      while (i_end < a.size() && isdigit(a[i_end])) i_end++;
+      while (j_end < b.size() && isdigit(b[j_end])) j_end++;
+      unsigned long long x = strtoull(a.c_str() + i, nullptr, 10);
+      unsigned long long y = strtoull(b.c_str() + j, nullptr, 10);
+      if (x != y) {
+        return x < y;
+      }
+      i = i_end;
+      j = j_end;
+    } else {
+      if (a[i] != b[j]) {
+        return a[i] < b[j];
+      }
+      i++;
+      j++;
+    }
+  }
+  return a.size() - i < b.size() - j;
+}
+
+void fil_expand_paths(const char *path,
+                      const std::vector<std::string> &dir_patterns,
+                      std::vector<std::string> *files) {
+  struct stat stat_buf;
+  std::vector<std::string> patterns;
+
+  if (stat(path, &stat_buf) == 0 && S_ISDIR(stat_buf.st_mode)) {
+    for (const std::string &pattern : dir_patterns) {
+      patterns.push_back(std::string(path) + "/" + pattern);
+    }
+  } else if (strpbrk(path, "*?[") != nullptr) {
+    patterns.push_back(path);
+  } else {
+    files->push_back(path);
+    return;
+  }
+
+  size_t first = files->size();
+  for (const std::string &pattern : patterns) {
+    glob_t g;
+    if (glob(pattern.c_str(), 0, nullptr, &g) == 0) {
+      for (size_t i = 0; i < g.gl_pathc; i++) {
+        files->push_back(g.gl_pathv[i]);
+      }
+    }
+    globfree(&g);
+  }
+  std::sort(files->begin() + first, files->end(), fil_name_less);
+}
+
+fil_scan_space_t::fil_scan_space_t(int fd, bool uncompress)
+    : fil_scan_space_t(fd, fil_get_page_size(fd), uncompress) {}
+
+fil_scan_space_t::fil_scan_space_t(int fd, const page_size_t &page_size,
+                                   bool uncompress)
+    : page_size(page_size) {
+  fil_space_t single(fd);
+  files = fil_space_get(fd, &single);
+  /* without uncompress, pages are passed as they are in the file */
+  decrypt = uncompress;
+  /* COMPRESSION= is not in the space flags, any page of an uncompressed
+  tablespace may have been written compressed */
+  page_compressed = uncompress && !page_size.is_compressed();
+  inflate = uncompress && page_size.is_compressed();
+  /* a space that was not given its key is decrypted with the keys of
+  inno_load_keyring() */
+  if (files.key == nullptr && decrypt) {
+    files.key = fil_space_get_key(fd);
+  } else if (!decrypt) {
+    files.key = nullptr;
+  }
+  if (files.block_size == 0) {
+    files.block_size = fil_get_block_size(fd);
+  }
+  n_pages = fil_get_n_pages(fd, page_size);
+}
+
+fil_scan_space_t::fil_scan_space_t(const fil_space_t &space,
+                                   const page_size_t &page_size,
+                                   bool uncompress)
+    : files(space), page_size(page_size) {
+  decrypt = uncompress;
+  page_compressed = uncompress && !page_size.is_compressed();
+  inflate = uncompress && page_size.is_compressed();
+  if (!decrypt) {
+    files.key = nullptr;
+  }
+  if (files.block_size == 0) {
+    files.block_size = fil_get_block_size(files.fd);
+  }
+  struct stat stat_buf;
+  n_pages = fil_space_stat(files, &stat_buf) == -1
+                ? 0
+                : stat_buf.st_size / page_size.physical();
+}
+
+Fil_scan_reader::Fil_scan_reader()
+    : n_corrupt(0),
+      n_undecrypted(0),
+      m_buf(nullptr),
+      m_frame(nullptr),
+      m_decryptor_key(nullptr) {
+  /* pages of an uncompressed tablespace are parsed in place, each must
+  be aligned to its size */
+  if (posix_memalign((void **)&m_buf, UNIV_PAGE_SIZE_MAX,
+                     (size_t)UNIV_PAGE_SIZE_MAX * FIL_SCAN_BATCH_PAGES) != 0) {
+    m_buf = nullptr;
+  }
+  if (posix_memalign((void **)&m_frame, UNIV_PAGE_SIZE_MAX,
+                     UNIV_PAGE_SIZE_MAX) != 0) {
+    m_frame = nullptr;
+  }
+}
+
+Fil_scan_reader::~Fil_scan_reader() {
+  free(m_frame);
+  free(m_buf);
+}
+
+uint64_t Fil_scan_reader::read_batch(const fil_scan_space_t &space,
+                                     uint64_t start, uint64_t n_pages,
+                                     uint32_t thread_no,
+                                     const fil_scan_func_t &func) {
+  const ulint physical = space.page_size.physical();
+  /* a hole reads as zeroes: skip the pages before the first data of the
+  batch, all of them if the batch is unallocated */
+  uint64_t offset = start * physical;
+  uint64_t data = fil_seek_data(space.files, offset);
+  uint64_t n_skip =
+      data == UINT64_MAX
+          ? n_pages
+          : std::min<uint64_t>((data - offset) / physical, n_pages);
+  memset(m_buf, 0, n_skip * physical);
+  monitor_progress_skip(n_skip * physical);
+  if (n_skip < n_pages) {
+    ssize_t ret = fil_pread(space.files, m_buf + n_skip * physical,
+                            (n_pages - n_skip) * physical,
+                            offset + n_skip * physical);
+    if (ret < 0) {
+      return 0;
+    }
+    n_pages = n_skip + ret / physical;
+  }
+
+  /* each thread decrypts with cipher contexts of its own */
+  const fil_space_key_t *key = space.files.key;
+  if (key != nullptr && key != m_decryptor_key) {
+    m_decryptor.reset(new Fil_page_decryptor(*key));
+    m_decryptor_key = key;
+  }
+  if (space.inflate && !m_zip) {
+    m_zip.reset(new Page_zip_decompressor());
+  }
+
+  for (uint64_t i = 0; i < n_pages; i++) {
+    byte *page_buf = m_buf + i * physical;
+    if (space.decrypt && fil_page_is_encrypted(page_buf)) {
+      if (key == nullptr ||
+          !m_decryptor->decrypt(page_buf, physical, space.files.block_size)) {
+        n_undecrypted++;
+        continue;
+      }
+    }
+    const byte *page = page_buf;
+    if (space.page_compressed && fil_page_is_page_compressed(page)) {
+      if (!fil_page_decompress(page, physical, m_frame)) {
+        n_corrupt++;
+        continue;
+      }
+      page = m_frame;
+    }
+    if (space.inflate) {
+      page = m_zip->decompress(page, space.page_size);
+      if (page == nullptr) {
+        n_corrupt++;
+        continue;
+      }
+    }
+    func(thread_no, start + i, page);
+  }
+  return n_pages;
+}
+
+void fil_scan_report_errors(uint64_t n_corrupt, uint64_t n_undecrypted,
+                            bool has_key) {
+  if (n_corrupt > 0) {
+    fprintf(stderr, "%lu compressed pages could not be inflated\n",
+            n_corrupt);
+  }
+  if (n_undecrypted > 0) {
+    fprintf(stderr, "%lu encrypted pages could not be decrypted%s\n",
+            n_undecrypted, has_key ? "" : ", give the keyring with --keyring");
+  }
+}
+
+uint64_t fil_scan_parallel(int fd, page_no_t first, page_no_t last,
+                           uint32_t n_threads, const fil_scan_func_t &func,
+                           bool uncompress) {
+  return fil_scan_parallel(fd, fil_get_page_size(fd), first, last, n_threads,
+                           func, uncompress);
+}
+
+uint64_t fil_scan_parallel(int fd, const page_size_t &page_size,
+                           page_no_t first, page_no_t last,
+                           uint32_t n_threads, const fil_scan_func_t &func,
+                           bool uncompress) {
+  return fil_scan_parallel(fil_scan_space_t(fd, page_size, uncompress), first,
+                           last, n_threads, func);
+}
+
+uint64_t fil_scan_parallel(const fil_scan_space_t &space, page_no_t first,
+                           page_no_t last, uint32_t n_threads,
+                           const fil_scan_func_t &func) {
+  std::atomic<uint64_t> next_batch(first);
+  std::atomic<uint64_t> n_visited(0);
+  std::atomic<uint64_t> n_corrupt(0);
+  std::atomic<uint64_t> n_undecrypted(0);
+  /* pages in a hole are not read, the end of the file must bound them */
+  last = std::min(last, space.n_pages);
+
+  auto worker = [&](uint32_t thread_no) {
+    Fil_scan_reader reader;
+    if (!reader.is_ready()) {
+      return;
+    }
+    uint64_t visited = 0;
+    while (true) {
+      uint64_t start = next_batch.fetch_add(FIL_SCAN_BATCH_PAGES);
+      if (start >= last) {
+        break;
+      }
+      uint64_t n_pages = std::min<uint64_t>(last - start, FIL_SCAN_BATCH_PAGES);
+      /* pages that could not be inflated or decrypted were counted in the
+      reader and not passed to func */
+      uint64_t n_failed = reader.n_corrupt + reader.n_undecrypted;
+      uint64_t n_read =
+          reader.read_batch(space, start, n_pages, thread_no, func);
+      visited += n_read - (reader.n_corrupt + reader.n_undecrypted - n_failed);
+    }
+    n_visited += visited;
+    n_corrupt += reader.n_corrupt;
+    n_undecrypted += reader.n_undecrypted;
+  };
+
+  if (n_threads <= 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < n_threads; i++) {
+      threads.emplace_back(worker, i);
+    }
+    for (std::thread &t : threads) {
+      t.join();
+    }
+  }
+  fil_scan_report_errors(n_corrupt, n_undecrypted,
+                         space.files.key != nullptr);
+  return n_visited;
+}
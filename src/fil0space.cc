@@ -0,0 +1,357 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "include/fil0space.h"
+#include "include/fil0crypt.h"
+#include "include/fil0scan.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/srv0mon.h"
+
+/** fds covered by a chunk of the registry */
+#define FIL_SPACE_CHUNK_SIZE 1024
+/** chunks of the registry: a space whose first fd is beyond them can not
+be attached */
+#define FIL_SPACE_N_CHUNKS 1024
+
+/** Slot of an fd in the registry, the space attached under it */
+typedef std::atomic<const fil_space_t *> fil_space_slot_t;
+
+/** Spaces attached under the fd of their first file, in chunks allocated
+when an fd of theirs is first attached and kept until exit. Readers look
+an fd up with two atomic loads and no latch: every fil_pread() given an
+fd goes through here, while spaces are only attached and detached when
+they are opened and closed. */
+static std::atomic<fil_space_slot_t *> spaces[FIL_SPACE_N_CHUNKS];
+/** serializes the changes of spaces */
+static std::mutex spaces_mutex;
+
+/** @return the slot of an fd, nullptr if its chunk was never allocated */
+static fil_space_slot_t *fil_space_get_slot(int fd) {
+  if (fd < 0 || fd >= FIL_SPACE_CHUNK_SIZE * FIL_SPACE_N_CHUNKS) {
+    return nullptr;
+  }
+  fil_space_slot_t *chunk =
+      spaces[fd / FIL_SPACE_CHUNK_SIZE].load(std::memory_order_acquire);
+  return chunk == nullptr ? nullptr : &chunk[fd % FIL_SPACE_CHUNK_SIZE];
+}
+
+/** Finds the space attached under an fd. A space is not changed once it
+is attached, so it can be read until it is detached.
+@param[in]  fd  fd of the first file
+@return the space, nullptr if there is none */
+static const fil_space_t *fil_space_find(int fd) {
+  const fil_space_slot_t *slot = fil_space_get_slot(fd);
+  return slot == nullptr ? nullptr : slot->load(std::memory_order_acquire);
+}
+
+bool fil_space_attach(const fil_space_t *space) {
+  int fd = space->fd;
+  if (fd < 0 || fd >= FIL_SPACE_CHUNK_SIZE * FIL_SPACE_N_CHUNKS) {
+    fprintf(stderr, "[ERROR] fd %d is beyond the tablespaces that can be "
+            "attached\n", fd);
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(spaces_mutex);
+  std::atomic<fil_space_slot_t *> &chunk = spaces[fd / FIL_SPACE_CHUNK_SIZE];
+  if (chunk.load(std::memory_order_relaxed) == nullptr) {
+    chunk.store(new fil_space_slot_t[FIL_SPACE_CHUNK_SIZE](),
+                std::memory_order_release);
+  }
+  chunk.load(std::memory_order_relaxed)[fd % FIL_SPACE_CHUNK_SIZE].store(
+      space, std::memory_order_release);
+  return true;
+}
+
+void fil_space_detach(const fil_space_t *space) {
+  fil_space_slot_t *slot = fil_space_get_slot(space->fd);
+  if (slot != nullptr) {
+    /* the fd may have been closed and attached to another space since */
+    slot->compare_exchange_strong(space, nullptr);
+  }
+}
+
+const fil_space_t &fil_space_get(int fd, fil_space_t *single) {
+  const fil_space_t *space = fil_space_find(fd);
+  return space == nullptr ? *single : *space;
+}
+
+/** Reads the space id and FSP_SIZE from page 0 of a file.
+@return false if page 0 can not be read */
+static bool fil_space_read_header(int fd, space_id_t *space_id,
+                                  page_no_t *size) {
+  byte header[FSP_HEADER_SIZE];
+  if (pread(fd, header, sizeof(header), FSP_HEADER_OFFSET) !=
+      (ssize_t)sizeof(header)) {
+    return false;
+  }
+  *space_id = mach_read_from_4(header + FSP_SPACE_ID);
+  *size = mach_read_from_4(header + FSP_SIZE);
+  return true;
+}
+
+bool fil_space_open(const std::vector<std::string> &files, int flags,
+                    fil_space_t *space) {
+  std::vector<fil_node_t> nodes;
+  for (const std::string &name : files) {
+    int fd = open(name.c_str(), flags, 0644);
+    if (fd == -1) {
+      fprintf(stderr, "[ERROR] Open %s failed: %s\n", name.c_str(),
+              strerror(errno));
+      for (const fil_node_t &node : nodes) {
+        close(node.fd);
+      }
+      return false;
+    }
+    nodes.push_back({name, fd, 0, 0});
+  }
+  if (nodes.empty()) {
+    return false;
+  }
+  space->fd = nodes[0].fd;
+  space->block_size = fil_get_block_size(space->fd);
+  if (nodes.size() == 1) {
+    return true;
+  }
+
+  ulint page_size = fil_get_page_size(nodes[0].fd).physical();
+  space_id_t space_id;
+  page_no_t space_pages = 0;
+  fil_space_read_header(nodes[0].fd, &space_id, &space_pages);
+  uint64_t space_size = (uint64_t)space_pages * page_size;
+
+  uint64_t start = 0;
+  for (size_t i = 0; i < nodes.size(); i++) {
+    struct stat stat_buf;
+    uint64_t size =
+        fstat(nodes[i].fd, &stat_buf) == 0 ? stat_buf.st_size : 0;
+    size = size / page_size * page_size;
+    /* an autoextend file may have been extended beyond what page 0
+    records, the pages after FSP_SIZE are not part of the space yet */
+    if (space_size != 0) {
+      size = std::min(size, space_size > start ? space_size - start : 0);
+    }
+    nodes[i].start = start;
+    nodes[i].size = size;
+    start += size;
+  }
+  space->nodes.swap(nodes);
+  return true;
+}
+
+void fil_space_close(fil_space_t *space) {
+  if (space->nodes.empty() && space->fd != -1) {
+    close(space->fd);
+  }
+  for (const fil_node_t &node : space->nodes) {
+    close(node.fd);
+  }
+  space->nodes.clear();
+  space->fd = -1;
+}
+
+int fil_space_open(const std::vector<std::string> &files, int flags) {
+  std::unique_ptr<fil_space_t> space(new fil_space_t());
+  if (!fil_space_open(files, flags, space.get())) {
+    return -1;
+  }
+  int fd = space->fd;
+  if (space->nodes.empty()) {
+    return fd;
+  }
+  if (!fil_space_attach(space.get())) {
+    fil_space_close(space.get());
+    return -1;
+  }
+  space.release();
+  return fd;
+}
+
+void fil_space_close(int fd) {
+  if (fd == -1) {
+    return;
+  }
+  const fil_space_t *space = nullptr;
+  if (fil_space_find(fd) != nullptr) {
+    std::lock_guard<std::mutex> guard(spaces_mutex);
+    space = fil_space_get_slot(fd)->exchange(nullptr);
+  }
+  if (space == nullptr) {
+    close(fd);
+    return;
+  }
+  std::unique_ptr<fil_space_t> owned(const_cast<fil_space_t *>(space));
+  fil_space_close(owned.get());
+}
+
+void fil_space_find_files(const char *path, std::vector<std::string> *files) {
+  fil_expand_paths(path, {"ibdata*"}, files);
+  if (files->size() != 1) {
+    return;
+  }
+
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return;
+  }
+  space_id_t space_id;
+  page_no_t space_pages;
+  bool ok = fil_space_read_header(fd, &space_id, &space_pages);
+  uint64_t space_size =
+      (uint64_t)space_pages * fil_get_page_size(fd).physical();
+  struct stat stat_buf;
+  ok = ok && fstat(fd, &stat_buf) == 0;
+  close(fd);
+  if (!ok || space_id != 0 || space_size <= (uint64_t)stat_buf.st_size) {
+    return;
+  }
+
+  /* the system tablespace goes on in the files named after it */
+  std::string dir(path);
+  char *dir_name = dirname(&dir[0]);
+  std::vector<std::string> siblings;
+  fil_expand_paths(dir_name, {"ibdata*"}, &siblings);
+  auto it = std::find_if(siblings.begin(), siblings.end(),
+                         [&](const std::string &name) {
+                           struct stat s;
+                           return stat(name.c_str(), &s) == 0 &&
+                                  s.st_dev == stat_buf.st_dev &&
+                                  s.st_ino == stat_buf.st_ino;
+                         });
+  if (it != siblings.end()) {
+    files->insert(files->end(), it + 1, siblings.end());
+  }
+}
+
+uint64_t fil_space_map(const fil_space_t &space, uint64_t offset,
+                       int *file_fd, uint64_t *file_offset) {
+  if (space.nodes.empty()) {
+    *file_fd = space.fd;
+    *file_offset = offset;
+    return UINT64_MAX;
+  }
+  for (const fil_node_t &node : space.nodes) {
+    if (offset < node.start + node.size) {
+      *file_fd = node.fd;
+      *file_offset = offset - node.start;
+      return node.size - *file_offset;
+    }
+  }
+  *file_fd = -1;
+  *file_offset = 0;
+  return 0;
+}
+
+uint64_t fil_space_map(int fd, uint64_t offset, int *file_fd,
+                       uint64_t *file_offset) {
+  fil_space_t single(fd);
+  return fil_space_map(fil_space_get(fd, &single), offset, file_fd,
+                       file_offset);
+}
+
+ssize_t fil_pread(const fil_space_t &space, void *buf, size_t n,
+                  uint64_t offset) {
+  Monitor_timer timer(MONITOR_PAGE_READ);
+  size_t done = 0;
+  while (done < n) {
+    int file_fd;
+    uint64_t file_offset;
+    uint64_t left =
+        fil_space_map(space, offset + done, &file_fd, &file_offset);
+    if (left == 0) {
+      break;
+    }
+    size_t len = std::min<uint64_t>(n - done, left);
+    ssize_t ret = pread(file_fd, (byte *)buf + done, len, file_offset);
+    if (ret < 0) {
+      return done == 0 ? ret : (ssize_t)done;
+    }
+    done += ret;
+    timer.add_bytes(ret);
+    if ((size_t)ret < len) {
+      break;
+    }
+  }
+  return done;
+}
+
+ssize_t fil_pread(int fd, void *buf, size_t n, uint64_t offset) {
+  fil_space_t single(fd);
+  return fil_pread(fil_space_get(fd, &single), buf, n, offset);
+}
+
+ssize_t fil_pwrite(const fil_space_t &space, const void *buf, size_t n,
+                   uint64_t offset) {
+  size_t done = 0;
+  while (done < n) {
+    int file_fd;
+    uint64_t file_offset;
+    uint64_t left =
+        fil_space_map(space, offset + done, &file_fd, &file_offset);
+    if (left == 0) {
+      break;
+    }
+    size_t len = std::min<uint64_t>(n - done, left);
+    ssize_t ret =
+        pwrite(file_fd, (const byte *)buf + done, len, file_offset);
+    if (ret < 0) {
+      return done == 0 ? ret : (ssize_t)done;
+    }
+    done += ret;
+    if ((size_t)ret < len) {
+      break;
+    }
+  }
+  return done;
+}
+
+ssize_t fil_pwrite(int fd, const void *buf, size_t n, uint64_t offset) {
+  fil_space_t single(fd);
+  return fil_pwrite(fil_space_get(fd, &single), buf, n, offset);
+}
+
+int fil_space_stat(const fil_space_t &space, struct stat *stat_buf) {
+  int ret = fstat(space.fd, stat_buf);
+  if (ret == -1 || space.nodes.empty()) {
+    return ret;
+  }
+  stat_buf->st_size = 0;
+  stat_buf->st_blocks = 0;
+  for (const fil_node_t &node : space.nodes) {
+    struct stat node_stat;
+    if (fstat(node.fd, &node_stat) == -1) {
+      return -1;
+    }
+    stat_buf->st_size += node.size;
+    stat_buf->st_blocks += node_stat.st_blocks;
+  }
+  return 0;
+}
+
+int fil_space_stat(int fd, struct stat *stat_buf) {
+  fil_space_t single(fd);
+  return fil_space_stat(fil_space_get(fd, &single), stat_buf);
+}
+
+void fil_space_print_files(int fd) {
+  const fil_space_t *space = fil_space_find(fd);
+  if (space == nullptr || space->nodes.empty()) {
+    return;
+  }
+  ulint page_size = fil_get_page_size(fd).physical();
+  printf("file\t\tfirst page\tpages\n");
+  for (const fil_node_t &node : space->nodes) {
+    printf("%s\t%lu\t\t%lu\n", node.name.c_str(), node.start / page_size,
+           node.size / page_size);
+  }
+}
@@ -4,11 +4,11 @@
 #include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <getopt.h>
 #include <errno.h>
 #include <string.h>
 #include <vector>
 #include <iostream>
-#include <fstream>
 
 #include <sys/stat.h>
 
@@ -16,13 +16,6 @@
 #include <iostream>
 #include <set>
 
-#include <rapidjson/document.h>
-#include <rapidjson/error/en.h>
-#include <rapidjson/filewritestream.h>
-#include <rapidjson/istreamwrapper.h>
-#include <rapidjson/ostreamwrapper.h>
-#include <rapidjson/prettywriter.h>
-
 #include "include/fil0fil.h"
 #include "include/page0page.h"
 #include "include/ut0crc32.h"
@@ -33,10 +26,39 @@
 #include "include/rem0types.h"
 #include "include/rec.h"
 #include "include/ut0dbg.h"
-
-
-
-static const uint32_t kPageSize = 16384;
+#include "include/row0stats.h"
+#include "include/row0recover.h"
+#include "include/trx0undo.h"
+#include "include/trx0purge.h"
+#include "include/trx0rseg.h"
+#include "include/log0log.h"
+#include "include/arch0page.h"
+#include "include/fil0diff.h"
+#include "include/lob0lob.h"
+#include "include/fil0scan.h"
+#include "include/fil0comp.h"
+#include "include/fil0crypt.h"
+#include "include/fil0space.h"
+#include "include/buf0dblwr.h"
+#include "include/fil0datadir.h"
+#include "include/srv0mon.h"
+#include "include/srv0srv.h"
+#include "include/buf0cache.h"
+#include "include/api0space.h"
+#include "include/page0zip.h"
+#include "include/ut0json.h"
+#include "include/rem0rec.h"
+
+
+
+// page size of the tablespace, read from the FSP_SPACE_FLAGS of page 0
+static page_size_t page_size(UNIV_PAGE_SIZE, UNIV_PAGE_SIZE, false);
+// size of a page in the file, the KEY_BLOCK_SIZE of ROW_FORMAT=COMPRESSED
+// tablespaces
+static uint32_t kPageSize = UNIV_PAGE_SIZE;
+// size of a page frame, the innodb_page_size of the instance
+static uint32_t kLogicalPageSize = UNIV_PAGE_SIZE;
+static bool is_compressed = false;
 
 // global variables
 char path[1024];
@@ -46,16 +68,49 @@ int fd;
 byte* read_buf;
 byte* inode_page_buf;
 
-// init offsets here
-ulint offsets_[REC_OFFS_NORMAL_SIZE];
+// pages read by the commands, shared by their threads
+static std::unique_ptr<Buf_page_cache> page_cache;
+
+/** print the --stats report at exit */
+static bool show_stats = false;
+
+// set while a command reads the file page after page, see UncachedReads
+static bool read_uncached = false;
+
+// Reads a page at offset through the page cache, returns the bytes read or
+// -1 as fil_pread() does
+static int ReadPage(byte *buf, uint64_t offset) {
+  if (read_uncached) {
+    return fil_pread(fd, buf, kPageSize, offset) == (ssize_t)kPageSize
+               ? kPageSize
+               : -1;
+  }
+  return buf_read_page(fd, kPageSize, offset / kPageSize, buf) ? kPageSize
+                                                                : -1;
+}
 
-struct dict_col {
-  std::string col_name;
-  std::string column_type_utf8;
-  int char_length;
+// Makes ReadPage() go around the page cache while it lives: a pass over
+// the whole file would only evict the pages the commands read one at a
+// time. Passes that need no page but the current one use
+// fil_scan_parallel() instead, which reads a batch of pages at once.
+struct UncachedReads {
+  UncachedReads() { read_uncached = true; }
+  ~UncachedReads() { read_uncached = false; }
 };
 
-std::vector<dict_col> dict_cols;
+// Writes a page at offset and drops its cached copy
+static int WritePage(const byte *buf, uint64_t offset) {
+  return buf_write_page(fd, kPageSize, offset / kPageSize, buf) ? kPageSize
+                                                                 : -1;
+}
+
+/** Stops the progress line and prints the --stats report, at exit. */
+static void StopMonitor() {
+  monitor_progress_stop();
+  if (show_stats) {
+    monitor_print(stderr);
+  }
+}
 
 static void usage()
 {
@@ -64,11 +119,39 @@ static void usage()
       "usage: inno [-h] [-f test/t.ibd] [-p page_num]\n"
       "\t-h                -- show this help\n"
       "\t-f test/t.ibd     -- ibd file \n"
+      "\t-D datadir        -- scan every tablespace of a data directory: page types, checksum failures, reclaimable space\n"
+      "\t--serve socket    -- answer page, records, summary and stats requests on a unix socket, pages cached in --cache-mb\n"
       "\t\t-c list-page-type      -- show all page type\n"
       "\t\t-c index-summary       -- show indexes information\n"
-      "\t\t-c show-undo-file       -- show undo log file detail\n"
+      "\t\t-c show-undo-file       -- show undo log file detail, -f may be a directory or a glob\n"
+      "\t\t-c undo-history         -- decode undo records of all history lists, -s decodes the table's fields\n"
+      "\t\t-c purge-lag            -- show history length, undo pages by state and undo bytes per table\n"
+      "\t\t-c column-stats         -- show column statistics, needs -s\n"
+      "\t\t-c recover-deleted      -- print deleted rows still on disk: delete-marked, on page free lists or on freed pages; needs -s\n"
+      "\t\t-c carve                 -- salvage rows from intact leaf pages when the B-tree is destroyed, -s prints the records\n"
+      "\t\t-c show-redo-file        -- validate redo log blocks, show checkpoints, LSN range and records by type\n"
+      "\t\t-c dump-redo-records     -- print every redo record with its lsn, type, space and page\n"
+      "\t\t-c redo-pages            -- list pages changed by redo in an LSN window, flag lost writes; needs --redo\n"
+      "\t\t-c changed-pages         -- list pages with FIL_PAGE_LSN newer than --since-lsn\n"
+      "\t\t-c diff other.ibd        -- list pages that differ from another copy of the file\n"
+      "\t\t-c dump-lobs             -- stream every off-page value of the table, needs -s\n"
+      "\t\t-c disk-usage            -- show logical and on-disk bytes per index, holes punched by page compression taken off\n"
+      "\t\t-c dblwr                 -- list corrupt pages with their newest valid copy in the doublewrite files; needs --dblwr\n"
+      "\t--redo path       -- redo log file, glob or directory\n"
+      "\t--since-lsn lsn   -- first LSN of the window, default 0\n"
+      "\t--until-lsn lsn   -- end LSN of the window, default end of log\n"
+      "\t--mem-mb mb       -- memory for the page index before spilling to disk, default 256\n"
+      "\t--cache-mb mb     -- memory for the page cache shared by the commands, default 64\n"
+      "\t--stats           -- print the time spent reading, checksumming, decoding and writing, with latency percentiles, to stderr at exit\n"
+      "\t--progress secs   -- print bytes and pages read, MB/s and ETA to stderr every secs seconds\n"
+      "\t--format fmt      -- text or json, a JSON object per line, for -p, list-page-type, index-summary, show-undo-file and the dumps\n"
+      "\t--lob-dir dir     -- write each off-page value dumped by dump-lobs to a file in dir\n"
+      "\t--keyring file    -- keyring_file holding the master key of an encrypted tablespace\n"
+      "\t--dblwr path      -- doublewrite files (#ib_*.dblwr), glob or directory\n"
+      "\t--apply           -- make dblwr write the copies over the corrupt pages\n"
+      "\t-t threads        -- number of scan threads, default one per cpu\n"
       "\t-p page_num       -- show page information\n"
-      "\t\t-c show-records        -- show all records information\n"
+      "\t\t-c show-records        -- show all records information, decoded with -s\n"
       "\t-u page_num       -- update page checksum\n"
       "\t-d page_num       -- delete page \n"
       "Example: \n"
@@ -79,191 +162,250 @@ static void usage()
       "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c index-summary\n"
       "Show undo_001 all rseg information\n"
       "./inno -f ~/git/primary/dbs2250/log/undo_001 -c show-undo-file\n"
+      "Show all rseg information of every undo tablespace in a directory\n"
+      "./inno -f ~/git/primary/dbs2250/log -c show-undo-file -t 16\n"
+      "Show undo_001 history lists and undo records\n"
+      "./inno -f ~/git/primary/dbs2250/log/undo_001 -c undo-history -s ./tool/sbtest1.json\n"
+      "Show what holds purge back in undo_001\n"
+      "./inno -f ~/git/primary/dbs2250/log/undo_001 -c purge-lag -t 8\n"
+      "Write every off-page value of t1.ibd to a file of its own under /tmp/lobs\n"
+      "./inno -f ~/git/primary/dbs2250/test/t1.ibd -c dump-lobs -s ./tool/t1.json --lob-dir /tmp/lobs\n"
+      "Validate the redo log of a data directory and show records by type\n"
+      "./inno -f ~/git/primary/dbs2250/#innodb_redo -c show-redo-file\n"
+      "List the ranges of sbtest1.ibd changed since LSN 1000000, for an incremental copy\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c changed-pages --since-lsn 1000000 -t 8\n"
+      "List the ranges of sbtest1.ibd that differ from yesterday's snapshot\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c diff /backup/sbtest1.ibd -t 8\n"
+      "Show pages of sbtest1.ibd changed by redo since LSN 1000000 and flag lost writes\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c redo-pages --redo ~/git/primary/dbs2250/#innodb_redo --since-lsn 1000000\n"
       "Show specify page information\n"
       "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -p 10\n"
       "Delete specify page\n"
       "./inno -f ~/git/primary/dbs2250/test/t1.ibd -d 2\n"
       "Update specify page checksum\n"
       "./inno -f ~/git/primary/dbs2250/test/t1.ibd -u 2\n"
+      "Dump the records of sbtest1.ibd as one JSON object per line\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c dump-all-records -s ./tool/sbtest1.json --format json\n"
+      "Recover the rows deleted from sbtest1.ibd that are still on disk\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c recover-deleted -s ./tool/sbtest1.json -t 8\n"
+      "Salvage the rows of sbtest1.ibd when page 0, the inodes or the root are destroyed\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c carve -s ./tool/sbtest1.json -t 8\n"
+      "Show column statistics of sbtest1.ibd\n"
+      "./inno -f ~/git/primary/dbs2250/sbtest/sbtest1.ibd -c column-stats -s ./tool/sbtest1.json\n"
       );
 }
 
 
 
+/** Prints a failure of a report as a JSON line */
+static void ShowJsonError(const char *func, uint32_t page_num,
+                          const char *message) {
+  Json_line line("error");
+  line.add("function", func);
+  line.add("page_no", page_num);
+  line.add("message", message);
+}
+
+/** Prints the FIL header of read_buf as a JSON line */
+static void ShowFILHeaderJson(uint32_t page_num) {
+  Json_line line("fil_header");
+  line.add("page_no", page_num);
+  line.add("checksum", mach_read_from_4(read_buf));
+  line.add("page_number", mach_read_from_4(read_buf + FIL_PAGE_OFFSET));
+  line.add("prev_page", mach_read_from_4(read_buf + FIL_PAGE_PREV));
+  line.add("next_page", mach_read_from_4(read_buf + FIL_PAGE_NEXT));
+  line.add("lsn", mach_read_from_8(read_buf + FIL_PAGE_LSN));
+  page_type_t page_type = mach_read_from_2(read_buf + FIL_PAGE_TYPE);
+  line.add("page_type", page_type);
+  line.add("page_type_name", fil_get_page_type_str(page_type));
+  line.add("flush_lsn", mach_read_from_8(read_buf + FIL_PAGE_FILE_FLUSH_LSN));
+}
+
 void ShowFILHeader(uint32_t page_num, uint16_t* type) {
-  printf("=========================%u's block==========================\n", page_num);
-  printf("FIL Header:\n");
+  if (ut_format_is_json()) {
+    if (ReadPage(read_buf, (uint64_t)kPageSize * (uint64_t)page_num) == -1) {
+      ShowJsonError("ShowFILHeader", page_num, "read error");
+      return;
+    }
+    *type = mach_read_from_2(read_buf + FIL_PAGE_TYPE);
+    ShowFILHeaderJson(page_num);
+    return;
+  }
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
+    printf("=========================%u's block==========================\n", page_num);
+    printf("FIL Header:\n");
     printf("ShowFILHeader read error %d\n", ret);
     return;
   }
 
-  printf("CheckSum: %u\n", mach_read_from_4(read_buf));
-
-  // uint32_t cc = buf_calc_page_crc32(read_buf, 0);
-  // printf("crc %u\n", cc);
-
-  printf("Page number: %u\n", mach_read_from_4(read_buf + FIL_PAGE_OFFSET));
-  printf("Previous Page: %u\n", mach_read_from_4(read_buf + FIL_PAGE_PREV));
-  printf("Next Page: %u\n", mach_read_from_4(read_buf + FIL_PAGE_NEXT));
-  printf("Page LSN: %lu\n", mach_read_from_8(read_buf + FIL_PAGE_LSN));
   *type = mach_read_from_2(read_buf + FIL_PAGE_TYPE);
-  printf("Page Type: %hu\n", *type);
-  printf("Flush LSN: %lu\n", mach_read_from_8(read_buf + FIL_PAGE_FILE_FLUSH_LSN));
+  std::string out;
+  fil_format_header(&out, page_num, read_buf);
+  fputs(out.c_str(), stdout);
 }
 
-void hexDump(void *ptr, size_t size) {
-  uint8_t *p = reinterpret_cast<uint8_t *>(ptr);
-  uint8_t bytesNum = 0;
-  while (bytesNum < size) {
-    std::cout << std::hex << "0x" << static_cast<uint32_t>(p[bytesNum++]) << " ";
+// Reads an index page into read_buf, decrypting it on an encrypted
+// tablespace and inflating it on a compressed tablespace or when it was
+// written by transparent page compression, so the records can be walked
+// as on an uncompressed page
+int ReadIndexPage(uint32_t page_num) {
+  static Page_zip_decompressor decompressor;
+  static byte zip_buf[UNIV_PAGE_SIZE];
 
+  uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
+  if (!is_compressed) {
+    int ret = ReadPage(read_buf, offset);
+    if (ret != -1 && !fil_page_restore(fd, read_buf, kPageSize)) {
+      fprintf(stderr, "Page %u could not be decrypted or decompressed\n",
+              page_num);
+      errno = EINVAL;
+      return -1;
+    }
+    return ret;
   }
-  std::cout << std::endl;
-} 
-
-/** TRUE if the record is the supremum record on a page.
- @return true if the supremum record */
-static inline bool page_rec_is_supremum_low(
-    ulint offset) /*!< in: record offset on page */
-{
-  return (offset == PAGE_NEW_SUPREMUM || offset == PAGE_OLD_SUPREMUM);
+  int ret = ReadPage(zip_buf, offset);
+  if (ret == -1) {
+    return ret;
+  }
+  const byte *page = decompressor.decompress(zip_buf, page_size);
+  if (page == nullptr) {
+    fprintf(stderr, "Page %u could not be inflated\n", page_num);
+    errno = EINVAL;
+    return -1;
+  }
+  memcpy(read_buf, page, kLogicalPageSize);
+  return ret;
 }
 
-/** TRUE if the record is the infimum record on a page.
- @return true if the infimum record */
-static inline bool page_rec_is_infimum_low(
-    ulint offset) /*!< in: record offset on page */
-{
-  return (offset == PAGE_NEW_INFIMUM || offset == PAGE_OLD_INFIMUM);
+/** @return the table definition of -s, loaded on first use; nullptr if
+there is none */
+static const Schema *TableSchema() {
+  static std::unique_ptr<Schema> schema =
+      sdi_path[0] != '\0' ? Schema::load(sdi_path) : nullptr;
+  return schema.get();
 }
 
-int rec_init_offsets() {
-  // Open the file for reading
-  std::ifstream file(sdi_path);
-
-  // Check if the file is open
-  if (!file.is_open()) {
-    std::cerr << "Failed to open json the file." << std::endl;
-    return 1;
+/** Prints the user records of the leaf page in read_buf as JSON lines,
+one per record, with the columns decoded by the table definition of -s;
+records marked deleted are skipped */
+static void ShowRecordsJson(uint32_t page_num) {
+  const Schema *schema = TableSchema();
+  if (schema == nullptr) {
+    ShowJsonError("ShowRecords", page_num,
+                  "records need a valid sdi file, -s");
+    return;
   }
-
-  // Create a string to store the file contents
-  std::string file_contents;
-
-  // Read the file and append its contents to the string
-  std::string line;
-  while (std::getline(file, line)) {
-    file_contents += line + '\n';
+  uint64_t index_id = mach_read_from_8(read_buf + PAGE_HEADER + PAGE_INDEX_ID);
+  const dict_index_t *index = schema->index_by_id(index_id);
+  if (index == nullptr ||
+      !(page_header_get_field(read_buf, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+    ShowJsonError("ShowRecords", page_num,
+                  "not a compact page of an index of the sdi");
+    return;
   }
 
-  // std::cout << file_contents;
-  // Close the file
-  file.close();
-
-  rapidjson::Document d;
-  d.Parse(file_contents.c_str());
-
-  // the sysbench offsets array
-  // offsets[0] 100   // 这个值默认初始化成100, 数组的元素个数, 没用
-  // offsets[1] 6  // 除了默认offsets[0, 1, 2] 三列以后, 剩下的其他列的个数, 是table 里面列的个数+ 2(trx_id 和 rollptr), 从offset[3] 开始
-  // offsets[2] 2147483653  //extra size
-  // offsets[3] 4  // id 这个列
-  // offsets[4] 10  // 根据record format 可以看出, 这个是trx_id
-  // offsets[5] 17  // 根据record format 可以看出, 这个是rollptr
-  // offsets[6] 21 // k 这个列 
-  // offsets[7] 141 // c 这个列
-  // offsets[8] 201 // pad 这个列,   201 + offset[2](如果有extra size) 就是整个rec 的大小
-
-  
-  // init offsets array from here
-  // previous code parse the json file
-  memset(offsets_, 0, sizeof(offsets_));
-  offsets_[0] = REC_OFFS_NORMAL_SIZE;
-
-  offsets_[1] = d[1]["object"]["dd_object"]["columns"].Size();
-  // TODO: init extra size
-  offsets_[2] = 0;
-
-  dict_cols.resize(REC_OFFS_NORMAL_SIZE);
-  dict_cols[3].col_name = d[1]["object"]["dd_object"]["columns"][0]["name"].GetString();
-  dict_cols[3].column_type_utf8 = d[1]["object"]["dd_object"]["columns"][0]["column_type_utf8"].GetString();
-  if (dict_cols[3].column_type_utf8 == "int") {
-    offsets_[3] = 4; 
-  } else if (dict_cols[3].column_type_utf8.substr(0, 4) == "char") {
-    offsets_[3] = d[1]["object"]["dd_object"]["columns"][0]["char_length"].GetInt();
-    dict_cols[3].char_length = d[1]["object"]["dd_object"]["columns"][0]["char_length"].GetInt();
-  } else {
-    return -1;
+  Record_cursor cursor(read_buf, *index, kLogicalPageSize);
+  while (cursor.next()) {
+    Json_line line("record");
+    line.add("page_no", page_num);
+    line.add("heap_no", (uint32_t)rec_get_bit_field_2(
+                            cursor.rec(), REC_NEW_HEAP_NO, REC_HEAP_NO_MASK,
+                            REC_HEAP_NO_SHIFT));
+    ut_json_rec_fields(line, schema->table(), *index, cursor.rec(),
+                       cursor.offsets());
   }
-  offsets_[4] = offsets_[3] + 6;
-  offsets_[5] = offsets_[4] + 7;
-
-  for (uint32_t i = 1; i < offsets_[1] - 2; i++) {
-    dict_cols[i + 5].col_name = d[1]["object"]["dd_object"]["columns"][i]["name"].GetString();
-    dict_cols[i + 5].column_type_utf8
-      = d[1]["object"]["dd_object"]["columns"][i]["column_type_utf8"].GetString();
-    if (dict_cols[i + 5].column_type_utf8 == "int") {
-      offsets_[i + 5] = offsets_[i + 4] + 4;
-      dict_cols[i + 5].char_length = 4;
-    } else if (dict_cols[i + 5].column_type_utf8.substr(0, 4) == "char") {
-      dict_cols[i + 5].char_length = d[1]["object"]["dd_object"]["columns"][i]["char_length"].GetInt();
-      offsets_[i + 5] = offsets_[i + 4] + d[1]["object"]["dd_object"]["columns"][i]["char_length"].GetInt();
-    } else {
-      return -1;
-    }
-  }
-  return 0;
 }
 
-void ShowRecord(rec_t *rec) {
-  ulint heap_no = rec_get_bit_field_2(rec, REC_NEW_HEAP_NO, REC_HEAP_NO_MASK, REC_HEAP_NO_SHIFT);
-  printf("heap no %u\n", heap_no);
-  printf("rec status %u\n", rec_get_status(rec));
-
-  if (rec_get_status(rec) >= 2 || heap_no == 1) return;
-
-  ulint is_delete = rec_get_bit_field_1(rec, REC_NEW_INFO_BITS, REC_INFO_DELETED_FLAG,
-                                      REC_INFO_BITS_SHIFT);
-  ulint is_min_record = rec_get_bit_field_1(rec, REC_NEW_INFO_BITS, REC_INFO_MIN_REC_FLAG,
-                                      REC_INFO_BITS_SHIFT);
-  
-  printf("Info Flags: is_deleted %d is_min_record %d\n", is_delete, is_min_record); 
-
-  printf("%s: ", dict_cols[3].col_name.c_str());
-  if (dict_cols[3].column_type_utf8 == "int") {
-    printf("%u ", (mach_read_from_4(rec) ^ 0x80000000));
-  } else {
-    printf("%.*s", dict_cols[3].char_length, rec);
+/** Prints the user records of the leaf page in read_buf, one line per
+record with the columns decoded by the table definition of -s; records
+marked deleted are skipped */
+static void ShowRecords(uint32_t page_num) {
+  const Schema *schema = TableSchema();
+  if (schema == nullptr) {
+    printf("Records are decoded with a valid sdi file, -s\n");
+    return;
+  }
+  uint64_t index_id = mach_read_from_8(read_buf + PAGE_HEADER + PAGE_INDEX_ID);
+  const dict_index_t *index = schema->index_by_id(index_id);
+  if (index == nullptr ||
+      !(page_header_get_field(read_buf, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+    printf("Page %u is not a compact page of an index of the sdi\n",
+           page_num);
+    return;
   }
-  printf("\n");
 
-  for (uint32_t i = 1; i < offsets_[1] - 2; i++) {
-    printf("%s: ", dict_cols[i + 5].col_name.c_str());
-    if (dict_cols[i + 5].column_type_utf8 == "int") {
-      printf("%u ", (mach_read_from_4(rec + offsets_[i + 4]) ^ 0x80000000));
-    } else {
-      printf("%.*s", dict_cols[i + 5].char_length, rec + offsets_[i + 4]);
+  const dict_table_t &table = schema->table();
+  Record_cursor cursor(read_buf, *index, kLogicalPageSize);
+  std::string value;
+  while (cursor.next()) {
+    printf("heap no %u:", (uint32_t)rec_get_bit_field_2(
+                              cursor.rec(), REC_NEW_HEAP_NO,
+                              REC_HEAP_NO_MASK, REC_HEAP_NO_SHIFT));
+    for (ulint i = 0; i < index->fields.size(); i++) {
+      const dict_col_t &col = table.cols[index->fields[i].col_no];
+      if (col.hidden == DD_HIDDEN_SE) {
+        continue;
+      }
+      ulint len;
+      const byte *data = cursor.field(i, &len);
+      if (len != UNIV_SQL_NULL && cursor.is_extern(i)) {
+        value = "<off-page>";
+      } else {
+        rec_field_to_string(col, data, len, &value);
+      }
+      printf(" %s=%s", col.name.c_str(), value.c_str());
     }
     printf("\n");
   }
-
 }
 
+/** Prints the page header of the index page in read_buf as a JSON line */
+static void ShowIndexHeaderJson(uint32_t page_num) {
+  Json_line line("index_header");
+  line.add("page_no", page_num);
+  line.add("n_dir_slots", mach_read_from_2(read_buf + PAGE_HEADER));
+  line.add("garbage", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_GARBAGE));
+  line.add("n_heap", page_dir_get_n_heap(read_buf));
+  line.add("n_recs", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_N_RECS));
+  line.add("max_trx_id", mach_read_from_8(read_buf + PAGE_HEADER + PAGE_MAX_TRX_ID));
+  line.add("level", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
+  line.add("index_id", mach_read_from_8(read_buf + PAGE_HEADER + PAGE_INDEX_ID));
 
-// void ShowCompressInfo(uint32_t page_num) {
-  
-
-// }
+  bool has_symbol_table = (page_header_get_field(read_buf, PAGE_N_HEAP) & PAGE_HAS_SYMBOL_TABLE);
+  byte *base_ptr = read_buf + PAGE_NEW_SUPREMUM_END;
+  if (has_symbol_table &&
+      mach_read_from_1(base_ptr + PAGE_SYMBOL_TABLE_MAGIC) ==
+          PAGE_SYMBOL_TABLE_HEADER_MAGIC) {
+    Json_writer &w = line.writer();
+    w.Key("symbol_table");
+    w.StartObject();
+    line.add("base_type", (uint32_t)mach_read_from_1(base_ptr + PAGE_SYMBOL_TABLE_TYPE));
+    line.add("n_bytes", mach_read_from_2(base_ptr + PAGE_SYMBOL_TABLE_N_BYTES));
+    line.add("n_slots", (uint32_t)mach_read_from_1(base_ptr + PAGE_SYMBOL_TABLE_N_SLOTS));
+    w.EndObject();
+  }
+}
 
 void ShowIndexHeader(uint32_t page_num, bool is_show_records) {
+  if (ut_format_is_json()) {
+    if (ReadIndexPage(page_num) == -1) {
+      ShowJsonError("ShowIndexHeader", page_num, "read error");
+      return;
+    }
+    ShowIndexHeaderJson(page_num);
+    if (is_show_records &&
+        mach_read_from_2(read_buf + FIL_PAGE_TYPE) == FIL_PAGE_INDEX &&
+        page_is_leaf(read_buf)) {
+      ShowRecordsJson(page_num);
+    }
+    return;
+  }
   printf("Index Header:\n");
-  uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadIndexPage(page_num);
 
   if (ret == -1) {
     printf("ShowIndexHeader read error %d, is_show_records %d\n",
@@ -293,9 +435,21 @@ void ShowIndexHeader(uint32_t page_num, bool is_show_records) {
     uint16_t prev_page_base_offset = mach_read_from_2(base_ptr + 
             PAGE_SYMBOL_TABLE_HEADER_SIZE);
     printf("slot %d, offset %hu, data ", 0, prev_page_base_offset);
+    /* the offsets come from the page: each slot must end after the one
+    before it and inside the page */
+    auto slot_is_valid = [&](uint16_t end) {
+      return end >= prev_page_base_offset &&
+             page_range_is_valid(PAGE_NEW_SUPREMUM_END + prev_page_base_offset,
+                                 end - prev_page_base_offset,
+                                 kLogicalPageSize);
+    };
     for (int i = 1; i < n_slots; i++) {
       uint16_t slot_i_offset = mach_read_from_2(base_ptr + 
             PAGE_SYMBOL_TABLE_HEADER_SIZE + i * PAGE_SYMBOL_TABLE_SLOT_SIZE);
+      if (!slot_is_valid(slot_i_offset)) {
+        printf("\nslot %d, offset %hu is out of the page\n", i, slot_i_offset);
+        return;
+      }
       for (uint16_t j = 0; j < (slot_i_offset - prev_page_base_offset); j++) {
         printf("%c",mach_read_from_1(base_ptr + prev_page_base_offset + j));
       }
@@ -304,6 +458,10 @@ void ShowIndexHeader(uint32_t page_num, bool is_show_records) {
       printf("slot %d, size %hu, data ", i, slot_i_offset);
     }
 
+    if (!slot_is_valid(n_bytes)) {
+      printf("\nn_bytes %hu is out of the page\n", n_bytes);
+      return;
+    }
     for (uint16_t j = 0; j < (n_bytes - prev_page_base_offset); j++) {
       printf("%c",mach_read_from_1(base_ptr + prev_page_base_offset + j));
     }
@@ -315,42 +473,27 @@ void ShowIndexHeader(uint32_t page_num, bool is_show_records) {
     return;
   }
   
-  rec_init_offsets();
-  byte *rec_ptr = read_buf + PAGE_NEW_INFIMUM;
-  // printf("page_rec_is_infimum_low %d page_rec_is_supremum_low %d\n", page_rec_is_infimum_low(PAGE_NEW_INFIMUM), page_rec_is_supremum_low(PAGE_NEW_SUPREMUM));
-  // printf("infimum %d\n", PAGE_NEW_INFIMUM);
-  // printf("supremum %d\n", PAGE_NEW_SUPREMUM);
-  return ;
-  while (1) {
-    printf("\n");
-    // offset from previous record
-    ulint off = mach_read_from_2(rec_ptr - REC_NEXT); 
-    // off = (((ulong)((rec_ptr + off))) & (UNIV_PAGE_SIZE - 1));
-    printf("offset from previous record %hu\n", off);
-    // off can't be negative, if the next record is less than current record
-    // the rec_ptr + off will > 16kb
-    // and the result & (UNIV_PAGE_SIZE - 1) will be less then current position
-    // after this, off is offset inside page offset
-    off = (((ulong)((rec_ptr + off))) & (UNIV_PAGE_SIZE - 1));
-    printf("offset inside page %hu\n", off);
-    // handle supremum
-    // https://raw.githubusercontent.com/baotiao/bb/main/uPic/image-20211212031146188.png
-    // off == 0 mean this is SUPREMUM record
-    if (page_rec_is_supremum_low(off)) {
-      break;
+  /* the record list is checked, not followed blindly: a corrupt page is
+  reported and the scan goes on */
+  static Page_rec_check rec_check;
+  page_check_t check = rec_check.check(read_buf, kLogicalPageSize);
+  if (check == PAGE_CHECK_OK) {
+    printf("Record list: %u records\n", rec_check.n_recs());
+    if (page_is_leaf(read_buf)) {
+      ShowRecords(page_num);
     }
-    rec_ptr = read_buf + off;
-    ShowRecord(rec_ptr);
-    printf("\n");
+  } else {
+    printf("Record list broken after %u records at offset %u: %s\n",
+           rec_check.n_recs(), rec_check.bad_offset(),
+           page_check_name(check));
   }
-
 }
 
 void ShowBlobHeader(uint32_t page_num) {
   printf("BLOB Header:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
     printf("ShowBlobHeader read error %d\n", ret);
@@ -365,7 +508,7 @@ void ShowBlobFirstPage(uint32_t page_num) {
   printf("BLOB First Page:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
     printf("ShowBlobFirstPage read error %d\n", ret);
@@ -383,7 +526,7 @@ void ShowBlobIndexPage(uint32_t page_num) {
   printf("BLOB Index Page:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
     printf("ShowBlobIndexPage read error %d\n", ret);
@@ -397,7 +540,7 @@ void ShowBlobDataPage(uint32_t page_num) {
   printf("BLOB Data Page:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
     printf("ShowBlobDataPage read error %d\n", ret);
@@ -410,49 +553,45 @@ void ShowBlobDataPage(uint32_t page_num) {
 }
 
 void ShowUndoPageHeader(uint32_t page_num) {
-  printf("Undo Page Header:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
+    printf("Undo Page Header:\n");
     printf("ShowUndoPageHeader read error %d\n", ret);
     return;
   }
 
-  /** Print undo page Header. */
-  printf("## Page Type enum:[1:insert; 2:update]\n");
-  printf("Undo page type: %u\n", mach_read_from_2(read_buf + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_TYPE));
-  printf("Latest undo log rec offset on this undo page: %u\n", mach_read_from_2(read_buf + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_START));
-  printf("First free byte offset on this undo page: %u\n", mach_read_from_2(read_buf + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_FREE));
-
-  fil_addr_t prev_undo_page_node = flst_get_prev_addr(read_buf + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE);
-  fil_addr_t next_undo_page_node = flst_get_next_addr(read_buf + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE);
-  printf("Prev undo page node[%u, %u]\n", prev_undo_page_node.boffset, prev_undo_page_node.page);
-  printf("Next undo page node[%u, %u]\n\n", next_undo_page_node.boffset, next_undo_page_node.page);
-
-  /** Print undo segment header. */
-  printf("## Undo state enum:[1:active; 2:cached; 3:free; 4:to purge; 5:preapred]\n");
-  printf("Undo state on this undo page: %u\n", mach_read_from_2(read_buf + TRX_UNDO_SEG_HDR + TRX_UNDO_STATE));
-  printf("Offset of last undo log header on this undo page: %u\n", mach_read_from_2(read_buf + TRX_UNDO_SEG_HDR + TRX_UNDO_LAST_LOG));
-
+  std::string out;
+  trx_undo_format_page_header(&out, read_buf);
+  fputs(out.c_str(), stdout);
 }
 
 void ShowRsegArray(uint32_t page_num, uint32_t* rseg_array = nullptr) {
-  ut_a(page_num == FSP_RSEG_ARRAY_PAGE_NO);
-
   printf("Rsegs Array:\n");
+  /* a page of this type elsewhere is garbage, reported and skipped */
+  if (page_num != FSP_RSEG_ARRAY_PAGE_NO) {
+    printf("ShowRsegArray page %u is not the rseg array page %u\n", page_num,
+           FSP_RSEG_ARRAY_PAGE_NO);
+    return;
+  }
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
 
   if (ret == -1) {
     printf("ShowRsegArray read error %d\n", ret);
     return;
   }
 
-  ut_a(RSEG_ARRAY_VERSION ==
-        mach_read_from_4(read_buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_VERSION_OFFSET));
+  uint32_t version =
+      mach_read_from_4(read_buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_VERSION_OFFSET);
+  if (version != RSEG_ARRAY_VERSION) {
+    printf("ShowRsegArray unknown version %u, page %u is corrupt\n", version,
+           page_num);
+    return;
+  }
 
   printf("Rsegs dict size: %u\n", mach_read_from_4(read_buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_SIZE_OFFSET));
 
@@ -469,7 +608,7 @@ void ShowRsegArray(uint32_t page_num, uint32_t* rseg_array = nullptr) {
 
 void ShowFile() {
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   if (ret == -1) {
     printf("ShowFile read error %d\n", ret);
     return;
@@ -478,6 +617,7 @@ void ShowFile() {
 
   int block_num = stat_buf.st_size / kPageSize;
   uint16_t type = 0;
+  UncachedReads uncached;
   for (int i = 0; i < block_num; i++) {
     ShowFILHeader(i, &type);
     if (type == FIL_PAGE_TYPE_BLOB) {
@@ -498,116 +638,31 @@ void ShowFile() {
   }
 }
 
-void ShowUndoLogHdr(uint32_t page_num, uint32_t page_offset)
-{
-  uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
-
-  int ret = pread(fd, read_buf, kPageSize, offset);
-
-  if (ret == -1)
-  {
-    printf("ShowUndoLogHdr read error %d\n", ret);
-    return;
-  }
-
-  byte *undo_log_hdr = read_buf + page_offset;
-
-  printf("trx id: %lu\n", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_ID));
-  printf("trx no: %lu\n", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_NO));
-  printf("del marks: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_DEL_MARKS));
-  printf("undo log start: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_LOG_START));
-  printf("next undo log header: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_NEXT_LOG));
-  printf("prev undo log header: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_PREV_LOG));
-}
-
-void ShowUndoRseg(uint32_t rseg_id, uint32_t page_num)
-{
-  printf("==========================Rollback Segment==========================\n");
-
-  uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
-
-  int ret = pread(fd, read_buf, kPageSize, offset);
-
-  if (ret == -1)
-  {
-    printf("ShowUndoRseg read error %d\n", ret);
-    return;
-  }
-
-  byte *rseg_header = TRX_RSEG + read_buf;
-
-  printf("Rseg %u's max size: %u\n", rseg_id,
-         mach_read_from_4(rseg_header + TRX_RSEG_MAX_SIZE));
-  printf("Rseg %u's history list page size: %u\n", rseg_id,
-         mach_read_from_4(rseg_header + TRX_RSEG_HISTORY_SIZE));
-  printf("Rseg %u's history list size: %u\n", rseg_id,
-         flst_get_len(rseg_header + TRX_RSEG_HISTORY));
-
-  fil_addr_t last_trx = flst_get_last(rseg_header + TRX_RSEG_HISTORY);
-  last_trx.boffset -= TRX_UNDO_HISTORY_NODE;
-
-  printf("Rseg %u's last page no: %u\n", rseg_id,
-         last_trx.page);
-  printf("Rseg %u's last offset: %u\n", rseg_id,
-         last_trx.boffset);
-
-  if (last_trx.page == FIL_NULL)
-  {
-    return;
-  }
-
-  uint16_t type = 0;
-  ShowFILHeader(last_trx.page, &type);
-  ShowUndoPageHeader(last_trx.page);
-  printf("-------------------last undo log header---------------------\n");
-  ShowUndoLogHdr(last_trx.page, last_trx.boffset);
-}
-
-void ShowUndoFile() {
-  struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
-  if (ret == -1)
-  {
-    printf("ShowUndoFile read error %d\n", ret);
-    return;
-  }
-  int block_num = stat_buf.st_size / kPageSize;
-  printf("Undo File size %ld, blocks %d\n", stat_buf.st_size, block_num);
-
-  uint32_t rseg_array[TRX_SYS_N_RSEGS];
-  uint16_t type = 0;
-  ShowFILHeader(FSP_RSEG_ARRAY_PAGE_NO, &type);
-  ShowRsegArray(FSP_RSEG_ARRAY_PAGE_NO, rseg_array);
-
-  for (size_t slot = 0; slot < TRX_SYS_N_RSEGS; slot++)
-  {
-    printf("\n-------------------rseg %lu's info-----------------------\n", slot);
-    ShowFILHeader(rseg_array[slot], &type);
-    ShowUndoRseg(slot, rseg_array[slot]);
-  }
-}
-
 void UpdateCheckSum(uint32_t page_num) {
   printf("==========================DeletePage==========================\n");
+  if (is_compressed) {
+    printf("UpdateCheckSum is not supported on compressed tablespaces\n");
+    return;
+  }
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
     printf("UpdateCheckSum read error %d\n", ret);
     return;
   }
   printf("CheckSum: %u\n", mach_read_from_4(read_buf));
 
-  uint32_t cc = buf_calc_page_crc32(read_buf, 0);
+  uint32_t cc = buf_calc_page_crc32(read_buf, 0, kLogicalPageSize);
   printf("crc %u\n", cc);
   mach_write_to_4(read_buf, cc);
-  mach_write_to_4(read_buf + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM, cc);
-  ret = pwrite(fd, read_buf, kPageSize, offset);
+  mach_write_to_4(read_buf + kLogicalPageSize - FIL_PAGE_END_LSN_OLD_CHKSUM, cc);
+  ret = WritePage(read_buf, offset);
   printf("UpdateCheckSum %u\n", ret);
 }
 
 static uint32_t find_prev_page(uint32_t page_num) {
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   if (ret == -1) {
     printf("ShowFile read error %d\n", ret);
     return 0;
@@ -616,9 +671,10 @@ static uint32_t find_prev_page(uint32_t page_num) {
 
   uint64_t offset = 0;
   uint32_t next_page;
+  UncachedReads uncached;
   for (int i = 0; i < block_num; i++) {
     offset = (uint64_t)kPageSize * (uint64_t)i;
-    ret = pread(fd, read_buf, kPageSize, offset);
+    ret = ReadPage(read_buf, offset);
     next_page = mach_read_from_4(read_buf + FIL_PAGE_NEXT);
     if (next_page == page_num) {
       return i;
@@ -629,7 +685,7 @@ static uint32_t find_prev_page(uint32_t page_num) {
 
 static uint32_t find_next_page(uint32_t page_num) {
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   if (ret == -1) {
     printf("ShowFile read error %d\n", ret);
     return 0;
@@ -638,9 +694,10 @@ static uint32_t find_next_page(uint32_t page_num) {
 
   uint64_t offset = 0;
   uint32_t prev_page;
+  UncachedReads uncached;
   for (int i = 0; i < block_num; i++) {
     offset = (uint64_t)kPageSize * (uint64_t)i;
-    ret = pread(fd, read_buf, kPageSize, offset);
+    ret = ReadPage(read_buf, offset);
     prev_page = mach_read_from_4(read_buf + FIL_PAGE_PREV);
     if (prev_page == page_num) {
       return i;
@@ -651,9 +708,13 @@ static uint32_t find_next_page(uint32_t page_num) {
 
 void DeletePage(uint32_t page_num) {
   printf("==========================DeletePage==========================\n");
+  if (is_compressed) {
+    printf("DeletePage is not supported on compressed tablespaces\n");
+    return;
+  }
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)page_num;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
     printf("DeletePage read error %d\n", ret);
     return;
@@ -661,10 +722,10 @@ void DeletePage(uint32_t page_num) {
 
   printf("CheckSum: %u\n", mach_read_from_4(read_buf));
 
-  uint32_t cc = buf_calc_page_crc32(read_buf, 0);
+  uint32_t cc = buf_calc_page_crc32(read_buf, 0, kLogicalPageSize);
   printf("crc %u\n", cc);
-  byte prev_buf[16 * 1024];
-  byte next_buf[16 * 1024];
+  byte prev_buf[UNIV_PAGE_SIZE_MAX];
+  byte next_buf[UNIV_PAGE_SIZE_MAX];
   uint32_t prev_page = 0, next_page = 0;
   // prev_page = mach_read_from_4(read_buf + FIL_PAGE_PREV);
   // next_page = mach_read_from_4(read_buf + FIL_PAGE_NEXT);
@@ -677,8 +738,8 @@ void DeletePage(uint32_t page_num) {
 
   uint64_t prev_offset = (uint64_t)kPageSize * (uint64_t)prev_page;
   uint64_t next_offset = (uint64_t)kPageSize * (uint64_t)next_page;
-  pread(fd, prev_buf, kPageSize, prev_offset);
-  pread(fd, next_buf, kPageSize, next_offset);
+  ReadPage(prev_buf, prev_offset);
+  ReadPage(next_buf, next_offset);
 
 
   printf("prev_page %u next_page %u\n", prev_page, next_page);
@@ -686,22 +747,22 @@ void DeletePage(uint32_t page_num) {
   mach_write_to_4(prev_buf + FIL_PAGE_NEXT, next_page);
   mach_write_to_4(next_buf + FIL_PAGE_PREV, prev_page);
 
-  uint32_t prev_cc = buf_calc_page_crc32(prev_buf, 0);
-  uint32_t next_cc = buf_calc_page_crc32(next_buf, 0);
+  uint32_t prev_cc = buf_calc_page_crc32(prev_buf, 0, kLogicalPageSize);
+  uint32_t next_cc = buf_calc_page_crc32(next_buf, 0, kLogicalPageSize);
 
   mach_write_to_4(prev_buf, prev_cc);
   mach_write_to_4(next_buf, next_cc);
 
-  mach_write_to_4(prev_buf + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
+  mach_write_to_4(prev_buf + kLogicalPageSize - FIL_PAGE_END_LSN_OLD_CHKSUM,
       prev_cc);
 
-  mach_write_to_4(next_buf + UNIV_PAGE_SIZE - FIL_PAGE_END_LSN_OLD_CHKSUM,
+  mach_write_to_4(next_buf + kLogicalPageSize - FIL_PAGE_END_LSN_OLD_CHKSUM,
       next_cc);
 
-  ret = pwrite(fd, prev_buf, kPageSize, prev_offset);
+  ret = WritePage(prev_buf, prev_offset);
   printf("Delete prev page ret %u\n", ret);
 
-  ret = pwrite(fd, next_buf, kPageSize, next_offset);
+  ret = WritePage(next_buf, next_offset);
   printf("Delete next page ret %u\n", ret);
 
 }
@@ -711,7 +772,7 @@ void ShowExtent()
   printf("==========================extents==========================\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)0;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
     printf("ShowExtent read error %d\n", ret);
   }
@@ -741,98 +802,99 @@ void ShowExtent()
 }
 
 void PrintPageType(page_type_t page_type) {
-  const char *str_type;
-  if (page_type == FIL_PAGE_INDEX) {
-    str_type = "INDEX PAGE";
-  } else if (page_type == FIL_PAGE_RTREE) {
-    str_type = "RTREE PAGE";
-  } else if (page_type == FIL_PAGE_SDI) {
-    str_type = "SDI INDEX PAGE";
-  } else if (page_type == FIL_PAGE_UNDO_LOG) {
-    str_type = "UNDO LOG PAGE";
-  } else if (page_type == FIL_PAGE_INODE) {
-    str_type = "INDEX NODE PAGE";
-  } else if (page_type == FIL_PAGE_IBUF_FREE_LIST) {
-    str_type = "INSERT BUFFER FREE LIST";
-  } else if (page_type == FIL_PAGE_TYPE_ALLOCATED) {
-    str_type = "FRESHLY ALLOCATED PAGE";
-  } else if (page_type == FIL_PAGE_IBUF_BITMAP ) {
-    str_type = "INSERT BUFFER BITMAP";
-  } else if (page_type == FIL_PAGE_TYPE_SYS) {
-    str_type = "SYSTEM PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_TRX_SYS) {
-    str_type = "TRX SYSTEM PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_FSP_HDR) {
-    str_type = "FSP HDR";
-  } else if (page_type == FIL_PAGE_TYPE_XDES) {
-    str_type = "XDES";
-  } else if (page_type == FIL_PAGE_TYPE_BLOB) {
-    str_type = "UNCOMPRESSED BLOB PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_ZBLOB) {
-    str_type = "FIRST COMPRESSED BLOB PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_ZBLOB2) {
-    str_type = "SUBSEQUENT FRESHLY ALLOCATED PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_UNKNOWN) {
-    str_type = "UNDO TYPE PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_LOB_FIRST) {
-    str_type = "FIRST PAGE OF UNCOMPRESSED BLOB PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_LOB_INDEX) {
-    str_type = "INDEX PAGE OF UNCOMPRESSED BLOB PAGE";
-  } else if (page_type == FIL_PAGE_TYPE_LOB_DATA) {
-    str_type = "DATA PAGE OF UNCOMPRESSED BLOB PAGE";
-  } else {
-    str_type = "ERROR";
+  printf("%s", fil_get_page_type_str(page_type));
+}
+
+/** Prints a run of pages of one type */
+static void PrintPageTypeRun(int st, int ed, int cnt, page_type_t page_type) {
+  if (ut_format_is_json()) {
+    Json_line line("page_type_run");
+    line.add("first_page", st);
+    line.add("last_page", ed);
+    line.add("count", cnt);
+    line.add("page_type", page_type);
+    line.add("page_type_name", fil_get_page_type_str(page_type));
+    return;
   }
-  printf("%s", str_type);
-  
+  printf("%d\t\t%d\t\t%d\t\t", st, ed, cnt);
+  PrintPageType(page_type);
+  printf("\n");
 }
 
 void ShowSpacePageType() {
-  printf("==========================space page type==========================\n");
+  bool is_json = ut_format_is_json();
+  if (!is_json) {
+    printf("==========================space page type==========================\n");
+  }
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   if (ret == -1) {
     printf("ShowFile read error %d\n", ret);
     return ;
   }
-  printf("File size %lu\n", stat_buf.st_size);
+  if (!is_json) {
+    printf("File size %lu\n", stat_buf.st_size);
+  }
 
   int block_num = stat_buf.st_size / kPageSize;
 
-  int st = 0, ed = 0, cnt = 0;
+  int st = 0, ed = 0;
 
-  printf("start\t\tend\t\tcount\t\ttype\n");
-  uint64_t offset = 0;
-  page_type_t page_type = 0, prev_page_type = 0;
-  for (int i = 0; i < block_num; i++) {
-    cnt++;
-    offset = (uint64_t)kPageSize * (uint64_t)i;
-    ret = pread(fd, read_buf, kPageSize, offset);
-    page_type = fil_page_get_type(read_buf);
-    if (i == 0) {
-      prev_page_type = page_type;
-    } else if (page_type != prev_page_type) {
-      ed = i - 1;
-      printf("%d\t\t%d\t\t%d\t\t", st, ed, ed - st + 1);
-      PrintPageType(prev_page_type);
-      printf("\n");
-      prev_page_type = page_type;
-      st = i;
-      cnt = 0;
-    }
+  if (!is_json) {
+    printf("start\t\tend\t\tcount\t\ttype\n");
   }
+  page_type_t prev_page_type = 0;
+  // one thread visits the pages in order, as they are in the file
+  fil_scan_parallel(
+      fd, page_size, 0, block_num, 1,
+      [&](uint32_t, page_no_t i, const byte *page) {
+        page_type_t page_type = fil_page_get_type(page);
+        if (i == 0) {
+          prev_page_type = page_type;
+        } else if (page_type != prev_page_type) {
+          ed = i - 1;
+          PrintPageTypeRun(st, ed, ed - st + 1, prev_page_type);
+          prev_page_type = page_type;
+          st = i;
+        }
+      },
+      false);
   // printf last page blocks
   ed = block_num - 1;
-  printf("%d\t\t%d\t\t%d\t\t", st, ed, cnt);
-  PrintPageType(prev_page_type);
-  printf("\n");
+  PrintPageTypeRun(st, ed, ed - st + 1, prev_page_type);
+}
+
+/** Prints the space header of page 0 in read_buf as a JSON line */
+static void ShowSpaceHeaderJson() {
+  struct stat stat_buf;
+  fsp_header_t *header = FSP_HEADER_OFFSET + read_buf;
+  Json_line line("space_header");
+  line.add("path", path);
+  if (fil_space_stat(fd, &stat_buf) == 0) {
+    line.add("file_size", (uint64_t)stat_buf.st_size);
+  }
+  line.add("page_size", page_size.physical());
+  line.add("logical_page_size", page_size.logical());
+  line.add("space_id", mach_read_from_4(header + FSP_SPACE_ID));
+  line.add("size", mach_read_from_4(header + FSP_SIZE));
+  line.add("free_limit", mach_read_from_4(header + FSP_FREE_LIMIT));
+  line.add("frag_n_used", mach_read_from_4(header + FSP_FRAG_N_USED));
+  line.add("next_seg_id", mach_read_from_8(header + FSP_SEG_ID));
 }
 
 void ShowSpaceHeader() {
+  if (ut_format_is_json()) {
+    if (ReadPage(read_buf, 0) == -1) {
+      ShowJsonError("ShowSpaceHeader", 0, "read error");
+      return;
+    }
+    ShowSpaceHeaderJson();
+    return;
+  }
   printf("==========================Space Header==========================\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)0;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
     printf("ShowSpaceHeader read error %d\n", ret);
     return;
@@ -846,6 +908,7 @@ void ShowSpaceHeader() {
   printf("Free limit Page Number: %u\n", mach_read_from_4(header + FSP_FREE_LIMIT));
   printf("FREE_FRAG page number: %u\n", mach_read_from_4(header + FSP_FRAG_N_USED));
   printf("Next Seg ID: %lu\n", mach_read_from_8(header + FSP_SEG_ID));
+  fil_space_print_files(fd);
 
 }
 /** Checks a file segment header within a B-tree root page.
@@ -857,7 +920,7 @@ static bool btr_root_fseg_validate(
   ulint offset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET);
 
   if (mach_read_from_4(seg_header + FSEG_HDR_SPACE) == space && 
-      offset >= FIL_PAGE_DATA && (offset <= UNIV_PAGE_SIZE - FIL_PAGE_DATA_END)) {
+      offset >= FIL_PAGE_DATA && (offset <= kLogicalPageSize - FIL_PAGE_DATA_END)) {
     return true;
   }
   return false;
@@ -899,7 +962,7 @@ static ulint fseg_n_reserved_pages_low(space_id_t space_id,
 
   /* total number of segment pages in the FSEG_NOT_FULL list */
   ulint n_total_not_full =
-      FSP_EXTENT_SIZE * mach_read_from_4(inode + FSEG_NOT_FULL);
+      FSP_EXTENT_SIZE_OF(kLogicalPageSize) * mach_read_from_4(inode + FSEG_NOT_FULL);
 
   /* n_used can be zero only if n_total is zero. */
   ut_ad(n_used_not_full > 0 || n_total_not_full == 0);
@@ -907,10 +970,10 @@ static ulint fseg_n_reserved_pages_low(space_id_t space_id,
         ((n_used_not_full == 0) && (n_total_not_full == 0)));
 
   /* total number of pages in FSEG_FULL list. */
-  ulint n_total_full = FSP_EXTENT_SIZE * mach_read_from_4(inode + FSEG_FULL + FLST_LEN);
+  ulint n_total_full = FSP_EXTENT_SIZE_OF(kLogicalPageSize) * mach_read_from_4(inode + FSEG_FULL + FLST_LEN);
 
   /* total number of pages in FSEG_FREE list. */
-  ulint n_total_free = FSP_EXTENT_SIZE * flst_get_len(inode + FSEG_FREE);
+  ulint n_total_free = FSP_EXTENT_SIZE_OF(kLogicalPageSize) * flst_get_len(inode + FSEG_FREE);
 
   /* Number of fragment pages in the segment. */
   ulint n_frags = fseg_get_n_frag_pages(inode);
@@ -925,9 +988,11 @@ static ulint fseg_n_reserved_pages_low(space_id_t space_id,
   return (ret);
 }
 
-/** Writes info of a segment. */
+/** Writes info of a segment, as a member of a JSON line if json is not
+nullptr. */
 static void fseg_print_low(space_id_t space_id,
-                           fseg_inode_t *inode, uint32_t &free_page) /*!< in: segment inode */
+                           fseg_inode_t *inode, uint32_t &free_page, /*!< in: segment inode */
+                           Json_line *json = nullptr)
 {
   space_id_t space;
   // ulint n_used;
@@ -941,7 +1006,7 @@ static void fseg_print_low(space_id_t space_id,
   uint64_t seg_id;
   File_segment_inode fseg_inode(space_id, inode);
 
-  space = page_get_space_id(align_page(inode));
+  space = page_get_space_id(align_page(inode, kPageSize));
   // page_no = page_get_page_no(align_page(inode));
 
   reserved = fseg_n_reserved_pages_low(space_id, inode, &used);
@@ -954,6 +1019,22 @@ static void fseg_print_low(space_id_t space_id,
   n_not_full = flst_get_len(inode + FSEG_NOT_FULL);
   n_full = flst_get_len(inode + FSEG_FULL);
 
+  free_page = reserved - used;
+  if (json != nullptr) {
+    Json_writer &w = json->writer();
+    w.StartObject();
+    json->add("seg_id", seg_id);
+    json->add("space_id", space);
+    json->add("n_full_extents", n_full);
+    json->add("n_free_extents", n_free);
+    json->add("n_not_full_extents", n_not_full);
+    json->add("reserved_pages", reserved);
+    json->add("used_pages", used);
+    json->add("free_pages", reserved - used);
+    w.EndObject();
+    return;
+  }
+
   printf("SEGMENT id %lu, space id %u\n", seg_id, space);
   printf("Extents information:\n");
   printf("FULL extent list size %u\n", n_full);
@@ -978,7 +1059,7 @@ void ShowLeafSegment() {
   ut_set_leaf_segment_callback_for_swat();
 
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   int block = stat_buf.st_size / kPageSize;
   int space_id;
   int segment_page, segment_offset, segment_space_id;
@@ -1000,18 +1081,24 @@ void ShowLeafSegment() {
     if (inode_list_node.first == FIL_NULL &&
         inode_list_node.second + XDES_FLST_NODE)
       return nullptr;
+    if (inode_list_node.first >= (ulint)block ||
+        !page_range_is_valid(inode_list_node.second,
+                             XDES_SIZE_OF(kLogicalPageSize),
+                             kLogicalPageSize)) {
+      throw std::logic_error("XDES entry out of the file");
+    }
 
-    pread(fd, read_buf, kPageSize, inode_list_node.first * kPageSize);
-    int xdes_length = XDES_SIZE * sizeof(char);
+    ReadPage(read_buf, inode_list_node.first * kPageSize);
+    int xdes_length = XDES_SIZE_OF(kLogicalPageSize) * sizeof(char);
     xdes_t *xdes_entry = (xdes_t *) malloc(xdes_length + 1);
-    memcpy((char *) xdes_entry, (char *) read_buf + inode_list_node.second, XDES_SIZE);
+    memcpy((char *) xdes_entry, (char *) read_buf + inode_list_node.second, XDES_SIZE_OF(kLogicalPageSize));
     
     fprintf(stderr, "INFO: Reading XDES entry from page number: %d, offset: %d\n"
                     "      Range in [%d, %d)\n", 
                     inode_list_node.first,
                     inode_list_node.second,
                     inode_list_node.second,
-                    inode_list_node.second + XDES_SIZE);
+                    inode_list_node.second + XDES_SIZE_OF(kLogicalPageSize));
     int state = mach_read_from_4(xdes_entry + XDES_STATE);
     fprintf(stderr, "INFO: XDES State = %d\n", mach_read_from_4(xdes_entry + XDES_STATE));
     if (fil_page_get_type(read_buf) != FIL_PAGE_TYPE_XDES &&
@@ -1034,7 +1121,7 @@ void ShowLeafSegment() {
                                       uint16_t xdes_offset,    /* IN: xdes_offset indicates the offset of this xdes_entry */
                                       int xdes_length,         /* IN: xdes_length is read from inode entry */
                                       page_array_t &pages) -> void {
-    if (xdes_page_id != FIL_NULL)
+    if (xdes_page_id != FIL_NULL || xdes_entry == nullptr)
       return;
     int xdes_state = mach_read_from_4(xdes_entry + XDES_STATE);
     int i = 0;
@@ -1045,33 +1132,34 @@ void ShowLeafSegment() {
     ulint32_t xdes_prev_page_id;
     uint16_t xdes_prev_offset;
 
-    uint16_t xdes_no = (xdes_offset - XDES_ARR_OFFSET) / XDES_SIZE;
+    uint16_t xdes_no = (xdes_offset - XDES_ARR_OFFSET) / XDES_SIZE_OF(kLogicalPageSize);
     page_loc_t xdes_next = std::make_pair(xdes_page_id, xdes_offset);
     do {
       fprintf(stderr, "INFO: XDES page %d, \n"
                       "      XDES offset: %d, \n"
                       "      page_type: %d\n", xdes_next_page_id, xdes_next_offset, fil_page_get_type(read_buf));
 
-      unsigned char xdes_bitmap[UT_BITS_IN_BYTES(FSP_EXTENT_SIZE * XDES_BITS_PER_PAGE)];
+      // sized for the smallest page size, whose extents have the most pages
+      unsigned char xdes_bitmap[UT_BITS_IN_BYTES(FSP_EXTENT_SIZE_MIN * XDES_BITS_PER_PAGE)];
       /* Don't contain any user record */
       if (xdes_state == XDES_FREE ||
           xdes_state == XDES_FREE_FRAG)
         return;
       /* Parse Bitmap */
       int i = XDES_BITMAP;
-      while (i < XDES_SIZE) {
+      while (i < XDES_SIZE_OF(kLogicalPageSize)) {
         xdes_bitmap[i - XDES_BITMAP] = mach_read_from_1(xdes_entry + i);
         i++;
       }
-      for (int j = 0; j < UT_BITS_IN_BYTES(FSP_EXTENT_SIZE * XDES_BITS_PER_PAGE); j++)
+      for (int j = 0; j < UT_BITS_IN_BYTES(FSP_EXTENT_SIZE_OF(kLogicalPageSize) * XDES_BITS_PER_PAGE); j++)
       {
         unsigned char curr_bitmap = xdes_bitmap[j];
         for (int k = 0; k < 8; k += XDES_BITS_PER_PAGE)
         {
             bool curr_bit1 = (curr_bitmap >> (k + 1)) % 2;
             bool curr_bit2 = (curr_bitmap >> (k)) % 2;
-            int page_id = (j * 8 + k) / XDES_BITS_PER_PAGE + xdes_no * FSP_EXTENT_SIZE + xdes_next_page_id;
-            pread(fd, read_buf, kPageSize, kPageSize * page_id);
+            int page_id = (j * 8 + k) / XDES_BITS_PER_PAGE + xdes_no * FSP_EXTENT_SIZE_OF(kLogicalPageSize) + xdes_next_page_id;
+            ReadPage(read_buf, kPageSize * page_id);
             if (fil_page_get_type(read_buf) == FIL_PAGE_INDEX &&
                 page_is_leaf(read_buf)) {
               if (!curr_bit2)
@@ -1096,13 +1184,13 @@ void ShowLeafSegment() {
       xdes_next_offset = mach_read_from_2(xdes_entry + XDES_FLST_NODE + FIL_ADDR_SIZE + FIL_ADDR_BYTE) - XDES_FLST_NODE;
       xdes_prev_offset = mach_read_from_2(xdes_entry + XDES_FLST_NODE + FIL_ADDR_BYTE) - XDES_FLST_NODE;
       xdes_next = std::make_pair(xdes_next_page_id, xdes_next_offset);
-      xdes_no = (xdes_next_offset - XDES_ARR_OFFSET) / XDES_SIZE;
+      xdes_no = (xdes_next_offset - XDES_ARR_OFFSET) / XDES_SIZE_OF(kLogicalPageSize);
       fprintf(stderr, "INFO: Get next page (%d, %d), prev page (%d, %d)\n",
                       xdes_next_page_id, xdes_next_offset,
                       xdes_prev_page_id, xdes_prev_offset);
       if (xdes_next_page_id == FIL_NULL)
         break;
-      pread(fd, read_buf, kPageSize, kPageSize * xdes_next_page_id);
+      ReadPage(read_buf, kPageSize * xdes_next_page_id);
 
       ulint32_t fil_hdr_checksum = mach_read_from_4(read_buf + FIL_PAGE_SPACE_OR_CHKSUM);
       ulint32_t fil_end_checksum = mach_read_from_4(read_buf + kPageSize - FIL_PAGE_END_LSN_OLD_CHKSUM);
@@ -1117,12 +1205,16 @@ void ShowLeafSegment() {
       }
       /* Calc & check the checksum
        * Assume that use default value of innodb variable innodb_checksum_algorithm (crc32) */
-      ulint32_t calc_checksum = buf_calc_page_crc32(read_buf, 0);
+      ulint32_t calc_checksum = buf_calc_page_crc32(read_buf, 0, kPageSize);
       fprintf(stderr, "INFO: Page %d checksum is %lld,\n"
                       "      Calc checksum is %lld\n", 
                       xdes_next_page_id, fil_hdr_checksum, calc_checksum);
 
-      ut_a(fil_hdr_checksum == calc_checksum);
+      if (fil_hdr_checksum != calc_checksum) {
+        throw std::logic_error("XDES page " +
+                               std::to_string(xdes_next_page_id) +
+                               " fails its checksum");
+      }
 
       free(xdes_entry);
       xdes_entry = get_xdes_from_inode(xdes_next);
@@ -1142,7 +1234,7 @@ void ShowLeafSegment() {
     {
       int page = *it;
       /* Check pages */
-      pread(fd, read_buf, kPageSize, page * kPageSize);
+      ReadPage(read_buf, page * kPageSize);
       level = mach_read_from_2(read_buf + FIL_PAGE_DATA + PAGE_LEVEL);
       if (level != 0) {
         fprintf(stderr, "WARNING: page %d is not leaf, on level: %d\n", page, level);
@@ -1159,12 +1251,15 @@ void ShowLeafSegment() {
       fprintf(stderr, "INFO: page %d has %d records, prev page is %d and next page is %d\n",
               page, page_n_recs, prev_page, next_page);
       /* debug */
-      if (next_page != FIL_NULL && pages.find(next_page) == pages.end())
+      /* links out of the file are not followed */
+      if (next_page != FIL_NULL && next_page >= 0 && next_page < block &&
+          pages.find(next_page) == pages.end())
       {
         pages.insert(next_page);
         fprintf(stderr, "WARNING: get leaf page by scanning b+ tree\n");
       }
-      if (prev_page != FIL_NULL && pages.find(prev_page) == pages.end())
+      if (prev_page != FIL_NULL && prev_page >= 0 && prev_page < block &&
+          pages.find(prev_page) == pages.end())
       {
         pages.insert(prev_page);
         fprintf(stderr, "ERROR: some previous page are ignored\n");
@@ -1180,7 +1275,7 @@ next:
   /* Get root page */
   while (i < block) {
     uint64_t offset = i * kPageSize;
-    pread(fd, read_buf, kPageSize, offset);
+    ReadPage(read_buf, offset);
     int type = fil_page_get_type(read_buf);
     if (i == 0)
         space_id = mach_read_from_4(read_buf + FSP_SPACE_ID);
@@ -1204,7 +1299,11 @@ next:
   fprintf(stderr, "INFO: Get leaf segment inode from page number: %d, page offset: %d\n", segment_page, segment_offset);
 
   /* Get segment Inode */
-  pread(fd, read_buf, kPageSize, segment_page * kPageSize);
+  if (segment_page < 0 || segment_page >= block ||
+      !page_range_is_valid(segment_offset, FSEG_INODE_SIZE, kLogicalPageSize)) {
+    throw std::logic_error("leaf segment inode out of the file");
+  }
+  ReadPage(read_buf, segment_page * kPageSize);
   fseg_inode_t *inode = read_buf + segment_offset;
   inode_segment_id = mach_read_from_8(inode + FSEG_ID);
   inode_magic = mach_read_from_4(inode + FSEG_MAGIC_N);
@@ -1275,13 +1374,14 @@ next:
 
 void ShowIndexSummary() {
   struct stat stat_buf;
-  int ret = fstat(fd, &stat_buf);
+  int ret = fil_space_stat(fd, &stat_buf);
   if (ret == -1) {
     printf("ShowIndexSummary read error %d\n", ret);
     return;
   }
 
   int block_num = stat_buf.st_size / kPageSize;
+  bool is_json = ut_format_is_json();
 
   uint32_t total_free_page = 0;
   uint32_t free_page = 0;
@@ -1290,65 +1390,98 @@ void ShowIndexSummary() {
   
   space_id_t space_id = UINT32_MAX;
   bool is_primary = 0;
-  for (int i = 0; i < block_num; i++) {
-    offset = (uint64_t)kPageSize * (uint64_t)i;
-    ret = pread(fd, read_buf, kPageSize, offset);
-    // fsp header page
-    // get the space id
-    if (i == 0) {
-      space_id = mach_read_from_4(FSP_HEADER_OFFSET + read_buf + FSP_SPACE_ID);
-    }
-    page_type = fil_page_get_type(read_buf);
-    if (page_type == FIL_PAGE_INDEX) {
-      if (btr_root_fseg_validate(FIL_PAGE_DATA + PAGE_BTR_SEG_LEAF + read_buf, space_id)
-          && btr_root_fseg_validate(FIL_PAGE_DATA + PAGE_BTR_SEG_TOP + read_buf, space_id)) {
-        printf("iiiiiiiiiiiiiiiiiiiiiiiiiiii %d\n", i);
-        if (is_primary == 0) {
-          printf("========Primary index========\n");
-          printf("Primary index root page space_id %u page_no %d\n", space_id, i);
-          printf("Btree hight: %hu\n", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
-          is_primary = 1;
-        } else {
-          printf("========Secondary index========\n");
-          printf("Secondary index root page space_id %u page_no %d\n", space_id, i);
-          printf("Btree hight: %hu\n", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
+  // one thread visits the pages in order, decrypted and inflated as
+  // ReadIndexPage() does; pages that can not be are reported at the end
+  fil_scan_parallel(
+      fd, page_size, 0, block_num, 1,
+      [&](uint32_t, page_no_t i, const byte *page) {
+        memcpy(read_buf, page, kLogicalPageSize);
+        // fsp header page
+        // get the space id
+        if (i == 0) {
+          space_id = mach_read_from_4(FSP_HEADER_OFFSET + read_buf + FSP_SPACE_ID);
         }
-
-        printf("<<<Leaf page segment>>>\n");
-        fseg_header_t *seg_header;
-        seg_header = read_buf + PAGE_HEADER + PAGE_BTR_SEG_LEAF;
-        fil_addr_t inode_addr;
-        inode_addr.page = mach_read_from_4(seg_header + FSEG_HDR_PAGE_NO);
-        inode_addr.boffset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET);
-
-        posix_memalign((void**)&inode_page_buf, kPageSize, kPageSize);
-        offset = (uint64_t)kPageSize * (uint64_t)inode_addr.page;
-        ret = pread(fd, inode_page_buf, kPageSize, offset);
-        fseg_inode_t *inode = inode_page_buf + inode_addr.boffset;
-        fseg_print_low(space_id, inode, free_page);
-        total_free_page += free_page;
-
-        inode_addr.page = mach_read_from_4(seg_header + FSEG_HDR_PAGE_NO + FSEG_HEADER_SIZE);
-        inode_addr.boffset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET + FSEG_HEADER_SIZE);
-
-        printf("\n<<<Non-Leaf page segment>>>\n");
-        offset = (uint64_t)kPageSize * (uint64_t)inode_addr.page;
-        ret = pread(fd, inode_page_buf, kPageSize, offset);
-        inode = inode_page_buf + inode_addr.boffset;
-        fseg_print_low(space_id, inode, free_page);
-        total_free_page += free_page;
-
-        free(inode_page_buf);
-        printf("\n");
-      }
-    }
+        page_type = fil_page_get_type(read_buf);
+        if (page_type == FIL_PAGE_INDEX) {
+          if (btr_root_fseg_validate(FIL_PAGE_DATA + PAGE_BTR_SEG_LEAF + read_buf, space_id)
+              && btr_root_fseg_validate(FIL_PAGE_DATA + PAGE_BTR_SEG_TOP + read_buf, space_id)) {
+            std::unique_ptr<Json_line> json;
+            if (is_json) {
+              json.reset(new Json_line("index"));
+              json->add("primary", is_primary == 0);
+              json->add("space_id", space_id);
+              json->add("root_page_no", i);
+              json->add("index_id", mach_read_from_8(read_buf + PAGE_HEADER + PAGE_INDEX_ID));
+              json->add("btree_height", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
+              json->writer().Key("leaf_segment");
+              is_primary = 1;
+            } else {
+              printf("iiiiiiiiiiiiiiiiiiiiiiiiiiii %d\n", i);
+              if (is_primary == 0) {
+                printf("========Primary index========\n");
+                printf("Primary index root page space_id %u page_no %d\n", space_id, i);
+                printf("Btree hight: %hu\n", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
+                is_primary = 1;
+              } else {
+                printf("========Secondary index========\n");
+                printf("Secondary index root page space_id %u page_no %d\n", space_id, i);
+                printf("Btree hight: %hu\n", mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL));
+              }
+
+              printf("<<<Leaf page segment>>>\n");
+            }
+            fseg_header_t *seg_header;
+            seg_header = read_buf + PAGE_HEADER + PAGE_BTR_SEG_LEAF;
+            fil_addr_t inode_addr;
+            inode_addr.page = mach_read_from_4(seg_header + FSEG_HDR_PAGE_NO);
+            inode_addr.boffset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET);
+
+            posix_memalign((void**)&inode_page_buf, UNIV_PAGE_SIZE_MAX, kPageSize);
+            offset = (uint64_t)kPageSize * (uint64_t)inode_addr.page;
+            ret = ReadPage(inode_page_buf, offset);
+            fil_page_restore(fd, inode_page_buf, kPageSize);
+            fseg_inode_t *inode = inode_page_buf + inode_addr.boffset;
+            fseg_print_low(space_id, inode, free_page, json.get());
+            total_free_page += free_page;
+
+            inode_addr.page = mach_read_from_4(seg_header + FSEG_HDR_PAGE_NO + FSEG_HEADER_SIZE);
+            inode_addr.boffset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET + FSEG_HEADER_SIZE);
+
+            if (is_json) {
+              json->writer().Key("non_leaf_segment");
+            } else {
+              printf("\n<<<Non-Leaf page segment>>>\n");
+            }
+            offset = (uint64_t)kPageSize * (uint64_t)inode_addr.page;
+            ret = ReadPage(inode_page_buf, offset);
+            fil_page_restore(fd, inode_page_buf, kPageSize);
+            inode = inode_page_buf + inode_addr.boffset;
+            fseg_print_low(space_id, inode, free_page, json.get());
+            total_free_page += free_page;
+
+            free(inode_page_buf);
+            if (!is_json) {
+              printf("\n");
+            }
+          }
+        }
+      });
+
+  uint64_t free_bytes = (uint64_t)total_free_page * (uint64_t)kPageSize;
+  if (is_json) {
+    Json_line line("index_summary");
+    line.add("file_size", (uint64_t)stat_buf.st_size);
+    line.add("reserved_unused_bytes", free_bytes);
+    line.add("reserved_unused_pct",
+             (double)free_bytes * 100.00 / stat_buf.st_size);
+    line.add("optimized_file_size", stat_buf.st_size - free_bytes);
+    return;
   }
-
   printf("**Suggestion**\n");
   printf("File size %lu, reserved but not used space %lu, percentage %.2lf%%\n", 
-      stat_buf.st_size, (uint64_t)total_free_page * (uint64_t)kPageSize,
-      (double)total_free_page * (double)kPageSize * 100.00 / stat_buf.st_size);
-  printf("Optimize table will get new fie size %lu\n", stat_buf.st_size - (uint64_t)total_free_page * (uint64_t)kPageSize);
+      stat_buf.st_size, free_bytes,
+      (double)free_bytes * 100.00 / stat_buf.st_size);
+  printf("Optimize table will get new fie size %lu\n", stat_buf.st_size - free_bytes);
 
   return;
 }
@@ -1358,9 +1491,7 @@ void DumpAllRecords() {
   // we have other way to find it, for simplicy dirctly assign it to 4
   uint32_t root_page_id = 4;
 
-  uint64_t offset = (uint64_t)kPageSize * (uint64_t)root_page_id;
-
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadIndexPage(root_page_id);
   if (ret == -1) {
     printf("DumpAllRecords read error %d\n", ret);
     return;
@@ -1368,29 +1499,54 @@ void DumpAllRecords() {
   uint16_t page_level = mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL);
   // Reach leftmost leaf page
 
-  std::cout << page_level << std::endl;
+  // in json only the pages and their records are printed
+  bool is_json = ut_format_is_json();
+  if (!is_json) {
+    std::cout << page_level << std::endl;
+  }
+  /* links come from the pages: a child or next page out of the file, or
+  one already dumped, ends the dump instead of reading garbage or looping */
+  const page_no_t n_pages = fil_get_n_pages(fd);
+  std::vector<bool> visited(n_pages);
+  auto dump_error = [&](uint32_t page_num, const char *msg) {
+    if (is_json) {
+      ShowJsonError("DumpAllRecords", page_num, msg);
+    } else {
+      printf("DumpAllRecords page %u: %s\n", page_num, msg);
+    }
+  };
   uint32_t curr_page = root_page_id;
   while (1) {
-    printf("curr_page %u %hu\n", curr_page, page_level);
-    byte *rec_ptr = read_buf + PAGE_NEW_INFIMUM;
-    ulint off = mach_read_from_2(rec_ptr - REC_NEXT); 
+    if (!is_json) {
+      printf("curr_page %u %hu\n", curr_page, page_level);
+    }
+    if (page_level == 0) {
+      break;
+    }
+    ulint off = rec_get_next_offs(read_buf, PAGE_NEW_INFIMUM, kLogicalPageSize);
+    if (off == 0 || off == PAGE_NEW_SUPREMUM ||
+        !page_range_is_valid(off + 4, 4, kLogicalPageSize)) {
+      dump_error(curr_page, "no leftmost node pointer");
+      return;
+    }
 
     page_no_t child_page_num =
-        mach_read_from_4(rec_ptr + off + 4);
+        mach_read_from_4(read_buf + off + 4);
 
-    printf("Next leftmost child page number is %u\n", child_page_num);
+    if (!is_json) {
+      printf("Next leftmost child page number is %u\n", child_page_num);
+    }
     uint64_t curr_page_level = page_level;
+    if (child_page_num >= n_pages) {
+      dump_error(curr_page, "child page out of the file");
+      return;
+    }
 
-    offset = (uint64_t)kPageSize * (uint64_t)child_page_num;
-
-    ret = pread(fd, read_buf, kPageSize, offset);
+    ret = ReadIndexPage(child_page_num);
     if (ret == -1) {
       printf("DumpAllRecords read error %d\n", errno);
       return;
     }
-    if (page_level == 0) {
-      break;
-    }
     page_level = mach_read_from_2(read_buf + PAGE_HEADER + PAGE_LEVEL);
     if (page_level != curr_page_level - 1) {
       break;
@@ -1400,14 +1556,27 @@ void DumpAllRecords() {
   }
   uint32_t next_page = 0;
   while (next_page != 4294967295) {
+    visited[curr_page] = true;
     ShowIndexHeader(curr_page, true);
     next_page = mach_read_from_4(read_buf + FIL_PAGE_NEXT);
-    printf("Next Page: %u\n", mach_read_from_4(read_buf + FIL_PAGE_NEXT));
+    if (!is_json) {
+      printf("Next Page: %u\n", mach_read_from_4(read_buf + FIL_PAGE_NEXT));
+    }
 
     curr_page = next_page;
-    offset = (uint64_t)kPageSize * (uint64_t)curr_page;
+    if (curr_page == FIL_NULL) {
+      break;
+    }
+    if (curr_page >= n_pages) {
+      dump_error(curr_page, "next page out of the file");
+      return;
+    }
+    if (visited[curr_page]) {
+      dump_error(curr_page, "next page already dumped, the links loop");
+      return;
+    }
 
-    ret = pread(fd, read_buf, kPageSize, offset);
+    ret = ReadIndexPage(curr_page);
     if (ret == -1) {
       printf("DumpAllRecords read error %d\n", errno);
       return;
@@ -1420,7 +1589,7 @@ void ShowSpaceIndexs() {
   printf("Space Indexs:\n");
   uint64_t offset = (uint64_t)kPageSize * (uint64_t)FIL_PAGE_INODE;
 
-  int ret = pread(fd, read_buf, kPageSize, offset);
+  int ret = ReadPage(read_buf, offset);
   if (ret == -1) {
     printf("ShowSpaceIndexs read error %d\n", ret);
     return;
@@ -1438,18 +1607,107 @@ int main(int argc, char *argv[]) {
   uint32_t user_page = 0;
   bool path_opt = false;
   bool sdi_path_opt = false;
-  char c;
+  int c;
   bool show_file = true;
   bool delete_page = false;
   bool update_checksum = false;
   bool is_show_records = false;
-  char command[128];
-  while (-1 != (c = getopt(argc, argv, "hf:s:p:d:u:c:"))) {
+  uint32_t n_threads = 0;
+  char command[128] = "";
+  char redo_path[1024] = "";
+  uint64_t since_lsn = 0;
+  uint64_t until_lsn = 0;
+  uint64_t mem_mb = 256;
+  uint64_t cache_mb = 64;
+  char lob_dir[1024] = "";
+  char keyring_path[1024] = "";
+  char dblwr_path[1024] = "";
+  bool apply = false;
+  char datadir[1024] = "";
+  char serve_path[1024] = "";
+  uint32_t progress_interval = 0;
+  enum {
+    OPT_REDO = 256,
+    OPT_SINCE_LSN,
+    OPT_UNTIL_LSN,
+    OPT_MEM_MB,
+    OPT_LOB_DIR,
+    OPT_KEYRING,
+    OPT_DBLWR,
+    OPT_APPLY,
+    OPT_SERVE,
+    OPT_CACHE_MB,
+    OPT_STATS,
+    OPT_PROGRESS,
+    OPT_FORMAT
+  };
+  static const struct option long_options[] = {
+      {"redo", required_argument, nullptr, OPT_REDO},
+      {"since-lsn", required_argument, nullptr, OPT_SINCE_LSN},
+      {"until-lsn", required_argument, nullptr, OPT_UNTIL_LSN},
+      {"mem-mb", required_argument, nullptr, OPT_MEM_MB},
+      {"lob-dir", required_argument, nullptr, OPT_LOB_DIR},
+      {"keyring", required_argument, nullptr, OPT_KEYRING},
+      {"dblwr", required_argument, nullptr, OPT_DBLWR},
+      {"apply", no_argument, nullptr, OPT_APPLY},
+      {"serve", required_argument, nullptr, OPT_SERVE},
+      {"cache-mb", required_argument, nullptr, OPT_CACHE_MB},
+      {"stats", no_argument, nullptr, OPT_STATS},
+      {"progress", required_argument, nullptr, OPT_PROGRESS},
+      {"format", required_argument, nullptr, OPT_FORMAT},
+      {nullptr, 0, nullptr, 0}};
+  while (-1 != (c = getopt_long(argc, argv, "hf:D:s:p:d:u:c:t:", long_options,
+                                nullptr))) {
     switch (c) {
+      case OPT_REDO:
+        snprintf(redo_path, 1024, "%s", optarg);
+        break;
+      case OPT_SINCE_LSN:
+        since_lsn = std::strtoull(optarg, nullptr, 10);
+        break;
+      case OPT_UNTIL_LSN:
+        until_lsn = std::strtoull(optarg, nullptr, 10);
+        break;
+      case OPT_MEM_MB:
+        mem_mb = std::strtoull(optarg, nullptr, 10);
+        break;
+      case OPT_LOB_DIR:
+        snprintf(lob_dir, 1024, "%s", optarg);
+        break;
+      case OPT_KEYRING:
+        snprintf(keyring_path, 1024, "%s", optarg);
+        break;
+      case OPT_DBLWR:
+        snprintf(dblwr_path, 1024, "%s", optarg);
+        break;
+      case OPT_APPLY:
+        apply = true;
+        break;
+      case OPT_SERVE:
+        snprintf(serve_path, 1024, "%s", optarg);
+        break;
+      case OPT_CACHE_MB:
+        cache_mb = std::strtoull(optarg, nullptr, 10);
+        break;
+      case OPT_STATS:
+        show_stats = true;
+        break;
+      case OPT_PROGRESS:
+        progress_interval = std::strtoul(optarg, nullptr, 10);
+        break;
+      case OPT_FORMAT:
+        if (!ut_format_parse(optarg, &ut_format)) {
+          fprintf(stderr, "Unknown format %s, use text or json\n", optarg);
+          exit(-1);
+        }
+        break;
       case 'f':
         snprintf(path, 1024, "%s", optarg);
         path_opt = true;
         break;
+      case 'D':
+        snprintf(datadir, 1024, "%s", optarg);
+        break;
       case 's':
         snprintf(sdi_path, 1024, "%s", optarg);
         sdi_path_opt = true;
@@ -1471,6 +1729,9 @@ int main(int argc, char *argv[]) {
       case 'c':
         snprintf(command, 128, "%s", optarg);
         break;
+      case 't':
+        n_threads = std::atol(optarg);
+        break;
       case 'h':
         usage();
         return 0;
@@ -1480,23 +1741,94 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  if (path_opt == false) {
+  if (path_opt == false && datadir[0] == '\0' && serve_path[0] == '\0') {
     fprintf(stderr, "Please specify the ibd file path\n");
     usage();
     exit(-1);
   }
 
-  printf("File path %s path, page num %u\n", path, user_page);
+  /* commands whose reports are not written as json yet */
+  if (ut_format_is_json() &&
+      (datadir[0] != '\0' || serve_path[0] != '\0' || delete_page ||
+       update_checksum ||
+       (show_file && command[0] != '\0' &&
+        strcmp(command, "list-page-type") != 0 &&
+        strcmp(command, "index-summary") != 0 &&
+        strcmp(command, "show-undo-file") != 0 &&
+        strcmp(command, "dump-all-records") != 0 &&
+        strcmp(command, "dump-redo-records") != 0 &&
+        strcmp(command, "dump-lobs") != 0 &&
+        strcmp(command, "recover-deleted") != 0 &&
+        strcmp(command, "carve") != 0))) {
+    fprintf(stderr, "--format json is not supported by this command\n");
+    exit(-1);
+  }
+
+  inno_init();
+
+  /* before any scan thread starts, so that every thread is counted */
+  if (show_stats || progress_interval > 0) {
+    monitor_enable();
+    monitor_progress_start(progress_interval);
+    atexit(StopMonitor);
+  }
 
-  fd = open(path, O_RDWR, 0644); 
-  if (fd == -1) {
-    fprintf(stderr, "[ERROR] Open %s failed: %s\n", path, strerror(errno));
+  if (keyring_path[0] != '\0' && !inno_load_keyring(keyring_path)) {
     exit(1);
   }
 
-  ut_crc32_init();
+  /* files are named by each request */
+  if (serve_path[0] != '\0') {
+    return srv_serve(serve_path, cache_mb << 20, n_threads) == 0 ? 0 : 1;
+  }
+
+  /* every tablespace of the instance, in one pass */
+  if (path_opt == false) {
+    printf("Data directory %s\n", datadir);
+    ShowDatadir(datadir, n_threads);
+    return 0;
+  }
 
-  posix_memalign((void**)&read_buf, kPageSize, kPageSize);
+  if (!ut_format_is_json()) {
+    printf("File path %s path, page num %u\n", path, user_page);
+  }
+
+  /* these may name several files, each is opened by the report itself */
+  if (show_file == true && strcmp(command, "show-undo-file") == 0) {
+    ShowUndoFile(path, n_threads);
+    return 0;
+  } else if (show_file == true && strcmp(command, "show-redo-file") == 0) {
+    ShowRedoFile(path);
+    return 0;
+  } else if (show_file == true && strcmp(command, "dump-redo-records") == 0) {
+    DumpRedoRecords(path);
+    return 0;
+  }
+
+  /* the system tablespace may span several files */
+  std::unique_ptr<Tablespace> space = Tablespace::open(path, true);
+  if (!space) {
+    fprintf(stderr, "[ERROR] Cannot open %s\n", path);
+    exit(1);
+  }
+  fd = space->fd();
+  monitor_progress_set_total(
+      (uint64_t)space->n_pages() * space->page_size().physical(),
+      space->page_size().physical());
+
+  page_size = space->page_size();
+  kPageSize = page_size.physical();
+  kLogicalPageSize = page_size.logical();
+  is_compressed = page_size.is_compressed();
+  posix_memalign((void**)&read_buf, UNIV_PAGE_SIZE_MAX, UNIV_PAGE_SIZE_MAX);
+
+  /* every page the commands read one at a time goes through one cache,
+  and the commands, given fd, read the files, key and cache of space */
+  page_cache.reset(new Buf_page_cache(cache_mb << 20, kPageSize));
+  space->set_cache(page_cache.get());
+  if (!space->attach()) {
+    exit(1);
+  }
 
   if (show_file == true) {
     ShowSpaceHeader();
@@ -1505,24 +1837,59 @@ int main(int argc, char *argv[]) {
     } else if (strcmp(command, "index-summary") == 0) {
       ShowIndexSummary();
       // ShowSpaceIndexs();
-    } else if (strcmp(command, "show-undo-file") == 0) {
-      ShowUndoFile();
+    } else if (strcmp(command, "undo-history") == 0) {
+      ShowUndoHistory(fd, sdi_path);
+    } else if (strcmp(command, "purge-lag") == 0) {
+      ShowPurgeLag(fd, n_threads);
     } else if (strcmp(command, "dump-all-records") == 0) {
       DumpAllRecords();
+    } else if (strcmp(command, "column-stats") == 0) {
+      ShowColumnStats(fd, sdi_path, n_threads);
+    } else if (strcmp(command, "recover-deleted") == 0) {
+      ShowDeletedRecords(fd, sdi_path, n_threads);
+    } else if (strcmp(command, "carve") == 0) {
+      ShowCarvedRecords(fd, sdi_path, n_threads);
+    } else if (strcmp(command, "dump-lobs") == 0) {
+      DumpLobs(fd, sdi_path, lob_dir[0] == '\0' ? nullptr : lob_dir);
+    } else if (strcmp(command, "disk-usage") == 0) {
+      ShowDiskUsage(fd, n_threads);
+    } else if (strcmp(command, "dblwr") == 0) {
+      if (dblwr_path[0] == '\0') {
+        fprintf(stderr, "Please specify the doublewrite files with --dblwr\n");
+        exit(-1);
+      }
+      ShowDblwr(fd, dblwr_path, apply, n_threads);
+    } else if (strcmp(command, "changed-pages") == 0) {
+      ShowChangedPages(fd, since_lsn, n_threads);
+    } else if (strcmp(command, "diff") == 0) {
+      if (optind >= argc) {
+        fprintf(stderr, "Please specify the file to compare with\n");
+        exit(-1);
+      }
+      ShowFileDiff(fd, argv[optind], n_threads);
+    } else if (strcmp(command, "redo-pages") == 0) {
+      if (redo_path[0] == '\0') {
+        fprintf(stderr, "Please specify the redo log path with --redo\n");
+        exit(-1);
+      }
+      ShowRedoPages(fd, redo_path, since_lsn, until_lsn, mem_mb << 20,
+                    n_threads);
     } else if (strcmp(command, "list-leaf-segment") == 0) {
       try {
         ShowLeafSegment();
       } catch (std::logic_error const& logic_exp) {
         fprintf(stderr, "Exception occurs: %s\nTry to scan whole file...\n", logic_exp.what());
         /* JUST take pages which level is 0 and page type index... */
-        ShowSpacePageType();
+        ShowCarvedRecords(fd, nullptr, n_threads);
       }
     }
   } else {
     uint16_t type = 0;
     ShowFILHeader(user_page, &type);
     // PrintUserRecord(user_page, &type);
-    printf("\n");
+    if (!ut_format_is_json()) {
+      printf("\n");
+    }
     if (strcmp(command, "show-records") == 0) {
       if (sdi_path_opt == false) {
         fprintf(stderr, "Please specify the sdi file path\n");
@@ -1531,7 +1898,13 @@ int main(int argc, char *argv[]) {
       }
       is_show_records = true;
     }
-    if (type == FIL_PAGE_TYPE_BLOB) {
+    if (ut_format_is_json()) {
+      /* the other headers are in text only, json has the FIL header */
+      if (type == FIL_PAGE_INDEX || type == FIL_PAGE_RTREE ||
+          type == FIL_PAGE_SDI) {
+        ShowIndexHeader(user_page, is_show_records);
+      }
+    } else if (type == FIL_PAGE_TYPE_BLOB) {
       ShowBlobHeader(user_page);
     } else if (type == FIL_PAGE_TYPE_LOB_FIRST) {
       ShowBlobFirstPage(user_page);
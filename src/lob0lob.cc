@@ -0,0 +1,498 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/lob0lob.h"
+#include "include/dict0dict.h"
+#include "include/fil0crypt.h"
+#include "include/fil0space.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/srv0mon.h"
+#include "include/rem0rec.h"
+#include "include/ut0json.h"
+
+/** Layout of an index entry of an 8.0 LOB, on the first page or on a
+FIL_PAGE_TYPE_LOB_INDEX page */
+/* @{ */
+#define LOB_ENTRY_NEXT 6          /* the entry is a list node: prev, next */
+#define LOB_ENTRY_VERSIONS 12     /* base node of the older versions */
+#define LOB_ENTRY_TRXID 28
+#define LOB_ENTRY_TRXID_MODIFIER 34
+#define LOB_ENTRY_TRX_UNDO_NO 40
+#define LOB_ENTRY_TRX_UNDO_NO_MODIFIER 44
+#define LOB_ENTRY_PAGE_NO 48      /* page holding the data of the entry */
+#define LOB_ENTRY_DATA_LEN 52     /* bytes of data on that page */
+#define LOB_ENTRY_LOB_VERSION 56  /* LOB version that created the entry */
+#define LOB_ENTRY_SIZE 60
+/* @} */
+
+/** Offset of the list of free index entries of an 8.0 LOB first page */
+#define LOB_FIRST_FREE_LIST \
+  ((ulint)BlobFirstPage::OFFSET_INDEX_LIST + FLST_BASE_NODE_SIZE)
+
+/** Offset of the index entries of an 8.0 LOB first page */
+#define LOB_FIRST_ENTRIES (LOB_FIRST_FREE_LIST + FLST_BASE_NODE_SIZE)
+
+/** @return the number of index entries on the first page of an 8.0 LOB,
+which InnoDB sizes with the page as first_page_t::get_n_index_entries()
+does
+@param[in]  page_size  page size of the tablespace */
+static ulint lob_first_n_entries(ulint page_size) {
+  switch (page_size) {
+    case 4096:
+    case 8192:
+      return 5;
+    case 32768:
+      return 20;
+    case 65536:
+      return 40;
+    default:
+      return 10;
+  }
+}
+
+/** @return offset of the data on the first page of an 8.0 LOB
+@param[in]  page_size  page size of the tablespace */
+static ulint lob_first_data(ulint page_size) {
+  return LOB_FIRST_ENTRIES + lob_first_n_entries(page_size) * LOB_ENTRY_SIZE;
+}
+
+/** Reads a 6-byte file address without trusting it. */
+static fil_addr_t lob_read_addr(const byte *ptr) {
+  return fil_addr_t(mach_read_from_4(ptr + FIL_ADDR_PAGE),
+                    mach_read_from_2(ptr + FIL_ADDR_BYTE));
+}
+
+lob_ref_t lob_ref_parse(const byte *field_ref) {
+  lob_ref_t ref;
+  byte flags = field_ref[BTR_EXTERN_LEN];
+  ref.space_id = mach_read_from_4(field_ref + BTR_EXTERN_SPACE_ID);
+  ref.page_no = mach_read_from_4(field_ref + BTR_EXTERN_PAGE_NO);
+  ref.offset = mach_read_from_4(field_ref + BTR_EXTERN_OFFSET);
+  ref.length = mach_read_from_4(field_ref + BTR_EXTERN_LEN + 4);
+  ref.owner = !(flags & BTR_EXTERN_OWNER_FLAG);
+  ref.inherited = flags & BTR_EXTERN_INHERITED_FLAG;
+  ref.being_modified = flags & BTR_EXTERN_BEING_MODIFIED_FLAG;
+  return ref;
+}
+
+const char *lob_status_name(lob_status_t status) {
+  switch (status) {
+    case LOB_OK: return "ok";
+    case LOB_EMPTY_REF: return "empty reference";
+    case LOB_READ_ERROR: return "read error";
+    case LOB_CORRUPT: return "corrupt";
+    case LOB_COMPRESSED: return "compressed LOB";
+    case LOB_STOPPED: return "stopped";
+  }
+  return "unknown";
+}
+
+/** Reads a page of a LOB unless it is the one already in buf.
+@param[in,out]  cur_page  page held by buf */
+static bool lob_read_page(int fd, ulint page_size, page_no_t page_no,
+                          byte *buf, page_no_t *cur_page) {
+  if (*cur_page == page_no) {
+    return true;
+  }
+  *cur_page = FIL_NULL;
+  if (fil_pread(fd, buf, page_size, (off_t)page_no * page_size) !=
+      (ssize_t)page_size) {
+    return false;
+  }
+  if (!fil_page_restore(fd, buf, page_size)) {
+    return false;
+  }
+  *cur_page = page_no;
+  return true;
+}
+
+/** Streams an old-style BLOB, a chain of FIL_PAGE_TYPE_BLOB pages each
+starting with a BTR_BLOB_HDR. */
+static lob_status_t lob_read_blob_chain(int fd, ulint page_size,
+                                        const lob_ref_t &ref, byte *buf,
+                                        const lob_sink_t &sink,
+                                        uint64_t *n_read) {
+  page_no_t n_file_pages = fil_get_n_pages(fd);
+  page_no_t page_no = ref.page_no;
+  ulint offset = ref.offset;
+  page_no_t cur_page = FIL_NULL;
+  for (page_no_t n_visited = 0; *n_read < ref.length; n_visited++) {
+    if (page_no == FIL_NULL || n_visited > n_file_pages) {
+      return LOB_CORRUPT;
+    }
+    if (!lob_read_page(fd, page_size, page_no, buf, &cur_page)) {
+      return LOB_READ_ERROR;
+    }
+    if (fil_page_get_type(buf) != FIL_PAGE_TYPE_BLOB ||
+        offset + BTR_BLOB_HDR_SIZE > page_size - FIL_PAGE_DATA_END) {
+      return LOB_CORRUPT;
+    }
+    ulint part_len = mach_read_from_4(buf + offset + BTR_BLOB_HDR_PART_LEN);
+    if (part_len >
+        page_size - FIL_PAGE_DATA_END - offset - BTR_BLOB_HDR_SIZE) {
+      return LOB_CORRUPT;
+    }
+    ulint n = std::min<uint64_t>(part_len, ref.length - *n_read);
+    if (!sink(buf + offset + BTR_BLOB_HDR_SIZE, n)) {
+      return LOB_STOPPED;
+    }
+    *n_read += n;
+    page_no = mach_read_from_4(buf + offset + BTR_BLOB_HDR_NEXT_PAGE_NO);
+    offset = FIL_PAGE_DATA;
+  }
+  return LOB_OK;
+}
+
+/** Copies the index entry at addr out of its page.
+@return false if addr does not point at an entry */
+static bool lob_read_entry(int fd, ulint page_size, fil_addr_t addr,
+                           byte *buf, page_no_t *cur_page, byte *entry) {
+  if (addr.boffset < FIL_PAGE_DATA ||
+      addr.boffset + LOB_ENTRY_SIZE > page_size - FIL_PAGE_DATA_END ||
+      !lob_read_page(fd, page_size, addr.page, buf, cur_page)) {
+    return false;
+  }
+  page_type_t type = fil_page_get_type(buf);
+  if (type != FIL_PAGE_TYPE_LOB_FIRST && type != FIL_PAGE_TYPE_LOB_INDEX) {
+    return false;
+  }
+  memcpy(entry, buf + addr.boffset, LOB_ENTRY_SIZE);
+  return true;
+}
+
+/** Streams an 8.0 LOB by walking the index list of its first page. An
+entry newer than the referenced LOB version is replaced by the newest of
+its older versions that the reference can see, as lob::read() does. */
+static lob_status_t lob_read_lob(int fd, ulint page_size,
+                                 const lob_ref_t &ref, byte *buf,
+                                 const lob_sink_t &sink, uint64_t *n_read) {
+  page_no_t n_file_pages = fil_get_n_pages(fd);
+  page_no_t cur_page = FIL_NULL;
+  if (!lob_read_page(fd, page_size, ref.page_no, buf, &cur_page)) {
+    return LOB_READ_ERROR;
+  }
+  fil_addr_t addr = lob_read_addr(
+      buf + (ulint)BlobFirstPage::OFFSET_INDEX_LIST + FLST_FIRST);
+
+  byte entry[LOB_ENTRY_SIZE];
+  byte version[LOB_ENTRY_SIZE];
+  for (uint64_t n_visited = 0; addr.page != FIL_NULL && *n_read < ref.length;
+       n_visited++) {
+    if (n_visited > (uint64_t)n_file_pages * 2 ||
+        !lob_read_entry(fd, page_size, addr, buf, &cur_page, entry)) {
+      return LOB_CORRUPT;
+    }
+    addr = lob_read_addr(entry + LOB_ENTRY_NEXT);
+
+    const byte *use = entry;
+    if (mach_read_from_4(entry + LOB_ENTRY_LOB_VERSION) > ref.offset) {
+      use = nullptr;
+      fil_addr_t vaddr = lob_read_addr(entry + LOB_ENTRY_VERSIONS + FLST_FIRST);
+      for (uint64_t n_versions = 0; vaddr.page != FIL_NULL; n_versions++) {
+        if (n_versions > n_file_pages ||
+            !lob_read_entry(fd, page_size, vaddr, buf, &cur_page, version)) {
+          return LOB_CORRUPT;
+        }
+        if (mach_read_from_4(version + LOB_ENTRY_LOB_VERSION) <= ref.offset) {
+          use = version;
+          break;
+        }
+        vaddr = lob_read_addr(version + LOB_ENTRY_NEXT);
+      }
+      if (use == nullptr) {
+        /* data added after the referenced version */
+        continue;
+      }
+    }
+
+    page_no_t page_no = mach_read_from_4(use + LOB_ENTRY_PAGE_NO);
+    ulint data_len = mach_read_from_4(use + LOB_ENTRY_DATA_LEN);
+    if (!lob_read_page(fd, page_size, page_no, buf, &cur_page)) {
+      return LOB_READ_ERROR;
+    }
+    ulint data_off;
+    if (page_no == ref.page_no) {
+      data_off = lob_first_data(page_size);
+    } else if (fil_page_get_type(buf) == FIL_PAGE_TYPE_LOB_DATA) {
+      data_off = (ulint)BlobDataPage::LOB_PAGE_DATA;
+    } else {
+      return LOB_CORRUPT;
+    }
+    if (data_len > page_size - FIL_PAGE_DATA_END - data_off) {
+      return LOB_CORRUPT;
+    }
+    ulint n = std::min<uint64_t>(data_len, ref.length - *n_read);
+    if (!sink(buf + data_off, n)) {
+      return LOB_STOPPED;
+    }
+    *n_read += n;
+  }
+  return *n_read == ref.length ? LOB_OK : LOB_CORRUPT;
+}
+
+/** lob_read() without its timer */
+static lob_status_t lob_read_low(int fd, const page_size_t &page_size,
+                                 const lob_ref_t &ref, byte *buf,
+                                 const lob_sink_t &sink, uint64_t *n_read) {
+  *n_read = 0;
+  if (ref.page_no == 0 && ref.length == 0) {
+    return LOB_EMPTY_REF;
+  }
+  /* pages of a compressed tablespace are read in their physical size,
+  enough to tell the type of the first page */
+  ulint physical = page_size.physical();
+  if (fil_pread(fd, buf, physical, (off_t)ref.page_no * physical) !=
+      (ssize_t)physical) {
+    return LOB_READ_ERROR;
+  }
+  if (!fil_page_restore(fd, buf, physical)) {
+    return LOB_CORRUPT;
+  }
+  switch (fil_page_get_type(buf)) {
+    case FIL_PAGE_TYPE_BLOB:
+      if (page_size.is_compressed()) {
+        return LOB_CORRUPT;
+      }
+      return lob_read_blob_chain(fd, physical, ref, buf, sink, n_read);
+    case FIL_PAGE_TYPE_LOB_FIRST:
+      if (page_size.is_compressed()) {
+        return LOB_CORRUPT;
+      }
+      return lob_read_lob(fd, physical, ref, buf, sink, n_read);
+    case FIL_PAGE_TYPE_ZBLOB:
+    case FIL_PAGE_TYPE_ZBLOB2:
+    case FIL_PAGE_TYPE_ZLOB_FIRST:
+      return LOB_COMPRESSED;
+    default:
+      return LOB_CORRUPT;
+  }
+}
+
+lob_status_t lob_read(int fd, const page_size_t &page_size,
+                      const lob_ref_t &ref, byte *buf,
+                      const lob_sink_t &sink, uint64_t *n_read) {
+  Monitor_timer timer(MONITOR_LOB_FETCH);
+  lob_status_t status =
+      lob_read_low(fd, page_size, ref, buf, sink, n_read);
+  timer.add_bytes(*n_read);
+  return status;
+}
+
+/** Writes bytes to stdout, escaping those that are not printable. */
+static void lob_print_escaped(const byte *data, ulint len) {
+  for (ulint i = 0; i < len; i++) {
+    if (data[i] >= ' ' && data[i] <= '~' && data[i] != '\\') {
+      putchar(data[i]);
+    } else {
+      printf("\\x%02x", data[i]);
+    }
+  }
+}
+
+/** @return a column name made safe to use in a file name: every byte but
+letters, digits, '_' and '-' becomes '_', so that no name reaches out of
+the directory */
+static std::string lob_file_name_part(const std::string &name) {
+  std::string part(name);
+  for (char &c : part) {
+    if (!isalnum((unsigned char)c) && c != '_' && c != '-') {
+      c = '_';
+    }
+  }
+  return part;
+}
+
+/** Streams the off-page fields of the user records of one leaf page. */
+static void lob_dump_page(int fd, const dict_table_t &table,
+                          const dict_index_t &index,
+                          const page_size_t &page_size, page_no_t page_no,
+                          const byte *page, const char *lob_dir,
+                          byte *lob_buf, std::vector<ulint> *offsets,
+                          uint64_t *n_values, uint64_t *n_bytes,
+                          uint64_t *n_failed) {
+  ulint n_heap = page_dir_get_n_heap(page);
+  ulint rec_off =
+      rec_get_next_offs(page, PAGE_NEW_INFIMUM, page_size.logical());
+  ulint n_visited = 0;
+  while (rec_off != 0 && rec_off != PAGE_NEW_SUPREMUM && n_visited < n_heap) {
+    const rec_t *rec = page + rec_off;
+    n_visited++;
+    rec_off = rec_get_next_offs(page, rec_off, page_size.logical());
+
+    if (rec_get_status(rec) != REC_STATUS_ORDINARY ||
+        (rec_get_info_bits(rec, true) & REC_INFO_DELETED_FLAG) ||
+        !rec_get_offsets(rec, index, *offsets, page_size.logical())) {
+      continue;
+    }
+    ulint heap_no = rec_get_bit_field_2(rec, REC_NEW_HEAP_NO,
+                                        REC_HEAP_NO_MASK, REC_HEAP_NO_SHIFT);
+    for (ulint i = 0; i < index.fields.size(); i++) {
+      ulint len;
+      const byte *data = rec_get_nth_field(rec, *offsets, i, &len);
+      if (!rec_offs_nth_extern(*offsets, i) || len == UNIV_SQL_NULL ||
+          len < BTR_EXTERN_FIELD_REF_SIZE) {
+        continue;
+      }
+      const dict_col_t &col = table.cols[index.fields[i].col_no];
+      ulint local_len = len - BTR_EXTERN_FIELD_REF_SIZE;
+      lob_ref_t ref = lob_ref_parse(data + local_len);
+      /* in json a value is a line, its bytes streamed into it */
+      std::unique_ptr<Json_line> json;
+      if (ut_format_is_json()) {
+        json.reset(new Json_line("lob"));
+        json->add("page_no", page_no);
+        json->add("heap_no", heap_no);
+        json->add("column", col.name);
+        json->add("local_len", local_len);
+        json->add("lob_space_id", ref.space_id);
+        json->add("lob_page_no", ref.page_no);
+        json->add("lob_offset", ref.offset);
+        json->add("length", ref.length);
+        json->add("owner", ref.owner);
+      } else {
+        printf("page %u heap %u column %s: local %u bytes, lob space %u page "
+               "%u version/offset %u length %lu%s\n",
+               page_no, heap_no, col.name.c_str(), local_len, ref.space_id,
+               ref.page_no, ref.offset, ref.length,
+               ref.owner ? "" : ", not owner");
+      }
+
+      FILE *out = stdout;
+      std::string name;
+      if (lob_dir != nullptr) {
+        /* the column number keeps names apart that the escaping merges */
+        name = std::string(lob_dir) + "/p" + std::to_string(page_no) + "_h" +
+               std::to_string(heap_no) + "_c" +
+               std::to_string(index.fields[i].col_no) + "_" +
+               lob_file_name_part(col.name);
+        out = fopen(name.c_str(), "wb");
+        if (out == nullptr) {
+          fprintf(stderr, "Open %s failed: %s\n", name.c_str(),
+                  strerror(errno));
+          (*n_failed)++;
+          if (json) {
+            json->add("error", strerror(errno));
+          }
+          continue;
+        }
+        if (json) {
+          json->add("file", name);
+        }
+      } else if (json) {
+        json->string_begin("value");
+      }
+      /* errno of a failed write to the value file, which stops the read */
+      int write_errno = 0;
+      auto write = [&](const byte *piece, ulint n) {
+        Monitor_timer timer(MONITOR_OUTPUT);
+        timer.add_bytes(n);
+        if (out == stdout && json) {
+          json->string_append(piece, n);
+          return true;
+        } else if (out == stdout) {
+          lob_print_escaped(piece, n);
+          return true;
+        }
+        if (fwrite(piece, 1, n, out) != n) {
+          write_errno = errno;
+          return false;
+        }
+        return true;
+      };
+
+      uint64_t n_read = 0;
+      lob_status_t status = LOB_STOPPED;
+      if (write(data, local_len)) {
+        status = lob_read(fd, page_size, ref, lob_buf, write, &n_read);
+      }
+      if (out == stdout && json) {
+        json->string_end();
+      } else if (out == stdout) {
+        printf("\n");
+      } else if (fclose(out) != 0 && write_errno == 0) {
+        /* a full disk may only show when the buffer is flushed */
+        write_errno = errno;
+      }
+      (*n_values)++;
+      *n_bytes += local_len + n_read;
+      if (status != LOB_OK || write_errno != 0) {
+        (*n_failed)++;
+      }
+      if (json) {
+        json->add("n_read", n_read);
+        json->add("status", lob_status_name(status));
+        if (write_errno != 0) {
+          json->add("error", strerror(write_errno));
+        }
+      } else if (write_errno != 0) {
+        printf("  write to %s failed after %lu of %lu bytes: %s\n",
+               name.c_str(), n_read, ref.length, strerror(write_errno));
+      } else if (status != LOB_OK) {
+        printf("  lob read %s after %lu of %lu bytes\n",
+               lob_status_name(status), n_read, ref.length);
+      }
+    }
+  }
+}
+
+void DumpLobs(int fd, const char *sdi_path, const char *lob_dir) {
+  if (!ut_format_is_json()) {
+    printf("==========================Off-page Values==========================\n");
+  }
+  dict_table_t table;
+  if (dict_load_from_sdi(sdi_path, &table) != 0) {
+    fprintf(stderr, "Please specify a valid sdi file with -s\n");
+    return;
+  }
+  const dict_index_t *index = table.clustered_index();
+  if (index == nullptr) {
+    fprintf(stderr, "No clustered index in %s\n", sdi_path);
+    return;
+  }
+  const page_size_t page_size = fil_get_page_size(fd);
+  byte *lob_buf;
+  if (posix_memalign((void **)&lob_buf, UNIV_PAGE_SIZE_MAX,
+                     page_size.logical()) != 0) {
+    fprintf(stderr, "DumpLobs out of memory\n");
+    return;
+  }
+
+  std::vector<ulint> offsets;
+  uint64_t n_values = 0;
+  uint64_t n_bytes = 0;
+  uint64_t n_failed = 0;
+  /* one thread, so that values come out in page order */
+  fil_scan_parallel(
+      fd, 0, fil_get_n_pages(fd), 1,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        (void)thread_no;
+        if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+            mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID) != index->id ||
+            !page_is_leaf(page) ||
+            !(page_header_get_field(page, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+          return;
+        }
+        lob_dump_page(fd, table, *index, page_size, page_no, page, lob_dir,
+                      lob_buf, &offsets, &n_values, &n_bytes, &n_failed);
+      });
+  free(lob_buf);
+  if (ut_format_is_json()) {
+    Json_line line("lob_summary");
+    line.add("n_values", n_values);
+    line.add("n_bytes", n_bytes);
+    line.add("n_failed", n_failed);
+    return;
+  }
+  printf("Off-page values: %lu, bytes %lu, failed %lu\n", n_values, n_bytes,
+         n_failed);
+}
@@ -0,0 +1,192 @@
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "include/log0log.h"
+#include "include/log0recv.h"
+#include "include/ut0json.h"
+
+/** @return the server version that writes a log header format */
+static const char *log_format_name(ulint format) {
+  switch (format) {
+    case LOG_HEADER_FORMAT_5_7_9: return "5.7.9";
+    case LOG_HEADER_FORMAT_8_0_1: return "8.0.1";
+    case LOG_HEADER_FORMAT_8_0_3: return "8.0.3";
+    case LOG_HEADER_FORMAT_8_0_19: return "8.0.19";
+    case LOG_HEADER_FORMAT_8_0_28: return "8.0.28";
+    case LOG_HEADER_FORMAT_8_0_30: return "8.0.30";
+  }
+  return "unknown";
+}
+
+/** Shows what was learnt about one redo log file. */
+static void log_show_file_info(const log_file_info_t &info) {
+  printf("\n-------------------file %s-----------------------\n",
+         info.path.c_str());
+  printf("File size %lu, blocks %lu\n", info.size,
+         info.size / OS_FILE_LOG_BLOCK_SIZE);
+  printf("Header checksum: %s\n", info.header_ok ? "ok" : "bad");
+  printf("Format: %u (%s)\n", info.format, log_format_name(info.format));
+  printf("Start LSN: %lu\n", info.start_lsn);
+  printf("Creator: %s\n", info.creator);
+  if (info.format >= LOG_HEADER_FORMAT_8_0_30) {
+    printf("Log UUID: %u\n", info.uuid);
+    printf("Flags: 0x%x\n", info.flags);
+  }
+  for (int i = 0; i < 2; i++) {
+    const log_checkpoint_t &cp = info.checkpoints[i];
+    if (info.format >= LOG_HEADER_FORMAT_8_0_30) {
+      printf("Checkpoint %d: lsn %lu, checksum %s\n", i + 1, cp.lsn,
+             cp.checksum_ok ? "ok" : "bad");
+    } else {
+      printf("Checkpoint %d: no %lu, lsn %lu, offset %lu, checksum %s\n",
+             i + 1, cp.no, cp.lsn, cp.offset, cp.checksum_ok ? "ok" : "bad");
+    }
+  }
+  printf("Log blocks: %lu, valid %lu, bad checksum %lu, empty %lu\n",
+         info.n_blocks, info.n_valid, info.n_bad_checksum, info.n_empty);
+  if (info.n_valid > 0) {
+    printf("LSN range: [%lu, %lu)\n", info.first_lsn, info.end_lsn);
+  } else {
+    printf("LSN range: none\n");
+  }
+}
+
+/** Shows the totals of a scan. */
+static void log_show_stats(const log_scan_stats_t &stats) {
+  printf("\n==========================Records==========================\n");
+  printf("Records: %lu, bytes %lu\n", stats.n_recs, stats.n_rec_bytes);
+  printf("Resyncs: %lu, bytes skipped %lu, bytes cut off by gaps %lu\n",
+         stats.n_resyncs, stats.n_skipped_bytes, stats.n_tail_bytes);
+  for (ulint type = 0; type <= MLOG_BIGGEST_TYPE; type++) {
+    if (stats.n_type_recs[type] == 0) {
+      continue;
+    }
+    printf("  %-36s records %lu, bytes %lu\n", mlog_type_name(type),
+           stats.n_type_recs[type], stats.n_type_bytes[type]);
+  }
+}
+
+/** Shows the totals of a scan as a JSON line. */
+static void log_json_stats(const log_scan_stats_t &stats) {
+  Json_line line("redo_stats");
+  line.add("n_recs", stats.n_recs);
+  line.add("n_rec_bytes", stats.n_rec_bytes);
+  line.add("n_resyncs", stats.n_resyncs);
+  line.add("n_skipped_bytes", stats.n_skipped_bytes);
+  line.add("n_tail_bytes", stats.n_tail_bytes);
+  Json_writer &w = line.writer();
+  w.Key("types");
+  w.StartArray();
+  for (ulint type = 0; type <= MLOG_BIGGEST_TYPE; type++) {
+    if (stats.n_type_recs[type] == 0) {
+      continue;
+    }
+    w.StartObject();
+    line.add("type", type);
+    line.add("type_name", mlog_type_name(type));
+    line.add("n_recs", stats.n_type_recs[type]);
+    line.add("n_bytes", stats.n_type_bytes[type]);
+    w.EndObject();
+  }
+  w.EndArray();
+}
+
+void ShowRedoFile(const char *path) {
+  std::vector<std::string> paths;
+  if (!log_expand_paths(path, &paths)) {
+    return;
+  }
+
+  std::map<space_id_t, uint64_t> space_recs;
+  std::vector<log_file_info_t> files;
+  log_scan_stats_t stats;
+  log_scan_files(paths, &files,
+                 [&](const log_rec_t &rec, const byte *body) {
+                   (void)body;
+                   if (rec.has_page) {
+                     space_recs[rec.space_id]++;
+                   }
+                 },
+                 &stats);
+
+  printf("==========================Redo Log==========================\n");
+  printf("Redo log files: %lu\n", files.size());
+  lsn_t first_lsn = 0;
+  lsn_t end_lsn = 0;
+  for (const log_file_info_t &info : files) {
+    log_show_file_info(info);
+    if (info.n_valid > 0) {
+      if (first_lsn == 0 || info.first_lsn < first_lsn) {
+        first_lsn = info.first_lsn;
+      }
+      end_lsn = std::max(end_lsn, info.end_lsn);
+    }
+  }
+  if (end_lsn > 0) {
+    printf("\nLSN range of all files: [%lu, %lu), %lu bytes of log\n",
+           first_lsn, end_lsn, end_lsn - first_lsn);
+  }
+
+  log_show_stats(stats);
+
+  std::vector<std::pair<space_id_t, uint64_t>> spaces(space_recs.begin(),
+                                                      space_recs.end());
+  std::sort(spaces.begin(), spaces.end(),
+            [](const std::pair<space_id_t, uint64_t> &a,
+               const std::pair<space_id_t, uint64_t> &b) {
+              return a.second > b.second;
+            });
+  printf("Records by space id:\n");
+  for (const auto &s : spaces) {
+    printf("  space %u: %lu records (%.2lf%%)\n", s.first, s.second,
+           stats.n_recs == 0 ? 0.0 : s.second * 100.0 / stats.n_recs);
+  }
+}
+
+void DumpRedoRecords(const char *path) {
+  std::vector<std::string> paths;
+  if (!log_expand_paths(path, &paths)) {
+    return;
+  }
+
+  std::vector<log_file_info_t> files;
+  log_scan_stats_t stats;
+  if (ut_format_is_json()) {
+    log_scan_files(paths, &files,
+                   [](const log_rec_t &rec, const byte *body) {
+                     (void)body;
+                     Json_line line("redo_record");
+                     line.add("lsn", rec.lsn);
+                     line.add("type", (uint32_t)rec.type);
+                     line.add("type_name", mlog_type_name(rec.type));
+                     line.add("single_rec", rec.single_rec);
+                     if (rec.has_page) {
+                       line.add("space_id", rec.space_id);
+                       line.add("page_no", rec.page_no);
+                     }
+                     line.add("len", rec.len);
+                   },
+                   &stats);
+    log_json_stats(stats);
+    return;
+  }
+  log_scan_files(paths, &files,
+                 [](const log_rec_t &rec, const byte *body) {
+                   (void)body;
+                   if (rec.has_page) {
+                     printf("lsn %lu %s%s space %u page %u len %u\n", rec.lsn,
+                            mlog_type_name(rec.type),
+                            rec.single_rec ? " (single)" : "", rec.space_id,
+                            rec.page_no, rec.len);
+                   } else {
+                     printf("lsn %lu %s len %u\n", rec.lsn,
+                            mlog_type_name(rec.type), rec.len);
+                   }
+                 },
+                 &stats);
+  log_show_stats(stats);
+}
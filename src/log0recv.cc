@@ -0,0 +1,898 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include "include/log0recv.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/rem0types.h"
+#include "include/ut0crc32.h"
+#include "include/ut0mem.h"
+
+/** Bytes read from a redo log file by one pread() */
+static const size_t LOG_SCAN_CHUNK_SIZE = 8 * 1024 * 1024;
+
+/** Parsed bytes kept in front of the parse position before the window
+is compacted */
+static const size_t LOG_SCAN_COMPACT_SIZE = 1024 * 1024;
+
+/** Upper bound of a length field of a sane record body. The redo log
+does not record innodb_page_size, so the bounds of the parser allow the
+largest one. */
+static const ulint LOG_REC_MAX_BODY = 4 * UNIV_PAGE_SIZE_MAX;
+
+/** Bits of the flag byte of the index header of MLOG_REC_INSERT and the
+other records written by 8.0.28 and later */
+/* @{ */
+#define LOG_INDEX_COMPACT_FLAG 1
+#define LOG_INDEX_VERSION_FLAG 2
+#define LOG_INDEX_INSTANT_FLAG 4
+/* @} */
+
+/** Length of DB_ROLL_PTR */
+#define LOG_DATA_ROLL_PTR_LEN 7
+
+/** Null length of a field of an update vector */
+#define LOG_UNIV_SQL_NULL 0xFFFFFFFFUL
+
+lsn_t log_block_get_start_lsn(uint32_t hdr_no, lsn_t ref_lsn) {
+  const int64_t n_nos = (int64_t)LOG_BLOCK_MAX_NO + 1;
+  int64_t ref_block = (int64_t)(ref_lsn / OS_FILE_LOG_BLOCK_SIZE);
+  int64_t block = ref_block - (ref_block & LOG_BLOCK_MAX_NO) +
+                  (int64_t)((hdr_no - 1) & LOG_BLOCK_MAX_NO);
+  /* block numbers wrap at 1G: take the block nearest to the reference */
+  if (block > ref_block + n_nos / 2) {
+    block -= n_nos;
+  } else if (block + n_nos / 2 < ref_block) {
+    block += n_nos;
+  }
+  return block < 0 ? 0 : (lsn_t)block * OS_FILE_LOG_BLOCK_SIZE;
+}
+
+bool log_block_checksum_is_ok(const byte *block) {
+  uint32_t checksum =
+      mach_read_from_4(block + OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_CHECKSUM);
+  return checksum == LOG_NO_CHECKSUM_MAGIC ||
+         checksum ==
+             ut_crc32(block, OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
+}
+
+const char *mlog_type_name(ulint type) {
+  switch (type) {
+    case MLOG_1BYTE: return "MLOG_1BYTE";
+    case MLOG_2BYTES: return "MLOG_2BYTES";
+    case MLOG_4BYTES: return "MLOG_4BYTES";
+    case MLOG_8BYTES: return "MLOG_8BYTES";
+    case MLOG_REC_INSERT_8027: return "MLOG_REC_INSERT_8027";
+    case MLOG_REC_CLUST_DELETE_MARK_8027: return "MLOG_REC_CLUST_DELETE_MARK_8027";
+    case MLOG_REC_SEC_DELETE_MARK: return "MLOG_REC_SEC_DELETE_MARK";
+    case MLOG_REC_UPDATE_IN_PLACE_8027: return "MLOG_REC_UPDATE_IN_PLACE_8027";
+    case MLOG_REC_DELETE_8027: return "MLOG_REC_DELETE_8027";
+    case MLOG_LIST_END_DELETE_8027: return "MLOG_LIST_END_DELETE_8027";
+    case MLOG_LIST_START_DELETE_8027: return "MLOG_LIST_START_DELETE_8027";
+    case MLOG_LIST_END_COPY_CREATED_8027: return "MLOG_LIST_END_COPY_CREATED_8027";
+    case MLOG_PAGE_REORGANIZE_8027: return "MLOG_PAGE_REORGANIZE_8027";
+    case MLOG_PAGE_CREATE: return "MLOG_PAGE_CREATE";
+    case MLOG_UNDO_INSERT: return "MLOG_UNDO_INSERT";
+    case MLOG_UNDO_ERASE_END: return "MLOG_UNDO_ERASE_END";
+    case MLOG_UNDO_INIT: return "MLOG_UNDO_INIT";
+    case MLOG_UNDO_HDR_REUSE: return "MLOG_UNDO_HDR_REUSE";
+    case MLOG_UNDO_HDR_CREATE: return "MLOG_UNDO_HDR_CREATE";
+    case MLOG_REC_MIN_MARK: return "MLOG_REC_MIN_MARK";
+    case MLOG_IBUF_BITMAP_INIT: return "MLOG_IBUF_BITMAP_INIT";
+    case MLOG_LSN: return "MLOG_LSN";
+    case MLOG_INIT_FILE_PAGE: return "MLOG_INIT_FILE_PAGE";
+    case MLOG_WRITE_STRING: return "MLOG_WRITE_STRING";
+    case MLOG_MULTI_REC_END: return "MLOG_MULTI_REC_END";
+    case MLOG_DUMMY_RECORD: return "MLOG_DUMMY_RECORD";
+    case MLOG_FILE_CREATE: return "MLOG_FILE_CREATE";
+    case MLOG_FILE_RENAME: return "MLOG_FILE_RENAME";
+    case MLOG_FILE_DELETE: return "MLOG_FILE_DELETE";
+    case MLOG_COMP_REC_MIN_MARK: return "MLOG_COMP_REC_MIN_MARK";
+    case MLOG_COMP_PAGE_CREATE: return "MLOG_COMP_PAGE_CREATE";
+    case MLOG_COMP_REC_INSERT_8027: return "MLOG_COMP_REC_INSERT_8027";
+    case MLOG_COMP_REC_CLUST_DELETE_MARK_8027: return "MLOG_COMP_REC_CLUST_DELETE_MARK_8027";
+    case MLOG_COMP_REC_SEC_DELETE_MARK: return "MLOG_COMP_REC_SEC_DELETE_MARK";
+    case MLOG_COMP_REC_UPDATE_IN_PLACE_8027: return "MLOG_COMP_REC_UPDATE_IN_PLACE_8027";
+    case MLOG_COMP_REC_DELETE_8027: return "MLOG_COMP_REC_DELETE_8027";
+    case MLOG_COMP_LIST_END_DELETE_8027: return "MLOG_COMP_LIST_END_DELETE_8027";
+    case MLOG_COMP_LIST_START_DELETE_8027: return "MLOG_COMP_LIST_START_DELETE_8027";
+    case MLOG_COMP_LIST_END_COPY_CREATED_8027: return "MLOG_COMP_LIST_END_COPY_CREATED_8027";
+    case MLOG_COMP_PAGE_REORGANIZE_8027: return "MLOG_COMP_PAGE_REORGANIZE_8027";
+    case MLOG_ZIP_WRITE_NODE_PTR: return "MLOG_ZIP_WRITE_NODE_PTR";
+    case MLOG_ZIP_WRITE_BLOB_PTR: return "MLOG_ZIP_WRITE_BLOB_PTR";
+    case MLOG_ZIP_WRITE_HEADER: return "MLOG_ZIP_WRITE_HEADER";
+    case MLOG_ZIP_PAGE_COMPRESS: return "MLOG_ZIP_PAGE_COMPRESS";
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA_8027: return "MLOG_ZIP_PAGE_COMPRESS_NO_DATA_8027";
+    case MLOG_ZIP_PAGE_REORGANIZE_8027: return "MLOG_ZIP_PAGE_REORGANIZE_8027";
+    case MLOG_PAGE_CREATE_RTREE: return "MLOG_PAGE_CREATE_RTREE";
+    case MLOG_COMP_PAGE_CREATE_RTREE: return "MLOG_COMP_PAGE_CREATE_RTREE";
+    case MLOG_INIT_FILE_PAGE2: return "MLOG_INIT_FILE_PAGE2";
+    case MLOG_INDEX_LOAD: return "MLOG_INDEX_LOAD";
+    case MLOG_TABLE_DYNAMIC_META: return "MLOG_TABLE_DYNAMIC_META";
+    case MLOG_PAGE_CREATE_SDI: return "MLOG_PAGE_CREATE_SDI";
+    case MLOG_COMP_PAGE_CREATE_SDI: return "MLOG_COMP_PAGE_CREATE_SDI";
+    case MLOG_FILE_EXTEND: return "MLOG_FILE_EXTEND";
+    case MLOG_TEST: return "MLOG_TEST";
+    case MLOG_REC_INSERT: return "MLOG_REC_INSERT";
+    case MLOG_REC_CLUST_DELETE_MARK: return "MLOG_REC_CLUST_DELETE_MARK";
+    case MLOG_REC_DELETE: return "MLOG_REC_DELETE";
+    case MLOG_REC_UPDATE_IN_PLACE: return "MLOG_REC_UPDATE_IN_PLACE";
+    case MLOG_LIST_END_COPY_CREATED: return "MLOG_LIST_END_COPY_CREATED";
+    case MLOG_PAGE_REORGANIZE: return "MLOG_PAGE_REORGANIZE";
+    case MLOG_ZIP_PAGE_REORGANIZE: return "MLOG_ZIP_PAGE_REORGANIZE";
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA: return "MLOG_ZIP_PAGE_COMPRESS_NO_DATA";
+    case MLOG_LIST_END_DELETE: return "MLOG_LIST_END_DELETE";
+    case MLOG_LIST_START_DELETE: return "MLOG_LIST_START_DELETE";
+  }
+  return "UNKNOWN";
+}
+
+/* The parsers below follow the *_parse() functions of the server. Each
+takes the bytes [ptr, end) and returns the end of what it parsed, or
+nullptr if the record continues beyond end. A field that no server
+could have written sets *corrupt and returns nullptr. */
+
+/** Skips n bytes. */
+static const byte *log_parse_skip(const byte *ptr, const byte *end,
+                                  ulint n) {
+  return ptr != nullptr && (ulint)(end - ptr) >= n ? ptr + n : nullptr;
+}
+
+/** Parses a value written by mach_write_compressed(). */
+static const byte *log_parse_compressed(const byte *ptr, const byte *end,
+                                        uint32_t *val) {
+  if (ptr == nullptr || ptr >= end) {
+    return nullptr;
+  }
+  ulint first = *ptr;
+  ulint size = first < 0x80   ? 1
+               : first < 0xC0 ? 2
+               : first < 0xE0 ? 3
+               : first < 0xF0 ? 4
+               : first < 0xF8 ? 5
+               : first < 0xFC ? 2
+               : first < 0xFE ? 3
+                              : 4;
+  if ((ulint)(end - ptr) < size) {
+    return nullptr;
+  }
+  *val = mach_read_next_compressed(&ptr);
+  return ptr;
+}
+
+/** Parses a value written by mach_u64_write_compressed(). */
+static const byte *log_parse_u64_compressed(const byte *ptr,
+                                            const byte *end) {
+  uint32_t high;
+  return log_parse_skip(log_parse_compressed(ptr, end, &high), end, 4);
+}
+
+/** Parses a page offset, which must lie inside the page. */
+static const byte *log_parse_offset(const byte *ptr, const byte *end,
+                                    bool *corrupt) {
+  if (log_parse_skip(ptr, end, 2) == nullptr) {
+    return nullptr;
+  }
+  if (mach_read_from_2(ptr) >= UNIV_PAGE_SIZE_MAX) {
+    *corrupt = true;
+    return nullptr;
+  }
+  return ptr + 2;
+}
+
+/** Parses a 2-byte length followed by that many bytes. */
+static const byte *log_parse_string(const byte *ptr, const byte *end) {
+  if (log_parse_skip(ptr, end, 2) == nullptr) {
+    return nullptr;
+  }
+  return log_parse_skip(ptr + 2, end, mach_read_from_2(ptr));
+}
+
+/** Parses the n, n_uniq and field lengths of the index written before
+8.0.28, as mlog_parse_index_8027() does. */
+static const byte *log_parse_index_8027(const byte *ptr, const byte *end,
+                                        bool comp, bool *corrupt) {
+  if (!comp) {
+    return ptr;
+  }
+  if (log_parse_skip(ptr, end, 4) == nullptr) {
+    return nullptr;
+  }
+  ulint n = mach_read_from_2(ptr);
+  ptr += 2;
+  if (n & 0x8000) {
+    /* a table with instantly added columns: the instant column count
+    comes first */
+    n = mach_read_from_2(ptr);
+    ptr += 2;
+    if (log_parse_skip(ptr, end, 2) == nullptr) {
+      return nullptr;
+    }
+  }
+  ulint n_uniq = mach_read_from_2(ptr);
+  ptr += 2;
+  if (n == 0 || n > REC_MAX_N_FIELDS || n_uniq > n) {
+    *corrupt = true;
+    return nullptr;
+  }
+  return log_parse_skip(ptr, end, n * 2);
+}
+
+/** Parses the versioned index header written by 8.0.28 and later, as
+mlog_parse_index() does. */
+static const byte *log_parse_index(const byte *ptr, const byte *end,
+                                   bool *corrupt) {
+  if (log_parse_skip(ptr, end, 2) == nullptr) {
+    return nullptr;
+  }
+  byte flag = ptr[1];
+  ptr += 2;
+  bool comp = flag & LOG_INDEX_COMPACT_FLAG;
+  bool versioned = flag & LOG_INDEX_VERSION_FLAG;
+  bool instant = flag & LOG_INDEX_INSTANT_FLAG;
+  if (flag & ~(LOG_INDEX_COMPACT_FLAG | LOG_INDEX_VERSION_FLAG |
+               LOG_INDEX_INSTANT_FLAG)) {
+    *corrupt = true;
+    return nullptr;
+  }
+  if (!comp && !versioned) {
+    return ptr;
+  }
+
+  ulint n_header = 4 + (instant ? 2 : 0);
+  if (log_parse_skip(ptr, end, n_header) == nullptr) {
+    return nullptr;
+  }
+  ulint n = mach_read_from_2(ptr);
+  ulint n_uniq = mach_read_from_2(ptr + n_header - 2);
+  ptr += n_header;
+  if (n == 0 || n > REC_MAX_N_FIELDS || n_uniq > n) {
+    *corrupt = true;
+    return nullptr;
+  }
+
+  if (versioned) {
+    /* fields whose physical position or visibility differs between row
+    versions: position, physical position and the versions that added
+    or dropped them */
+    if (log_parse_skip(ptr, end, 2) == nullptr) {
+      return nullptr;
+    }
+    ulint n_changed = mach_read_from_2(ptr);
+    ptr += 2;
+    if (n_changed > n) {
+      *corrupt = true;
+      return nullptr;
+    }
+    for (ulint i = 0; i < n_changed; i++) {
+      if (log_parse_skip(ptr, end, 4) == nullptr) {
+        return nullptr;
+      }
+      ulint phy_pos = mach_read_from_2(ptr + 2);
+      ptr += 4;
+      ulint n_versions = ((phy_pos & 0x8000) ? 1 : 0) +
+                         ((phy_pos & 0x4000) ? 1 : 0);
+      if ((ptr = log_parse_skip(ptr, end, n_versions)) == nullptr) {
+        return nullptr;
+      }
+    }
+  }
+  return log_parse_skip(ptr, end, n * 2);
+}
+
+/** Parses the index header of a record type. */
+static const byte *log_parse_rec_index(mlog_id_t type, const byte *ptr,
+                                       const byte *end, bool *corrupt) {
+  switch (type) {
+    case MLOG_REC_INSERT:
+    case MLOG_REC_CLUST_DELETE_MARK:
+    case MLOG_REC_DELETE:
+    case MLOG_REC_UPDATE_IN_PLACE:
+    case MLOG_LIST_END_COPY_CREATED:
+    case MLOG_PAGE_REORGANIZE:
+    case MLOG_ZIP_PAGE_REORGANIZE:
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA:
+    case MLOG_LIST_END_DELETE:
+    case MLOG_LIST_START_DELETE:
+      return log_parse_index(ptr, end, corrupt);
+    case MLOG_COMP_REC_INSERT_8027:
+    case MLOG_COMP_REC_CLUST_DELETE_MARK_8027:
+    case MLOG_COMP_REC_SEC_DELETE_MARK:
+    case MLOG_COMP_REC_UPDATE_IN_PLACE_8027:
+    case MLOG_COMP_REC_DELETE_8027:
+    case MLOG_COMP_LIST_END_DELETE_8027:
+    case MLOG_COMP_LIST_START_DELETE_8027:
+    case MLOG_COMP_LIST_END_COPY_CREATED_8027:
+    case MLOG_COMP_PAGE_REORGANIZE_8027:
+    case MLOG_ZIP_PAGE_REORGANIZE_8027:
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA_8027:
+      return log_parse_index_8027(ptr, end, true, corrupt);
+    default:
+      return log_parse_index_8027(ptr, end, false, corrupt);
+  }
+}
+
+/** Parses an inserted record, as page_cur_parse_insert_rec() does. */
+static const byte *log_parse_insert(const byte *ptr, const byte *end,
+                                    bool *corrupt) {
+  uint32_t end_seg_len;
+  uint32_t val;
+  ptr = log_parse_compressed(log_parse_offset(ptr, end, corrupt), end,
+                             &end_seg_len);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  if (end_seg_len >= 2 * UNIV_PAGE_SIZE_MAX) {
+    *corrupt = true;
+    return nullptr;
+  }
+  if (end_seg_len & 0x1UL) {
+    /* info and status bits, origin offset and mismatch index */
+    ptr = log_parse_skip(ptr, end, 1);
+    for (int i = 0; i < 2 && ptr != nullptr; i++) {
+      ptr = log_parse_compressed(ptr, end, &val);
+      if (ptr != nullptr && val >= UNIV_PAGE_SIZE_MAX) {
+        *corrupt = true;
+        return nullptr;
+      }
+    }
+  }
+  return log_parse_skip(ptr, end, end_seg_len >> 1);
+}
+
+/** Parses the system columns written by row_upd_write_sys_vals_to_log(). */
+static const byte *log_parse_sys_vals(const byte *ptr, const byte *end) {
+  uint32_t pos;
+  ptr = log_parse_skip(log_parse_compressed(ptr, end, &pos), end,
+                       LOG_DATA_ROLL_PTR_LEN);
+  return log_parse_u64_compressed(ptr, end);
+}
+
+/** Parses an update vector, as row_upd_index_parse() does. */
+static const byte *log_parse_update(const byte *ptr, const byte *end,
+                                    bool *corrupt) {
+  uint32_t n_fields;
+  ptr = log_parse_compressed(log_parse_skip(ptr, end, 1), end, &n_fields);
+  if (ptr != nullptr && n_fields > REC_MAX_N_FIELDS) {
+    *corrupt = true;
+    return nullptr;
+  }
+  for (uint32_t i = 0; i < n_fields && ptr != nullptr; i++) {
+    uint32_t field_no;
+    uint32_t len;
+    ptr = log_parse_compressed(log_parse_compressed(ptr, end, &field_no), end,
+                               &len);
+    if (ptr == nullptr || len == LOG_UNIV_SQL_NULL) {
+      continue;
+    }
+    if (len > LOG_REC_MAX_BODY) {
+      *corrupt = true;
+      return nullptr;
+    }
+    ptr = log_parse_skip(ptr, end, len);
+  }
+  return ptr;
+}
+
+/** Parses the body of a record that follows its space id and page number.
+@return end of the body, nullptr if incomplete or corrupt */
+static const byte *log_parse_body(mlog_id_t type, const byte *ptr,
+                                  const byte *end, bool *corrupt) {
+  uint32_t val;
+  switch (type) {
+    case MLOG_1BYTE:
+    case MLOG_2BYTES:
+    case MLOG_4BYTES:
+      return log_parse_compressed(log_parse_offset(ptr, end, corrupt), end,
+                                  &val);
+    case MLOG_8BYTES:
+      return log_parse_u64_compressed(log_parse_offset(ptr, end, corrupt),
+                                      end);
+
+    case MLOG_REC_INSERT_8027:
+    case MLOG_COMP_REC_INSERT_8027:
+    case MLOG_REC_INSERT:
+      return log_parse_insert(log_parse_rec_index(type, ptr, end, corrupt),
+                              end, corrupt);
+
+    case MLOG_REC_CLUST_DELETE_MARK_8027:
+    case MLOG_COMP_REC_CLUST_DELETE_MARK_8027:
+    case MLOG_REC_CLUST_DELETE_MARK:
+      /* flags, value, system columns, offset */
+      ptr = log_parse_skip(log_parse_rec_index(type, ptr, end, corrupt), end,
+                           2);
+      return log_parse_offset(log_parse_sys_vals(ptr, end), end, corrupt);
+
+    case MLOG_REC_SEC_DELETE_MARK:
+    case MLOG_COMP_REC_SEC_DELETE_MARK:
+      ptr = log_parse_skip(log_parse_rec_index(type, ptr, end, corrupt), end,
+                           1);
+      return log_parse_offset(ptr, end, corrupt);
+
+    case MLOG_REC_UPDATE_IN_PLACE_8027:
+    case MLOG_COMP_REC_UPDATE_IN_PLACE_8027:
+    case MLOG_REC_UPDATE_IN_PLACE:
+      ptr = log_parse_skip(log_parse_rec_index(type, ptr, end, corrupt), end,
+                           1);
+      ptr = log_parse_offset(log_parse_sys_vals(ptr, end), end, corrupt);
+      return log_parse_update(ptr, end, corrupt);
+
+    case MLOG_REC_DELETE_8027:
+    case MLOG_COMP_REC_DELETE_8027:
+    case MLOG_REC_DELETE:
+    case MLOG_LIST_END_DELETE_8027:
+    case MLOG_COMP_LIST_END_DELETE_8027:
+    case MLOG_LIST_END_DELETE:
+    case MLOG_LIST_START_DELETE_8027:
+    case MLOG_COMP_LIST_START_DELETE_8027:
+    case MLOG_LIST_START_DELETE:
+      return log_parse_offset(log_parse_rec_index(type, ptr, end, corrupt),
+                              end, corrupt);
+
+    case MLOG_LIST_END_COPY_CREATED_8027:
+    case MLOG_COMP_LIST_END_COPY_CREATED_8027:
+    case MLOG_LIST_END_COPY_CREATED:
+      ptr = log_parse_rec_index(type, ptr, end, corrupt);
+      if (log_parse_skip(ptr, end, 4) == nullptr) {
+        return nullptr;
+      }
+      if (mach_read_from_4(ptr) > LOG_REC_MAX_BODY) {
+        *corrupt = true;
+        return nullptr;
+      }
+      return log_parse_skip(ptr + 4, end, mach_read_from_4(ptr));
+
+    case MLOG_PAGE_REORGANIZE_8027:
+    case MLOG_COMP_PAGE_REORGANIZE_8027:
+    case MLOG_PAGE_REORGANIZE:
+      return log_parse_rec_index(type, ptr, end, corrupt);
+
+    case MLOG_ZIP_PAGE_REORGANIZE_8027:
+    case MLOG_ZIP_PAGE_REORGANIZE:
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA_8027:
+    case MLOG_ZIP_PAGE_COMPRESS_NO_DATA:
+      /* compression level */
+      return log_parse_skip(log_parse_rec_index(type, ptr, end, corrupt), end,
+                            1);
+
+    case MLOG_PAGE_CREATE:
+    case MLOG_COMP_PAGE_CREATE:
+    case MLOG_PAGE_CREATE_RTREE:
+    case MLOG_COMP_PAGE_CREATE_RTREE:
+    case MLOG_PAGE_CREATE_SDI:
+    case MLOG_COMP_PAGE_CREATE_SDI:
+    case MLOG_INIT_FILE_PAGE:
+    case MLOG_INIT_FILE_PAGE2:
+    case MLOG_IBUF_BITMAP_INIT:
+    case MLOG_UNDO_ERASE_END:
+      return ptr;
+
+    case MLOG_REC_MIN_MARK:
+    case MLOG_COMP_REC_MIN_MARK:
+      return log_parse_offset(ptr, end, corrupt);
+
+    case MLOG_UNDO_INSERT:
+      return log_parse_string(ptr, end);
+    case MLOG_UNDO_INIT:
+      return log_parse_compressed(ptr, end, &val);
+    case MLOG_UNDO_HDR_REUSE:
+    case MLOG_UNDO_HDR_CREATE:
+      return log_parse_u64_compressed(ptr, end);
+
+    case MLOG_WRITE_STRING:
+      return log_parse_string(log_parse_offset(ptr, end, corrupt), end);
+
+    case MLOG_FILE_CREATE:
+      /* tablespace flags, then the file name */
+      return log_parse_string(log_parse_skip(ptr, end, 4), end);
+    case MLOG_FILE_RENAME:
+      return log_parse_string(log_parse_string(ptr, end), end);
+    case MLOG_FILE_DELETE:
+      return log_parse_string(ptr, end);
+    case MLOG_FILE_EXTEND:
+      /* offset and size of the extension */
+      return log_parse_skip(ptr, end, 16);
+    case MLOG_INDEX_LOAD:
+      return log_parse_skip(ptr, end, 8);
+
+    case MLOG_ZIP_WRITE_NODE_PTR:
+      return log_parse_skip(ptr, end, 2 + 2 + 4);
+    case MLOG_ZIP_WRITE_BLOB_PTR:
+      return log_parse_skip(ptr, end, 2 + 2 + 20);
+    case MLOG_ZIP_WRITE_HEADER:
+      if (log_parse_skip(ptr, end, 2) == nullptr) {
+        return nullptr;
+      }
+      return log_parse_skip(ptr + 2, end, ptr[1]);
+    case MLOG_ZIP_PAGE_COMPRESS:
+      /* size and trailer size, the FIL_PAGE_PREV and FIL_PAGE_NEXT
+      fields, then the compressed data and its trailer */
+      if (log_parse_skip(ptr, end, 4) == nullptr) {
+        return nullptr;
+      }
+      val = mach_read_from_2(ptr) + mach_read_from_2(ptr + 2);
+      if (val > UNIV_PAGE_SIZE_MAX) {
+        *corrupt = true;
+        return nullptr;
+      }
+      return log_parse_skip(ptr + 4, end, 8 + val);
+
+    default:
+      /* MLOG_LSN and MLOG_TEST are never written by a release server;
+      the body of MLOG_TABLE_DYNAMIC_META is not described by any length */
+      *corrupt = true;
+      return nullptr;
+  }
+}
+
+/** Outcome of parsing one record */
+enum log_parse_status_t { LOG_PARSE_OK, LOG_PARSE_INCOMPLETE, LOG_PARSE_CORRUPT };
+
+/** Parses one record of the bytes [ptr, end).
+@param[out]  rec  the record; lsn is left alone
+@return status */
+static log_parse_status_t log_parse_rec(const byte *ptr, const byte *end,
+                                        log_rec_t *rec) {
+  if (ptr >= end) {
+    return LOG_PARSE_INCOMPLETE;
+  }
+  const byte *start = ptr;
+  ulint type = *ptr & ~MLOG_SINGLE_REC_FLAG;
+  rec->single_rec = *ptr & MLOG_SINGLE_REC_FLAG;
+  rec->type = (mlog_id_t)type;
+  rec->space_id = 0;
+  rec->page_no = 0;
+  rec->has_page = false;
+  ptr++;
+
+  if (type == MLOG_MULTI_REC_END || type == MLOG_DUMMY_RECORD) {
+    if (rec->single_rec) {
+      return LOG_PARSE_CORRUPT;
+    }
+    rec->len = 1;
+    return LOG_PARSE_OK;
+  }
+  if (type == 0 || type > MLOG_BIGGEST_TYPE) {
+    return LOG_PARSE_CORRUPT;
+  }
+
+  uint32_t space_id;
+  uint32_t page_no;
+  ptr = log_parse_compressed(log_parse_compressed(ptr, end, &space_id), end,
+                             &page_no);
+  if (ptr == nullptr) {
+    return LOG_PARSE_INCOMPLETE;
+  }
+  rec->has_page = true;
+  rec->space_id = space_id;
+  rec->page_no = page_no;
+
+  bool corrupt = false;
+  ptr = log_parse_body(rec->type, ptr, end, &corrupt);
+  if (corrupt) {
+    return LOG_PARSE_CORRUPT;
+  }
+  if (ptr == nullptr) {
+    return LOG_PARSE_INCOMPLETE;
+  }
+  rec->len = ptr - start;
+  return LOG_PARSE_OK;
+}
+
+bool log_expand_paths(const char *path, std::vector<std::string> *paths) {
+  fil_expand_paths(path, {"#ib_redo[0-9]*", "ib_logfile[0-9]*"}, paths);
+  /* spare files of 8.0.30 hold no log yet */
+  paths->erase(std::remove_if(paths->begin(), paths->end(),
+                              [](const std::string &p) {
+                                return p.size() >= 4 &&
+                                       p.compare(p.size() - 4, 4, "_tmp") == 0;
+                              }),
+               paths->end());
+  if (paths->empty()) {
+    fprintf(stderr, "No redo log file matches %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+bool log_read_file_header(int fd, log_file_info_t *info) {
+  byte hdr[LOG_FILE_HDR_SIZE];
+  info->header_ok = false;
+  info->format = 0;
+  info->start_lsn = 0;
+  info->uuid = 0;
+  info->flags = 0;
+  info->creator[0] = '\0';
+  memset(info->checkpoints, 0, sizeof(info->checkpoints));
+  if (pread(fd, hdr, LOG_FILE_HDR_SIZE, 0) != LOG_FILE_HDR_SIZE) {
+    return false;
+  }
+
+  info->header_ok = log_block_checksum_is_ok(hdr);
+  info->format = mach_read_from_4(hdr + LOG_HEADER_FORMAT);
+  info->uuid = mach_read_from_4(hdr + LOG_HEADER_PAD1);
+  info->start_lsn = mach_read_from_8(hdr + LOG_HEADER_START_LSN);
+  memcpy(info->creator, hdr + LOG_HEADER_CREATOR,
+         LOG_HEADER_CREATOR_END - LOG_HEADER_CREATOR);
+  info->creator[LOG_HEADER_CREATOR_END - LOG_HEADER_CREATOR] = '\0';
+  for (char *p = info->creator; *p != '\0'; p++) {
+    if (*p < ' ' || *p > '~') {
+      *p = '?';
+    }
+  }
+  if (info->format >= LOG_HEADER_FORMAT_8_0_30) {
+    info->flags = mach_read_from_4(hdr + LOG_HEADER_FLAGS);
+  }
+
+  static const ulint offsets[2] = {LOG_CHECKPOINT_1, LOG_CHECKPOINT_2};
+  for (int i = 0; i < 2; i++) {
+    const byte *block = hdr + offsets[i];
+    log_checkpoint_t *cp = &info->checkpoints[i];
+    cp->checksum_ok = log_block_checksum_is_ok(block);
+    cp->no = mach_read_from_8(block + LOG_CHECKPOINT_NO);
+    cp->lsn = mach_read_from_8(block + LOG_CHECKPOINT_LSN);
+    cp->offset = mach_read_from_8(block + LOG_CHECKPOINT_OFFSET);
+  }
+  return true;
+}
+
+/** Reassembles the log data of consecutive intact blocks and parses the
+records in it. The window holds the log data of the blocks appended
+since the last gap, minus what was parsed and compacted away. */
+class Log_scanner {
+ public:
+  Log_scanner(const log_rec_func_t &func, log_scan_stats_t *stats)
+      : m_func(func), m_stats(stats), m_pos(0), m_synced(false),
+        m_next_lsn(0) {}
+
+  /** Appends an intact block holding log data.
+  @param[in]  block      the block
+  @param[in]  lsn        start lsn of the block */
+  void add_block(const byte *block, lsn_t lsn) {
+    ulint data_len = mach_read_from_2(block + LOG_BLOCK_HDR_DATA_LEN);
+    ulint first_rec_group = mach_read_from_2(block + LOG_BLOCK_FIRST_REC_GROUP);
+    ulint data_end = std::min<ulint>(data_len,
+                                     OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE);
+    if (!m_window.empty() && lsn != m_next_lsn) {
+      gap();
+    }
+
+    ulint data_start = LOG_BLOCK_HDR_SIZE;
+    if (!m_synced) {
+      /* an mtr is parseable only from its start */
+      if (first_rec_group < LOG_BLOCK_HDR_SIZE ||
+          first_rec_group >= data_end) {
+        m_stats->n_skipped_bytes += data_end - LOG_BLOCK_HDR_SIZE;
+        return;
+      }
+      m_stats->n_skipped_bytes += first_rec_group - LOG_BLOCK_HDR_SIZE;
+      data_start = first_rec_group;
+      m_synced = true;
+    }
+
+    size_t offset = m_window.size();
+    m_blocks.push_back(std::make_pair(offset, lsn + data_start));
+    if (first_rec_group >= data_start && first_rec_group < data_end) {
+      m_groups.push_back(offset + first_rec_group - data_start);
+    }
+    m_window.insert(m_window.end(), block + data_start, block + data_end);
+    m_next_lsn = lsn + OS_FILE_LOG_BLOCK_SIZE;
+
+    parse();
+
+    /* a block that is not full is the last one written */
+    if (data_len < OS_FILE_LOG_BLOCK_SIZE) {
+      gap();
+    }
+  }
+
+  /** Ends the current stretch of log: what is left unparsed is an mtr
+  cut off by a gap. */
+  void gap() {
+    m_stats->n_tail_bytes += m_window.size() - m_pos;
+    m_window.clear();
+    m_blocks.clear();
+    m_groups.clear();
+    m_pos = 0;
+    m_synced = false;
+  }
+
+ private:
+  /** @return lsn of a byte of the window */
+  lsn_t window_lsn(size_t pos) const {
+    auto it = std::upper_bound(
+        m_blocks.begin(), m_blocks.end(), std::make_pair(pos, ~(lsn_t)0));
+    --it;
+    return it->second + (pos - it->first);
+  }
+
+  /** Parses the complete records of the window. */
+  void parse() {
+    const byte *begin = m_window.data();
+    const byte *end = begin + m_window.size();
+    log_rec_t rec;
+    while (m_pos < m_window.size()) {
+      log_parse_status_t status = log_parse_rec(begin + m_pos, end, &rec);
+      if (status == LOG_PARSE_INCOMPLETE) {
+        break;
+      }
+      if (status == LOG_PARSE_CORRUPT) {
+        resync();
+        continue;
+      }
+      rec.lsn = window_lsn(m_pos);
+      m_stats->n_recs++;
+      m_stats->n_rec_bytes += rec.len;
+      m_stats->n_type_recs[rec.type]++;
+      m_stats->n_type_bytes[rec.type] += rec.len;
+      if (m_func) {
+        m_func(rec, begin + m_pos);
+      }
+      m_pos += rec.len;
+    }
+    if (m_pos >= LOG_SCAN_COMPACT_SIZE) {
+      compact();
+    }
+  }
+
+  /** Skips to the next mtr start after the parse position. */
+  void resync() {
+    m_stats->n_resyncs++;
+    auto it = std::upper_bound(m_groups.begin(), m_groups.end(), m_pos);
+    size_t next = it == m_groups.end() ? m_window.size() : *it;
+    m_stats->n_skipped_bytes += next - m_pos;
+    m_pos = next;
+    if (it == m_groups.end()) {
+      /* wait for a block holding the start of an mtr */
+      m_window.clear();
+      m_blocks.clear();
+      m_groups.clear();
+      m_pos = 0;
+      m_synced = false;
+    }
+  }
+
+  /** Drops the parsed bytes in front of the window. */
+  void compact() {
+    size_t drop = m_pos;
+    auto bit = std::upper_bound(m_blocks.begin(), m_blocks.end(),
+                                std::make_pair(drop, ~(lsn_t)0));
+    --bit;
+    /* the block holding the parse position now starts at it */
+    bit->second += drop - bit->first;
+    bit->first = drop;
+    m_blocks.erase(m_blocks.begin(), bit);
+    for (auto &b : m_blocks) {
+      b.first -= drop;
+    }
+    m_groups.erase(m_groups.begin(),
+                   std::lower_bound(m_groups.begin(), m_groups.end(), drop));
+    for (size_t &g : m_groups) {
+      g -= drop;
+    }
+    m_window.erase(m_window.begin(), m_window.begin() + drop);
+    m_pos = 0;
+  }
+
+  const log_rec_func_t &m_func;
+  log_scan_stats_t *m_stats;
+
+  std::vector<byte> m_window;
+  /** window offset and lsn of the first byte of every block in it */
+  std::vector<std::pair<size_t, lsn_t>> m_blocks;
+  /** window offsets where an mtr starts, from LOG_BLOCK_FIRST_REC_GROUP */
+  std::vector<size_t> m_groups;
+  /** parse position in the window */
+  size_t m_pos;
+  /** whether the window starts at the start of an mtr */
+  bool m_synced;
+  /** lsn of the block expected next */
+  lsn_t m_next_lsn;
+};
+
+/** Scans the blocks of one file after its header. */
+static void log_scan_file(int fd, lsn_t ref_lsn, byte *buf,
+                          log_file_info_t *info, Log_scanner *scanner) {
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  info->n_blocks = info->n_valid = info->n_bad_checksum = info->n_empty = 0;
+  info->first_lsn = info->end_lsn = 0;
+
+  for (uint64_t offset = LOG_FILE_HDR_SIZE; offset < info->size;) {
+    ssize_t n = pread(fd, buf, LOG_SCAN_CHUNK_SIZE, offset);
+    if (n < (ssize_t)OS_FILE_LOG_BLOCK_SIZE) {
+      break;
+    }
+    n -= n % OS_FILE_LOG_BLOCK_SIZE;
+    for (ssize_t i = 0; i < n; i += OS_FILE_LOG_BLOCK_SIZE) {
+      const byte *block = buf + i;
+      info->n_blocks++;
+      if (ut_is_zeroes(block, OS_FILE_LOG_BLOCK_SIZE)) {
+        info->n_empty++;
+        scanner->gap();
+        continue;
+      }
+      if (!log_block_checksum_is_ok(block)) {
+        info->n_bad_checksum++;
+        scanner->gap();
+        continue;
+      }
+      ulint data_len = mach_read_from_2(block + LOG_BLOCK_HDR_DATA_LEN);
+      if (data_len <= LOG_BLOCK_HDR_SIZE) {
+        info->n_empty++;
+        scanner->gap();
+        continue;
+      }
+      info->n_valid++;
+      lsn_t lsn = log_block_get_start_lsn(log_block_get_hdr_no(block), ref_lsn);
+      lsn_t data_end = lsn + std::min<ulint>(data_len, OS_FILE_LOG_BLOCK_SIZE -
+                                                           LOG_BLOCK_TRL_SIZE);
+      if (info->first_lsn == 0 || lsn + LOG_BLOCK_HDR_SIZE < info->first_lsn) {
+        info->first_lsn = lsn + LOG_BLOCK_HDR_SIZE;
+      }
+      info->end_lsn = std::max(info->end_lsn, data_end);
+      scanner->add_block(block, lsn);
+    }
+    offset += n;
+  }
+}
+
+void log_scan_files(const std::vector<std::string> &paths,
+                    std::vector<log_file_info_t> *files,
+                    const log_rec_func_t &func, log_scan_stats_t *stats) {
+  files->assign(paths.size(), log_file_info_t());
+  std::vector<int> fds(paths.size(), -1);
+  lsn_t max_checkpoint_lsn = 0;
+  for (size_t i = 0; i < paths.size(); i++) {
+    log_file_info_t *info = &(*files)[i];
+    struct stat stat_buf;
+    info->path = paths[i];
+    info->size = 0;
+    fds[i] = open(paths[i].c_str(), O_RDONLY);
+    if (fds[i] == -1) {
+      fprintf(stderr, "Open %s failed: %s\n", paths[i].c_str(),
+              strerror(errno));
+      continue;
+    }
+    if (fstat(fds[i], &stat_buf) == 0) {
+      info->size = stat_buf.st_size;
+    }
+    log_read_file_header(fds[i], info);
+    for (const log_checkpoint_t &cp : info->checkpoints) {
+      if (cp.checksum_ok && cp.lsn > max_checkpoint_lsn) {
+        max_checkpoint_lsn = cp.lsn;
+      }
+    }
+  }
+
+  byte *buf;
+  if (posix_memalign((void **)&buf, OS_FILE_LOG_BLOCK_SIZE,
+                     LOG_SCAN_CHUNK_SIZE) != 0) {
+    fprintf(stderr, "log_scan_files out of memory\n");
+    return;
+  }
+  Log_scanner scanner(func, stats);
+  for (size_t i = 0; i < paths.size(); i++) {
+    log_file_info_t *info = &(*files)[i];
+    if (fds[i] == -1) {
+      scanner.gap();
+      continue;
+    }
+    /* block numbers wrap at 1G blocks, the files of 8.0.30 carry the lsn
+    they start at and older ones are near the latest checkpoint */
+    lsn_t ref_lsn = info->header_ok && info->format >= LOG_HEADER_FORMAT_8_0_30
+                        ? info->start_lsn
+                        : max_checkpoint_lsn;
+    log_scan_file(fds[i], ref_lsn, buf, info, &scanner);
+    close(fds[i]);
+  }
+  scanner.gap();
+  free(buf);
+}
@@ -23,6 +23,11 @@ uint16_t mach_read_from_2(const byte *b) {
   return (((ulint)(b[0]) << 8) | (ulint)(b[1]));
 }
 
+uint32_t mach_read_from_3(const byte *b) {
+  return ((static_cast<uint32_t>(b[0]) << 16) |
+      (static_cast<uint32_t>(b[1]) << 8) | static_cast<uint32_t>(b[2]));
+}
+
 uint32_t mach_read_from_4(const byte *b) {
   return ((static_cast<uint32_t>(b[0]) << 24) |
       (static_cast<uint32_t>(b[1]) << 16) |
@@ -47,6 +52,77 @@ uint64_t mach_read_from_8(const byte *b) {
   return (u64);
 }
 
+/** Read a 32-bit integer in a compressed form and advance the pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned value */
+uint32_t mach_read_next_compressed(const byte **b) {
+  uint32_t val = mach_read_from_1(*b);
+
+  if (val < 0x80) {
+    /* 0nnnnnnn (7 bits) */
+    ++*b;
+  } else if (val < 0xC0) {
+    /* 10nnnnnn nnnnnnnn (14 bits) */
+    val = mach_read_from_2(*b) & 0x3FFF;
+    *b += 2;
+  } else if (val < 0xE0) {
+    /* 110nnnnn nnnnnnnn nnnnnnnn (21 bits) */
+    val = mach_read_from_3(*b) & 0x1FFFFF;
+    *b += 3;
+  } else if (val < 0xF0) {
+    /* 1110nnnn nnnnnnnn nnnnnnnn nnnnnnnn (28 bits) */
+    val = mach_read_from_4(*b) & 0xFFFFFFF;
+    *b += 4;
+  } else if (val < 0xF8) {
+    /* 11110000 nnnnnnnn nnnnnnnn nnnnnnnn nnnnnnnn (32 bits) */
+    val = mach_read_from_4(*b + 1);
+    *b += 5;
+  } else if (val < 0xFC) {
+    /* 111110nn nnnnnnnn (10 bits) (extended) */
+    val = (mach_read_from_2(*b) & 0x3FF) | 0xFFFFFC00;
+    *b += 2;
+  } else if (val < 0xFE) {
+    /* 1111110n nnnnnnnn nnnnnnnn (17 bits) (extended) */
+    val = (mach_read_from_3(*b) & 0x1FFFF) | 0xFFFE0000;
+    *b += 3;
+  } else {
+    /* 11111110 nnnnnnnn nnnnnnnn nnnnnnnn (24 bits) (extended) */
+    val = (mach_read_from_4(*b) & 0xFFFFFF) | 0xFF000000;
+    *b += 4;
+  }
+  return (val);
+}
+
+/** Read a 64-bit integer in a compressed form and advance the pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned value */
+uint64_t mach_u64_read_next_compressed(const byte **b) {
+  uint64_t val = mach_read_next_compressed(b);
+  val <<= 32;
+  val |= mach_read_from_4(*b);
+  *b += 4;
+  return (val);
+}
+
+/** Read a 64-bit integer in a much compressed form and advance the
+pointer.
+@param[in,out]	b	pointer to memory where to read;
+advanced by the number of bytes consumed
+@return unsigned 64-bit integer */
+uint64_t mach_read_next_much_compressed(const byte **b) {
+  uint64_t val = mach_read_from_1(*b);
+
+  if (val != 0xFF) {
+    return (mach_read_next_compressed(b));
+  }
+  ++*b;
+  val = mach_read_next_compressed(b);
+  val <<= 32;
+  val |= mach_read_next_compressed(b);
+  return (val);
+}
 
 /** The following function is used to store data in one byte.
 @param[in]	b	pointer to byte where to store
@@ -97,3 +173,25 @@ void mach_write_to_4(byte *b, ulint n) {
   b[3] = static_cast<byte>(n);
 }
 
+/** The following function is used to store data in 6 consecutive
+bytes. We store the most significant byte to the lowest address.
+@param[in]  b pointer to 6 bytes where to store
+@param[in]  n 48-bit integer to be stored */
+void mach_write_to_6(byte *b, uint64_t n) {
+  ut_ad(b);
+
+  mach_write_to_2(b, static_cast<ulint>(n >> 32));
+  mach_write_to_4(b + 2, static_cast<ulint>(n));
+}
+
+/** The following function is used to store data in 8 consecutive
+bytes. We store the most significant byte to the lowest address.
+@param[in]  b pointer to 8 bytes where to store
+@param[in]  n 64-bit integer to be stored */
+void mach_write_to_8(byte *b, uint64_t n) {
+  ut_ad(b);
+
+  mach_write_to_4(b, static_cast<ulint>(n >> 32));
+  mach_write_to_4(b + 4, static_cast<ulint>(n));
+}
+
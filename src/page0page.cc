@@ -1,4 +1,8 @@
+#include <string.h>
+
 #include "include/page0page.h"
+#include "include/fsp0types.h"
+#include "include/rem0rec.h"
 
 /** Gets the page number.
  @return page number */
@@ -15,8 +19,8 @@ space_id_t page_get_space_id(const page_t *page) /*!< in: page */
 }
 
 
-page_t *align_page(const void* ptr) {
-  return((page_t*)(((reinterpret_cast<uint64_t>(ptr))) & ~(UNIV_PAGE_SIZE - 1)));
+page_t *align_page(const void* ptr, ulint page_size) {
+  return((page_t*)(((reinterpret_cast<uint64_t>(ptr))) & ~((uint64_t)page_size - 1)));
 }
 
 /** Reads the given header field. */
@@ -42,3 +46,68 @@ page_is_leaf(
 {
   return(!*(const uint16*) (page + (PAGE_HEADER + PAGE_LEVEL)));
 }
+
+const char *page_check_name(page_check_t check) {
+  switch (check) {
+    case PAGE_CHECK_OK:
+      return "ok";
+    case PAGE_CHECK_HEADER:
+      return "bad page header";
+    case PAGE_CHECK_LINK:
+      return "record link out of the heap";
+    case PAGE_CHECK_LOOP:
+      return "record links loop";
+    case PAGE_CHECK_STATUS:
+      return "record status does not fit the page level";
+    case PAGE_CHECK_N_RECS:
+      return "record count differs from PAGE_N_RECS";
+  }
+  return "unknown";
+}
+
+page_check_t Page_rec_check::check(const page_t *page, ulint page_size) {
+  const ulint n_heap = page_dir_get_n_heap(page);
+  const ulint heap_top = page_header_get_field(page, PAGE_HEAP_TOP);
+  m_n_recs = 0;
+  m_bad_offset = 0;
+  if (n_heap < PAGE_HEAP_NO_USER_LOW || heap_top < PAGE_NEW_SUPREMUM_END ||
+      heap_top > page_size - FIL_PAGE_DATA_END ||
+      memcmp(page + PAGE_NEW_INFIMUM, "infimum", 8) != 0 ||
+      memcmp(page + PAGE_NEW_SUPREMUM, "supremum", 8) != 0) {
+    return PAGE_CHECK_HEADER;
+  }
+  const ulint status =
+      page_is_leaf(page) ? REC_STATUS_ORDINARY : REC_STATUS_NODE_PTR;
+  m_seen.assign((n_heap + 63) / 64, 0);
+
+  ulint rec_off = PAGE_NEW_INFIMUM;
+  while (true) {
+    ulint next = rec_get_next_offs(page, rec_off, page_size);
+    if (next == PAGE_NEW_SUPREMUM) {
+      break;
+    }
+    if (next < PAGE_NEW_SUPREMUM_END + REC_N_NEW_EXTRA_BYTES ||
+        next >= heap_top) {
+      m_bad_offset = rec_off;
+      return PAGE_CHECK_LINK;
+    }
+    rec_off = next;
+    m_bad_offset = rec_off;
+    const rec_t *rec = page + rec_off;
+    ulint heap_no = rec_get_bit_field_2(rec, REC_NEW_HEAP_NO,
+                                        REC_HEAP_NO_MASK, REC_HEAP_NO_SHIFT);
+    if (rec_get_status(rec) != status) {
+      return PAGE_CHECK_STATUS;
+    }
+    if (heap_no < PAGE_HEAP_NO_USER_LOW || heap_no >= n_heap ||
+        (m_seen[heap_no / 64] >> (heap_no % 64)) & 1) {
+      return PAGE_CHECK_LOOP;
+    }
+    m_seen[heap_no / 64] |= 1ULL << (heap_no % 64);
+    m_n_recs++;
+  }
+  m_bad_offset = 0;
+  return m_n_recs == page_header_get_field(page, PAGE_N_RECS)
+             ? PAGE_CHECK_OK
+             : PAGE_CHECK_N_RECS;
+}
@@ -0,0 +1,22 @@
+#include "include/page0size.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+
+page_size_t::page_size_t(uint32_t fsp_flags) {
+  ulint page_ssize = FSP_FLAGS_GET_PAGE_SSIZE(fsp_flags);
+  m_logical = page_ssize == 0 ? UNIV_PAGE_SIZE
+                              : ((ulint)UNIV_ZIP_SIZE_MIN >> 1) << page_ssize;
+  if (m_logical < UNIV_PAGE_SIZE_MIN || m_logical > UNIV_PAGE_SIZE_MAX) {
+    m_logical = UNIV_PAGE_SIZE;
+  }
+
+  /* KEY_BLOCK_SIZE may equal the page size: such pages are still
+  compressed */
+  ulint zip_ssize = FSP_FLAGS_GET_ZIP_SSIZE(fsp_flags);
+  m_physical = ((ulint)UNIV_ZIP_SIZE_MIN >> 1) << zip_ssize;
+  m_is_compressed = zip_ssize != 0 && m_physical >= UNIV_ZIP_SIZE_MIN &&
+                    m_physical <= m_logical;
+  if (!m_is_compressed) {
+    m_physical = m_logical;
+  }
+}
@@ -0,0 +1,770 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "include/page0zip.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/rem0rec.h"
+
+/** Lengths of the system columns of a clustered index record */
+/* @{ */
+#define DATA_TRX_ID_LEN 6
+#define DATA_ROLL_PTR_LEN 7
+/* @} */
+
+/** Bytes of DB_TRX_ID and DB_ROLL_PTR kept uncompressed per record */
+#define PAGE_ZIP_TRX_ROLL_LEN (DATA_TRX_ID_LEN + DATA_ROLL_PTR_LEN)
+
+/** Size of a page directory slot of the uncompressed frame */
+#define PAGE_DIR_SLOT_SIZE 2
+
+/** Offset of the page directory from the end of the frame */
+#define PAGE_DIR FIL_PAGE_DATA_END
+
+/** m_trx_id_col of pages without DB_TRX_ID */
+#define PAGE_ZIP_NO_TRX_ID_COL (~(ulint)0)
+
+/** Extra bytes and data of the infimum record, which is not stored */
+static const byte infimum_extra[] = {
+    0x01,      /* info_bits=0, n_owned=1 */
+    0x00, 0x02 /* heap_no=0, status=2 */
+    /* ?, ?     next=(first user rec, or supremum) */
+};
+static const byte infimum_data[] = {
+    0x69, 0x6e, 0x66, 0x69, 0x6d, 0x75, 0x6d, 0x00 /* "infimum\0" */
+};
+/** Extra bytes and data of the supremum record, n_owned excepted */
+static const byte supremum_extra_data[] = {
+    /* 0x0?, */ /* info_bits=0, n_owned=1..8 */
+    0x00, 0x0b, /* heap_no=1, status=3 */
+    0x00, 0x00, /* next=0 */
+    0x73, 0x75, 0x70, 0x72, 0x65, 0x6d, 0x75, 0x6d /* "supremum" */
+};
+
+/** Gets an entry of the dense directory, counted from the end of the page. */
+static ulint page_zip_dir_get(const byte *zip, ulint zip_size, ulint slot) {
+  return mach_read_from_2(zip + zip_size - PAGE_ZIP_DIR_SLOT_SIZE * (slot + 1));
+}
+
+/** Sets the next record pointer of a record of the frame. */
+static void page_zip_set_next_offs(byte *page, byte *rec, ulint next) {
+  ulint field = next == 0 ? 0 : (next - (ulint)(rec - page)) & 0xFFFF;
+  mach_write_to_2(rec - REC_NEXT, field);
+}
+
+/** @return the end offset of the data of a record */
+static ulint page_zip_offs_data_size(const std::vector<ulint> &offsets) {
+  return offsets.empty() ? 0 : (offsets.back() & REC_OFFS_MASK);
+}
+
+/** @return true if any field of a record is stored externally */
+static bool page_zip_offs_any_extern(const std::vector<ulint> &offsets) {
+  for (ulint offs : offsets) {
+    if (offs & REC_OFFS_EXTERNAL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Computes the offsets of a record whose extra bytes are stored forwards
+in the modification log, as rec_get_offsets_reverse() does.
+@param[in]   extra    extra bytes in the log, the byte next to the fixed
+                      REC_N_NEW_EXTRA_BYTES first
+@param[in]   end      end of the log
+@param[in]   index    index of the page
+@param[out]  offsets  end offsets of the fields
+@param[out]  n_extra  number of extra bytes read
+@return false if the extra bytes run past end */
+static bool page_zip_offsets_reverse(const byte *extra, const byte *end,
+                                     const dict_index_t &index,
+                                     std::vector<ulint> &offsets,
+                                     ulint *n_extra) {
+  const byte *nulls = extra;
+  const byte *lens = nulls + UT_BITS_IN_BYTES(index.n_nullable);
+  ulint null_mask = 1;
+  ulint offs = 0;
+
+  offsets.resize(index.fields.size());
+  for (ulint i = 0; i < index.fields.size(); i++) {
+    const dict_field_t &field = index.fields[i];
+    if (lens + 2 > end) {
+      return false;
+    }
+    if (field.is_nullable) {
+      if (!(byte)null_mask) {
+        nulls++;
+        null_mask = 1;
+      }
+      if (*nulls & null_mask) {
+        null_mask <<= 1;
+        offsets[i] = offs | REC_OFFS_SQL_NULL;
+        continue;
+      }
+      null_mask <<= 1;
+    }
+    if (field.fixed_len == 0) {
+      ulint len = *lens++;
+      if (field.is_big && (len & 0x80)) {
+        /* 1exxxxxxx xxxxxxxx */
+        len <<= 8;
+        len |= *lens++;
+        offs += len & 0x3fff;
+        offsets[i] = (len & 0x4000) ? (offs | REC_OFFS_EXTERNAL) : offs;
+        continue;
+      }
+      offs += len;
+    } else {
+      offs += field.fixed_len;
+    }
+    offsets[i] = offs;
+  }
+  *n_extra = lens - extra;
+  return true;
+}
+
+/** Inflates into the frame up to end.
+@param[in,out]  strm        inflate stream
+@param[in]      end         where the output has to stop
+@param[out]     stream_end  set when the compressed stream ended
+@return false on error, or if the stream ended before end */
+static bool page_zip_inflate_to(z_stream *strm, byte *end, bool *stream_end) {
+  if (end < strm->next_out) {
+    return false;
+  }
+  strm->avail_out = static_cast<uInt>(end - strm->next_out);
+  switch (inflate(strm, Z_SYNC_FLUSH)) {
+    case Z_STREAM_END:
+      *stream_end = true;
+      /* fall through */
+    case Z_OK:
+    case Z_BUF_ERROR:
+      return strm->avail_out == 0;
+    default:
+      return false;
+  }
+}
+
+Page_zip_decompressor::Page_zip_decompressor()
+    : m_stream_ok(false),
+      m_buf(nullptr),
+      m_page(nullptr),
+      m_size(UNIV_PAGE_SIZE),
+      m_trx_id_col(PAGE_ZIP_NO_TRX_ID_COL),
+      m_node_ptr(false),
+      m_end(0) {
+  memset(&m_stream, 0, sizeof(m_stream));
+  m_stream_ok = inflateInit2(&m_stream, MAX_WBITS) == Z_OK;
+  if (posix_memalign((void **)&m_buf, UNIV_PAGE_SIZE_MAX,
+                     2 * UNIV_PAGE_SIZE_MAX) == 0) {
+    memset(m_buf, 0, 2 * UNIV_PAGE_SIZE_MAX);
+    m_page = m_buf + UNIV_PAGE_SIZE_MAX;
+  }
+}
+
+Page_zip_decompressor::~Page_zip_decompressor() {
+  if (m_stream_ok) {
+    inflateEnd(&m_stream);
+  }
+  free(m_buf);
+}
+
+const byte *Page_zip_decompressor::decompress(const byte *zip,
+                                              const page_size_t &page_size) {
+  ulint zip_size = page_size.physical();
+  m_size = page_size.logical();
+  if (!m_stream_ok || m_page == nullptr || m_size > UNIV_PAGE_SIZE_MAX ||
+      zip_size > m_size || zip_size < UNIV_ZIP_SIZE_MIN) {
+    return nullptr;
+  }
+  page_type_t type = fil_page_get_type(zip);
+  if (!fil_page_type_is_index(type)) {
+    memcpy(m_page, zip, zip_size);
+    memset(m_page + zip_size, 0, m_size - zip_size);
+    return m_page;
+  }
+  return decompress_index(zip, zip_size) ? m_page : nullptr;
+}
+
+/** Builds the sparse directory of the frame from the dense directory and
+collects the records, as page_zip_dir_decode() does. */
+bool Page_zip_decompressor::dir_decode(const byte *zip, ulint zip_size,
+                                       ulint n_dense) {
+  ulint n_recs = page_header_get_field(m_page, PAGE_N_RECS);
+  if (n_recs > n_dense) {
+    return false;
+  }
+
+  byte *slot = m_page + (m_size - PAGE_DIR - PAGE_DIR_SLOT_SIZE);
+  /* Zero out the page trailer. */
+  memset(slot + PAGE_DIR_SLOT_SIZE, 0, PAGE_DIR);
+  mach_write_to_2(slot, PAGE_NEW_INFIMUM);
+  slot -= PAGE_DIR_SLOT_SIZE;
+
+  m_recs.resize(n_dense);
+  ulint i;
+  for (i = 0; i < n_recs; i++) {
+    ulint offs = page_zip_dir_get(zip, zip_size, i);
+    if (offs & PAGE_ZIP_DIR_SLOT_OWNED) {
+      if (slot < m_page + PAGE_ZIP_START) {
+        return false;
+      }
+      mach_write_to_2(slot, offs & PAGE_ZIP_DIR_SLOT_MASK);
+      slot -= PAGE_DIR_SLOT_SIZE;
+    }
+    if ((offs & PAGE_ZIP_DIR_SLOT_MASK) <
+        PAGE_ZIP_START + REC_N_NEW_EXTRA_BYTES) {
+      return false;
+    }
+    m_recs[i] = m_page + (offs & PAGE_ZIP_DIR_SLOT_MASK);
+  }
+
+  mach_write_to_2(slot, PAGE_NEW_SUPREMUM);
+  ulint n_slots = page_header_get_field(m_page, PAGE_N_DIR_SLOTS);
+  if (slot != m_page + (m_size - PAGE_DIR -
+                        PAGE_DIR_SLOT_SIZE * n_slots)) {
+    return false;
+  }
+
+  /* the rest of the dense directory lists the free records */
+  for (; i < n_dense; i++) {
+    ulint offs = page_zip_dir_get(zip, zip_size, i);
+    if ((offs & ~PAGE_ZIP_DIR_SLOT_MASK) ||
+        offs < PAGE_ZIP_START + REC_N_NEW_EXTRA_BYTES) {
+      return false;
+    }
+    m_recs[i] = m_page + offs;
+  }
+
+  std::sort(m_recs.begin(), m_recs.end());
+  return true;
+}
+
+/** Decodes the field information that leads the compressed stream into
+m_index, as page_zip_fields_decode() does. Fixed-length NOT NULL fields
+that are next to each other are merged into one field. */
+bool Page_zip_decompressor::fields_decode(const byte *buf, const byte *end,
+                                          bool is_leaf) {
+  ulint n = 0;
+  const byte *b;
+  for (b = buf; b < end; n++) {
+    if (*b++ & 0x80) {
+      b++; /* skip the second byte */
+    }
+  }
+  if (n == 0 || b > end) {
+    return false;
+  }
+  n--; /* n_nullable or trx_id */
+  if (n > REC_MAX_N_FIELDS) {
+    return false;
+  }
+
+  m_index.fields.clear();
+  m_index.n_nullable = 0;
+  m_index.n_uniq = n;
+  b = buf;
+  for (ulint i = 0; i < n; i++) {
+    dict_field_t field;
+    ulint val = *b++;
+    field.col_no = i;
+    field.is_big = false;
+    if (val & 0x80) {
+      /* fixed length > 62 bytes */
+      val = (val & 0x7f) << 8 | *b++;
+      field.fixed_len = val >> 1;
+    } else if (val >= 126) {
+      /* variable length with max > 255 bytes */
+      field.fixed_len = 0;
+      field.is_big = true;
+    } else if (val <= 1) {
+      /* variable length with max <= 255 bytes */
+      field.fixed_len = 0;
+    } else {
+      /* fixed length < 62 bytes */
+      field.fixed_len = val >> 1;
+    }
+    field.max_len = field.is_big ? 0x7fff
+                                 : (field.fixed_len ? field.fixed_len : 255);
+    field.is_nullable = !(val & 1);
+    if (field.is_nullable) {
+      m_index.n_nullable++;
+    }
+    m_index.fields.push_back(field);
+  }
+
+  ulint val = *b++;
+  if (val & 0x80) {
+    val = (val & 0x7f) << 8 | *b;
+  }
+
+  m_trx_id_col = PAGE_ZIP_NO_TRX_ID_COL;
+  if (is_leaf) {
+    /* the position of DB_TRX_ID, 0 for secondary indexes */
+    if (val >= n) {
+      return false;
+    }
+    if (val != 0) {
+      m_trx_id_col = val;
+    }
+  } else {
+    /* the number of nullable fields */
+    if (m_index.n_nullable > val) {
+      return false;
+    }
+    m_index.n_nullable = val;
+    /* the child page number follows the key of a node pointer */
+    dict_field_t child;
+    child.col_no = n;
+    child.fixed_len = REC_NODE_PTR_SIZE;
+    child.max_len = REC_NODE_PTR_SIZE;
+    child.is_big = false;
+    child.is_nullable = false;
+    m_index.fields.push_back(child);
+  }
+  m_index.is_clustered = m_trx_id_col != PAGE_ZIP_NO_TRX_ID_COL;
+  return true;
+}
+
+/** Inflates the records in address order. The fixed extra bytes of each
+record are not stored; on node pointer pages the child page number, on
+clustered leaf pages DB_TRX_ID, DB_ROLL_PTR and the external references
+are stored uncompressed at the end of the page and are skipped here.
+@param[in,out]  heap_status  heap number and status of the next record */
+bool Page_zip_decompressor::inflate_recs(const byte *zip, ulint n_dense,
+                                         ulint *heap_status) {
+  bool stream_end = false;
+  for (ulint slot = 0; slot < n_dense && !stream_end; slot++) {
+    byte *rec = m_recs[slot];
+
+    /* Inflate everything up to this record. */
+    if (!page_zip_inflate_to(&m_stream, rec - REC_N_NEW_EXTRA_BYTES,
+                             &stream_end)) {
+      /* a record may also be brought in by the modification log only */
+      if (!stream_end) {
+        return false;
+      }
+    }
+    if (m_stream.next_out != rec - REC_N_NEW_EXTRA_BYTES) {
+      break;
+    }
+    /* Skip the REC_N_NEW_EXTRA_BYTES and set heap_no and status. */
+    m_stream.next_out = rec;
+    mach_write_to_2(rec - REC_NEW_HEAP_NO, *heap_status);
+    *heap_status += 1 << REC_HEAP_NO_SHIFT;
+    if (stream_end) {
+      break;
+    }
+
+    if (!rec_get_offsets(rec, m_index, m_offsets, m_size)) {
+      return false;
+    }
+    byte *rec_end = rec + page_zip_offs_data_size(m_offsets);
+
+    if (m_node_ptr) {
+      /* Inflate the data bytes, except the child page number. */
+      if (page_zip_offs_any_extern(m_offsets) ||
+          rec_end - REC_NODE_PTR_SIZE < rec) {
+        return false;
+      }
+      if (!page_zip_inflate_to(&m_stream, rec_end - REC_NODE_PTR_SIZE,
+                               &stream_end)) {
+        if (stream_end) {
+          break;
+        }
+        return false;
+      }
+      memset(m_stream.next_out, 0, REC_NODE_PTR_SIZE);
+      m_stream.next_out += REC_NODE_PTR_SIZE;
+      continue;
+    }
+    if (m_trx_id_col == PAGE_ZIP_NO_TRX_ID_COL) {
+      /* secondary index leaf: the data follows with the next record */
+      continue;
+    }
+
+    /* clustered index leaf: skip DB_TRX_ID, DB_ROLL_PTR and the
+    BTR_EXTERN_FIELD_REF of every external field */
+    for (ulint i = 0; i < m_offsets.size(); i++) {
+      ulint len;
+      byte *dst;
+      ulint skip;
+      if (i == m_trx_id_col) {
+        dst = const_cast<byte *>(rec_get_nth_field(rec, m_offsets, i, &len));
+        if (len == UNIV_SQL_NULL || len < PAGE_ZIP_TRX_ROLL_LEN ||
+            rec_offs_nth_extern(m_offsets, i)) {
+          return false;
+        }
+        skip = PAGE_ZIP_TRX_ROLL_LEN;
+      } else if (rec_offs_nth_extern(m_offsets, i)) {
+        dst = const_cast<byte *>(rec_get_nth_field(rec, m_offsets, i, &len));
+        if (len < BTR_EXTERN_FIELD_REF_SIZE) {
+          return false;
+        }
+        dst += len - BTR_EXTERN_FIELD_REF_SIZE;
+        skip = BTR_EXTERN_FIELD_REF_SIZE;
+      } else {
+        continue;
+      }
+      if (!page_zip_inflate_to(&m_stream, dst, &stream_end)) {
+        return false;
+      }
+      /* cleared now, restored once the modification log is applied */
+      memset(dst, 0, skip);
+      m_stream.next_out += skip;
+    }
+    /* Inflate the last bytes of the record. */
+    if (!page_zip_inflate_to(&m_stream, rec_end, &stream_end)) {
+      return false;
+    }
+  }
+
+  if (!stream_end) {
+    /* Inflate any trailing garbage, in case the last record was
+    allocated from an originally longer space on the free list. */
+    ulint heap_top = page_header_get_field(zip, PAGE_HEAP_TOP);
+    ulint out = m_stream.next_out - m_page;
+    if (heap_top < out ||
+        heap_top - out > m_size - PAGE_ZIP_START - PAGE_DIR) {
+      return false;
+    }
+    m_stream.avail_out = static_cast<uInt>(heap_top - out);
+    if (inflate(&m_stream, Z_FINISH) != Z_STREAM_END) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Applies the modification log that follows the compressed stream, as
+page_zip_apply_log() does. Each entry rewrites one record, either one
+that existed when the page was compressed or one allocated since.
+@param[in]      data         start of the log
+@param[in]      size         bytes the log may span
+@param[in,out]  heap_status  heap number and status of the next record
+@return end of the log, nullptr if it is corrupt */
+const byte *Page_zip_decompressor::apply_log(const byte *data, ulint size,
+                                             ulint n_dense,
+                                             ulint *heap_status) {
+  const byte *const end = data + size;
+  byte *const frame_end = m_page + m_size - PAGE_DIR;
+
+  for (;;) {
+    ulint val = *data++;
+    if (val == 0) {
+      return data - 1;
+    }
+    if (val & 0x80) {
+      val = (val & 0x7f) << 8 | *data++;
+      if (val == 0) {
+        return nullptr;
+      }
+    }
+    if (data >= end || (val >> 1) == 0 || (val >> 1) > n_dense) {
+      return nullptr;
+    }
+
+    /* Determine the heap number and status bits of the record. */
+    byte *rec = m_recs[(val >> 1) - 1];
+    ulint hs = ((val >> 1) + 1) << REC_HEAP_NO_SHIFT;
+    hs |= *heap_status & ((1 << REC_HEAP_NO_SHIFT) - 1);
+    if (hs > *heap_status) {
+      return nullptr;
+    } else if (hs == *heap_status) {
+      /* A new record was allocated from the heap. */
+      if (val & 1) {
+        /* Only existing records may be cleared. */
+        return nullptr;
+      }
+      *heap_status += 1 << REC_HEAP_NO_SHIFT;
+    }
+    mach_write_to_2(rec - REC_NEW_HEAP_NO, hs);
+
+    if (val & 1) {
+      /* Clear the data bytes of the record. */
+      if (!rec_get_offsets(rec, m_index, m_offsets, m_size)) {
+        return nullptr;
+      }
+      memset(rec, 0, page_zip_offs_data_size(m_offsets));
+      continue;
+    }
+
+    ulint n_extra;
+    if (!page_zip_offsets_reverse(data, end, m_index, m_offsets, &n_extra)) {
+      return nullptr;
+    }
+    byte *start = rec - REC_N_NEW_EXTRA_BYTES - n_extra;
+    byte *rec_end = rec + page_zip_offs_data_size(m_offsets);
+    if (start < m_page + PAGE_ZIP_START || rec_end > frame_end) {
+      return nullptr;
+    }
+    /* Copy the extra bytes (backwards). */
+    for (byte *b = rec - REC_N_NEW_EXTRA_BYTES; b != start;) {
+      *--b = *data++;
+    }
+
+    /* Copy the data bytes, leaving out what is stored uncompressed. */
+    byte *next_out = rec;
+    if (m_node_ptr) {
+      if (page_zip_offs_any_extern(m_offsets)) {
+        return nullptr;
+      }
+      rec_end -= REC_NODE_PTR_SIZE;
+    } else if (m_trx_id_col != PAGE_ZIP_NO_TRX_ID_COL) {
+      for (ulint i = 0; i < m_offsets.size(); i++) {
+        ulint len;
+        byte *dst;
+        ulint skip;
+        if (i == m_trx_id_col) {
+          dst = const_cast<byte *>(rec_get_nth_field(rec, m_offsets, i, &len));
+          if (len == UNIV_SQL_NULL || len < PAGE_ZIP_TRX_ROLL_LEN ||
+              rec_offs_nth_extern(m_offsets, i)) {
+            return nullptr;
+          }
+          skip = PAGE_ZIP_TRX_ROLL_LEN;
+        } else if (rec_offs_nth_extern(m_offsets, i)) {
+          dst = const_cast<byte *>(rec_get_nth_field(rec, m_offsets, i, &len));
+          if (len < BTR_EXTERN_FIELD_REF_SIZE) {
+            return nullptr;
+          }
+          dst += len - BTR_EXTERN_FIELD_REF_SIZE;
+          skip = BTR_EXTERN_FIELD_REF_SIZE;
+        } else {
+          continue;
+        }
+        if (dst < next_out || data + (dst - next_out) >= end) {
+          return nullptr;
+        }
+        memcpy(next_out, data, dst - next_out);
+        data += dst - next_out;
+        next_out = dst + skip;
+      }
+    }
+    if (rec_end < next_out || data + (rec_end - next_out) >= end) {
+      return nullptr;
+    }
+    memcpy(next_out, data, rec_end - next_out);
+    data += rec_end - next_out;
+  }
+}
+
+/** Sets the info bits, n_owned and next pointers of the records from the
+dense directory, as page_zip_set_extra_bytes() does.
+@param[in]  info_bits  info bits of the first user record */
+bool Page_zip_decompressor::set_extra_bytes(const byte *zip, ulint zip_size,
+                                            ulint info_bits) {
+  ulint n = page_header_get_field(m_page, PAGE_N_RECS);
+  ulint n_owned = 1;
+  byte *rec = m_page + PAGE_NEW_INFIMUM;
+  ulint i;
+
+  for (i = 0; i < n; i++) {
+    ulint offs = page_zip_dir_get(zip, zip_size, i);
+    if (offs & PAGE_ZIP_DIR_SLOT_DEL) {
+      info_bits |= REC_INFO_DELETED_FLAG;
+    }
+    if (offs & PAGE_ZIP_DIR_SLOT_OWNED) {
+      info_bits |= n_owned;
+      n_owned = 1;
+    } else {
+      n_owned++;
+    }
+    offs &= PAGE_ZIP_DIR_SLOT_MASK;
+    if (offs < PAGE_ZIP_START + REC_N_NEW_EXTRA_BYTES) {
+      return false;
+    }
+    page_zip_set_next_offs(m_page, rec, offs);
+    rec = m_page + offs;
+    rec[-REC_N_NEW_EXTRA_BYTES] = (byte)info_bits;
+    info_bits = 0;
+  }
+
+  /* Set the next pointer of the last user record. */
+  page_zip_set_next_offs(m_page, rec, PAGE_NEW_SUPREMUM);
+  /* Set n_owned of the supremum record. */
+  m_page[PAGE_NEW_SUPREMUM - REC_N_NEW_EXTRA_BYTES] = (byte)n_owned;
+
+  /* The dense directory excludes the infimum and supremum records. */
+  n = page_dir_get_n_heap(m_page) - PAGE_HEAP_NO_USER_LOW;
+  if (i >= n) {
+    return i == n;
+  }
+
+  /* Link the deleted records of the free list. */
+  ulint offs = page_zip_dir_get(zip, zip_size, i);
+  for (;;) {
+    if (offs == 0 || (offs & ~PAGE_ZIP_DIR_SLOT_MASK)) {
+      return false;
+    }
+    rec = m_page + offs;
+    rec[-REC_N_NEW_EXTRA_BYTES] = 0; /* info_bits and n_owned */
+    if (++i == n) {
+      break;
+    }
+    offs = page_zip_dir_get(zip, zip_size, i);
+    page_zip_set_next_offs(m_page, rec, offs);
+  }
+  /* Terminate the free list. */
+  page_zip_set_next_offs(m_page, rec, 0);
+  return true;
+}
+
+bool Page_zip_decompressor::decompress_index(const byte *zip,
+                                             ulint zip_size) {
+  ulint n_heap = page_dir_get_n_heap(zip);
+  if (n_heap < PAGE_HEAP_NO_USER_LOW) {
+    return false;
+  }
+  ulint n_dense = n_heap - PAGE_HEAP_NO_USER_LOW;
+  if ((n_dense + 1) * PAGE_ZIP_DIR_SLOT_SIZE + PAGE_DATA >= zip_size) {
+    return false;
+  }
+
+  /* Copy the page header. */
+  memcpy(m_page, zip, PAGE_DATA);
+  if (!dir_decode(zip, zip_size, n_dense)) {
+    return false;
+  }
+
+  /* Copy the infimum and supremum records. */
+  memcpy(m_page + (PAGE_NEW_INFIMUM - REC_N_NEW_EXTRA_BYTES), infimum_extra,
+         sizeof infimum_extra);
+  if (page_header_get_field(m_page, PAGE_N_RECS) == 0) {
+    page_zip_set_next_offs(m_page, m_page + PAGE_NEW_INFIMUM,
+                           PAGE_NEW_SUPREMUM);
+  } else {
+    page_zip_set_next_offs(
+        m_page, m_page + PAGE_NEW_INFIMUM,
+        page_zip_dir_get(zip, zip_size, 0) & PAGE_ZIP_DIR_SLOT_MASK);
+  }
+  memcpy(m_page + PAGE_NEW_INFIMUM, infimum_data, sizeof infimum_data);
+  memcpy(m_page + (PAGE_NEW_SUPREMUM - REC_N_NEW_EXTRA_BYTES + 1),
+         supremum_extra_data, sizeof supremum_extra_data);
+
+  inflateReset(&m_stream);
+  m_stream.next_in = const_cast<byte *>(zip) + PAGE_DATA;
+  /* Leave out the page header and the end marker of the log. */
+  m_stream.avail_in = static_cast<uInt>(zip_size - (PAGE_DATA + 1));
+  m_stream.next_out = m_page + PAGE_ZIP_START;
+  m_stream.avail_out = m_size - PAGE_ZIP_START;
+
+  /* Decode the zlib header and the field information. */
+  if (inflate(&m_stream, Z_BLOCK) != Z_OK ||
+      inflate(&m_stream, Z_BLOCK) != Z_OK) {
+    return false;
+  }
+  bool is_leaf = page_is_leaf(m_page);
+  if (!fields_decode(m_page + PAGE_ZIP_START, m_stream.next_out, is_leaf)) {
+    return false;
+  }
+  m_node_ptr = !is_leaf;
+  m_stream.next_out = m_page + PAGE_ZIP_START;
+
+  /* Leave out the data kept uncompressed at the end of the page. */
+  ulint stored = PAGE_ZIP_DIR_SLOT_SIZE;
+  if (m_node_ptr) {
+    stored += REC_NODE_PTR_SIZE;
+  } else if (m_trx_id_col != PAGE_ZIP_NO_TRX_ID_COL) {
+    stored += PAGE_ZIP_TRX_ROLL_LEN;
+  }
+  if (n_dense * stored > m_stream.avail_in) {
+    return false;
+  }
+  m_stream.avail_in -= static_cast<uInt>(n_dense * stored);
+
+  ulint heap_status =
+      (m_node_ptr ? REC_STATUS_NODE_PTR : REC_STATUS_ORDINARY) |
+      PAGE_HEAP_NO_USER_LOW << REC_HEAP_NO_SHIFT;
+  if (!inflate_recs(zip, n_dense, &heap_status)) {
+    return false;
+  }
+
+  /* Clear the unused heap space of the frame. */
+  byte *last_slot =
+      m_page + (m_size - PAGE_DIR -
+                PAGE_DIR_SLOT_SIZE *
+                    page_header_get_field(m_page, PAGE_N_DIR_SLOTS));
+  if (last_slot > m_stream.next_out) {
+    memset(m_stream.next_out, 0, last_slot - m_stream.next_out);
+  }
+
+  const byte *log_end = apply_log(m_stream.next_in, m_stream.avail_in + 1,
+                                  n_dense, &heap_status);
+  if (log_end == nullptr) {
+    return false;
+  }
+  m_end = log_end - zip;
+  if (n_dense * stored + m_end >= zip_size) {
+    return false;
+  }
+
+  /* Restore the uncompressed columns in heap_no order. */
+  const byte *storage = zip + zip_size - n_dense * PAGE_ZIP_DIR_SLOT_SIZE;
+  if (m_node_ptr) {
+    for (ulint slot = 0; slot < n_dense; slot++) {
+      byte *rec = m_recs[slot];
+      if (!rec_get_offsets(rec, m_index, m_offsets, m_size)) {
+        return false;
+      }
+      storage -= REC_NODE_PTR_SIZE;
+      memcpy(rec + page_zip_offs_data_size(m_offsets) - REC_NODE_PTR_SIZE,
+             storage, REC_NODE_PTR_SIZE);
+    }
+  } else if (m_trx_id_col != PAGE_ZIP_NO_TRX_ID_COL) {
+    ulint n_recs = page_header_get_field(m_page, PAGE_N_RECS);
+    const byte *externs = storage - n_dense * PAGE_ZIP_TRX_ROLL_LEN;
+    for (ulint slot = 0; slot < n_dense; slot++) {
+      byte *rec = m_recs[slot];
+      ulint rec_offs = rec - m_page;
+      bool exists = true;
+      for (ulint i = n_recs; i < n_dense; i++) {
+        if ((page_zip_dir_get(zip, zip_size, i) & PAGE_ZIP_DIR_SLOT_MASK) ==
+            rec_offs) {
+          exists = false;
+          break;
+        }
+      }
+      if (!rec_get_offsets(rec, m_index, m_offsets, m_size)) {
+        return false;
+      }
+      ulint len;
+      byte *dst = const_cast<byte *>(
+          rec_get_nth_field(rec, m_offsets, m_trx_id_col, &len));
+      if (len == UNIV_SQL_NULL || len < PAGE_ZIP_TRX_ROLL_LEN) {
+        return false;
+      }
+      storage -= PAGE_ZIP_TRX_ROLL_LEN;
+      memcpy(dst, storage, PAGE_ZIP_TRX_ROLL_LEN);
+
+      for (ulint i = 0; i < m_offsets.size(); i++) {
+        if (!rec_offs_nth_extern(m_offsets, i)) {
+          continue;
+        }
+        dst = const_cast<byte *>(rec_get_nth_field(rec, m_offsets, i, &len));
+        if (len < BTR_EXTERN_FIELD_REF_SIZE) {
+          return false;
+        }
+        dst += len - BTR_EXTERN_FIELD_REF_SIZE;
+        if (exists) {
+          /* existing record: restore the BLOB pointer */
+          externs -= BTR_EXTERN_FIELD_REF_SIZE;
+          if (externs < zip + m_end) {
+            return false;
+          }
+          memcpy(dst, externs, BTR_EXTERN_FIELD_REF_SIZE);
+        } else {
+          /* deleted record: clear the BLOB pointer */
+          memset(dst, 0, BTR_EXTERN_FIELD_REF_SIZE);
+        }
+      }
+    }
+  }
+
+  ulint info_bits = 0;
+  if (m_node_ptr && mach_read_from_4(m_page + FIL_PAGE_PREV) == FIL_NULL) {
+    info_bits = REC_INFO_MIN_REC_FLAG;
+  }
+  return set_extra_bytes(zip, zip_size, info_bits);
+}
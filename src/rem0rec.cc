@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "include/rem0rec.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/srv0mon.h"
+
+ulint rec_get_next_offs(const byte *page, ulint rec_off, ulint page_size) {
+  /* the next pointer of a compact record is relative, the sum wraps
+  around within the page */
+  ulint off = (rec_off + mach_read_from_2(page + rec_off - REC_NEXT)) &
+              (page_size - 1);
+  if (off < PAGE_NEW_SUPREMUM || off >= page_size - FIL_PAGE_DATA_END) {
+    return 0;
+  }
+  return off;
+}
+
+bool rec_get_offsets(const rec_t *rec, const dict_index_t &index,
+                     std::vector<ulint> &offsets, ulint page_size) {
+  Monitor_timer timer(MONITOR_REC_DECODE);
+  const byte *nulls = rec - (REC_N_NEW_EXTRA_BYTES + 1);
+  const byte *lens = nulls - UT_BITS_IN_BYTES(index.n_nullable);
+  ulint null_mask = 1;
+  ulint offs = 0;
+  ulint n_fields = index.fields.size();
+  /* the header is read backwards from the record and must stay after the
+  supremum */
+  ulint rec_off = (ulint)((uintptr_t)rec & (page_size - 1));
+  const byte *header_low = rec - rec_off + PAGE_NEW_SUPREMUM_END;
+  if (rec_off < PAGE_NEW_SUPREMUM_END || lens + 1 < header_low) {
+    return false;
+  }
+
+  offsets.resize(n_fields);
+  for (ulint i = 0; i < n_fields; i++) {
+    const dict_field_t &field = index.fields[i];
+    ulint len;
+
+    if (field.is_nullable) {
+      if (!(byte)null_mask) {
+        nulls--;
+        null_mask = 1;
+      }
+      if (*nulls & null_mask) {
+        null_mask <<= 1;
+        offsets[i] = offs | REC_OFFS_SQL_NULL;
+        continue;
+      }
+      null_mask <<= 1;
+    }
+
+    if (field.fixed_len == 0) {
+      if (lens < header_low) {
+        return false;
+      }
+      len = *lens--;
+      if (field.is_big && (len & 0x80)) {
+        if (lens < header_low) {
+          return false;
+        }
+        /* 1exxxxxxx xxxxxxxx */
+        len <<= 8;
+        len |= *lens--;
+        /* an off-page field ends with its 20-byte reference */
+        if ((len & 0x4000) && (len & 0x3fff) < BTR_EXTERN_FIELD_REF_SIZE) {
+          return false;
+        }
+        offs += len & 0x3fff;
+        if (len & 0x4000) {
+          offsets[i] = offs | REC_OFFS_EXTERNAL;
+        } else {
+          offsets[i] = offs;
+        }
+        continue;
+      }
+      offs += len;
+    } else {
+      offs += field.fixed_len;
+    }
+    offsets[i] = offs;
+  }
+
+  /* the record must end inside the page */
+  return rec_off + offs <= page_size - FIL_PAGE_DATA_END;
+}
+
+const byte *rec_get_nth_field(const rec_t *rec,
+                              const std::vector<ulint> &offsets, ulint n,
+                              ulint *len) {
+  ulint start = n == 0 ? 0 : (offsets[n - 1] & REC_OFFS_MASK);
+  if (offsets[n] & REC_OFFS_SQL_NULL) {
+    *len = UNIV_SQL_NULL;
+  } else {
+    *len = (offsets[n] & REC_OFFS_MASK) - start;
+  }
+  return rec + start;
+}
+
+int64_t rec_field_to_int(const dict_col_t &col, const byte *data, ulint len) {
+  uint64_t value = 0;
+  for (ulint i = 0; i < len && i < 8; i++) {
+    value = (value << 8) | data[i];
+  }
+  if (col.is_unsigned || col.type == DD_TYPE_YEAR || len == 0) {
+    return (int64_t)value;
+  }
+  /* the sign bit is stored inverted so that memcmp() orders values */
+  uint32_t bits = 8 * (len < 8 ? len : 8);
+  value ^= (uint64_t)1 << (bits - 1);
+  if (bits < 64 && (value & ((uint64_t)1 << (bits - 1)))) {
+    value |= ~(uint64_t)0 << bits;
+  }
+  return (int64_t)value;
+}
+
+double rec_field_to_double(const dict_col_t &col, const byte *data) {
+  /* FLOAT and DOUBLE are stored in little-endian machine format */
+  if (col.type == DD_TYPE_FLOAT) {
+    float f;
+    memcpy(&f, data, sizeof(f));
+    return f;
+  }
+  double d;
+  memcpy(&d, data, sizeof(d));
+  return d;
+}
+
+/** Formats a NEWDECIMAL column stored in the binary format of
+bin2decimal(). */
+static void rec_decimal_to_string(const dict_col_t &col, const byte *data,
+                                  ulint len, std::string *out) {
+  static const uint32_t dig2bytes[10] = {0, 1, 1, 2, 2, 3, 3, 4, 4, 4};
+  byte buf[64];
+  if (len > sizeof(buf)) {
+    out->assign("<bad decimal>");
+    return;
+  }
+  memcpy(buf, data, len);
+  bool negative = !(buf[0] & 0x80);
+  buf[0] ^= 0x80;
+  if (negative) {
+    for (ulint i = 0; i < len; i++) {
+      buf[i] = ~buf[i];
+    }
+  }
+
+  uint32_t intg = col.numeric_precision - col.numeric_scale;
+  uint32_t frac = col.numeric_scale;
+  const byte *p = buf;
+  char tmp[16];
+
+  auto read_group = [&](uint32_t n_bytes) -> uint32_t {
+    uint32_t v = 0;
+    for (uint32_t i = 0; i < n_bytes; i++) {
+      v = (v << 8) | *p++;
+    }
+    return v;
+  };
+
+  out->assign(negative ? "-" : "");
+  std::string int_part;
+  if (intg % 9) {
+    snprintf(tmp, sizeof(tmp), "%u", read_group(dig2bytes[intg % 9]));
+    int_part += tmp;
+  }
+  for (uint32_t i = 0; i < intg / 9; i++) {
+    snprintf(tmp, sizeof(tmp), int_part.empty() ? "%u" : "%09u",
+             read_group(4));
+    int_part += tmp;
+  }
+  size_t nz = int_part.find_first_not_of('0');
+  int_part = nz == std::string::npos ? "0" : int_part.substr(nz);
+  out->append(int_part);
+
+  if (frac > 0) {
+    out->push_back('.');
+    for (uint32_t i = 0; i < frac / 9; i++) {
+      snprintf(tmp, sizeof(tmp), "%09u", read_group(4));
+      out->append(tmp);
+    }
+    if (frac % 9) {
+      snprintf(tmp, sizeof(tmp), "%0*u", (int)(frac % 9),
+               read_group(dig2bytes[frac % 9]));
+      out->append(tmp);
+    }
+  }
+}
+
+void rec_field_to_string(const dict_col_t &col, const byte *data, ulint len,
+                         std::string *out) {
+  char buf[64];
+
+  if (len == UNIV_SQL_NULL) {
+    out->assign("NULL");
+    return;
+  }
+
+  if (dict_col_is_integer(col)) {
+    int64_t v = rec_field_to_int(col, data, len);
+    if (col.type == DD_TYPE_YEAR) {
+      v = v == 0 ? 0 : v + 1900;
+    }
+    if (col.is_unsigned) {
+      snprintf(buf, sizeof(buf), "%llu", (unsigned long long)v);
+    } else {
+      snprintf(buf, sizeof(buf), "%lld", (long long)v);
+    }
+    out->assign(buf);
+    return;
+  }
+
+  switch (col.type) {
+    case DD_TYPE_FLOAT:
+    case DD_TYPE_DOUBLE:
+      snprintf(buf, sizeof(buf), "%.17g", rec_field_to_double(col, data));
+      out->assign(buf);
+      return;
+    case DD_TYPE_NEWDECIMAL:
+      rec_decimal_to_string(col, data, len, out);
+      return;
+    case DD_TYPE_DATE:
+    case DD_TYPE_NEWDATE: {
+      uint32_t v = (data[0] << 16) | (data[1] << 8) | data[2];
+      snprintf(buf, sizeof(buf), "%04u-%02u-%02u", v >> 9, (v >> 5) & 15,
+               v & 31);
+      out->assign(buf);
+      return;
+    }
+    case DD_TYPE_DATETIME2: {
+      uint64_t v = 0;
+      for (int i = 0; i < 5; i++) {
+        v = (v << 8) | data[i];
+      }
+      v -= 0x8000000000ULL;
+      uint64_t ymd = v >> 17;
+      uint64_t ym = ymd >> 5;
+      uint64_t hms = v % (1 << 17);
+      snprintf(buf, sizeof(buf), "%04u-%02u-%02u %02u:%02u:%02u",
+               (uint32_t)(ym / 13), (uint32_t)(ym % 13),
+               (uint32_t)(ymd % 32), (uint32_t)(hms >> 12),
+               (uint32_t)((hms >> 6) % 64), (uint32_t)(hms % 64));
+      out->assign(buf);
+      return;
+    }
+    case DD_TYPE_TIMESTAMP2: {
+      snprintf(buf, sizeof(buf), "%u", mach_read_from_4(data));
+      out->assign(buf);
+      return;
+    }
+    default:
+      break;
+  }
+
+  if (dict_col_is_string(col) && col.collation_id != 63) {
+    out->assign(reinterpret_cast<const char *>(data), len);
+    return;
+  }
+
+  /* binary data, DB_TRX_ID, DB_ROLL_PTR and anything we do not decode */
+  static const char hex[] = "0123456789ABCDEF";
+  out->assign("0x");
+  for (ulint i = 0; i < len; i++) {
+    out->push_back(hex[data[i] >> 4]);
+    out->push_back(hex[data[i] & 15]);
+  }
+}
@@ -0,0 +1,721 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/row0recover.h"
+#include "include/dict0dict.h"
+#include "include/fil0crypt.h"
+#include "include/fil0scan.h"
+#include "include/fil0space.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page0zip.h"
+#include "include/rem0rec.h"
+#include "include/srv0mon.h"
+#include "include/ut0json.h"
+#include "include/ut0pool.h"
+
+/** Length of DB_TRX_ID */
+#define DATA_TRX_ID_LEN 6
+
+/** trx_id_field of a table without DB_TRX_ID */
+#define RECOVER_NO_TRX_ID ((ulint)-1)
+
+/** Where a recovered record was found */
+enum recover_source_t {
+  /** delete-marked in the record list of its page */
+  RECOVER_DELETE_MARKED,
+  /** on the PAGE_FREE list of its page */
+  RECOVER_FREE_LIST,
+  /** in the record list of a page the extent descriptors mark free */
+  RECOVER_FREED_PAGE,
+  RECOVER_N_SOURCES
+};
+
+static const char *recover_source_names[RECOVER_N_SOURCES] = {
+    "delete-marked", "free list", "freed page"};
+
+/** What one scan thread found */
+struct recover_thread_t {
+  recover_thread_t() : n_pages(0), n_freed_pages(0), n_rejected(0), n_recs() {}
+
+  uint64_t n_pages;
+  uint64_t n_freed_pages;
+  /** candidates whose header or fields do not fit their page */
+  uint64_t n_rejected;
+  uint64_t n_recs[RECOVER_N_SOURCES];
+  std::vector<ulint> offsets;
+  std::string line;
+};
+
+/** The table being recovered */
+struct recover_ctx_t {
+  dict_table_t table;
+  const dict_index_t *index;
+  ulint page_size;
+  /** field number of DB_TRX_ID in the index, RECOVER_NO_TRX_ID if none */
+  ulint trx_id_field;
+  /** one byte per page, 1 if the extent descriptors mark it free */
+  std::vector<byte> is_free;
+};
+
+/** Reads the free bits of the extent descriptors, as
+fil_datadir_free_pages() counts them.
+@param[in]   fd       tablespace
+@param[in]   n_pages  pages of the file
+@param[out]  is_free  one byte per page */
+static void recover_read_free_pages(int fd, page_no_t n_pages,
+                                    std::vector<byte> *is_free) {
+  const page_size_t page_size = fil_get_page_size(fd);
+  const ulint physical = page_size.physical();
+  const ulint logical = page_size.logical();
+  const page_no_t extent_size = FSP_EXTENT_SIZE_OF(logical);
+  byte *page;
+
+  is_free->assign(n_pages, 0);
+  if (posix_memalign((void **)&page, UNIV_PAGE_SIZE_MAX,
+                     UNIV_PAGE_SIZE_MAX) != 0) {
+    return;
+  }
+  if (fil_pread(fd, page, physical, 0) != (ssize_t)physical) {
+    free(page);
+    return;
+  }
+  page_no_t free_limit =
+      std::min<page_no_t>(mach_read_from_4(page + FSP_HEADER_OFFSET + FSP_FREE_LIMIT),
+                          n_pages);
+  /* pages above the free limit were never handed out */
+  for (uint64_t xdes_page_no = 0; xdes_page_no < free_limit;
+       xdes_page_no += physical) {
+    if (xdes_page_no != 0 &&
+        (fil_pread(fd, page, physical, xdes_page_no * physical) !=
+             (ssize_t)physical ||
+         !fil_page_restore(fd, page, physical))) {
+      break;
+    }
+    for (ulint i = 0; i < physical / extent_size; i++) {
+      uint64_t first = xdes_page_no + i * extent_size;
+      if (first >= free_limit) {
+        break;
+      }
+      const xdes_t *descr = page + XDES_ARR_OFFSET + i * XDES_SIZE_OF(logical);
+      if (mach_read_from_4(descr + XDES_STATE) == XDES_NOT_INITED) {
+        continue;
+      }
+      for (page_no_t j = 0; j < extent_size && first + j < free_limit; j++) {
+        ulint bit = j * XDES_BITS_PER_PAGE + XDES_FREE_BIT;
+        if ((descr[XDES_BITMAP + bit / 8] >> (bit % 8)) & 1) {
+          (*is_free)[first + j] = 1;
+        }
+      }
+    }
+  }
+  free(page);
+}
+
+/** Appends the columns of a record as " name=value" pairs and a newline,
+leaving out those InnoDB adds.
+@param[in]      table    table definition
+@param[in]      index    index of the record
+@param[in]      rec      record
+@param[in]      offsets  offsets computed by rec_get_offsets()
+@param[in,out]  out      line */
+static void recover_format_fields(const dict_table_t &table,
+                                  const dict_index_t &index, const rec_t *rec,
+                                  const std::vector<ulint> &offsets,
+                                  std::string *out) {
+  std::string value;
+  for (ulint i = 0; i < index.fields.size(); i++) {
+    const dict_col_t &col = table.cols[index.fields[i].col_no];
+    if (col.hidden == DD_HIDDEN_SE) {
+      continue;
+    }
+    ulint len;
+    const byte *data = rec_get_nth_field(rec, offsets, i, &len);
+    if (len == UNIV_SQL_NULL) {
+      value = "NULL";
+    } else if (rec_offs_nth_extern(offsets, i)) {
+      value = "<off-page>";
+    } else {
+      rec_field_to_string(col, data, len, &value);
+    }
+    out->append(" ").append(col.name).append("=").append(value);
+  }
+  out->push_back('\n');
+}
+
+/** Prints a recovered record as a line of text or json, written by one
+fwrite() so that the lines of the threads do not mix. */
+static void recover_print(const recover_ctx_t &ctx, page_no_t page_no,
+                          const rec_t *rec, recover_source_t source,
+                          recover_thread_t *thr) {
+  ulint heap_no = rec_get_bit_field_2(rec, REC_NEW_HEAP_NO, REC_HEAP_NO_MASK,
+                                      REC_HEAP_NO_SHIFT);
+  uint64_t trx_id = 0;
+  if (ctx.trx_id_field != RECOVER_NO_TRX_ID) {
+    ulint len;
+    const byte *data =
+        rec_get_nth_field(rec, thr->offsets, ctx.trx_id_field, &len);
+    if (len == DATA_TRX_ID_LEN) {
+      trx_id = mach_read_from_6(data);
+    }
+  }
+
+  if (ut_format_is_json()) {
+    Json_line line("deleted_record");
+    line.add("page_no", page_no);
+    line.add("heap_no", heap_no);
+    line.add("source", recover_source_names[source]);
+    line.add("trx_id", trx_id);
+    ut_json_rec_fields(line, ctx.table, *ctx.index, rec, thr->offsets);
+    return;
+  }
+
+  std::string &out = thr->line;
+  char buf[128];
+  snprintf(buf, sizeof(buf), "page %u heap %u %s trx %lu:", page_no, heap_no,
+           recover_source_names[source], trx_id);
+  out.assign(buf);
+  recover_format_fields(ctx.table, *ctx.index, rec, thr->offsets, &out);
+  Monitor_timer timer(MONITOR_OUTPUT);
+  timer.add_bytes(out.size());
+  fwrite(out.data(), 1, out.size(), stdout);
+}
+
+/** Checks a candidate and prints it.
+@return false if it is not a record of the index */
+static bool recover_try(const recover_ctx_t &ctx, page_no_t page_no,
+                        const byte *page, ulint rec_off, ulint heap_top,
+                        recover_source_t source, recover_thread_t *thr) {
+  /* the record and its header must be in the heap, which starts after
+  the supremum and ends at PAGE_HEAP_TOP */
+  if (rec_off < PAGE_NEW_SUPREMUM_END + REC_N_NEW_EXTRA_BYTES ||
+      rec_off >= heap_top) {
+    return false;
+  }
+  const rec_t *rec = page + rec_off;
+  if (rec_get_status(rec) != REC_STATUS_ORDINARY ||
+      !rec_get_offsets(rec, *ctx.index, thr->offsets, ctx.page_size) ||
+      rec_off + (thr->offsets.back() & REC_OFFS_MASK) > heap_top) {
+    return false;
+  }
+  recover_print(ctx, page_no, rec, source, thr);
+  thr->n_recs[source]++;
+  return true;
+}
+
+/** Looks for deleted records on one leaf page of the index. */
+static void recover_scan_page(const recover_ctx_t &ctx, page_no_t page_no,
+                              const byte *page, recover_thread_t *thr) {
+  const bool is_free = page_no < ctx.is_free.size() && ctx.is_free[page_no];
+  const ulint n_heap = page_dir_get_n_heap(page);
+  const ulint heap_top =
+      std::min<ulint>(page_header_get_field(page, PAGE_HEAP_TOP),
+                      ctx.page_size - FIL_PAGE_DATA_END);
+  thr->n_pages++;
+  if (is_free) {
+    thr->n_freed_pages++;
+  }
+
+  /* the record list: delete-marked records, and all of them on a page
+  that no longer belongs to the index */
+  ulint rec_off = rec_get_next_offs(page, PAGE_NEW_INFIMUM, ctx.page_size);
+  ulint n_visited = 0;
+  while (rec_off != 0 && rec_off != PAGE_NEW_SUPREMUM && n_visited < n_heap) {
+    const rec_t *rec = page + rec_off;
+    n_visited++;
+    bool is_deleted =
+        (rec_get_info_bits(rec, true) & REC_INFO_DELETED_FLAG) != 0;
+    if ((is_deleted || is_free) &&
+        !recover_try(ctx, page_no, page, rec_off, heap_top,
+                     is_deleted ? RECOVER_DELETE_MARKED : RECOVER_FREED_PAGE,
+                     thr)) {
+      thr->n_rejected++;
+    }
+    rec_off = rec_get_next_offs(page, rec_off, ctx.page_size);
+  }
+
+  /* the free list: purged records, linked through their next pointers
+  until one that is 0 */
+  rec_off = page_header_get_field(page, PAGE_FREE);
+  n_visited = 0;
+  while (rec_off != 0 && n_visited < n_heap) {
+    n_visited++;
+    if (!recover_try(ctx, page_no, page, rec_off, heap_top,
+                     RECOVER_FREE_LIST, thr)) {
+      thr->n_rejected++;
+      /* a link out of the heap can not be followed */
+      if (rec_off < PAGE_NEW_SUPREMUM_END || rec_off >= heap_top) {
+        break;
+      }
+    }
+    if (mach_read_from_2(page + rec_off - REC_NEXT) == 0) {
+      break;
+    }
+    rec_off = rec_get_next_offs(page, rec_off, ctx.page_size);
+  }
+}
+
+void ShowDeletedRecords(int fd, const char *sdi_path, uint32_t n_threads) {
+  const bool is_json = ut_format_is_json();
+  if (!is_json) {
+    printf("==========================Deleted Records==========================\n");
+  }
+  recover_ctx_t ctx;
+  if (dict_load_from_sdi(sdi_path, &ctx.table) != 0) {
+    fprintf(stderr, "Please specify a valid sdi file with -s\n");
+    return;
+  }
+  ctx.index = ctx.table.clustered_index();
+  if (ctx.index == nullptr) {
+    fprintf(stderr, "No clustered index in %s\n", sdi_path);
+    return;
+  }
+  ctx.page_size = fil_get_page_size(fd).logical();
+  ctx.trx_id_field = RECOVER_NO_TRX_ID;
+  for (ulint i = 0; i < ctx.index->fields.size(); i++) {
+    if (ctx.table.cols[ctx.index->fields[i].col_no].name == "DB_TRX_ID") {
+      ctx.trx_id_field = i;
+    }
+  }
+  page_no_t n_pages = fil_get_n_pages(fd);
+  recover_read_free_pages(fd, n_pages, &ctx.is_free);
+
+  n_threads = fil_scan_n_threads(n_threads);
+  std::vector<recover_thread_t> threads(n_threads);
+  fil_scan_parallel(
+      fd, 0, n_pages, n_threads,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+            mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID) !=
+                ctx.index->id ||
+            !page_is_leaf(page) ||
+            !(page_header_get_field(page, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+          return;
+        }
+        recover_scan_page(ctx, page_no, page, &threads[thread_no]);
+      });
+
+  recover_thread_t &total = threads[0];
+  for (uint32_t i = 1; i < n_threads; i++) {
+    total.n_pages += threads[i].n_pages;
+    total.n_freed_pages += threads[i].n_freed_pages;
+    total.n_rejected += threads[i].n_rejected;
+    for (int s = 0; s < RECOVER_N_SOURCES; s++) {
+      total.n_recs[s] += threads[i].n_recs[s];
+    }
+  }
+
+  if (is_json) {
+    Json_line line("deleted_summary");
+    line.add("table", ctx.table.name);
+    line.add("index_id", ctx.index->id);
+    line.add("n_pages", total.n_pages);
+    line.add("n_freed_pages", total.n_freed_pages);
+    line.add("n_delete_marked", total.n_recs[RECOVER_DELETE_MARKED]);
+    line.add("n_free_list", total.n_recs[RECOVER_FREE_LIST]);
+    line.add("n_freed_page", total.n_recs[RECOVER_FREED_PAGE]);
+    line.add("n_rejected", total.n_rejected);
+    return;
+  }
+  printf("Table: %s, index %s (id %lu), threads %u\n", ctx.table.name.c_str(),
+         ctx.index->name.c_str(), ctx.index->id, n_threads);
+  printf("Leaf pages: %lu, of which freed: %lu\n", total.n_pages,
+         total.n_freed_pages);
+  printf("Recovered records: delete-marked %lu, free list %lu, freed pages "
+         "%lu; candidates rejected %lu\n",
+         total.n_recs[RECOVER_DELETE_MARKED], total.n_recs[RECOVER_FREE_LIST],
+         total.n_recs[RECOVER_FREED_PAGE], total.n_rejected);
+}
+
+/** Leaf pages a carving round reads and formats before printing them */
+#define CARVE_BATCH_PAGES 256
+
+/** A leaf page whose record list is intact */
+struct carve_page_t {
+  uint64_t index_id;
+  page_no_t page_no;
+  page_no_t prev;
+  page_no_t next;
+  uint32_t n_recs;
+};
+
+/** The pages of one PAGE_INDEX_ID */
+struct carve_index_t {
+  carve_index_t()
+      : n_leaf_pages(0), n_nonleaf_pages(0), n_rejected(0), n_recs(0),
+        n_chains(0) {}
+
+  void add(const carve_index_t &other) {
+    n_leaf_pages += other.n_leaf_pages;
+    n_nonleaf_pages += other.n_nonleaf_pages;
+    n_rejected += other.n_rejected;
+    n_recs += other.n_recs;
+  }
+
+  uint64_t n_leaf_pages;
+  uint64_t n_nonleaf_pages;
+  /** leaf pages whose record list is broken */
+  uint64_t n_rejected;
+  uint64_t n_recs;
+  /** runs of leaf pages joined by their sibling links */
+  uint64_t n_chains;
+};
+
+/** What one carving thread found */
+struct carve_thread_t {
+  carve_thread_t() : frame(nullptr), n_recs(0), n_undecoded(0) {}
+  ~carve_thread_t() { free(frame); }
+
+  std::vector<carve_page_t> pages;
+  std::map<uint64_t, carve_index_t> indexes;
+  Page_rec_check rec_check;
+  /** pages dumped are read into it */
+  byte *frame;
+  std::unique_ptr<Page_zip_decompressor> zip;
+  std::vector<ulint> offsets;
+  uint64_t n_recs;
+  /** records of intact lists that do not decode with the table */
+  uint64_t n_undecoded;
+};
+
+/** Orders the leaf pages of one index as their sibling links chain them.
+A chain starts at a page whose FIL_PAGE_PREV is FIL_NULL, or names a page
+that is missing or does not point back, and follows FIL_PAGE_NEXT while
+the next page points back. The chain of the leftmost page comes first,
+the others in the order of their first page; pages on a loop of links
+come last.
+@param[in]   pages    pages of the index, by page number
+@param[in]   n_pages  number of pages
+@param[out]  order    indexes into pages
+@return number of chains */
+static uint64_t carve_order_pages(const carve_page_t *pages, size_t n_pages,
+                                  std::vector<size_t> *order) {
+  auto find = [&](page_no_t page_no) -> size_t {
+    const carve_page_t *it = std::lower_bound(
+        pages, pages + n_pages, page_no,
+        [](const carve_page_t &p, page_no_t no) { return p.page_no < no; });
+    return it != pages + n_pages && it->page_no == page_no
+               ? it - pages
+               : n_pages;
+  };
+  auto is_head = [&](size_t i) {
+    if (pages[i].prev == FIL_NULL) {
+      return true;
+    }
+    size_t prev = find(pages[i].prev);
+    return prev == n_pages || pages[prev].next != pages[i].page_no;
+  };
+  std::vector<byte> visited(n_pages, 0);
+  uint64_t n_chains = 0;
+  auto follow = [&](size_t i) {
+    n_chains++;
+    while (i != n_pages && !visited[i]) {
+      visited[i] = 1;
+      order->push_back(i);
+      size_t next = find(pages[i].next);
+      if (next == n_pages || pages[next].prev != pages[i].page_no) {
+        break;
+      }
+      i = next;
+    }
+  };
+
+  order->clear();
+  for (size_t i = 0; i < n_pages; i++) {
+    if (pages[i].prev == FIL_NULL && !visited[i]) {
+      follow(i);
+    }
+  }
+  for (size_t i = 0; i < n_pages; i++) {
+    if (!visited[i] && is_head(i)) {
+      follow(i);
+    }
+  }
+  for (size_t i = 0; i < n_pages; i++) {
+    if (!visited[i]) {
+      follow(i);
+    }
+  }
+  return n_chains;
+}
+
+/** Reads a leaf page again and formats its records, checked as the scan
+did, into the report of the page.
+@param[in]   fd         tablespace
+@param[in]   page_size  page size of the tablespace
+@param[in]   table      table definition
+@param[in]   index      clustered index
+@param[in]   page_no    page
+@param[in]   chain_no   chain of the page
+@param[out]  out        report of the page
+@param[in]   thr        thread */
+static void carve_dump_page(int fd, const page_size_t &page_size,
+                            const dict_table_t &table,
+                            const dict_index_t &index, page_no_t page_no,
+                            uint64_t chain_no, std::string *out,
+                            carve_thread_t *thr) {
+  const ulint physical = page_size.physical();
+  const ulint logical = page_size.logical();
+  const byte *page = thr->frame;
+  out->clear();
+  if (fil_pread(fd, thr->frame, physical, (uint64_t)page_no * physical) !=
+          (ssize_t)physical ||
+      !fil_page_restore(fd, thr->frame, physical)) {
+    return;
+  }
+  if (page_size.is_compressed()) {
+    if (!thr->zip) {
+      thr->zip.reset(new Page_zip_decompressor());
+    }
+    page = thr->zip->decompress(thr->frame, page_size);
+    if (page == nullptr) {
+      return;
+    }
+  }
+  if (thr->rec_check.check(page, logical) != PAGE_CHECK_OK) {
+    return;
+  }
+
+  /* the header of a record is read backwards from its origin */
+  const ulint extra = REC_N_NEW_EXTRA_BYTES +
+                      UT_BITS_IN_BYTES(index.n_nullable) +
+                      2 * index.fields.size();
+  const ulint heap_top = page_header_get_field(page, PAGE_HEAP_TOP);
+  const bool is_json = ut_format_is_json();
+  char buf[128];
+  for (ulint rec_off = rec_get_next_offs(page, PAGE_NEW_INFIMUM, logical);
+       rec_off != PAGE_NEW_SUPREMUM;
+       rec_off = rec_get_next_offs(page, rec_off, logical)) {
+    const rec_t *rec = page + rec_off;
+    if (rec_off < extra ||
+        !rec_get_offsets(rec, index, thr->offsets, logical) ||
+        rec_off + (thr->offsets.back() & REC_OFFS_MASK) > heap_top) {
+      thr->n_undecoded++;
+      continue;
+    }
+    ulint heap_no = rec_get_bit_field_2(rec, REC_NEW_HEAP_NO,
+                                        REC_HEAP_NO_MASK, REC_HEAP_NO_SHIFT);
+    bool is_deleted =
+        (rec_get_info_bits(rec, true) & REC_INFO_DELETED_FLAG) != 0;
+    thr->n_recs++;
+    if (is_json) {
+      Json_line line("carved_record");
+      line.add("page_no", page_no);
+      line.add("heap_no", heap_no);
+      line.add("chain", chain_no);
+      line.add("deleted", is_deleted);
+      ut_json_rec_fields(line, table, index, rec, thr->offsets);
+      line.append_to(out);
+      continue;
+    }
+    snprintf(buf, sizeof(buf), "page %u heap %u chain %lu%s:", page_no,
+             heap_no, chain_no, is_deleted ? " deleted" : "");
+    out->append(buf);
+    recover_format_fields(table, index, rec, thr->offsets, out);
+  }
+}
+
+void ShowCarvedRecords(int fd, const char *sdi_path, uint32_t n_threads) {
+  const bool is_json = ut_format_is_json();
+  if (!is_json) {
+    printf("==========================Carved Records==========================\n");
+  }
+  dict_table_t table;
+  const dict_index_t *index = nullptr;
+  if (sdi_path != nullptr && sdi_path[0] != '\0') {
+    if (dict_load_from_sdi(sdi_path, &table) != 0) {
+      fprintf(stderr, "Please specify a valid sdi file with -s\n");
+      return;
+    }
+    index = table.clustered_index();
+    if (index == nullptr) {
+      fprintf(stderr, "No clustered index in %s\n", sdi_path);
+      return;
+    }
+  }
+  /* page 0 may be as broken as the rest: the pages themselves tell the
+  size they were written in */
+  const page_size_t page_size = fil_detect_page_size(fd);
+  const page_size_t flags_size = fil_get_page_size(fd);
+  if (!page_size.equals_to(flags_size)) {
+    fprintf(stderr,
+            "Page 0 gives %u byte pages but the pages of the file are %u "
+            "bytes, carving in %u byte pages\n",
+            flags_size.physical(), page_size.physical(),
+            page_size.physical());
+  }
+  const ulint logical = page_size.logical();
+
+  /* every page on its own: leaf pages whose record list holds together,
+  whatever page 0, the inodes and the upper levels have become */
+  n_threads = fil_scan_n_threads(n_threads);
+  std::vector<carve_thread_t> threads(n_threads);
+  fil_scan_parallel(
+      fd, page_size, 0, fil_get_n_pages(fd, page_size), n_threads,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+            !(page_header_get_field(page, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+          return;
+        }
+        carve_thread_t &thr = threads[thread_no];
+        uint64_t index_id =
+            mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID);
+        carve_index_t &counts = thr.indexes[index_id];
+        if (!page_is_leaf(page)) {
+          counts.n_nonleaf_pages++;
+          return;
+        }
+        carve_page_t p;
+        if (thr.rec_check.check(page, logical) != PAGE_CHECK_OK) {
+          counts.n_rejected++;
+          return;
+        }
+        p.n_recs = thr.rec_check.n_recs();
+        p.index_id = index_id;
+        p.page_no = page_no;
+        p.prev = mach_read_from_4(page + FIL_PAGE_PREV);
+        p.next = mach_read_from_4(page + FIL_PAGE_NEXT);
+        counts.n_leaf_pages++;
+        counts.n_recs += p.n_recs;
+        thr.pages.push_back(p);
+      });
+
+  std::vector<carve_page_t> pages;
+  std::map<uint64_t, carve_index_t> indexes;
+  for (carve_thread_t &thr : threads) {
+    pages.insert(pages.end(), thr.pages.begin(), thr.pages.end());
+    std::vector<carve_page_t>().swap(thr.pages);
+    for (const auto &it : thr.indexes) {
+      indexes[it.first].add(it.second);
+    }
+  }
+  std::sort(pages.begin(), pages.end(),
+            [](const carve_page_t &a, const carve_page_t &b) {
+              return a.index_id != b.index_id ? a.index_id < b.index_id
+                                              : a.page_no < b.page_no;
+            });
+
+  /* the pages of the table in the order of their links, with the chain
+  each belongs to */
+  std::vector<page_no_t> dump_pages;
+  std::vector<uint64_t> dump_chains;
+  std::vector<size_t> order;
+  for (size_t begin = 0, end; begin < pages.size(); begin = end) {
+    end = begin;
+    while (end < pages.size() && pages[end].index_id == pages[begin].index_id) {
+      end++;
+    }
+    uint64_t n_chains =
+        carve_order_pages(&pages[begin], end - begin, &order);
+    indexes[pages[begin].index_id].n_chains = n_chains;
+    if (index == nullptr || pages[begin].index_id != index->id) {
+      continue;
+    }
+    uint64_t chain_no = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+      const carve_page_t &p = pages[begin + order[k]];
+      const carve_page_t *prev =
+          k == 0 ? nullptr : &pages[begin + order[k - 1]];
+      if (prev == nullptr || prev->next != p.page_no ||
+          p.prev != prev->page_no) {
+        chain_no++;
+      }
+      dump_pages.push_back(p.page_no);
+      dump_chains.push_back(chain_no);
+    }
+  }
+
+  if (!is_json) {
+    printf("index id\tleaf pages\tnon-leaf\trejected\trecords\t\tchains\tname\n");
+  }
+  for (const auto &it : indexes) {
+    const carve_index_t &c = it.second;
+    std::string name;
+    for (const dict_index_t &i : table.indexes) {
+      if (i.id == it.first) {
+        name = i.name;
+      }
+    }
+    if (is_json) {
+      Json_line line("carve_index");
+      line.add("index_id", it.first);
+      if (!name.empty()) {
+        line.add("name", name);
+      }
+      line.add("n_leaf_pages", c.n_leaf_pages);
+      line.add("n_nonleaf_pages", c.n_nonleaf_pages);
+      line.add("n_rejected", c.n_rejected);
+      line.add("n_recs", c.n_recs);
+      line.add("n_chains", c.n_chains);
+    } else {
+      printf("%lu\t\t%lu\t\t%lu\t\t%lu\t\t%lu\t\t%lu\t%s\n", it.first,
+             c.n_leaf_pages, c.n_nonleaf_pages, c.n_rejected, c.n_recs,
+             c.n_chains, name.c_str());
+    }
+  }
+  if (index == nullptr) {
+    return;
+  }
+  if (dump_pages.empty()) {
+    fprintf(stderr, "No intact leaf page of index %s (id %lu) in the file\n",
+            index->name.c_str(), index->id);
+  }
+
+  /* pages are read and formatted by the threads a batch at a time, and
+  printed in chain order */
+  for (carve_thread_t &thr : threads) {
+    if (posix_memalign((void **)&thr.frame, UNIV_PAGE_SIZE_MAX,
+                       UNIV_PAGE_SIZE_MAX) != 0) {
+      thr.frame = nullptr;
+      fprintf(stderr, "Out of memory\n");
+      return;
+    }
+  }
+  std::vector<std::string> reports(CARVE_BATCH_PAGES);
+  for (size_t first = 0; first < dump_pages.size();
+       first += CARVE_BATCH_PAGES) {
+    size_t n = std::min<size_t>(CARVE_BATCH_PAGES, dump_pages.size() - first);
+    ut_parallel_for(n, n_threads, [&](uint32_t thread_no, size_t task_no) {
+      carve_dump_page(fd, page_size, table, *index,
+                      dump_pages[first + task_no],
+                      dump_chains[first + task_no], &reports[task_no],
+                      &threads[thread_no]);
+    });
+    Monitor_timer timer(MONITOR_OUTPUT);
+    for (size_t i = 0; i < n; i++) {
+      timer.add_bytes(reports[i].size());
+      fwrite(reports[i].data(), 1, reports[i].size(), stdout);
+    }
+  }
+
+  uint64_t n_recs = 0;
+  uint64_t n_undecoded = 0;
+  for (const carve_thread_t &thr : threads) {
+    n_recs += thr.n_recs;
+    n_undecoded += thr.n_undecoded;
+  }
+  const carve_index_t &c = indexes[index->id];
+  if (is_json) {
+    Json_line line("carve_summary");
+    line.add("table", table.name);
+    line.add("index_id", index->id);
+    line.add("n_pages", (uint64_t)dump_pages.size());
+    line.add("n_chains", c.n_chains);
+    line.add("n_recs", n_recs);
+    line.add("n_undecoded", n_undecoded);
+    return;
+  }
+  printf("Table: %s, index %s (id %lu), threads %u\n", table.name.c_str(),
+         index->name.c_str(), index->id, n_threads);
+  printf("Carved records: %lu from %lu leaf pages in %lu chains; records "
+         "that do not decode %lu, leaf pages rejected %lu\n",
+         n_recs, (uint64_t)dump_pages.size(), c.n_chains, n_undecoded,
+         c.n_rejected);
+}
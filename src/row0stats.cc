@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "include/row0stats.h"
+#include "include/dict0dict.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/rem0rec.h"
+#include "include/ut0sketch.h"
+
+/** Number of buckets of the equi-height histogram */
+static const uint32_t STATS_HISTOGRAM_BUCKETS = 10;
+
+/** Number of most frequent values reported per column */
+static const uint32_t STATS_TOP_K = 10;
+
+/** String values are truncated to this many bytes before they enter the
+quantile sketch, which bounds its memory use */
+static const size_t STATS_MAX_KEY_LEN = 64;
+
+/** Statistics of one column gathered by one scan thread. */
+struct column_stats_t {
+  column_stats_t()
+      : n_values(0), n_nulls(0), n_external(0), n_rejected(0), total_len(0),
+        has_min_max(false), num_min(0), num_max(0), top_k(STATS_TOP_K) {}
+
+  uint64_t n_values;
+  uint64_t n_nulls;
+  uint64_t n_external;
+  /** values that do not fit in their page or their own length */
+  uint64_t n_rejected;
+  uint64_t total_len;
+
+  bool has_min_max;
+  double num_min;
+  double num_max;
+  std::string str_min;
+  std::string str_max;
+
+  Kll_sketch<double> num_kll;
+  Kll_sketch<std::string> str_kll;
+  Hll_sketch hll;
+  Top_k_sketch top_k;
+
+  void merge(const column_stats_t &other) {
+    n_values += other.n_values;
+    n_nulls += other.n_nulls;
+    n_external += other.n_external;
+    n_rejected += other.n_rejected;
+    total_len += other.total_len;
+    if (other.has_min_max) {
+      if (!has_min_max || other.num_min < num_min) num_min = other.num_min;
+      if (!has_min_max || other.num_max > num_max) num_max = other.num_max;
+      if (!has_min_max || other.str_min < str_min) str_min = other.str_min;
+      if (!has_min_max || other.str_max > str_max) str_max = other.str_max;
+      has_min_max = true;
+    }
+    num_kll.merge(other.num_kll);
+    str_kll.merge(other.str_kll);
+    hll.merge(other.hll);
+    top_k.merge(other.top_k);
+  }
+};
+
+/** Per-thread scan state. */
+struct stats_thread_t {
+  std::vector<column_stats_t> cols;
+  std::vector<ulint> offsets;
+  std::string value;
+  uint64_t n_pages;
+  uint64_t n_recs;
+  uint64_t n_deleted;
+};
+
+/** @return true if the column is profiled in the numeric domain */
+static bool stats_col_is_numeric(const dict_col_t &col) {
+  return dict_col_is_integer(col) || dict_col_is_float(col) ||
+         col.type == DD_TYPE_NEWDECIMAL;
+}
+
+/** Adds one field value to the statistics of its column.
+@param[in]  page_end  end of the page holding the record */
+static void stats_add_field(const dict_col_t &col, column_stats_t *stats,
+                            const byte *data, ulint len, bool is_extern,
+                            const byte *page_end, std::string *value) {
+  if (len == UNIV_SQL_NULL) {
+    stats->n_nulls++;
+    return;
+  }
+  /* a corrupt or carved record may still claim an off-page field shorter
+  than its reference, or run past the page */
+  if ((is_extern && len < BTR_EXTERN_FIELD_REF_SIZE) || data > page_end ||
+      len > (ulint)(page_end - data)) {
+    stats->n_rejected++;
+    return;
+  }
+  stats->n_values++;
+  stats->total_len += len;
+  if (is_extern) {
+    /* only the local prefix is profiled */
+    stats->n_external++;
+    len -= BTR_EXTERN_FIELD_REF_SIZE;
+  }
+
+  if (dict_col_is_string(col)) {
+    value->assign(reinterpret_cast<const char *>(data), len);
+  } else {
+    rec_field_to_string(col, data, len, value);
+  }
+  uint64_t hash = ut_hash_bytes(value->data(), value->size());
+  stats->hll.update(hash);
+  stats->top_k.update(*value, hash);
+
+  if (stats_col_is_numeric(col)) {
+    double v;
+    if (dict_col_is_integer(col)) {
+      v = (double)rec_field_to_int(col, data, len);
+    } else if (dict_col_is_float(col)) {
+      v = rec_field_to_double(col, data);
+    } else {
+      v = strtod(value->c_str(), nullptr);
+    }
+    if (!stats->has_min_max || v < stats->num_min) stats->num_min = v;
+    if (!stats->has_min_max || v > stats->num_max) stats->num_max = v;
+    stats->num_kll.update(v);
+  } else {
+    if (value->size() > STATS_MAX_KEY_LEN) {
+      value->resize(STATS_MAX_KEY_LEN);
+    }
+    if (!stats->has_min_max || *value < stats->str_min) stats->str_min = *value;
+    if (!stats->has_min_max || *value > stats->str_max) stats->str_max = *value;
+    stats->str_kll.update(*value);
+  }
+  stats->has_min_max = true;
+}
+
+/** Profiles the user records of one leaf page. */
+static void stats_scan_page(const dict_table_t &table,
+                            const dict_index_t &index, const byte *page,
+                            ulint page_size, stats_thread_t *thr) {
+  ulint n_heap = page_dir_get_n_heap(page);
+  ulint rec_off = rec_get_next_offs(page, PAGE_NEW_INFIMUM, page_size);
+  ulint n_visited = 0;
+
+  thr->n_pages++;
+  while (rec_off != 0 && rec_off != PAGE_NEW_SUPREMUM && n_visited < n_heap) {
+    const rec_t *rec = page + rec_off;
+    n_visited++;
+    rec_off = rec_get_next_offs(page, rec_off, page_size);
+
+    if (rec_get_status(rec) != REC_STATUS_ORDINARY) {
+      continue;
+    }
+    if (rec_get_info_bits(rec, true) & REC_INFO_DELETED_FLAG) {
+      /* waiting for purge, not part of the table any more */
+      thr->n_deleted++;
+      continue;
+    }
+    if (!rec_get_offsets(rec, index, thr->offsets, page_size)) {
+      continue;
+    }
+    thr->n_recs++;
+
+    for (ulint i = 0; i < index.fields.size(); i++) {
+      const dict_col_t &col = table.cols[index.fields[i].col_no];
+      if (col.hidden == DD_HIDDEN_SE) {
+        continue;
+      }
+      ulint len;
+      const byte *data = rec_get_nth_field(rec, thr->offsets, i, &len);
+      stats_add_field(col, &thr->cols[index.fields[i].col_no], data, len,
+                      rec_offs_nth_extern(thr->offsets, i),
+                      page + page_size - FIL_PAGE_DATA_END, &thr->value);
+    }
+  }
+}
+
+/** Prints the merged statistics of one column. */
+static void stats_print_column(const dict_col_t &col,
+                               const dict_field_t &field,
+                               const column_stats_t &stats) {
+  uint64_t n_rows = stats.n_values + stats.n_nulls;
+  printf("\n-------------------column %s-----------------------\n",
+         col.name.c_str());
+  printf("Type: %s\n", col.column_type_utf8.c_str());
+  printf("Null fraction: %.2lf%%\n",
+         n_rows == 0 ? 0.0 : stats.n_nulls * 100.0 / n_rows);
+  if (stats.n_rejected > 0) {
+    printf("Rejected values: %lu\n", stats.n_rejected);
+  }
+  if (!stats.has_min_max) {
+    return;
+  }
+
+  if (stats_col_is_numeric(col)) {
+    printf("Min: %.17g\n", stats.num_min);
+    printf("Max: %.17g\n", stats.num_max);
+  } else {
+    printf("Min: %s\n", stats.str_min.c_str());
+    printf("Max: %s\n", stats.str_max.c_str());
+  }
+  if (field.fixed_len == 0) {
+    printf("Average length: %.2lf\n",
+           (double)stats.total_len / stats.n_values);
+    printf("Stored off-page: %lu\n", stats.n_external);
+  }
+  printf("Distinct values (HLL): %lu\n", stats.hll.estimate());
+
+  std::vector<double> ranks;
+  for (uint32_t i = 0; i <= STATS_HISTOGRAM_BUCKETS; i++) {
+    ranks.push_back((double)i / STATS_HISTOGRAM_BUCKETS);
+  }
+  printf("Histogram (equi-height, %u buckets, ~%lu rows each):\n",
+         STATS_HISTOGRAM_BUCKETS, stats.n_values / STATS_HISTOGRAM_BUCKETS);
+  if (stats_col_is_numeric(col)) {
+    std::vector<double> bounds = stats.num_kll.quantiles(ranks);
+    /* the sketch may have compacted the extremes away */
+    bounds.front() = stats.num_min;
+    bounds.back() = stats.num_max;
+    for (uint32_t i = 0; i + 1 < bounds.size(); i++) {
+      printf("  bucket %u: [%.17g, %.17g]\n", i, bounds[i], bounds[i + 1]);
+    }
+  } else {
+    std::vector<std::string> bounds = stats.str_kll.quantiles(ranks);
+    bounds.front() = stats.str_min;
+    bounds.back() = stats.str_max;
+    for (uint32_t i = 0; i + 1 < bounds.size(); i++) {
+      printf("  bucket %u: [%s, %s]\n", i, bounds[i].c_str(),
+             bounds[i + 1].c_str());
+    }
+  }
+
+  printf("Top %u values:\n", STATS_TOP_K);
+  for (const auto &v : stats.top_k.top()) {
+    printf("  %.*s: %lu\n", (int)STATS_MAX_KEY_LEN, v.first.c_str(),
+           v.second);
+  }
+}
+
+void ShowColumnStats(int fd, const char *sdi_path, uint32_t n_threads) {
+  printf("==========================Column Statistics==========================\n");
+  dict_table_t table;
+  if (dict_load_from_sdi(sdi_path, &table) != 0) {
+    fprintf(stderr, "Please specify a valid sdi file with -s\n");
+    return;
+  }
+  const dict_index_t *index = table.clustered_index();
+  if (index == nullptr) {
+    fprintf(stderr, "No clustered index in %s\n", sdi_path);
+    return;
+  }
+
+  n_threads = fil_scan_n_threads(n_threads);
+  std::vector<stats_thread_t> threads(n_threads);
+  for (stats_thread_t &thr : threads) {
+    thr.cols.resize(table.cols.size());
+    thr.n_pages = thr.n_recs = thr.n_deleted = 0;
+  }
+
+  const ulint page_size = fil_get_page_size(fd).logical();
+  fil_scan_parallel(
+      fd, 0, fil_get_n_pages(fd), n_threads,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        (void)page_no;
+        if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+            mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID) != index->id ||
+            !page_is_leaf(page) ||
+            !(page_header_get_field(page, PAGE_N_HEAP) & PAGE_IS_COMPACT)) {
+          return;
+        }
+        stats_scan_page(table, *index, page, page_size, &threads[thread_no]);
+      });
+
+  stats_thread_t &total = threads[0];
+  for (uint32_t i = 1; i < n_threads; i++) {
+    total.n_pages += threads[i].n_pages;
+    total.n_recs += threads[i].n_recs;
+    total.n_deleted += threads[i].n_deleted;
+    for (size_t c = 0; c < table.cols.size(); c++) {
+      total.cols[c].merge(threads[i].cols[c]);
+    }
+  }
+
+  printf("Table: %s, index %s (id %lu), threads %u\n", table.name.c_str(),
+         index->name.c_str(), index->id, n_threads);
+  printf("Leaf pages: %lu, records: %lu, delete-marked records: %lu\n",
+         total.n_pages, total.n_recs, total.n_deleted);
+
+  for (const dict_field_t &field : index->fields) {
+    const dict_col_t &col = table.cols[field.col_no];
+    if (col.hidden == DD_HIDDEN_SE) {
+      continue;
+    }
+    stats_print_column(col, field, total.cols[field.col_no]);
+  }
+}
@@ -0,0 +1,286 @@
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "include/srv0mon.h"
+
+/** Sub-buckets of each power of two of a latency histogram: 8 keep the
+error of a percentile under 12.5%, as an HDR histogram of one
+significant digit does */
+#define MONITOR_HIST_SUB_BITS 3
+#define MONITOR_HIST_SUB (1 << MONITOR_HIST_SUB_BITS)
+/** Buckets covering every 64-bit duration */
+#define MONITOR_HIST_BUCKETS ((64 - MONITOR_HIST_SUB_BITS + 1) * MONITOR_HIST_SUB)
+
+bool monitor_is_on = false;
+
+/** Counters of one thread, written by that thread only */
+struct monitor_slot_t {
+  monitor_slot_t()
+      : count(), ticks(), bytes(), max(), hist(), read_bytes(0),
+        skipped_bytes(0) {}
+
+  uint64_t count[NUM_MONITOR];
+  uint64_t ticks[NUM_MONITOR];
+  uint64_t bytes[NUM_MONITOR];
+  uint64_t max[NUM_MONITOR];
+  uint64_t hist[NUM_MONITOR][MONITOR_HIST_BUCKETS];
+  /** bytes[MONITOR_PAGE_READ] and the bytes scans passed over, which the
+  progress thread reads while the thread counts: relaxed atomics, added
+  to with a load and a store since no other thread writes them */
+  std::atomic<uint64_t> read_bytes;
+  std::atomic<uint64_t> skipped_bytes;
+};
+
+static const char *monitor_names[NUM_MONITOR] = {
+    "page read", "page crc32", "record decode", "lob fetch", "output"};
+
+static std::mutex monitor_mutex;
+/** slots of every thread that counted, kept after the thread exits */
+static std::vector<std::unique_ptr<monitor_slot_t>> monitor_slots;
+static thread_local monitor_slot_t *monitor_slot = nullptr;
+
+/** clocks when counting started */
+static uint64_t monitor_start_clock;
+static std::chrono::steady_clock::time_point monitor_start_time;
+
+/** bytes the command is expected to read, for the progress line */
+static std::atomic<uint64_t> monitor_total_bytes(0);
+static std::atomic<uint64_t> monitor_page_size(0);
+
+static uint32_t monitor_bucket(uint64_t v) {
+  if (v < MONITOR_HIST_SUB) {
+    return v;
+  }
+  uint32_t e = 63 - __builtin_clzll(v);
+  return (e - MONITOR_HIST_SUB_BITS + 1) * MONITOR_HIST_SUB +
+         ((v >> (e - MONITOR_HIST_SUB_BITS)) & (MONITOR_HIST_SUB - 1));
+}
+
+/** @return the smallest duration falling in a bucket */
+static uint64_t monitor_bucket_low(uint32_t b) {
+  if (b < MONITOR_HIST_SUB) {
+    return b;
+  }
+  uint32_t e = b / MONITOR_HIST_SUB + MONITOR_HIST_SUB_BITS - 1;
+  return (uint64_t)(MONITOR_HIST_SUB + b % MONITOR_HIST_SUB)
+         << (e - MONITOR_HIST_SUB_BITS);
+}
+
+/** @return the slot of the calling thread, registered on first use */
+static monitor_slot_t *monitor_get_slot() {
+  monitor_slot_t *slot = monitor_slot;
+  if (slot == nullptr) {
+    slot = new monitor_slot_t();
+    std::lock_guard<std::mutex> guard(monitor_mutex);
+    monitor_slots.emplace_back(slot);
+    monitor_slot = slot;
+  }
+  return slot;
+}
+
+/** Adds to a counter of the calling thread that another thread reads. */
+static void monitor_add_shared(std::atomic<uint64_t> *counter,
+                               uint64_t bytes) {
+  counter->store(counter->load(std::memory_order_relaxed) + bytes,
+                 std::memory_order_relaxed);
+}
+
+void monitor_add(monitor_id_t id, uint64_t ticks, uint64_t bytes) {
+  monitor_slot_t *slot = monitor_get_slot();
+  slot->count[id]++;
+  slot->ticks[id] += ticks;
+  slot->bytes[id] += bytes;
+  slot->max[id] = std::max(slot->max[id], ticks);
+  slot->hist[id][monitor_bucket(ticks)]++;
+  if (id == MONITOR_PAGE_READ) {
+    monitor_add_shared(&slot->read_bytes, bytes);
+  }
+}
+
+void monitor_enable() {
+  monitor_start_time = std::chrono::steady_clock::now();
+  monitor_start_clock = monitor_clock();
+  monitor_is_on = true;
+}
+
+/** @return seconds since monitor_enable() */
+static double monitor_elapsed() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       monitor_start_time)
+      .count();
+}
+
+/** Formats a duration with a unit that keeps it short */
+static const char *monitor_format_ns(double ns, char *buf, size_t size) {
+  if (ns < 1e3) {
+    snprintf(buf, size, "%.0fns", ns);
+  } else if (ns < 1e6) {
+    snprintf(buf, size, "%.1fus", ns / 1e3);
+  } else if (ns < 1e9) {
+    snprintf(buf, size, "%.1fms", ns / 1e6);
+  } else {
+    snprintf(buf, size, "%.2fs", ns / 1e9);
+  }
+  return buf;
+}
+
+void monitor_print(FILE *out) {
+  if (!monitor_is_on) {
+    return;
+  }
+  {
+    Monitor_timer timer(MONITOR_OUTPUT);
+    fflush(stdout);
+  }
+  double wall = monitor_elapsed();
+  /* the time stamp counter is calibrated over the whole run */
+  double ns_per_tick =
+      wall > 0 ? wall * 1e9 / (monitor_clock() - monitor_start_clock) : 1;
+
+  monitor_slot_t sum;
+  size_t n_threads;
+  {
+    std::lock_guard<std::mutex> guard(monitor_mutex);
+    n_threads = monitor_slots.size();
+    for (const std::unique_ptr<monitor_slot_t> &slot : monitor_slots) {
+      for (int id = 0; id < NUM_MONITOR; id++) {
+        sum.count[id] += slot->count[id];
+        sum.ticks[id] += slot->ticks[id];
+        sum.bytes[id] += slot->bytes[id];
+        sum.max[id] = std::max(sum.max[id], slot->max[id]);
+        for (uint32_t b = 0; b < MONITOR_HIST_BUCKETS; b++) {
+          sum.hist[id][b] += slot->hist[id][b];
+        }
+      }
+    }
+  }
+  fprintf(out, "==========================Statistics==========================\n");
+  fprintf(out, "Wall time %.3f s, %lu threads counted\n", wall, n_threads);
+  fprintf(out, "%-14s %10s %10s %6s %12s %10s %8s %8s %8s %8s %8s %8s\n",
+          "phase", "calls", "time s", "%wall", "bytes", "MB/s", "avg",
+          "p50", "p90", "p99", "p99.9", "max");
+  static const double percentiles[] = {0.5, 0.9, 0.99, 0.999};
+  for (int id = 0; id < NUM_MONITOR; id++) {
+    if (sum.count[id] == 0) {
+      continue;
+    }
+    double seconds = sum.ticks[id] * ns_per_tick / 1e9;
+    char buf[6][16];
+    /* the middle of the bucket holding each percentile, no more than the
+    largest duration seen */
+    double max = sum.max[id] * ns_per_tick;
+    double values[4];
+    uint64_t seen = 0;
+    uint32_t p = 0;
+    for (uint32_t b = 0; b < MONITOR_HIST_BUCKETS && p < 4; b++) {
+      seen += sum.hist[id][b];
+      while (p < 4 && seen >= percentiles[p] * sum.count[id] && seen > 0) {
+        values[p++] = std::min(
+            (monitor_bucket_low(b) + monitor_bucket_low(b + 1)) / 2.0 *
+                ns_per_tick,
+            max);
+      }
+    }
+    fprintf(out,
+            "%-14s %10lu %10.3f %5.1f%% %12lu %10.1f %8s %8s %8s %8s %8s "
+            "%8s\n",
+            monitor_names[id], sum.count[id], seconds,
+            wall > 0 ? seconds * 100.0 / wall : 0.0,
+            sum.bytes[id],
+            seconds > 0 ? sum.bytes[id] / seconds / (1 << 20) : 0.0,
+            monitor_format_ns(seconds * 1e9 / sum.count[id], buf[0], 16),
+            monitor_format_ns(values[0], buf[1], 16),
+            monitor_format_ns(values[1], buf[2], 16),
+            monitor_format_ns(values[2], buf[3], 16),
+            monitor_format_ns(values[3], buf[4], 16),
+            monitor_format_ns(max, buf[5], 16));
+  }
+  fprintf(out, "Time is summed over the threads, so %%wall may pass 100%% "
+               "with several; a lob fetch includes its reads and output. "
+               "MB/s is bytes over that time.\n");
+  fflush(out);
+}
+
+static std::mutex monitor_progress_mutex;
+static std::condition_variable monitor_progress_cond;
+static bool monitor_progress_done = false;
+static std::unique_ptr<std::thread> monitor_progress_thread;
+
+static void monitor_progress_print() {
+  double elapsed = monitor_elapsed();
+  uint64_t done = 0;
+  {
+    std::lock_guard<std::mutex> guard(monitor_mutex);
+    for (const std::unique_ptr<monitor_slot_t> &slot : monitor_slots) {
+      done += slot->read_bytes.load(std::memory_order_relaxed) +
+              slot->skipped_bytes.load(std::memory_order_relaxed);
+    }
+  }
+  uint64_t total = monitor_total_bytes.load(std::memory_order_relaxed);
+  uint64_t page_size = monitor_page_size.load(std::memory_order_relaxed);
+  double rate = elapsed > 0 ? done / elapsed : 0;
+  char line[256];
+  int len = snprintf(line, sizeof(line), "progress: %.1f MB", done / 1048576.0);
+  if (total > 0) {
+    len += snprintf(line + len, sizeof(line) - len, " of %.1f MB",
+                    total / 1048576.0);
+  }
+  if (page_size > 0) {
+    len += snprintf(line + len, sizeof(line) - len, ", %lu pages",
+                    done / page_size);
+  }
+  len += snprintf(line + len, sizeof(line) - len, ", %.1f MB/s",
+                  rate / 1048576.0);
+  if (total > 0 && done <= total && rate > 0) {
+    uint64_t left = (total - done) / rate;
+    snprintf(line + len, sizeof(line) - len,
+             " (%.1f%%), ETA %02lu:%02lu:%02lu", done * 100.0 / total,
+             left / 3600, left / 60 % 60, left % 60);
+  }
+  fprintf(stderr, "%s\n", line);
+}
+
+void monitor_progress_start(uint32_t interval) {
+  if (monitor_progress_thread != nullptr || interval == 0) {
+    return;
+  }
+  monitor_progress_thread.reset(new std::thread([interval]() {
+    std::unique_lock<std::mutex> lock(monitor_progress_mutex);
+    while (!monitor_progress_cond.wait_for(
+        lock, std::chrono::seconds(interval),
+        []() { return monitor_progress_done; })) {
+      monitor_progress_print();
+    }
+  }));
+}
+
+void monitor_progress_set_total(uint64_t total, ulint page_size) {
+  monitor_total_bytes = total;
+  monitor_page_size = page_size;
+}
+
+void monitor_progress_skip(uint64_t bytes) {
+  if (monitor_is_on) {
+    monitor_add_shared(&monitor_get_slot()->skipped_bytes, bytes);
+  }
+}
+
+void monitor_progress_stop() {
+  if (monitor_progress_thread == nullptr) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(monitor_progress_mutex);
+    monitor_progress_done = true;
+  }
+  monitor_progress_cond.notify_all();
+  monitor_progress_thread->join();
+  monitor_progress_thread.reset();
+}
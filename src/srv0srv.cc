@@ -0,0 +1,574 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/srv0srv.h"
+#include "include/api0space.h"
+#include "include/buf0cache.h"
+#include "include/fil0fil.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/page_crc32.h"
+#include "include/rem0rec.h"
+#include "include/srv0mon.h"
+#include "include/ut0ut.h"
+
+/** An open tablespace and what the server knows of it */
+struct srv_space_t {
+  std::shared_ptr<Tablespace> space;
+  /** mtime and size of the file when it was opened */
+  struct timespec mtime;
+  off_t size;
+  /** reply to "summary", empty until asked for */
+  std::string summary;
+};
+
+/** A table definition loaded from an ibd2sdi json */
+struct srv_schema_t {
+  std::shared_ptr<Schema> schema;
+  struct timespec mtime;
+};
+
+/** A client connection */
+struct srv_conn_t {
+  srv_conn_t(int fd) : fd(fd), done(false) {}
+
+  int fd;
+  std::thread thread;
+  /** set by the thread when it has finished with the connection */
+  std::atomic<bool> done;
+};
+
+/** State shared by the connections */
+struct srv_t {
+  srv_t(uint64_t cache_bytes, uint32_t n_threads)
+      : cache(cache_bytes), n_threads(n_threads), listen_fd(-1),
+        shutdown(false), n_requests(0) {}
+
+  Buf_page_cache cache;
+  uint32_t n_threads;
+  int listen_fd;
+  std::atomic<bool> shutdown;
+  std::atomic<uint64_t> n_requests;
+
+  /** protects spaces and schemas */
+  std::mutex mutex;
+  std::map<std::string, srv_space_t> spaces;
+  std::map<std::string, srv_schema_t> schemas;
+};
+
+static bool srv_same_mtime(const struct timespec &a,
+                           const struct timespec &b) {
+  return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+/** Gets an open tablespace, opening it on first use or when the file
+changed since. The pages of the file it replaces are dropped from the
+cache when the last request using it is done.
+@param[in]   srv     server
+@param[in]   path    data file
+@param[out]  error   why it can not be opened
+@return the tablespace, nullptr on error */
+static std::shared_ptr<Tablespace> srv_get_space(srv_t *srv,
+                                                 const std::string &path,
+                                                 std::string *error) {
+  struct stat stat_buf;
+  if (stat(path.c_str(), &stat_buf) == -1) {
+    *error = strerror(errno);
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(srv->mutex);
+  auto it = srv->spaces.find(path);
+  if (it != srv->spaces.end() &&
+      srv_same_mtime(it->second.mtime, stat_buf.st_mtim) &&
+      it->second.size == stat_buf.st_size) {
+    return it->second.space;
+  }
+
+  std::unique_ptr<Tablespace> space = Tablespace::open(path.c_str());
+  if (!space) {
+    *error = "can not open the file";
+    return nullptr;
+  }
+  Buf_page_cache *cache = &srv->cache;
+  srv_space_t &entry = srv->spaces[path];
+  entry.space.reset(space.release(), [cache](Tablespace *t) {
+    /* the descriptor may be reused once it is closed */
+    cache->evict(t->fd());
+    delete t;
+  });
+  entry.mtime = stat_buf.st_mtim;
+  entry.size = stat_buf.st_size;
+  entry.summary.clear();
+  return entry.space;
+}
+
+/** Gets a table definition, loading it on first use or when the json
+changed since. */
+static std::shared_ptr<Schema> srv_get_schema(srv_t *srv,
+                                              const std::string &path,
+                                              std::string *error) {
+  struct stat stat_buf;
+  if (stat(path.c_str(), &stat_buf) == -1) {
+    *error = strerror(errno);
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(srv->mutex);
+  auto it = srv->schemas.find(path);
+  if (it != srv->schemas.end() &&
+      srv_same_mtime(it->second.mtime, stat_buf.st_mtim)) {
+    return it->second.schema;
+  }
+  std::unique_ptr<Schema> schema = Schema::load(path.c_str());
+  if (!schema) {
+    *error = "can not parse the sdi";
+    return nullptr;
+  }
+  srv_schema_t &entry = srv->schemas[path];
+  entry.schema.reset(schema.release());
+  entry.mtime = stat_buf.st_mtim;
+  return entry.schema;
+}
+
+/** Frame of the largest page size, for the pages read by a request */
+struct srv_frame_t {
+  srv_frame_t() : buf(nullptr) {
+    if (posix_memalign((void **)&buf, UNIV_PAGE_SIZE_MAX,
+                       UNIV_PAGE_SIZE_MAX) != 0) {
+      buf = nullptr;
+    }
+  }
+  ~srv_frame_t() { free(buf); }
+
+  byte *buf;
+};
+
+/** Reads a page of a request through the cache.
+@return false with error set if it can not be read */
+static bool srv_read_page(srv_t *srv, const Tablespace &space,
+                          const std::string &page_arg, byte *frame,
+                          page_no_t *page_no, std::string *error) {
+  char *end;
+  unsigned long n = strtoul(page_arg.c_str(), &end, 10);
+  if (page_arg.empty() || *end != '\0' || n >= space.n_pages()) {
+    *error = "no page " + page_arg + " in the file";
+    return false;
+  }
+  *page_no = n;
+  if (!space.read_page(*page_no, frame, &srv->cache)) {
+    *error = "can not read or restore page " + page_arg;
+    return false;
+  }
+  return true;
+}
+
+static bool srv_page(srv_t *srv, const std::vector<std::string> &args,
+                     std::string *out, std::string *error) {
+  if (args.size() != 3) {
+    *error = "usage: page <file> <page_no>";
+    return false;
+  }
+  std::shared_ptr<Tablespace> space = srv_get_space(srv, args[1], error);
+  srv_frame_t frame;
+  page_no_t page_no;
+  if (!space || !srv_read_page(srv, *space, args[2], frame.buf, &page_no,
+                               error)) {
+    return false;
+  }
+  const byte *page = frame.buf;
+  const page_size_t &page_size = space->page_size();
+  page_type_t type = fil_page_get_type(page);
+  ut_str_printf(out, "page %u type %s (%u) space %u prev %u next %u lsn %lu\n",
+             page_no, fil_get_page_type_str(type), type,
+             mach_read_from_4(page + FIL_PAGE_SPACE_ID),
+             mach_read_from_4(page + FIL_PAGE_PREV),
+             mach_read_from_4(page + FIL_PAGE_NEXT),
+             mach_read_from_8(page + FIL_PAGE_LSN));
+  if (page_size.is_compressed()) {
+    ut_str_printf(out, "checksum not checked on a compressed page\n");
+  } else {
+    ut_str_printf(out, "checksum %s\n",
+               buf_page_is_corrupted(page, page_size.logical()) ? "corrupt"
+                                                                : "ok");
+  }
+  if (fil_page_type_is_index(type)) {
+    ut_str_printf(out,
+               "index id %lu level %u records %u heap %u garbage %u\n",
+               mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID),
+               page_header_get_field(page, PAGE_LEVEL),
+               page_header_get_field(page, PAGE_N_RECS),
+               page_dir_get_n_heap(page),
+               page_header_get_field(page, PAGE_GARBAGE));
+  }
+  return true;
+}
+
+static bool srv_records(srv_t *srv, const std::vector<std::string> &args,
+                        std::string *out, std::string *error) {
+  if (args.size() != 4) {
+    *error = "usage: records <file> <page_no> <sdi json>";
+    return false;
+  }
+  std::shared_ptr<Tablespace> space = srv_get_space(srv, args[1], error);
+  if (!space) {
+    return false;
+  }
+  std::shared_ptr<Schema> schema = srv_get_schema(srv, args[3], error);
+  srv_frame_t frame;
+  page_no_t page_no;
+  if (!schema || !srv_read_page(srv, *space, args[2], frame.buf, &page_no,
+                                error)) {
+    return false;
+  }
+  const byte *page = frame.buf;
+  if (fil_page_get_type(page) != FIL_PAGE_INDEX ||
+      page_header_get_field(page, PAGE_LEVEL) != 0) {
+    *error = "page " + args[2] + " is not a leaf page";
+    return false;
+  }
+  uint64_t index_id = mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID);
+  const dict_index_t *index = schema->index_by_id(index_id);
+  if (index == nullptr) {
+    *error = "index " + std::to_string(index_id) + " is not in the sdi";
+    return false;
+  }
+
+  const dict_table_t &table = schema->table();
+  Record_cursor cursor(page, *index, space->page_size().logical());
+  std::string value;
+  uint64_t n_recs = 0;
+  while (cursor.next()) {
+    n_recs++;
+    const char *sep = "";
+    for (ulint i = 0; i < index->fields.size(); i++) {
+      const dict_col_t &col = table.cols[index->fields[i].col_no];
+      if (col.hidden == DD_HIDDEN_SE) {
+        continue;
+      }
+      ulint len;
+      const byte *data = cursor.field(i, &len);
+      if (len == UNIV_SQL_NULL) {
+        value = "NULL";
+      } else if (cursor.is_extern(i)) {
+        value = "<off-page>";
+      } else {
+        rec_field_to_string(col, data, len, &value);
+      }
+      ut_str_printf(out, "%s%s=%s", sep, col.name.c_str(), value.c_str());
+      sep = " ";
+    }
+    out->push_back('\n');
+  }
+  ut_str_printf(out, "records %lu\n", n_recs);
+  return true;
+}
+
+/** Root pages carry the segment headers of their B-tree */
+static bool srv_fseg_is_valid(const byte *seg_header, space_id_t space_id,
+                              ulint page_size) {
+  ulint offset = mach_read_from_2(seg_header + FSEG_HDR_OFFSET);
+  return mach_read_from_4(seg_header + FSEG_HDR_SPACE) == space_id &&
+         offset >= FIL_PAGE_DATA && offset <= page_size - FIL_PAGE_DATA_END;
+}
+
+/** Builds the reply to "summary" with one scan of the file */
+static void srv_build_summary(const Tablespace &space, uint32_t n_threads,
+                              std::string *out) {
+  struct root_t {
+    page_no_t page_no;
+    uint64_t index_id;
+    ulint level;
+  };
+  struct counts_t {
+    std::map<page_type_t, uint64_t> types;
+    std::vector<root_t> roots;
+  };
+  const space_id_t space_id = space.space_id();
+  const ulint logical = space.page_size().logical();
+  n_threads = fil_scan_n_threads(n_threads);
+  std::vector<counts_t> counts(n_threads);
+  uint64_t n_visited = space.scan(
+      0, space.n_pages(), n_threads,
+      [&](uint32_t thread_no, page_no_t page_no, const byte *page) {
+        page_type_t type = fil_page_get_type(page);
+        counts[thread_no].types[type]++;
+        if (type == FIL_PAGE_INDEX &&
+            srv_fseg_is_valid(page + PAGE_HEADER + PAGE_BTR_SEG_LEAF,
+                              space_id, logical) &&
+            srv_fseg_is_valid(page + PAGE_HEADER + PAGE_BTR_SEG_TOP,
+                              space_id, logical)) {
+          counts[thread_no].roots.push_back(
+              {page_no, mach_read_from_8(page + PAGE_HEADER + PAGE_INDEX_ID),
+               page_header_get_field(page, PAGE_LEVEL)});
+        }
+      });
+
+  std::map<page_type_t, uint64_t> types;
+  std::vector<root_t> roots;
+  for (const counts_t &c : counts) {
+    for (const auto &it : c.types) {
+      types[it.first] += it.second;
+    }
+    roots.insert(roots.end(), c.roots.begin(), c.roots.end());
+  }
+  std::sort(roots.begin(), roots.end(),
+            [](const root_t &a, const root_t &b) {
+              return a.page_no < b.page_no;
+            });
+
+  srv_frame_t frame;
+  if (frame.buf != nullptr && space.read_page(0, frame.buf)) {
+    const byte *header = frame.buf + FSP_HEADER_OFFSET;
+    ut_str_printf(out, "space %u size %u free limit %u\n", space_id,
+               mach_read_from_4(header + FSP_SIZE),
+               mach_read_from_4(header + FSP_FREE_LIMIT));
+  }
+  ut_str_printf(out, "page size %u logical %u pages %u read %lu\n",
+             space.page_size().physical(), logical, space.n_pages(),
+             n_visited);
+  for (const auto &it : types) {
+    ut_str_printf(out, "type %s (%u) pages %lu\n",
+               fil_get_page_type_str(it.first), it.first, it.second);
+  }
+  for (const root_t &root : roots) {
+    ut_str_printf(out, "index %lu root %u height %u\n", root.index_id,
+               root.page_no, root.level + 1);
+  }
+}
+
+static bool srv_summary(srv_t *srv, const std::vector<std::string> &args,
+                        std::string *out, std::string *error) {
+  if (args.size() != 2) {
+    *error = "usage: summary <file>";
+    return false;
+  }
+  std::shared_ptr<Tablespace> space = srv_get_space(srv, args[1], error);
+  if (!space) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> guard(srv->mutex);
+    auto it = srv->spaces.find(args[1]);
+    if (it != srv->spaces.end() && it->second.space == space &&
+        !it->second.summary.empty()) {
+      out->append(it->second.summary);
+      return true;
+    }
+  }
+  /* scanned outside the latch, other requests go on meanwhile */
+  std::string summary;
+  srv_build_summary(*space, srv->n_threads, &summary);
+  std::lock_guard<std::mutex> guard(srv->mutex);
+  auto it = srv->spaces.find(args[1]);
+  if (it != srv->spaces.end() && it->second.space == space) {
+    it->second.summary = summary;
+  }
+  out->append(summary);
+  return true;
+}
+
+static bool srv_stats(srv_t *srv, std::string *out) {
+  std::lock_guard<std::mutex> guard(srv->mutex);
+  uint64_t hits = srv->cache.n_hits();
+  uint64_t misses = srv->cache.n_misses();
+  ut_str_printf(out,
+             "files %lu schemas %lu requests %lu cache bytes %lu hits %lu "
+             "misses %lu hit rate %.2lf%%\n",
+             srv->spaces.size(), srv->schemas.size(), srv->n_requests.load(),
+             srv->cache.size(), hits, misses,
+             hits + misses == 0 ? 0.0 : hits * 100.0 / (hits + misses));
+  for (const auto &it : srv->spaces) {
+    ut_str_printf(out, "file %s pages %u\n", it.first.c_str(),
+               it.second.space->n_pages());
+  }
+  return true;
+}
+
+/** Answers one request line.
+@return false when the server is to stop */
+static bool srv_handle(srv_t *srv, const std::string &line,
+                       std::string *out) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::string> args;
+  std::istringstream words(line);
+  std::string word;
+  while (words >> word) {
+    args.push_back(word);
+  }
+  if (args.empty()) {
+    return true;
+  }
+  srv->n_requests++;
+
+  bool ok = false;
+  bool running = true;
+  std::string error;
+  const std::string &cmd = args[0];
+  if (cmd == "page") {
+    ok = srv_page(srv, args, out, &error);
+  } else if (cmd == "records") {
+    ok = srv_records(srv, args, out, &error);
+  } else if (cmd == "summary") {
+    ok = srv_summary(srv, args, out, &error);
+  } else if (cmd == "stats") {
+    ok = srv_stats(srv, out);
+  } else if (cmd == "close" && args.size() == 2) {
+    std::lock_guard<std::mutex> guard(srv->mutex);
+    ok = srv->spaces.erase(args[1]) > 0;
+    error = "file is not open";
+  } else if (cmd == "shutdown") {
+    ok = true;
+    running = false;
+  } else {
+    error = "unknown request, try page, records, summary, stats, close or "
+            "shutdown";
+  }
+
+  if (ok) {
+    ut_str_printf(out, "OK %ld\n",
+               (long)std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count());
+  } else {
+    ut_str_printf(out, "ERROR %s\n", error.c_str());
+  }
+  return running;
+}
+
+/** Writes a whole reply.
+@return false if the client went away */
+static bool srv_write(int fd, const std::string &out) {
+  Monitor_timer timer(MONITOR_OUTPUT);
+  timer.add_bytes(out.size());
+  size_t done = 0;
+  while (done < out.size()) {
+    ssize_t ret = send(fd, out.data() + done, out.size() - done, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    done += ret;
+  }
+  return true;
+}
+
+/** Serves the requests of one connection until the client closes it */
+static void srv_conn_thread(srv_t *srv, srv_conn_t *conn) {
+  std::string in;
+  char buf[SRV_MAX_REQUEST];
+  bool open = true;
+  while (open) {
+    ssize_t ret = recv(conn->fd, buf, sizeof(buf), 0);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      break;
+    }
+    in.append(buf, ret);
+    size_t eol;
+    while (open && (eol = in.find('\n')) != std::string::npos) {
+      std::string out;
+      bool running = srv_handle(srv, in.substr(0, eol), &out);
+      in.erase(0, eol + 1);
+      open = srv_write(conn->fd, out);
+      if (!running) {
+        srv->shutdown = true;
+        /* wakes up accept() */
+        shutdown(srv->listen_fd, SHUT_RDWR);
+        open = false;
+      }
+    }
+    if (in.size() > SRV_MAX_REQUEST) {
+      srv_write(conn->fd, "ERROR request too long\n");
+      break;
+    }
+  }
+  conn->done = true;
+}
+
+int srv_serve(const char *socket_path, uint64_t cache_bytes,
+              uint32_t n_threads) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Socket path %s is too long\n", socket_path);
+    return -1;
+  }
+  strcpy(addr.sun_path, socket_path);
+
+  srv_t srv(cache_bytes, n_threads);
+  srv.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(socket_path);
+  if (srv.listen_fd == -1 ||
+      bind(srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+      listen(srv.listen_fd, 64) == -1) {
+    fprintf(stderr, "Listen on %s failed: %s\n", socket_path,
+            strerror(errno));
+    if (srv.listen_fd != -1) {
+      close(srv.listen_fd);
+    }
+    return -1;
+  }
+  printf("Serving on %s, page cache %lu bytes\n", socket_path, cache_bytes);
+  fflush(stdout);
+
+  std::list<std::unique_ptr<srv_conn_t>> conns;
+  while (!srv.shutdown) {
+    int fd = accept(srv.listen_fd, nullptr, nullptr);
+    /* join the threads of the connections that are over */
+    for (auto it = conns.begin(); it != conns.end();) {
+      if ((*it)->done) {
+        (*it)->thread.join();
+        close((*it)->fd);
+        it = conns.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (fd == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      break;
+    }
+    conns.emplace_back(new srv_conn_t(fd));
+    srv_conn_t *conn = conns.back().get();
+    conn->thread = std::thread(srv_conn_thread, &srv, conn);
+  }
+
+  /* wake up the connections still waiting for a request */
+  for (const std::unique_ptr<srv_conn_t> &conn : conns) {
+    shutdown(conn->fd, SHUT_RDWR);
+  }
+  for (const std::unique_ptr<srv_conn_t> &conn : conns) {
+    conn->thread.join();
+    close(conn->fd);
+  }
+  close(srv.listen_fd);
+  unlink(socket_path);
+  printf("Served %lu requests\n", srv.n_requests.load());
+  return 0;
+}
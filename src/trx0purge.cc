@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "include/trx0purge.h"
+#include "include/trx0rec.h"
+#include "include/trx0undo.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/ut0pool.h"
+
+/** What one rollback segment holds, gathered by one walking thread. */
+struct purge_rseg_stats_t {
+  purge_rseg_stats_t()
+      : history_len(0), history_size(0), n_logs(0), oldest_trx_no(~0ULL),
+        oldest_trx_id(0), n_bytes(0), n_segs(), seg_pages() {}
+
+  /** length of TRX_RSEG_HISTORY, and TRX_RSEG_HISTORY_SIZE in pages */
+  ulint history_len;
+  ulint history_size;
+
+  uint64_t n_logs;
+  uint64_t oldest_trx_no;
+  uint64_t oldest_trx_id;
+  uint64_t n_bytes;
+
+  /** undo segments and their pages by TRX_UNDO_STATE, 0 for unknown */
+  uint64_t n_segs[TRX_UNDO_PREPARED + 1];
+  uint64_t seg_pages[TRX_UNDO_PREPARED + 1];
+
+  /** undo record bytes by table_id */
+  std::map<uint64_t, uint64_t> table_bytes;
+};
+
+/** @return TRX_UNDO_STATE, or 0 if it is out of range */
+static ulint purge_seg_state(ulint state) {
+  return state >= TRX_UNDO_ACTIVE && state <= TRX_UNDO_PREPARED ? state : 0;
+}
+
+/** Gathers the statistics of one rollback segment.
+@param[in]   fd         undo tablespace
+@param[in]   page_size  page size of the tablespace
+@param[in]   rseg_id    rollback segment slot
+@param[in]   rseg_page  page of the rollback segment header
+@param[in]   buf        page frame owned by the calling thread
+@param[out]  stats      statistics of the rollback segment */
+static void purge_scan_rseg(int fd, ulint page_size, uint32_t rseg_id,
+                            page_no_t rseg_page, byte *buf,
+                            purge_rseg_stats_t *stats) {
+  if (!trx_undo_read_page(fd, page_size, rseg_page, buf)) {
+    return;
+  }
+  const byte *rseg_header = buf + TRX_RSEG;
+  stats->history_len = flst_get_len(rseg_header + TRX_RSEG_HISTORY);
+  stats->history_size = mach_read_from_4(rseg_header + TRX_RSEG_HISTORY_SIZE);
+
+  /* segments still owned by the rollback segment: active, cached and
+  prepared ones; a segment leaves its slot when it is handed to purge */
+  std::vector<page_no_t> slots;
+  for (ulint i = 0; i < TRX_RSEG_N_SLOTS_OF(page_size); i++) {
+    page_no_t page_no = mach_read_from_4(rseg_header + TRX_RSEG_UNDO_SLOTS +
+                                         i * TRX_RSEG_SLOT_SIZE);
+    if (page_no != FIL_NULL && page_no != 0) {
+      slots.push_back(page_no);
+      trx_undo_prefetch(fd, page_size, page_no);
+    }
+  }
+  for (page_no_t page_no : slots) {
+    if (!trx_undo_read_page(fd, page_size, page_no, buf)) {
+      continue;
+    }
+    ulint state = purge_seg_state(
+        mach_read_from_2(buf + TRX_UNDO_SEG_HDR + TRX_UNDO_STATE));
+    stats->n_segs[state]++;
+    stats->seg_pages[state] +=
+        flst_get_len(buf + TRX_UNDO_SEG_HDR + TRX_UNDO_PAGE_LIST);
+  }
+
+  /* segments waiting for purge are reachable only through the history
+  list; a segment may hold several logs if it was cached before */
+  std::set<page_no_t> to_purge;
+  trx_undo_rec_info_t info;
+  trx_undo_walk_history(
+      fd, page_size, rseg_id, rseg_page,
+      [&](const trx_undo_log_t &log) {
+        stats->n_logs++;
+        if (log.trx_no < stats->oldest_trx_no) {
+          stats->oldest_trx_no = log.trx_no;
+          stats->oldest_trx_id = log.trx_id;
+        }
+        if (log.seg_state == TRX_UNDO_TO_PURGE &&
+            to_purge.insert(log.hdr_page_no).second) {
+          stats->n_segs[TRX_UNDO_TO_PURGE]++;
+          stats->seg_pages[TRX_UNDO_TO_PURGE] += log.seg_n_pages;
+        }
+      },
+      [&](const trx_undo_log_t &log, const byte *rec, ulint size) {
+        (void)log;
+        stats->n_bytes += size;
+        if (trx_undo_rec_get_pars(rec, size, &info) != nullptr) {
+          stats->table_bytes[info.table_id] += size;
+        }
+      });
+}
+
+/** @return pages as MiB */
+static double purge_pages_to_mb(uint64_t n_pages, ulint page_size) {
+  return (double)n_pages * page_size / (1024 * 1024);
+}
+
+void ShowPurgeLag(int fd, uint32_t n_threads) {
+  printf("==========================Purge Lag==========================\n");
+  const ulint page_size = fil_get_page_size(fd).logical();
+  std::vector<page_no_t> rsegs;
+  if (!trx_undo_read_rseg_array(fd, page_size, &rsegs)) {
+    fprintf(stderr, "Page %u is not a valid RSEG_ARRAY page\n",
+            FSP_RSEG_ARRAY_PAGE_NO);
+    return;
+  }
+
+  n_threads = fil_scan_n_threads(n_threads);
+  if (n_threads > TRX_SYS_N_RSEGS) {
+    n_threads = TRX_SYS_N_RSEGS;
+  }
+  std::vector<purge_rseg_stats_t> stats(TRX_SYS_N_RSEGS);
+  page_no_t n_file_pages = fil_get_n_pages(fd);
+  std::vector<byte *> bufs(n_threads);
+  for (uint32_t i = 0; i < n_threads; i++) {
+    if (posix_memalign((void **)&bufs[i], UNIV_PAGE_SIZE_MAX, page_size) !=
+        0) {
+      fprintf(stderr, "ShowPurgeLag out of memory\n");
+      return;
+    }
+  }
+
+  ut_parallel_for(TRX_SYS_N_RSEGS, n_threads,
+                  [&](uint32_t thread_no, size_t slot) {
+                    if (rsegs[slot] != FIL_NULL && rsegs[slot] != 0 &&
+                        rsegs[slot] < n_file_pages) {
+                      purge_scan_rseg(fd, page_size, slot, rsegs[slot],
+                                      bufs[thread_no], &stats[slot]);
+                    }
+                  });
+  for (byte *buf : bufs) {
+    free(buf);
+  }
+
+  /* merge in slot order so that the report does not depend on timing */
+  purge_rseg_stats_t total;
+  uint32_t oldest_rseg = 0;
+  uint32_t n_rsegs = 0;
+  for (uint32_t slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+    const purge_rseg_stats_t &s = stats[slot];
+    if (rsegs[slot] == FIL_NULL || rsegs[slot] == 0) {
+      continue;
+    }
+    n_rsegs++;
+    printf("Rseg %u (page %u): history length %u, history pages %u", slot,
+           rsegs[slot], s.history_len, s.history_size);
+    if (s.n_logs > 0) {
+      printf(", oldest trx_no %lu (trx_id %lu)", s.oldest_trx_no,
+             s.oldest_trx_id);
+    }
+    printf("\n");
+
+    total.history_len += s.history_len;
+    total.history_size += s.history_size;
+    total.n_logs += s.n_logs;
+    total.n_bytes += s.n_bytes;
+    if (s.n_logs > 0 && s.oldest_trx_no < total.oldest_trx_no) {
+      total.oldest_trx_no = s.oldest_trx_no;
+      total.oldest_trx_id = s.oldest_trx_id;
+      oldest_rseg = slot;
+    }
+    for (ulint i = 0; i <= TRX_UNDO_PREPARED; i++) {
+      total.n_segs[i] += s.n_segs[i];
+      total.seg_pages[i] += s.seg_pages[i];
+    }
+    for (const auto &t : s.table_bytes) {
+      total.table_bytes[t.first] += t.second;
+    }
+  }
+
+  printf("\n==========================Summary==========================\n");
+  printf("Rollback segments: %u, threads %u\n", n_rsegs, n_threads);
+  printf("History list length: %u, pages %u, undo logs walked %lu\n",
+         total.history_len, total.history_size, total.n_logs);
+  if (total.n_logs > 0) {
+    printf("Oldest trx_no in history: %lu (trx_id %lu, rseg %u)\n",
+           total.oldest_trx_no, total.oldest_trx_id, oldest_rseg);
+  }
+
+  static const char *state_names[TRX_UNDO_PREPARED + 1] = {
+      "unknown", "active", "cached", "to-free", "to-purge", "prepared"};
+  printf("Undo segments by state:\n");
+  uint64_t kept_pages = 0;
+  for (ulint i = 0; i <= TRX_UNDO_PREPARED; i++) {
+    if (total.n_segs[i] == 0) {
+      continue;
+    }
+    printf("  %-9s segments %lu, pages %lu (%.2lf MiB)\n", state_names[i],
+           total.n_segs[i], total.seg_pages[i],
+           purge_pages_to_mb(total.seg_pages[i], page_size));
+    if (i != TRX_UNDO_TO_PURGE && i != TRX_UNDO_TO_FREE) {
+      kept_pages += total.seg_pages[i];
+    }
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> tables(total.table_bytes.begin(),
+                                                    total.table_bytes.end());
+  std::sort(tables.begin(), tables.end(),
+            [](const std::pair<uint64_t, uint64_t> &a,
+               const std::pair<uint64_t, uint64_t> &b) {
+              return a.second > b.second;
+            });
+  printf("Undo record bytes by table_id:\n");
+  for (const auto &t : tables) {
+    printf("  table_id %lu: %lu bytes (%.2lf%%)\n", t.first, t.second,
+           total.n_bytes == 0 ? 0.0 : t.second * 100.0 / total.n_bytes);
+  }
+
+  /* purge frees whole to-purge segments; cached segments keep their
+  pages for reuse. Truncation could then shrink the file to the pages
+  still owned by segments plus the rollback segment headers and the
+  fixed pages in front of them. */
+  uint64_t reclaimable = total.seg_pages[TRX_UNDO_TO_PURGE];
+  uint64_t needed = kept_pages + n_rsegs + FSP_RSEG_ARRAY_PAGE_NO + 1;
+  printf("Reclaimable by purge: %lu pages (%.2lf MiB)\n", reclaimable,
+         purge_pages_to_mb(reclaimable, page_size));
+  printf("File pages: %u (%.2lf MiB), still needed after purge: %lu "
+         "(%.2lf MiB)\n",
+         n_file_pages, purge_pages_to_mb(n_file_pages, page_size), needed,
+         purge_pages_to_mb(needed, page_size));
+}
@@ -0,0 +1,170 @@
+#include "include/trx0rec.h"
+#include "include/mach_data.h"
+#include "include/rem0rec.h"
+
+/* The guards below only check that a compressed integer starts before
+the end of the record: its longest encoding may read up to 10 bytes past
+the last byte checked, which stays inside the 2-byte trailing link and the
+FIL page trailer of the page holding the record. */
+
+/** Reads one field value, following trx_undo_rec_get_col_val().
+@return pointer past the field, nullptr if it runs past end */
+static const byte *trx_undo_rec_get_col_val(const byte *ptr, const byte *end,
+                                            trx_undo_field_t *field) {
+  if (ptr >= end) {
+    return nullptr;
+  }
+  ulint len = mach_read_next_compressed(&ptr);
+
+  field->is_extern = false;
+  if (len == UNIV_SQL_NULL) {
+    field->data = nullptr;
+    field->len = UNIV_SQL_NULL;
+    return ptr;
+  }
+  if (len == UNIV_EXTERN_STORAGE_FIELD) {
+    /* the original length and a prefix of a spatial column */
+    if (ptr >= end) {
+      return nullptr;
+    }
+    mach_read_next_compressed(&ptr);
+    if (ptr >= end) {
+      return nullptr;
+    }
+    len = mach_read_next_compressed(&ptr);
+    field->is_extern = true;
+  } else if (len > UNIV_EXTERN_STORAGE_FIELD) {
+    len -= UNIV_EXTERN_STORAGE_FIELD;
+    field->is_extern = true;
+  }
+  if (ptr + len > end) {
+    return nullptr;
+  }
+  field->data = ptr;
+  field->len = len;
+  return ptr + len;
+}
+
+const byte *trx_undo_rec_get_pars(const byte *rec, ulint size,
+                                  trx_undo_rec_info_t *info) {
+  /* next record pointer, type_cmpl, and the trailing start pointer */
+  if (size < 2 + 1 + 2) {
+    return nullptr;
+  }
+  const byte *end = rec + size - 2;
+  const byte *ptr = rec + 2;
+
+  ulint type_cmpl = mach_read_from_1(ptr);
+  ptr++;
+  if (type_cmpl & TRX_UNDO_MODIFY_BLOB) {
+    /* skip the reserved flag byte */
+    ptr++;
+  }
+  info->updated_extern = (type_cmpl & TRX_UNDO_UPD_EXTERN) != 0;
+  type_cmpl &= ~(TRX_UNDO_UPD_EXTERN | TRX_UNDO_MODIFY_BLOB);
+  info->type = type_cmpl & (TRX_UNDO_CMPL_INFO_MULT - 1);
+  info->cmpl_info = type_cmpl / TRX_UNDO_CMPL_INFO_MULT;
+
+  if (ptr >= end) {
+    return nullptr;
+  }
+  info->undo_no = mach_read_next_much_compressed(&ptr);
+  if (ptr >= end) {
+    return nullptr;
+  }
+  info->table_id = mach_read_next_much_compressed(&ptr);
+  if (ptr > end) {
+    return nullptr;
+  }
+  return ptr;
+}
+
+bool trx_undo_rec_parse(const byte *rec, ulint size, ulint n_pk,
+                        trx_undo_rec_info_t *info) {
+  info->pk.clear();
+  info->update.clear();
+  info->info_bits = 0;
+  info->trx_id = 0;
+  info->roll_ptr = 0;
+  info->truncated = false;
+
+  const byte *ptr = trx_undo_rec_get_pars(rec, size, info);
+  if (ptr == nullptr) {
+    return false;
+  }
+  const byte *end = rec + size - 2;
+  bool is_modify = info->type != TRX_UNDO_INSERT_REC;
+
+  if (is_modify) {
+    if (ptr + 1 >= end) {
+      return false;
+    }
+    info->info_bits = mach_read_from_1(ptr);
+    ptr++;
+    info->trx_id = mach_u64_read_next_compressed(&ptr);
+    if (ptr >= end) {
+      return false;
+    }
+    info->roll_ptr = mach_u64_read_next_compressed(&ptr);
+    if (ptr > end) {
+      return false;
+    }
+  }
+
+  for (ulint i = 0; i < n_pk; i++) {
+    trx_undo_field_t field;
+    field.field_no = i;
+    ptr = trx_undo_rec_get_col_val(ptr, end, &field);
+    if (ptr == nullptr) {
+      return false;
+    }
+    info->pk.push_back(field);
+  }
+
+  if (!is_modify || info->type == TRX_UNDO_DEL_MARK_REC) {
+    return true;
+  }
+
+  if (ptr >= end) {
+    return false;
+  }
+  ulint n_fields = mach_read_next_compressed(&ptr);
+  for (ulint i = 0; i < n_fields; i++) {
+    trx_undo_field_t field;
+    if (ptr >= end) {
+      return false;
+    }
+    field.field_no = mach_read_next_compressed(&ptr);
+    if (field.field_no >= REC_MAX_N_FIELDS) {
+      /* a virtual column, followed by its index positions */
+      info->truncated = true;
+      return true;
+    }
+    ptr = trx_undo_rec_get_col_val(ptr, end, &field);
+    if (ptr == nullptr) {
+      return false;
+    }
+    info->update.push_back(field);
+    if (field.is_extern && (mach_read_from_1(rec + 2) & TRX_UNDO_MODIFY_BLOB)) {
+      /* followed by the partial LOB update vector */
+      info->truncated = true;
+      return true;
+    }
+  }
+  return true;
+}
+
+const char *trx_undo_rec_type_name(ulint type) {
+  switch (type) {
+    case TRX_UNDO_INSERT_REC:
+      return "INSERT";
+    case TRX_UNDO_UPD_EXIST_REC:
+      return "UPD_EXIST";
+    case TRX_UNDO_UPD_DEL_REC:
+      return "UPD_DEL";
+    case TRX_UNDO_DEL_MARK_REC:
+      return "DEL_MARK";
+    default:
+      return "UNKNOWN";
+  }
+}
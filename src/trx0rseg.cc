@@ -0,0 +1,311 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "include/trx0rseg.h"
+#include "include/buf0cache.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/trx0undo.h"
+#include "include/ut0json.h"
+#include "include/ut0pool.h"
+#include "include/ut0ut.h"
+
+/** Pages kept by the page cache shared by the report threads */
+static const size_t RSEG_CACHE_PAGES = 4096;
+
+/** An undo tablespace taking part in the report. */
+struct rseg_file_t {
+  std::string path;
+  int fd;
+  /** errno of a failed open() */
+  int open_errno;
+  off_t size;
+  ulint page_size;
+  uint32_t rseg_array[TRX_SYS_N_RSEGS];
+  /** report of the file header and the rollback segment array */
+  std::string header;
+  /** report of every rollback segment */
+  std::string rsegs[TRX_SYS_N_RSEGS];
+};
+
+/** Reads the rollback segment array of a file and formats it as a JSON
+line. */
+static void rseg_json_file_header(Buf_page_cache *cache, rseg_file_t *file) {
+  Json_line line("undo_file");
+  line.add("path", file->path);
+  if (file->fd == -1) {
+    line.add("error", strerror(file->open_errno));
+    line.append_to(&file->header);
+    return;
+  }
+  line.add("file_size", (uint64_t)file->size);
+  line.add("page_size", file->page_size);
+  line.add("n_pages", (uint64_t)(file->size / (off_t)file->page_size));
+
+  Buf_page_guard guard(cache, file->fd, file->page_size,
+                       FSP_RSEG_ARRAY_PAGE_NO);
+  const byte *buf = guard.page();
+  if (buf == nullptr) {
+    line.add("error", "rseg array read error");
+  } else if (mach_read_from_4(buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_VERSION_OFFSET) !=
+             RSEG_ARRAY_VERSION) {
+    line.add("error", "bad rseg array version, not an undo tablespace");
+  } else {
+    line.add("rseg_array_size", mach_read_from_4(buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_SIZE_OFFSET));
+    Json_writer &w = line.writer();
+    w.Key("rseg_pages");
+    w.StartArray();
+    const byte *rseg_array_buf = buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_PAGES_OFFSET;
+    for (ulint slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+      file->rseg_array[slot] = mach_read_from_4(rseg_array_buf + slot * RSEG_ARRAY_SLOT_SIZE);
+      w.Uint(file->rseg_array[slot]);
+    }
+    w.EndArray();
+  }
+  line.append_to(&file->header);
+}
+
+/** Reads the rollback segment array of a file and formats its header. */
+static void rseg_show_file_header(Buf_page_cache *cache, rseg_file_t *file) {
+  std::string *out = &file->header;
+  for (ulint slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+    file->rseg_array[slot] = FIL_NULL;
+  }
+  if (ut_format_is_json()) {
+    rseg_json_file_header(cache, file);
+    return;
+  }
+
+  ut_str_printf(out, "\n==========================Undo File %s==========================\n",
+              file->path.c_str());
+  if (file->fd == -1) {
+    ut_str_printf(out, "Open failed: %s\n", strerror(file->open_errno));
+    return;
+  }
+  ut_str_printf(out, "Undo File size %ld, blocks %ld\n", file->size,
+              file->size / (off_t)file->page_size);
+
+  Buf_page_guard guard(cache, file->fd, file->page_size,
+                       FSP_RSEG_ARRAY_PAGE_NO);
+  const byte *buf = guard.page();
+  if (buf == nullptr) {
+    ut_str_printf(out, "ShowRsegArray read error\n");
+    return;
+  }
+  fil_format_header(out, FSP_RSEG_ARRAY_PAGE_NO, buf);
+  ut_str_printf(out, "Rsegs Array:\n");
+  if (mach_read_from_4(buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_VERSION_OFFSET) !=
+      RSEG_ARRAY_VERSION) {
+    ut_str_printf(out, "Bad rseg array version, not an undo tablespace\n");
+    return;
+  }
+  ut_str_printf(out, "Rsegs dict size: %u\n", mach_read_from_4(buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_SIZE_OFFSET));
+
+  const byte *rseg_array_buf = buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_PAGES_OFFSET;
+  for (ulint slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+    page_no_t page_no = mach_read_from_4(rseg_array_buf + slot * RSEG_ARRAY_SLOT_SIZE);
+    ut_str_printf(out, "Rseg %u's page no: %u\n", slot, page_no);
+    file->rseg_array[slot] = page_no;
+  }
+}
+
+/** Formats one rollback segment as a JSON line; nothing for an empty
+slot. */
+static void rseg_json_rseg(Buf_page_cache *cache, rseg_file_t *file,
+                           uint32_t rseg_id) {
+  page_no_t page_no = file->rseg_array[rseg_id];
+  if (page_no == FIL_NULL) {
+    return;
+  }
+  Json_line line("rseg");
+  line.add("path", file->path);
+  line.add("rseg_id", rseg_id);
+  line.add("page_no", page_no);
+  Buf_page_guard guard(cache, file->fd, file->page_size, page_no);
+  const byte *buf = guard.page();
+  if (buf == nullptr) {
+    line.add("error", "rseg read error");
+    line.append_to(&file->rsegs[rseg_id]);
+    return;
+  }
+  const byte *rseg_header = TRX_RSEG + buf;
+  line.add("page_lsn", mach_read_from_8(buf + FIL_PAGE_LSN));
+  line.add("max_size", mach_read_from_4(rseg_header + TRX_RSEG_MAX_SIZE));
+  line.add("history_size", mach_read_from_4(rseg_header + TRX_RSEG_HISTORY_SIZE));
+  line.add("history_len", flst_get_len(rseg_header + TRX_RSEG_HISTORY));
+
+  fil_addr_t last_trx = flst_get_last(rseg_header + TRX_RSEG_HISTORY);
+  last_trx.boffset -= TRX_UNDO_HISTORY_NODE;
+  line.add("last_page_no", last_trx.page);
+  line.add("last_offset", last_trx.boffset);
+  if (last_trx.page == FIL_NULL) {
+    line.append_to(&file->rsegs[rseg_id]);
+    return;
+  }
+  Buf_page_guard log_guard(cache, file->fd, file->page_size, last_trx.page);
+  const byte *log_page = log_guard.page();
+  if (!page_range_is_valid(last_trx.boffset,
+                           TRX_UNDO_HISTORY_NODE + FLST_NODE_SIZE,
+                           file->page_size) ||
+      log_page == nullptr) {
+    line.add("error", "last undo log read error");
+    line.append_to(&file->rsegs[rseg_id]);
+    return;
+  }
+  const byte *undo_log_hdr = log_page + last_trx.boffset;
+  Json_writer &w = line.writer();
+  w.Key("last_undo_log");
+  w.StartObject();
+  line.add("page_lsn", mach_read_from_8(log_page + FIL_PAGE_LSN));
+  line.add("undo_page_type", mach_read_from_2(log_page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_TYPE));
+  line.add("undo_state", mach_read_from_2(log_page + TRX_UNDO_SEG_HDR + TRX_UNDO_STATE));
+  line.add("trx_id", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_ID));
+  line.add("trx_no", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_NO));
+  line.add("del_marks", mach_read_from_2(undo_log_hdr + TRX_UNDO_DEL_MARKS));
+  line.add("log_start", mach_read_from_2(undo_log_hdr + TRX_UNDO_LOG_START));
+  line.add("next_log", mach_read_from_2(undo_log_hdr + TRX_UNDO_NEXT_LOG));
+  line.add("prev_log", mach_read_from_2(undo_log_hdr + TRX_UNDO_PREV_LOG));
+  w.EndObject();
+  line.append_to(&file->rsegs[rseg_id]);
+}
+
+/** Formats one rollback segment, as ShowUndoRseg() did. */
+static void rseg_show_rseg(Buf_page_cache *cache, rseg_file_t *file,
+                           uint32_t rseg_id) {
+  if (ut_format_is_json()) {
+    rseg_json_rseg(cache, file, rseg_id);
+    return;
+  }
+  std::string *out = &file->rsegs[rseg_id];
+  page_no_t page_no = file->rseg_array[rseg_id];
+
+  ut_str_printf(out, "\n-------------------rseg %u's info-----------------------\n", rseg_id);
+  if (page_no == FIL_NULL) {
+    ut_str_printf(out, "ShowUndoRseg read error, page %u\n", page_no);
+    return;
+  }
+  Buf_page_guard guard(cache, file->fd, file->page_size, page_no);
+  const byte *buf = guard.page();
+  if (buf == nullptr) {
+    ut_str_printf(out, "ShowUndoRseg read error, page %u\n", page_no);
+    return;
+  }
+  fil_format_header(out, page_no, buf);
+  ut_str_printf(out, "==========================Rollback Segment==========================\n");
+
+  const byte *rseg_header = TRX_RSEG + buf;
+  ut_str_printf(out, "Rseg %u's max size: %u\n", rseg_id,
+              mach_read_from_4(rseg_header + TRX_RSEG_MAX_SIZE));
+  ut_str_printf(out, "Rseg %u's history list page size: %u\n", rseg_id,
+              mach_read_from_4(rseg_header + TRX_RSEG_HISTORY_SIZE));
+  ut_str_printf(out, "Rseg %u's history list size: %u\n", rseg_id,
+              flst_get_len(rseg_header + TRX_RSEG_HISTORY));
+
+  fil_addr_t last_trx = flst_get_last(rseg_header + TRX_RSEG_HISTORY);
+  last_trx.boffset -= TRX_UNDO_HISTORY_NODE;
+  ut_str_printf(out, "Rseg %u's last page no: %u\n", rseg_id, last_trx.page);
+  ut_str_printf(out, "Rseg %u's last offset: %u\n", rseg_id, last_trx.boffset);
+
+  if (last_trx.page == FIL_NULL) {
+    return;
+  }
+  /* an offset below the node wraps around and is out of the page too */
+  if (!page_range_is_valid(last_trx.boffset,
+                           TRX_UNDO_HISTORY_NODE + FLST_NODE_SIZE,
+                           file->page_size)) {
+    ut_str_printf(out, "ShowUndoLogHdr read error, page %u\n", last_trx.page);
+    return;
+  }
+  Buf_page_guard log_guard(cache, file->fd, file->page_size, last_trx.page);
+  const byte *log_page = log_guard.page();
+  if (log_page == nullptr) {
+    ut_str_printf(out, "ShowUndoLogHdr read error, page %u\n", last_trx.page);
+    return;
+  }
+  fil_format_header(out, last_trx.page, log_page);
+  trx_undo_format_page_header(out, log_page);
+
+  const byte *undo_log_hdr = log_page + last_trx.boffset;
+  ut_str_printf(out, "-------------------last undo log header---------------------\n");
+  ut_str_printf(out, "trx id: %lu\n", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_ID));
+  ut_str_printf(out, "trx no: %lu\n", mach_read_from_8(undo_log_hdr + TRX_UNDO_TRX_NO));
+  ut_str_printf(out, "del marks: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_DEL_MARKS));
+  ut_str_printf(out, "undo log start: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_LOG_START));
+  ut_str_printf(out, "next undo log header: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_NEXT_LOG));
+  ut_str_printf(out, "prev undo log header: %hu\n", mach_read_from_2(undo_log_hdr + TRX_UNDO_PREV_LOG));
+}
+
+void ShowUndoFile(const char *path, uint32_t n_threads) {
+  std::vector<std::string> paths;
+  fil_expand_paths(path, {"undo_[0-9]*", "*.ibu"}, &paths);
+  if (paths.empty()) {
+    fprintf(stderr, "No undo tablespace matches %s\n", path);
+    return;
+  }
+
+  std::vector<rseg_file_t> files(paths.size());
+  for (size_t i = 0; i < paths.size(); i++) {
+    struct stat stat_buf;
+    files[i].path = paths[i];
+    files[i].fd = open(paths[i].c_str(), O_RDONLY);
+    files[i].open_errno = errno;
+    files[i].size =
+        files[i].fd != -1 && fstat(files[i].fd, &stat_buf) == 0
+            ? stat_buf.st_size
+            : 0;
+    files[i].page_size = files[i].fd != -1
+                             ? fil_get_page_size(files[i].fd).logical()
+                             : UNIV_PAGE_SIZE;
+  }
+
+  n_threads = fil_scan_n_threads(n_threads);
+  /* frames hold the largest page of the files; pages are parsed where
+  they sit in the cache, pinned */
+  ulint frame_size = UNIV_PAGE_SIZE;
+  for (const rseg_file_t &file : files) {
+    frame_size = std::max(frame_size, file.page_size);
+  }
+  Buf_page_cache cache(RSEG_CACHE_PAGES * frame_size, frame_size);
+
+  /* the rollback segment arrays first, then every rseg of every file */
+  ut_parallel_for(files.size(), n_threads,
+                  [&](uint32_t, size_t task_no) {
+                    rseg_show_file_header(&cache, &files[task_no]);
+                  });
+  ut_parallel_for(files.size() * TRX_SYS_N_RSEGS, n_threads,
+                  [&](uint32_t, size_t task_no) {
+                    rseg_file_t &file = files[task_no / TRX_SYS_N_RSEGS];
+                    if (file.fd == -1) {
+                      return;
+                    }
+                    rseg_show_rseg(&cache, &file,
+                                   task_no % TRX_SYS_N_RSEGS);
+                  });
+
+  if (ut_format_is_json()) {
+    Json_line line("undo_files");
+    line.add("n_files", files.size());
+    line.add("n_threads", n_threads);
+  } else {
+    printf("Undo tablespaces: %lu, threads %u\n", files.size(), n_threads);
+  }
+  for (rseg_file_t &file : files) {
+    fwrite(file.header.data(), 1, file.header.size(), stdout);
+    for (ulint slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+      fwrite(file.rsegs[slot].data(), 1, file.rsegs[slot].size(), stdout);
+    }
+    if (file.fd != -1) {
+      close(file.fd);
+    }
+  }
+}
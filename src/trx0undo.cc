@@ -0,0 +1,408 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "include/trx0undo.h"
+#include "include/buf0cache.h"
+#include "include/trx0rec.h"
+#include "include/dict0dict.h"
+#include "include/fil0space.h"
+#include "include/fil0fil.h"
+#include "include/fil0scan.h"
+#include "include/fsp0types.h"
+#include "include/page0page.h"
+#include "include/fut0lst.h"
+#include "include/mach_data.h"
+#include "include/rem0rec.h"
+#include "include/ut0ut.h"
+
+/** Number of transactions listed in the per-transaction aggregates */
+static const size_t UNDO_TOP_TRX = 20;
+
+/** Field values are printed up to this many bytes */
+static const ulint UNDO_MAX_PRINT_LEN = 32;
+
+void trx_undo_prefetch(int fd, ulint page_size, page_no_t page_no) {
+  if (page_no == FIL_NULL) {
+    return;
+  }
+  posix_fadvise(fd, (off_t)page_no * page_size, page_size,
+                POSIX_FADV_WILLNEED);
+}
+
+bool trx_undo_read_page(int fd, ulint page_size, page_no_t page_no,
+                        byte *buf) {
+  return buf_read_page(fd, page_size, page_no, buf);
+}
+
+bool trx_undo_read_rseg_array(int fd, ulint page_size,
+                              std::vector<page_no_t> *rsegs) {
+  byte *buf = nullptr;
+  if (posix_memalign((void **)&buf, UNIV_PAGE_SIZE_MAX, page_size) != 0) {
+    return false;
+  }
+  rsegs->assign(TRX_SYS_N_RSEGS, FIL_NULL);
+  bool ok = trx_undo_read_page(fd, page_size, FSP_RSEG_ARRAY_PAGE_NO, buf) &&
+            mach_read_from_4(buf + RSEG_ARRAY_HEADER +
+                             RSEG_ARRAY_VERSION_OFFSET) == RSEG_ARRAY_VERSION;
+  if (ok) {
+    const byte *slots = buf + RSEG_ARRAY_HEADER + RSEG_ARRAY_PAGES_OFFSET;
+    for (ulint slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+      (*rsegs)[slot] = mach_read_from_4(slots + slot * RSEG_ARRAY_SLOT_SIZE);
+      trx_undo_prefetch(fd, page_size, (*rsegs)[slot]);
+    }
+  }
+  free(buf);
+  return ok;
+}
+
+/** Visits the records of one undo log, following trx_undo_get_next_rec().
+The records start on the header page, and only the last log on that page
+continues on the following pages of the undo segment.
+@param[in]      fd            undo tablespace
+@param[in]      page_size     page size of the tablespace
+@param[in]      n_file_pages  size of the tablespace in pages
+@param[in]      hdr_page      header page of the log
+@param[in,out]  log           log whose counters are updated
+@param[in]      buf           buffer for the following pages
+@param[in]      rec_func      called once per record, may be empty */
+static void trx_undo_walk_log(int fd, ulint page_size, page_no_t n_file_pages,
+                              const byte *hdr_page,
+                              trx_undo_log_t *log, byte *buf,
+                              const trx_undo_rec_func_t &rec_func) {
+  const byte *log_hdr = hdr_page + log->hdr_offset;
+  ulint next_log = mach_read_from_2(log_hdr + TRX_UNDO_NEXT_LOG);
+  ulint start = mach_read_from_2(log_hdr + TRX_UNDO_LOG_START);
+  const byte *page = hdr_page;
+
+  while (true) {
+    ulint end = next_log != 0 && page == hdr_page
+                    ? next_log
+                    : mach_read_from_2(page + TRX_UNDO_PAGE_HDR +
+                                       TRX_UNDO_PAGE_FREE);
+    page_no_t next_page =
+        next_log != 0
+            ? FIL_NULL
+            : flst_get_next_addr(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE)
+                  .page;
+    trx_undo_prefetch(fd, page_size, next_page);
+
+    log->n_pages++;
+    if (end > page_size - FIL_PAGE_DATA_END) {
+      break;
+    }
+    ulint rec = start;
+    while (rec < end) {
+      ulint next = mach_read_from_2(page + rec);
+      if (next <= rec || next > end) {
+        /* a broken link, the rest of this page is unreadable */
+        break;
+      }
+      log->n_recs++;
+      log->n_bytes += next - rec;
+      if (rec_func) {
+        rec_func(*log, page + rec, next - rec);
+      }
+      rec = next;
+    }
+
+    if (next_page == FIL_NULL || next_page >= n_file_pages ||
+        log->n_pages >= n_file_pages ||
+        !trx_undo_read_page(fd, page_size, next_page, buf)) {
+      break;
+    }
+    page = buf;
+    start = TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_HDR_SIZE;
+  }
+}
+
+uint64_t trx_undo_walk_history(int fd, ulint page_size, uint32_t rseg_id,
+                               page_no_t rseg_page,
+                               const trx_undo_log_func_t &log_func,
+                               const trx_undo_rec_func_t &rec_func) {
+  byte *bufs = nullptr;
+  if (posix_memalign((void **)&bufs, UNIV_PAGE_SIZE_MAX, 2 * page_size) !=
+      0) {
+    return 0;
+  }
+  byte *hdr_page = bufs;
+  byte *page_buf = bufs + page_size;
+  page_no_t n_file_pages = fil_get_n_pages(fd);
+  uint64_t n_logs = 0;
+
+  if (rseg_page < n_file_pages &&
+      trx_undo_read_page(fd, page_size, rseg_page, hdr_page)) {
+    const byte *history = hdr_page + TRX_RSEG + TRX_RSEG_HISTORY;
+    ulint len = flst_get_len(history);
+    fil_addr_t addr = flst_get_first(history);
+
+    /* the list length bounds the walk in case the links form a cycle */
+    while (addr.page != FIL_NULL && n_logs < len) {
+      if (addr.page >= n_file_pages ||
+          addr.boffset < TRX_UNDO_HISTORY_NODE ||
+          addr.boffset + FLST_NODE_SIZE > page_size - FIL_PAGE_DATA_END ||
+          !trx_undo_read_page(fd, page_size, addr.page, hdr_page)) {
+        break;
+      }
+      fil_addr_t next = flst_get_next_addr(hdr_page + addr.boffset);
+      trx_undo_prefetch(fd, page_size, next.page);
+
+      trx_undo_log_t log;
+      log.rseg_id = rseg_id;
+      log.hdr_page_no = addr.page;
+      log.hdr_offset = addr.boffset - TRX_UNDO_HISTORY_NODE;
+      const byte *log_hdr = hdr_page + log.hdr_offset;
+      log.trx_id = mach_read_from_8(log_hdr + TRX_UNDO_TRX_ID);
+      log.trx_no = mach_read_from_8(log_hdr + TRX_UNDO_TRX_NO);
+      log.del_marks = mach_read_from_2(log_hdr + TRX_UNDO_DEL_MARKS) != 0;
+      log.seg_state =
+          mach_read_from_2(hdr_page + TRX_UNDO_SEG_HDR + TRX_UNDO_STATE);
+      log.seg_n_pages =
+          flst_get_len(hdr_page + TRX_UNDO_SEG_HDR + TRX_UNDO_PAGE_LIST);
+      log.n_pages = 0;
+      log.n_recs = 0;
+      log.n_bytes = 0;
+
+      trx_undo_walk_log(fd, page_size, n_file_pages, hdr_page, &log, page_buf,
+                        rec_func);
+      if (log_func) {
+        log_func(log);
+      }
+      n_logs++;
+      addr = next;
+    }
+  }
+  free(bufs);
+  return n_logs;
+}
+
+/** Per-table aggregates of the history */
+struct undo_table_stats_t {
+  uint64_t n_recs;
+  uint64_t n_bytes;
+  uint64_t n_by_type[TRX_UNDO_DEL_MARK_REC + 1];
+};
+
+/** Per-transaction aggregates of the history */
+struct undo_trx_stats_t {
+  uint64_t trx_id;
+  uint64_t trx_no;
+  uint64_t n_logs;
+  uint64_t n_pages;
+  uint64_t n_recs;
+  uint64_t n_bytes;
+};
+
+/** Formats a field of an undo record, decoding it when its column is
+known. */
+static void undo_field_to_string(const dict_table_t *table,
+                                 const dict_index_t *index,
+                                 const trx_undo_field_t &field,
+                                 std::string *out) {
+  if (field.len == UNIV_SQL_NULL) {
+    out->assign("NULL");
+    return;
+  }
+  ulint len = field.len;
+  if (len > UNDO_MAX_PRINT_LEN && (index == nullptr || field.is_extern)) {
+    len = UNDO_MAX_PRINT_LEN;
+  }
+  if (index != nullptr && field.field_no < index->fields.size() &&
+      !field.is_extern) {
+    const dict_col_t &col = table->cols[index->fields[field.field_no].col_no];
+    rec_field_to_string(col, field.data, len, out);
+  } else {
+    static const char hex[] = "0123456789ABCDEF";
+    out->assign("0x");
+    for (ulint i = 0; i < len; i++) {
+      out->push_back(hex[field.data[i] >> 4]);
+      out->push_back(hex[field.data[i] & 15]);
+    }
+  }
+  if (len < field.len) {
+    out->append("...");
+  }
+  if (field.is_extern) {
+    out->append(" (extern)");
+  }
+}
+
+/** @return name of the column a field of the clustered index belongs to */
+static std::string undo_field_name(const dict_table_t *table,
+                                   const dict_index_t *index, ulint field_no) {
+  if (index != nullptr && field_no < index->fields.size()) {
+    return table->cols[index->fields[field_no].col_no].name;
+  }
+  return "field " + std::to_string(field_no);
+}
+
+/** Prints one decoded undo record. */
+static void undo_print_rec(const trx_undo_rec_info_t &info,
+                           const dict_table_t *table,
+                           const dict_index_t *index, ulint size) {
+  std::string value;
+  printf("  undo_no %lu %s table_id %lu size %u", info.undo_no,
+         trx_undo_rec_type_name(info.type), info.table_id, size);
+  if (info.type != TRX_UNDO_INSERT_REC) {
+    printf(" cmpl_info %u info_bits 0x%x trx_id %lu roll_ptr 0x%014lx",
+           info.cmpl_info, info.info_bits, info.trx_id, info.roll_ptr);
+  }
+  if (info.updated_extern) {
+    printf(" updated_extern");
+  }
+
+  printf("\n    pk (");
+  for (size_t i = 0; i < info.pk.size(); i++) {
+    undo_field_to_string(table, index, info.pk[i], &value);
+    printf("%s%s", i == 0 ? "" : ", ", value.c_str());
+  }
+  printf(")\n");
+
+  if (info.type == TRX_UNDO_UPD_EXIST_REC ||
+      info.type == TRX_UNDO_UPD_DEL_REC) {
+    printf("    update {");
+    for (size_t i = 0; i < info.update.size(); i++) {
+      undo_field_to_string(table, index, info.update[i], &value);
+      printf("%s%s: %s", i == 0 ? "" : ", ",
+             undo_field_name(table, index, info.update[i].field_no).c_str(),
+             value.c_str());
+    }
+    printf("%s}\n", info.truncated ? " ..." : "");
+  }
+}
+
+void ShowUndoHistory(int fd, const char *sdi_path) {
+  printf("==========================Undo History==========================\n");
+  const ulint page_size = fil_get_page_size(fd).logical();
+  std::vector<page_no_t> rsegs;
+  if (!trx_undo_read_rseg_array(fd, page_size, &rsegs)) {
+    fprintf(stderr, "Page %u is not a valid RSEG_ARRAY page\n",
+            FSP_RSEG_ARRAY_PAGE_NO);
+    return;
+  }
+
+  /* decoding the primary key needs the number of its fields, which the
+  undo record does not store; without a table definition a single field
+  (an explicit one-column key or DB_ROW_ID) is assumed */
+  dict_table_t table;
+  const dict_index_t *index = nullptr;
+  if (sdi_path != nullptr && sdi_path[0] != '\0' &&
+      dict_load_from_sdi(sdi_path, &table) == 0) {
+    index = table.clustered_index();
+  }
+
+  std::map<uint64_t, undo_table_stats_t> tables;
+  std::map<uint64_t, undo_trx_stats_t> trxs;
+  trx_undo_rec_info_t info;
+  uint64_t n_logs = 0;
+  uint64_t n_bad = 0;
+
+  auto rec_func = [&](const trx_undo_log_t &log, const byte *rec, ulint size) {
+    if (log.n_recs == 1) {
+      printf("undo log [page %u, offset %u] trx id %lu trx no %lu del marks "
+             "%d\n",
+             log.hdr_page_no, log.hdr_offset, log.trx_id, log.trx_no,
+             log.del_marks);
+    }
+    bool is_known = index != nullptr &&
+                    trx_undo_rec_get_pars(rec, size, &info) != nullptr &&
+                    info.table_id == table.id;
+    if (!trx_undo_rec_parse(rec, size, is_known ? index->n_uniq : 1, &info)) {
+      n_bad++;
+      printf("  corrupted record %lu of undo log [page %u, offset %u]\n",
+           log.n_recs, log.hdr_page_no, log.hdr_offset);
+      return;
+    }
+    undo_print_rec(info, is_known ? &table : nullptr,
+                   is_known ? index : nullptr, size);
+
+    undo_table_stats_t &t = tables[info.table_id];
+    t.n_recs++;
+    t.n_bytes += size;
+    if (info.type <= TRX_UNDO_DEL_MARK_REC) {
+      t.n_by_type[info.type]++;
+    }
+  };
+
+  auto log_func = [&](const trx_undo_log_t &log) {
+    printf("undo log [page %u, offset %u] trx id %lu: %u pages, %lu records, "
+           "%lu bytes\n",
+           log.hdr_page_no, log.hdr_offset, log.trx_id, log.n_pages,
+           log.n_recs, log.n_bytes);
+    undo_trx_stats_t &t = trxs[log.trx_id];
+    t.trx_id = log.trx_id;
+    t.trx_no = log.trx_no;
+    t.n_logs++;
+    t.n_pages += log.n_pages;
+    t.n_recs += log.n_recs;
+    t.n_bytes += log.n_bytes;
+    n_logs++;
+  };
+
+  for (uint32_t slot = 0; slot < TRX_SYS_N_RSEGS; slot++) {
+    if (rsegs[slot] == FIL_NULL || rsegs[slot] == 0) {
+      continue;
+    }
+    printf("\n-------------------rseg %u's history (page %u)-----------------------\n",
+           slot, rsegs[slot]);
+    uint64_t n = trx_undo_walk_history(fd, page_size, slot, rsegs[slot],
+                                       log_func, rec_func);
+    printf("Rseg %u's history list undo logs visited: %lu\n", slot, n);
+  }
+
+  printf("\n==========================Per-table Aggregates==========================\n");
+  printf("Undo logs: %lu, corrupted records: %lu\n", n_logs, n_bad);
+  for (const auto &t : tables) {
+    const undo_table_stats_t &s = t.second;
+    printf("table_id %lu%s%s: records %lu, bytes %lu, insert %lu, update %lu, "
+           "update-deleted %lu, delete-mark %lu\n",
+           t.first, index != nullptr && t.first == table.id ? " " : "",
+           index != nullptr && t.first == table.id ? table.name.c_str() : "",
+           s.n_recs, s.n_bytes, s.n_by_type[TRX_UNDO_INSERT_REC],
+           s.n_by_type[TRX_UNDO_UPD_EXIST_REC],
+           s.n_by_type[TRX_UNDO_UPD_DEL_REC],
+           s.n_by_type[TRX_UNDO_DEL_MARK_REC]);
+  }
+
+  std::vector<undo_trx_stats_t> top;
+  for (const auto &t : trxs) {
+    top.push_back(t.second);
+  }
+  std::sort(top.begin(), top.end(),
+            [](const undo_trx_stats_t &a, const undo_trx_stats_t &b) {
+              return a.n_bytes > b.n_bytes;
+            });
+  if (top.size() > UNDO_TOP_TRX) {
+    top.resize(UNDO_TOP_TRX);
+  }
+  printf("\n==========================Per-trx Aggregates==========================\n");
+  printf("Transactions: %lu, largest %lu by undo bytes:\n", trxs.size(),
+         top.size());
+  for (const undo_trx_stats_t &t : top) {
+    printf("trx_id %lu trx_no %lu: logs %lu, pages %lu, records %lu, bytes "
+           "%lu\n",
+           t.trx_id, t.trx_no, t.n_logs, t.n_pages, t.n_recs, t.n_bytes);
+  }
+}
+
+void trx_undo_format_page_header(std::string *out, const byte *page) {
+  ut_str_printf(out, "Undo Page Header:\n");
+  ut_str_printf(out, "## Page Type enum:[1:insert; 2:update]\n");
+  ut_str_printf(out, "Undo page type: %u\n", mach_read_from_2(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_TYPE));
+  ut_str_printf(out, "Latest undo log rec offset on this undo page: %u\n", mach_read_from_2(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_START));
+  ut_str_printf(out, "First free byte offset on this undo page: %u\n", mach_read_from_2(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_FREE));
+
+  fil_addr_t prev_undo_page_node = flst_get_prev_addr(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE);
+  fil_addr_t next_undo_page_node = flst_get_next_addr(page + TRX_UNDO_PAGE_HDR + TRX_UNDO_PAGE_NODE);
+  ut_str_printf(out, "Prev undo page node[%u, %u]\n", prev_undo_page_node.boffset, prev_undo_page_node.page);
+  ut_str_printf(out, "Next undo page node[%u, %u]\n\n", next_undo_page_node.boffset, next_undo_page_node.page);
+
+  ut_str_printf(out, "## Undo state enum:[1:active; 2:cached; 3:free; 4:to purge; 5:preapred]\n");
+  ut_str_printf(out, "Undo state on this undo page: %u\n", mach_read_from_2(page + TRX_UNDO_SEG_HDR + TRX_UNDO_STATE));
+  ut_str_printf(out, "Offset of last undo log header on this undo page: %u\n", mach_read_from_2(page + TRX_UNDO_SEG_HDR + TRX_UNDO_LAST_LOG));
+}
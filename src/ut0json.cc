@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "include/ut0json.h"
+#include "include/dict0dict.h"
+#include "include/rem0rec.h"
+#include "include/srv0mon.h"
+#include "include/ut0mem.h"
+
+ut_format_t ut_format = UT_FORMAT_TEXT;
+
+bool ut_format_parse(const char *name, ut_format_t *format) {
+  if (strcmp(name, "text") == 0) {
+    *format = UT_FORMAT_TEXT;
+  } else if (strcmp(name, "json") == 0) {
+    *format = UT_FORMAT_JSON;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/** The buffer and writer of a thread, reused by each of its lines */
+struct ut_json_thread_t {
+  ut_json_thread_t() : writer(buf) {}
+
+  rapidjson::StringBuffer buf;
+  Json_writer writer;
+};
+
+static thread_local ut_json_thread_t ut_json_thread;
+
+/** Writes the buffer to stdout and empties it */
+static void ut_json_flush(rapidjson::StringBuffer &buf) {
+  Monitor_timer timer(MONITOR_OUTPUT);
+  timer.add_bytes(buf.GetSize());
+  fwrite(buf.GetString(), 1, buf.GetSize(), stdout);
+  buf.Clear();
+}
+
+Json_line::Json_line(const char *kind)
+    : m_buf(ut_json_thread.buf), m_writer(ut_json_thread.writer),
+      m_done(false) {
+  m_buf.Clear();
+  m_writer.Reset(m_buf);
+  m_writer.StartObject();
+  add("kind", kind);
+}
+
+Json_line::~Json_line() {
+  if (m_done) {
+    return;
+  }
+  m_writer.EndObject();
+  m_buf.Put('\n');
+  ut_json_flush(m_buf);
+}
+
+void Json_line::add(const char *key, int value) {
+  m_writer.Key(key);
+  m_writer.Int(value);
+}
+
+void Json_line::add(const char *key, uint32_t value) {
+  m_writer.Key(key);
+  m_writer.Uint(value);
+}
+
+void Json_line::add(const char *key, int64_t value) {
+  m_writer.Key(key);
+  m_writer.Int64(value);
+}
+
+void Json_line::add(const char *key, uint64_t value) {
+  m_writer.Key(key);
+  m_writer.Uint64(value);
+}
+
+void Json_line::add(const char *key, double value) {
+  m_writer.Key(key);
+  m_writer.Double(value);
+}
+
+void Json_line::add(const char *key, bool value) {
+  m_writer.Key(key);
+  m_writer.Bool(value);
+}
+
+void Json_line::add(const char *key, const char *value) {
+  m_writer.Key(key);
+  ut_json_string(m_writer, value, strlen(value));
+}
+
+void Json_line::add(const char *key, const std::string &value) {
+  m_writer.Key(key);
+  ut_json_string(m_writer, value.data(), value.size());
+}
+
+void Json_line::add_null(const char *key) {
+  m_writer.Key(key);
+  m_writer.Null();
+}
+
+void Json_line::append_to(std::string *out) {
+  m_writer.EndObject();
+  out->append(m_buf.GetString(), m_buf.GetSize());
+  out->push_back('\n');
+  m_buf.Clear();
+  m_done = true;
+}
+
+void Json_line::string_begin(const char *key) {
+  m_writer.Key(key);
+  /* an empty raw value puts the ':' and counts the value, whose bytes
+  are then written around the writer */
+  m_writer.RawValue("", 0, rapidjson::kStringType);
+  m_buf.Put('"');
+  ut_json_flush(m_buf);
+}
+
+void Json_line::string_append(const byte *data, ulint len) {
+  static const char hex[] = "0123456789abcdef";
+  for (ulint i = 0; i < len; i++) {
+    byte c = data[i];
+    if (c == '"' || c == '\\') {
+      m_buf.Put('\\');
+      m_buf.Put(c);
+    } else if (c < 0x20) {
+      char *p = m_buf.Push(6);
+      memcpy(p, "\\u00", 4);
+      p[4] = hex[c >> 4];
+      p[5] = hex[c & 15];
+    } else if (c < 0x80) {
+      m_buf.Put(c);
+    } else {
+      m_buf.Put(0xC0 | (c >> 6));
+      m_buf.Put(0x80 | (c & 0x3F));
+    }
+  }
+  ut_json_flush(m_buf);
+}
+
+void Json_line::string_end() { m_buf.Put('"'); }
+
+/** @return true if the bytes are well-formed UTF-8 */
+UT_TARGET_CLONES
+static bool ut_json_is_utf8(const byte *p, size_t len) {
+  size_t i = 0;
+  /* most text is ASCII: a block without a high bit is skipped whole, one
+  with is checked a byte at a time up to block_end */
+  size_t block_end = 0;
+  while (i < len) {
+    if (i >= block_end && len - i >= UT_SCAN_BLOCK) {
+      byte bits = 0;
+      for (size_t k = 0; k < UT_SCAN_BLOCK; k++) {
+        bits |= p[i + k];
+      }
+      if (bits < 0x80) {
+        i += UT_SCAN_BLOCK;
+        continue;
+      }
+      block_end = i + UT_SCAN_BLOCK;
+    }
+    byte c = p[i];
+    if (c < 0x80) {
+      i++;
+      continue;
+    }
+    size_t n;
+    uint32_t cp;
+    if ((c & 0xE0) == 0xC0) {
+      n = 1;
+      cp = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+      n = 2;
+      cp = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+      n = 3;
+      cp = c & 0x07;
+    } else {
+      return false;
+    }
+    if (len - i <= n) {
+      return false;
+    }
+    for (size_t k = 1; k <= n; k++) {
+      if ((p[i + k] & 0xC0) != 0x80) {
+        return false;
+      }
+      cp = (cp << 6) | (p[i + k] & 0x3F);
+    }
+    /* overlong forms, surrogates and code points past Unicode */
+    if ((n == 1 && cp < 0x80) || (n == 2 && cp < 0x800) ||
+        (n == 3 && cp < 0x10000) || cp > 0x10FFFF ||
+        (cp >= 0xD800 && cp <= 0xDFFF)) {
+      return false;
+    }
+    i += n + 1;
+  }
+  return true;
+}
+
+void ut_json_string(Json_writer &writer, const char *data, size_t len) {
+  const byte *p = reinterpret_cast<const byte *>(data);
+  if (ut_json_is_utf8(p, len)) {
+    writer.String(data, len);
+    return;
+  }
+  static thread_local std::string latin1;
+  latin1.clear();
+  for (size_t i = 0; i < len; i++) {
+    if (p[i] < 0x80) {
+      latin1.push_back(p[i]);
+    } else {
+      latin1.push_back(0xC0 | (p[i] >> 6));
+      latin1.push_back(0x80 | (p[i] & 0x3F));
+    }
+  }
+  writer.String(latin1.data(), latin1.size());
+}
+
+void ut_json_rec_fields(Json_line &line, const dict_table_t &table,
+                        const dict_index_t &index, const rec_t *rec,
+                        const std::vector<ulint> &offsets) {
+  Json_writer &w = line.writer();
+  std::string value;
+  w.Key("fields");
+  w.StartObject();
+  for (ulint i = 0; i < index.fields.size(); i++) {
+    const dict_col_t &col = table.cols[index.fields[i].col_no];
+    if (col.hidden == DD_HIDDEN_SE) {
+      continue;
+    }
+    ulint len;
+    const byte *data = rec_get_nth_field(rec, offsets, i, &len);
+    if (len == UNIV_SQL_NULL) {
+      line.add_null(col.name.c_str());
+    } else if (rec_offs_nth_extern(offsets, i)) {
+      line.add(col.name.c_str(), "<off-page>");
+    } else if (dict_col_is_integer(col) && col.type != DD_TYPE_YEAR) {
+      int64_t v = rec_field_to_int(col, data, len);
+      if (col.is_unsigned) {
+        line.add(col.name.c_str(), (uint64_t)v);
+      } else {
+        line.add(col.name.c_str(), v);
+      }
+    } else {
+      rec_field_to_string(col, data, len, &value);
+      line.add(col.name.c_str(), value);
+    }
+  }
+  w.EndObject();
+}
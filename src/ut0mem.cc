@@ -0,0 +1,21 @@
+#include "include/ut0mem.h"
+
+UT_TARGET_CLONES
+bool ut_is_zeroes(const byte *ptr, ulint len) {
+  /* no early exit inside a block, so that its loop is vectorized */
+  for (; len >= UT_SCAN_BLOCK; ptr += UT_SCAN_BLOCK, len -= UT_SCAN_BLOCK) {
+    byte bits = 0;
+    for (ulint i = 0; i < UT_SCAN_BLOCK; i++) {
+      bits |= ptr[i];
+    }
+    if (bits != 0) {
+      return false;
+    }
+  }
+  for (ulint i = 0; i < len; i++) {
+    if (ptr[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
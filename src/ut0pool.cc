@@ -0,0 +1,33 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "include/ut0pool.h"
+
+void ut_parallel_for(size_t n_tasks, uint32_t n_threads,
+                     const ut_task_func_t &func) {
+  std::atomic<size_t> next_task(0);
+
+  auto worker = [&](uint32_t thread_no) {
+    size_t task_no;
+    while ((task_no = next_task.fetch_add(1)) < n_tasks) {
+      func(thread_no, task_no);
+    }
+  };
+
+  if (n_threads > n_tasks) {
+    n_threads = n_tasks;
+  }
+  if (n_threads <= 1) {
+    worker(0);
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    threads.emplace_back(worker, i);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+}
@@ -0,0 +1,152 @@
+#include <math.h>
+#include <string.h>
+
+#include "include/ut0sketch.h"
+
+uint64_t ut_hash_bytes(const void *data, size_t len, uint64_t seed) {
+  const uint64_t m = 0xc6a4a7935bd1e995ULL;
+  const int r = 47;
+  const byte *p = static_cast<const byte *>(data);
+  uint64_t h = seed ^ (len * m);
+
+  while (len >= 8) {
+    uint64_t k;
+    memcpy(&k, p, 8);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+    p += 8;
+    len -= 8;
+  }
+  switch (len) {
+    case 7: h ^= uint64_t(p[6]) << 48; /* fall through */
+    case 6: h ^= uint64_t(p[5]) << 40; /* fall through */
+    case 5: h ^= uint64_t(p[4]) << 32; /* fall through */
+    case 4: h ^= uint64_t(p[3]) << 24; /* fall through */
+    case 3: h ^= uint64_t(p[2]) << 16; /* fall through */
+    case 2: h ^= uint64_t(p[1]) << 8; /* fall through */
+    case 1: h ^= uint64_t(p[0]);
+            h *= m;
+  }
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+void Hll_sketch::merge(const Hll_sketch &other) {
+  for (uint32_t i = 0; i < HLL_REGISTERS; i++) {
+    if (other.m_registers[i] > m_registers[i]) {
+      m_registers[i] = other.m_registers[i];
+    }
+  }
+}
+
+uint64_t Hll_sketch::estimate() const {
+  const double m = HLL_REGISTERS;
+  const double alpha = 0.7213 / (1.0 + 1.079 / m);
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < HLL_REGISTERS; i++) {
+    sum += ldexp(1.0, -m_registers[i]);
+    if (m_registers[i] == 0) {
+      zeros++;
+    }
+  }
+  double est = alpha * m * m / sum;
+  if (est <= 2.5 * m && zeros != 0) {
+    /* small range correction: linear counting */
+    est = m * log(m / zeros);
+  }
+  return (uint64_t)(est + 0.5);
+}
+
+uint64_t Top_k_sketch::estimate(uint64_t hash) const {
+  uint64_t est = UINT64_MAX;
+  for (uint32_t d = 0; d < CM_DEPTH; d++) {
+    uint32_t col = (uint32_t)(hash >> (d * 16)) % CM_WIDTH;
+    if (m_counts[d * CM_WIDTH + col] < est) {
+      est = m_counts[d * CM_WIDTH + col];
+    }
+  }
+  return est;
+}
+
+void Top_k_sketch::update(const std::string &value, uint64_t hash) {
+  for (uint32_t d = 0; d < CM_DEPTH; d++) {
+    uint32_t col = (uint32_t)(hash >> (d * 16)) % CM_WIDTH;
+    m_counts[d * CM_WIDTH + col]++;
+  }
+  uint64_t est = estimate(hash);
+
+  auto it = m_candidates.find(value);
+  if (it != m_candidates.end()) {
+    it->second.second = est;
+    return;
+  }
+  if (m_candidates.size() < capacity() || est > m_min_candidate) {
+    m_candidates[value] = std::make_pair(hash, est);
+    /* the set is let grow to twice its capacity before it is cut back,
+    so that a prune is paid for by capacity() insertions instead of
+    running on every value of a skewed column */
+    if (m_candidates.size() >= 2 * capacity()) {
+      prune();
+    }
+  }
+}
+
+void Top_k_sketch::prune() {
+  std::vector<std::pair<uint64_t, std::string>> order;
+  order.reserve(m_candidates.size());
+  for (const auto &c : m_candidates) {
+    order.push_back(std::make_pair(c.second.second, c.first));
+  }
+  if (order.empty()) {
+    m_min_candidate = 0;
+    return;
+  }
+  /* only the split at capacity() matters, not the order on either side */
+  const size_t n_kept = std::min(order.size(), capacity());
+  std::nth_element(order.begin(), order.begin() + (n_kept - 1), order.end(),
+                   [](const std::pair<uint64_t, std::string> &a,
+                      const std::pair<uint64_t, std::string> &b) {
+                     return a.first > b.first;
+                   });
+  for (size_t i = n_kept; i < order.size(); i++) {
+    m_candidates.erase(order[i].second);
+  }
+  m_min_candidate = order[n_kept - 1].first;
+}
+
+void Top_k_sketch::merge(const Top_k_sketch &other) {
+  for (size_t i = 0; i < m_counts.size(); i++) {
+    m_counts[i] += other.m_counts[i];
+  }
+  for (const auto &c : other.m_candidates) {
+    m_candidates[c.first] = c.second;
+  }
+  /* every candidate is re-estimated from the merged counters */
+  for (auto &c : m_candidates) {
+    c.second.second = estimate(c.second.first);
+  }
+  prune();
+}
+
+std::vector<std::pair<std::string, uint64_t>> Top_k_sketch::top() const {
+  std::vector<std::pair<std::string, uint64_t>> result;
+  for (const auto &c : m_candidates) {
+    result.push_back(std::make_pair(c.first, c.second.second));
+  }
+  std::sort(result.begin(), result.end(),
+            [](const std::pair<std::string, uint64_t> &a,
+               const std::pair<std::string, uint64_t> &b) {
+              return a.second > b.second ||
+                     (a.second == b.second && a.first < b.first);
+            });
+  if (result.size() > m_k) {
+    result.resize(m_k);
+  }
+  return result;
+}
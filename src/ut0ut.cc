@@ -0,0 +1,26 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "include/ut0ut.h"
+
+void ut_str_printf(std::string *out, const char *fmt, ...) {
+  char buf[1024];
+  va_list ap;
+  va_start(ap, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (len < 0) {
+    return;
+  }
+  if ((size_t)len < sizeof(buf)) {
+    out->append(buf, len);
+    return;
+  }
+  std::vector<char> big(len + 1);
+  va_start(ap, fmt);
+  vsnprintf(big.data(), big.size(), fmt, ap);
+  va_end(ap);
+  out->append(big.data(), len);
+}
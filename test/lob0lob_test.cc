@@ -0,0 +1,387 @@
+/* Reassembles 8.0 LOBs from tablespaces of every page size.
+
+For each innodb_page_size a small tablespace is written: page 0 with the
+FSP_SPACE_FLAGS of that size, a clustered index leaf page holding one
+row (id INT, a LONGBLOB stored off-page) and the LOB itself, a
+FIL_PAGE_TYPE_LOB_FIRST page whose index entries point at its own data
+and at FIL_PAGE_TYPE_LOB_DATA pages. The value is read back with
+lob_read() and with DumpLobs() --lob-dir, and must come out byte for
+byte. The column is named so that a file named after it would leave the
+directory. Exits non-zero if anything differs. */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+
+#include "include/udef.h"
+#include "include/fil0fil.h"
+#include "include/fil0scan.h"
+#include "include/fsp0fsp.h"
+#include "include/fsp0types.h"
+#include "include/fut0lst.h"
+#include "include/lob0lob.h"
+#include "include/page0page.h"
+#include "include/page0types.h"
+#include "include/rem0types.h"
+#include "include/rec.h"
+#include "include/rem0rec.h"
+
+/** Pages of the test tablespace */
+enum lob_test_page_t {
+  LOB_TEST_FSP_HDR,
+  LOB_TEST_LEAF,
+  LOB_TEST_FIRST,
+  /** the data pages follow */
+  LOB_TEST_DATA
+};
+
+static const space_id_t LOB_TEST_SPACE_ID = 200;
+static const uint64_t LOB_TEST_INDEX_ID = 2000;
+/** LOB version the entries and the reference carry */
+static const uint32_t LOB_TEST_VERSION = 1;
+/** Name of the LOB column, unsafe as a file name */
+static const char *LOB_TEST_COLUMN = "b/../../escape";
+
+/** Layout of an index entry, as in lob0lob.cc */
+static const ulint LOB_TEST_ENTRY_NEXT = 6;
+static const ulint LOB_TEST_ENTRY_VERSIONS = 12;
+static const ulint LOB_TEST_ENTRY_PAGE_NO = 48;
+static const ulint LOB_TEST_ENTRY_DATA_LEN = 52;
+static const ulint LOB_TEST_ENTRY_LOB_VERSION = 56;
+static const ulint LOB_TEST_ENTRY_SIZE = 60;
+
+static int lob_test_failures = 0;
+
+static void lob_test_check(bool ok, ulint page_size, const char *what) {
+  if (!ok) {
+    fprintf(stderr, "FAILED: %u byte pages: %s\n", page_size, what);
+    lob_test_failures++;
+  }
+}
+
+static void lob_test_write_addr(byte *ptr, page_no_t page_no, ulint offset) {
+  mach_write_to_4(ptr + FIL_ADDR_PAGE, page_no);
+  mach_write_to_2(ptr + FIL_ADDR_BYTE, offset);
+}
+
+/** Index entries of a LOB first page, as InnoDB sizes the array */
+static ulint lob_test_n_entries(ulint page_size) {
+  switch (page_size) {
+    case 4096:
+    case 8192:
+      return 5;
+    case 32768:
+      return 20;
+    case 65536:
+      return 40;
+    default:
+      return 10;
+  }
+}
+
+/** Writes the tablespace and returns the value its LOB holds.
+@return false if the file cannot be written */
+static bool lob_test_write_space(const char *path, ulint page_size,
+                                 std::string *value) {
+  const ulint first_entries =
+      (ulint)BlobFirstPage::OFFSET_INDEX_LIST + 2 * FLST_BASE_NODE_SIZE;
+  const ulint n_entries = lob_test_n_entries(page_size);
+  const ulint first_data = first_entries + n_entries * LOB_TEST_ENTRY_SIZE;
+  const ulint first_len = page_size - FIL_PAGE_DATA_END - first_data;
+  const ulint data_len =
+      page_size - FIL_PAGE_DATA_END - (ulint)BlobDataPage::LOB_PAGE_DATA;
+  /* every entry of the first page used, the last data page half full */
+  const ulint n_data_pages = n_entries - 1;
+  const ulint last_len = data_len / 2;
+  const ulint n_pages = LOB_TEST_DATA + n_data_pages;
+
+  std::vector<byte> file(n_pages * page_size);
+  for (page_no_t page_no = 0; page_no < n_pages; page_no++) {
+    byte *page = &file[page_no * page_size];
+    mach_write_to_4(page + FIL_PAGE_OFFSET, page_no);
+    mach_write_to_4(page + FIL_PAGE_PREV, FIL_NULL);
+    mach_write_to_4(page + FIL_PAGE_NEXT, FIL_NULL);
+    mach_write_to_4(page + FIL_PAGE_SPACE_ID, LOB_TEST_SPACE_ID);
+  }
+
+  /* page 0: the page size and the atomic blobs flag of DYNAMIC */
+  byte *fsp = &file[0];
+  mach_write_to_2(fsp + FIL_PAGE_TYPE, FIL_PAGE_TYPE_FSP_HDR);
+  uint32_t ssize = 0;
+  while ((((ulint)UNIV_ZIP_SIZE_MIN >> 1) << ssize) < page_size) {
+    ssize++;
+  }
+  mach_write_to_4(fsp + FSP_HEADER_OFFSET + FSP_SPACE_ID, LOB_TEST_SPACE_ID);
+  mach_write_to_4(fsp + FSP_HEADER_OFFSET + FSP_SPACE_FLAGS,
+                  (1U << FSP_FLAGS_POS_POST_ANTELOPE) |
+                      (1U << FSP_FLAGS_POS_ATOMIC_BLOBS) |
+                      (ssize << FSP_FLAGS_POS_PAGE_SSIZE));
+  mach_write_to_4(fsp + FSP_HEADER_OFFSET + FSP_SIZE, n_pages);
+
+  /* the value, a byte pattern that shows a misplaced piece */
+  value->clear();
+  uint64_t seed = page_size;
+  const ulint length = first_len + (n_data_pages - 1) * data_len + last_len;
+  for (ulint i = 0; i < length; i++) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    value->push_back((char)(seed >> 56));
+  }
+
+  /* the first page: its own data is the first entry, each data page the
+  next one */
+  byte *first = &file[LOB_TEST_FIRST * page_size];
+  mach_write_to_2(first + FIL_PAGE_TYPE, FIL_PAGE_TYPE_LOB_FIRST);
+  mach_write_to_1(first + FIL_PAGE_DATA, 1);
+  mach_write_to_4(first + (ulint)BlobFirstPage::OFFSET_DATA_LEN, first_len);
+  byte *base = first + (ulint)BlobFirstPage::OFFSET_INDEX_LIST;
+  mach_write_to_4(base + FLST_LEN, n_entries);
+  lob_test_write_addr(base + FLST_FIRST, LOB_TEST_FIRST, first_entries);
+  lob_test_write_addr(
+      base + FLST_LAST, LOB_TEST_FIRST,
+      first_entries + (n_entries - 1) * LOB_TEST_ENTRY_SIZE);
+  lob_test_write_addr(base + FLST_BASE_NODE_SIZE + FLST_FIRST, FIL_NULL, 0);
+  lob_test_write_addr(base + FLST_BASE_NODE_SIZE + FLST_LAST, FIL_NULL, 0);
+  ulint pos = 0;
+  for (ulint e = 0; e < n_entries; e++) {
+    byte *entry = first + first_entries + e * LOB_TEST_ENTRY_SIZE;
+    ulint next = e + 1 < n_entries ? first_entries + (e + 1) * LOB_TEST_ENTRY_SIZE
+                                   : 0;
+    lob_test_write_addr(entry + LOB_TEST_ENTRY_NEXT,
+                        next != 0 ? (page_no_t)LOB_TEST_FIRST : FIL_NULL, next);
+    lob_test_write_addr(entry + LOB_TEST_ENTRY_VERSIONS + FLST_FIRST, FIL_NULL,
+                        0);
+    lob_test_write_addr(entry + LOB_TEST_ENTRY_VERSIONS + FLST_LAST, FIL_NULL,
+                        0);
+    mach_write_to_4(entry + LOB_TEST_ENTRY_LOB_VERSION, LOB_TEST_VERSION);
+    page_no_t page_no =
+        e == 0 ? (page_no_t)LOB_TEST_FIRST : (page_no_t)LOB_TEST_DATA + e - 1;
+    ulint len = e == 0 ? first_len : e + 1 < n_entries ? data_len : last_len;
+    byte *page = &file[page_no * page_size];
+    ulint data_off = e == 0 ? first_data : (ulint)BlobDataPage::LOB_PAGE_DATA;
+    if (e > 0) {
+      mach_write_to_2(page + FIL_PAGE_TYPE, FIL_PAGE_TYPE_LOB_DATA);
+      mach_write_to_4(page + (ulint)BlobDataPage::OFFSET_DATA_LEN, len);
+    }
+    memcpy(page + data_off, value->data() + pos, len);
+    pos += len;
+    mach_write_to_4(entry + LOB_TEST_ENTRY_PAGE_NO, page_no);
+    mach_write_to_4(entry + LOB_TEST_ENTRY_DATA_LEN, len);
+  }
+
+  /* the leaf page: infimum, the row, supremum. The row is id, DB_TRX_ID,
+  DB_ROLL_PTR and a reference with no local prefix, after the 2-byte
+  length of the LOB column and the 5-byte header. */
+  byte *leaf = &file[LOB_TEST_LEAF * page_size];
+  mach_write_to_2(leaf + FIL_PAGE_TYPE, FIL_PAGE_INDEX);
+  const ulint rec_off = PAGE_NEW_SUPREMUM_END + 2 + REC_N_NEW_EXTRA_BYTES;
+  const ulint rec_size = 4 + 6 + 7 + BTR_EXTERN_FIELD_REF_SIZE;
+  byte *rec = leaf + rec_off;
+  rec[-6] = 0x80 | 0x40 | (BTR_EXTERN_FIELD_REF_SIZE >> 8);
+  rec[-7] = BTR_EXTERN_FIELD_REF_SIZE & 0xFF;
+  rec[-5] = 0;
+  mach_write_to_2(rec - 4, (PAGE_HEAP_NO_USER_LOW << REC_HEAP_NO_SHIFT) |
+                               REC_STATUS_ORDINARY);
+  mach_write_to_2(rec - 2, (PAGE_NEW_SUPREMUM - rec_off) & 0xFFFF);
+  mach_write_to_4(rec, 1 ^ 0x80000000);
+  mach_write_to_6(rec + 4, 1000);
+  mach_write_to_8(rec + 10, 1ULL << 63);
+  byte *ref = rec + 17;
+  mach_write_to_4(ref + BTR_EXTERN_SPACE_ID, LOB_TEST_SPACE_ID);
+  mach_write_to_4(ref + BTR_EXTERN_PAGE_NO, LOB_TEST_FIRST);
+  mach_write_to_4(ref + BTR_EXTERN_VERSION, LOB_TEST_VERSION);
+  mach_write_to_4(ref + BTR_EXTERN_LEN + 4, length);
+
+  memcpy(leaf + PAGE_NEW_INFIMUM, "infimum\0", 8);
+  leaf[PAGE_NEW_INFIMUM - 5] = 1;
+  mach_write_to_2(leaf + PAGE_NEW_INFIMUM - 4,
+                  (PAGE_HEAP_NO_INFIMUM << REC_HEAP_NO_SHIFT) |
+                      REC_STATUS_INFIMUM);
+  mach_write_to_2(leaf + PAGE_NEW_INFIMUM - 2,
+                  (rec_off - PAGE_NEW_INFIMUM) & 0xFFFF);
+  memcpy(leaf + PAGE_NEW_SUPREMUM, "supremum", 8);
+  leaf[PAGE_NEW_SUPREMUM - 5] = 2;
+  mach_write_to_2(leaf + PAGE_NEW_SUPREMUM - 4,
+                  (PAGE_HEAP_NO_SUPREMUM << REC_HEAP_NO_SHIFT) |
+                      REC_STATUS_SUPREMUM);
+  mach_write_to_2(leaf + page_size - FIL_PAGE_DATA_END - 2, PAGE_NEW_INFIMUM);
+  mach_write_to_2(leaf + page_size - FIL_PAGE_DATA_END - 4, PAGE_NEW_SUPREMUM);
+  byte *header = leaf + PAGE_HEADER;
+  mach_write_to_2(header + PAGE_N_DIR_SLOTS, 2);
+  mach_write_to_2(header + PAGE_HEAP_TOP, rec_off + rec_size);
+  mach_write_to_2(header + PAGE_N_HEAP,
+                  PAGE_IS_COMPACT | (PAGE_HEAP_NO_USER_LOW + 1));
+  mach_write_to_2(header + PAGE_N_RECS, 1);
+  mach_write_to_2(header + PAGE_LEVEL, 0);
+  mach_write_to_8(header + PAGE_INDEX_ID, LOB_TEST_INDEX_ID);
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    return false;
+  }
+  bool ok = write(fd, file.data(), file.size()) == (ssize_t)file.size();
+  return close(fd) == 0 && ok;
+}
+
+/** Writes the ibd2sdi json of the table: id INT PRIMARY KEY, a LONGBLOB */
+static bool lob_test_write_sdi(const char *path) {
+  FILE *f = fopen(path, "w");
+  if (f == nullptr) {
+    return false;
+  }
+  struct {
+    const char *name;
+    int type;
+    uint32_t char_length;
+    int collation_id;
+    int hidden;
+  } cols[] = {{"id", 4, 11, 8, 1},
+              {LOB_TEST_COLUMN, 24, 4294967295U, 63, 1},
+              {"DB_TRX_ID", 10, 6, 63, 2},
+              {"DB_ROLL_PTR", 9, 7, 63, 2}};
+  fprintf(f, "[\"ibd2sdi\", {\"type\": 1, \"id\": %u, \"object\": {"
+             "\"dd_object_type\": \"Table\", \"dd_object\": {"
+             "\"name\": \"t\", \"se_private_id\": %u, \"columns\": [\n",
+          LOB_TEST_SPACE_ID, LOB_TEST_SPACE_ID);
+  for (size_t i = 0; i < 4; i++) {
+    fprintf(f,
+            "{\"name\": \"%s\", \"type\": %d, \"is_nullable\": false, "
+            "\"is_unsigned\": false, \"hidden\": %d, \"char_length\": %u, "
+            "\"numeric_precision\": 0, \"numeric_scale\": 0, "
+            "\"datetime_precision\": 0, \"collation_id\": %d, "
+            "\"column_type_utf8\": \"\"}%s\n",
+            cols[i].name, cols[i].type, cols[i].hidden,
+            cols[i].char_length, cols[i].collation_id,
+            i + 1 < 4 ? "," : "");
+  }
+  fprintf(f, "], \"indexes\": [{\"name\": \"PRIMARY\", \"type\": 1, "
+             "\"se_private_data\": \"id=%lu;root=%u;space_id=%u;\", "
+             "\"elements\": [\n",
+          LOB_TEST_INDEX_ID, (uint32_t)LOB_TEST_LEAF, LOB_TEST_SPACE_ID);
+  /* id, DB_TRX_ID, DB_ROLL_PTR, then the blob */
+  const int opx[] = {0, 2, 3, 1};
+  for (size_t i = 0; i < 4; i++) {
+    fprintf(f,
+            "{\"length\": %u, \"hidden\": %s, \"column_opx\": %d}%s\n",
+            i == 0 ? 4 : 4294967295U, i == 0 ? "false" : "true", opx[i],
+            i + 1 < 4 ? "," : "");
+  }
+  fprintf(f, "]}]}}}]\n");
+  bool ok = ferror(f) == 0;
+  return fclose(f) == 0 && ok;
+}
+
+/** @return the contents of a file, empty if it cannot be read */
+static std::string lob_test_read_file(const std::string &path) {
+  std::string contents;
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == nullptr) {
+    return contents;
+  }
+  char buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    contents.append(buf, n);
+  }
+  fclose(f);
+  return contents;
+}
+
+static void lob_test_page_size(const std::string &dir, ulint page_size) {
+  const std::string name = dir + "/t" + std::to_string(page_size);
+  const std::string ibd = name + ".ibd";
+  const std::string sdi = name + ".json";
+  const std::string lob_dir = name + "_lobs";
+  std::string value;
+  if (!lob_test_write_space(ibd.c_str(), page_size, &value) ||
+      !lob_test_write_sdi(sdi.c_str()) || mkdir(lob_dir.c_str(), 0755) != 0) {
+    lob_test_check(false, page_size, "cannot write the test files");
+    return;
+  }
+  int fd = open(ibd.c_str(), O_RDONLY);
+  if (fd == -1) {
+    lob_test_check(false, page_size, "cannot open the tablespace");
+    return;
+  }
+  const page_size_t space_page_size = fil_get_page_size(fd);
+  lob_test_check(space_page_size.logical() == page_size, page_size,
+                 "page size read from the FSP flags");
+
+  /* lob_read() on the reference of the row */
+  std::vector<byte> leaf(page_size);
+  lob_test_check(pread(fd, leaf.data(), page_size,
+                       (off_t)LOB_TEST_LEAF * page_size) == (ssize_t)page_size,
+                 page_size, "read of the leaf page");
+  const ulint rec_off = PAGE_NEW_SUPREMUM_END + 2 + REC_N_NEW_EXTRA_BYTES;
+  lob_ref_t ref = lob_ref_parse(leaf.data() + rec_off + 17);
+  void *buf;
+  if (posix_memalign(&buf, UNIV_PAGE_SIZE_MAX, page_size) != 0) {
+    lob_test_check(false, page_size, "out of memory");
+    close(fd);
+    return;
+  }
+  std::string read;
+  uint64_t n_read = 0;
+  lob_status_t status = lob_read(
+      fd, space_page_size, ref, static_cast<byte *>(buf),
+      [&](const byte *data, ulint len) {
+        read.append(reinterpret_cast<const char *>(data), len);
+        return true;
+      },
+      &n_read);
+  free(buf);
+  lob_test_check(status == LOB_OK, page_size, "lob_read() status");
+  lob_test_check(n_read == value.size() && read == value, page_size,
+                 "value returned by lob_read()");
+
+  /* dump-lobs --lob-dir, its report thrown away */
+  fflush(stdout);
+  int saved_stdout = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  DumpLobs(fd, sdi.c_str(), lob_dir.c_str());
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  close(null_fd);
+  close(saved_stdout);
+  close(fd);
+
+  const std::string file = lob_dir + "/p1_h2_c1_b_______escape";
+  lob_test_check(lob_test_read_file(file) == value, page_size,
+                 "value written by DumpLobs() to its --lob-dir file");
+
+  /* what failed is left behind to look at */
+  if (lob_test_failures == 0) {
+    unlink(file.c_str());
+    rmdir(lob_dir.c_str());
+    unlink(ibd.c_str());
+    unlink(sdi.c_str());
+  }
+}
+
+int main(int argc, char **argv) {
+  char tmpl[] = "/tmp/lob0lob_test.XXXXXX";
+  const char *dir = argc > 1 ? argv[1] : mkdtemp(tmpl);
+  if (dir == nullptr) {
+    perror("mkdtemp");
+    return 1;
+  }
+  const ulint page_sizes[] = {4096, 8192, 16384, 32768, 65536};
+  for (ulint page_size : page_sizes) {
+    lob_test_page_size(dir, page_size);
+  }
+  if (lob_test_failures != 0) {
+    printf("lob0lob_test: FAILED, files in %s\n", dir);
+    return 1;
+  }
+  if (argc == 1) {
+    rmdir(dir);
+  }
+  printf("lob0lob_test: ok\n");
+  return 0;
+}